@@ -41,7 +41,6 @@
 
 #include <string>
 #include <vector>
-#include <unordered_map>
 #include <chrono>
 
 #include <ros/ros.h>
@@ -71,16 +70,7 @@
 
 #include <Eigen/Eigen>
 
-namespace std {
-	template <>
-	class hash< cv::Point >{
-	public :
-		size_t operator()(const cv::Point &pixel_cloud ) const
-		{
-			return hash<std::string>()( std::to_string(pixel_cloud.x) + "|" + std::to_string(pixel_cloud.y) );
-		}
-	};
-};
+#include "image_processor/undistortion_maps.h"
 
 class RosPixelCloudFusionApp
 {
@@ -92,8 +82,7 @@ class RosPixelCloudFusionApp
 	tf::StampedTransform                camera_lidar_tf_;
 
 	cv::Size                            image_size_;
-	cv::Mat                             camera_instrinsics_;
-	cv::Mat                             distortion_coefficients_;
+	image_processor::UndistortionMaps   undistortion_maps_;
 	cv::Mat                             current_frame_;
 
 	std::string 						image_frame_id_;
@@ -103,7 +92,12 @@ class RosPixelCloudFusionApp
 	bool                                camera_lidar_tf_ok_;
 
 	float                               fx_, fy_, cx_, cy_;
+
+	// kept between clouds so that their buffers are only allocated once
+	pcl::PointCloud<pcl::PointXYZ>      in_cloud_;
 	pcl::PointCloud<pcl::PointXYZRGB>   colored_cloud_;
+	std::vector<int>                    point_pixels_;   // v * width + u of the projected points
+	std::vector<int>                    point_indices_;
 
 	typedef
 	message_filters::sync_policies::ApproximateTime<sensor_msgs::PointCloud2, sensor_msgs::Image> SyncPolicyT;
@@ -58,8 +58,7 @@ void RosPixelCloudFusionApp::ImageCallback(const sensor_msgs::Image::ConstPtr &i
 	cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(in_image_msg, "bgr8");
 	cv::Mat in_image = cv_image->image;
 
-	cv::Mat undistorted_image;
-	cv::undistort(in_image, current_frame_, camera_instrinsics_, distortion_coefficients_);
+	undistortion_maps_.Undistort(in_image, current_frame_);
 
 	image_frame_id_ = in_image_msg->header.frame_id;
 	image_size_.height = current_frame_.rows;
@@ -84,54 +83,63 @@ void RosPixelCloudFusionApp::CloudCallback(const sensor_msgs::PointCloud2::Const
 		return;
 	}
 
-	pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud(new pcl::PointCloud<pcl::PointXYZ>);
-	pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud(new pcl::PointCloud<pcl::PointXYZRGB>);
-	pcl::fromROSMsg(*in_cloud_msg, *in_cloud);
-	std::unordered_map<cv::Point, pcl::PointXYZ> projection_map;
+	pcl::fromROSMsg(*in_cloud_msg, in_cloud_);
 
-	std::vector<pcl::PointXYZ> cam_cloud(in_cloud->points.size());
-	for (size_t i = 0; i < in_cloud->points.size(); i++)
+	// Project the points on the image, -1 for the ones outside of it
+	const int point_count = static_cast<int>(in_cloud_.points.size());
+	point_pixels_.resize(point_count);
+#pragma omp parallel for
+	for (int i = 0; i < point_count; i++)
 	{
-		cam_cloud[i] = TransformPoint(in_cloud->points[i], camera_lidar_tf_);
-		int u = int(cam_cloud[i].x * fx_ / cam_cloud[i].z + cx_);
-		int v = int(cam_cloud[i].y * fy_ / cam_cloud[i].z + cy_);
-		if ((u >= 0) && (u < image_size_.width)
-			&& (v >= 0) && (v < image_size_.height)
-			&& cam_cloud[i].z > 0
-				)
+		pcl::PointXYZ cam_point = TransformPoint(in_cloud_.points[i], camera_lidar_tf_);
+		point_pixels_[i] = -1;
+		if (cam_point.z > 0)
 		{
-			projection_map.insert(std::pair<cv::Point, pcl::PointXYZ>(cv::Point(u, v), in_cloud->points[i]));
+			int u = int(cam_point.x * fx_ / cam_point.z + cx_);
+			int v = int(cam_point.y * fy_ / cam_point.z + cy_);
+			if ((u >= 0) && (u < image_size_.width)
+			    && (v >= 0) && (v < image_size_.height))
+			{
+				point_pixels_[i] = v * image_size_.width + u;
+			}
 		}
 	}
 
-	out_cloud->points.clear();
-
-#pragma omp for
-	for (int row = 0; row < image_size_.height; row++)
+	// Keep the projected points at the front, in the order of the input cloud
+	point_indices_.resize(point_count);
+	int colored_count = 0;
+	for (int i = 0; i < point_count; i++)
 	{
-		for (int col = 0; col < image_size_.width; col++)
+		if (point_pixels_[i] >= 0)
 		{
-			std::unordered_map<cv::Point, pcl::PointXYZ>::const_iterator iterator_3d_2d;
-			pcl::PointXYZ corresponding_3d_point;
-			pcl::PointXYZRGB colored_3d_point;
-			iterator_3d_2d = projection_map.find(cv::Point(col, row));
-			if (iterator_3d_2d != projection_map.end())
-			{
-				corresponding_3d_point = iterator_3d_2d->second;
-				cv::Vec3b rgb_pixel = current_frame_.at<cv::Vec3b>(row, col);
-				colored_3d_point.x = corresponding_3d_point.x;
-				colored_3d_point.y = corresponding_3d_point.y;
-				colored_3d_point.z = corresponding_3d_point.z;
-				colored_3d_point.r = rgb_pixel[2];
-				colored_3d_point.g = rgb_pixel[1];
-				colored_3d_point.b = rgb_pixel[0];
-				out_cloud->points.push_back(colored_3d_point);
-			}
+			point_indices_[colored_count] = i;
+			point_pixels_[colored_count] = point_pixels_[i];
+			colored_count++;
 		}
 	}
+	colored_cloud_.points.resize(colored_count);
+	colored_cloud_.width = colored_count;
+	colored_cloud_.height = 1;
+
+	// Colour them, each point writes its own slot
+#pragma omp parallel for
+	for (int j = 0; j < colored_count; j++)
+	{
+		const pcl::PointXYZ &in_point = in_cloud_.points[point_indices_[j]];
+		const cv::Vec3b &rgb_pixel = current_frame_.at<cv::Vec3b>(point_pixels_[j] / image_size_.width,
+		                                                          point_pixels_[j] % image_size_.width);
+		pcl::PointXYZRGB &colored_3d_point = colored_cloud_.points[j];
+		colored_3d_point.x = in_point.x;
+		colored_3d_point.y = in_point.y;
+		colored_3d_point.z = in_point.z;
+		colored_3d_point.r = rgb_pixel[2];
+		colored_3d_point.g = rgb_pixel[1];
+		colored_3d_point.b = rgb_pixel[0];
+	}
+
 	// Publish PC
 	sensor_msgs::PointCloud2 cloud_msg;
-	pcl::toROSMsg(*out_cloud, cloud_msg);
+	pcl::toROSMsg(colored_cloud_, cloud_msg);
 	cloud_msg.header = in_cloud_msg->header;
 	publisher_fused_cloud_.publish(cloud_msg);
 }
@@ -141,20 +149,7 @@ void RosPixelCloudFusionApp::IntrinsicsCallback(const sensor_msgs::CameraInfo &i
 	image_size_.height = in_message.height;
 	image_size_.width = in_message.width;
 
-	camera_instrinsics_ = cv::Mat(3, 3, CV_64F);
-	for (int row = 0; row < 3; row++)
-	{
-		for (int col = 0; col < 3; col++)
-		{
-			camera_instrinsics_.at<double>(row, col) = in_message.K[row * 3 + col];
-		}
-	}
-
-	distortion_coefficients_ = cv::Mat(1, 5, CV_64F);
-	for (int col = 0; col < 5; col++)
-	{
-		distortion_coefficients_.at<double>(col) = in_message.D[col];
-	}
+	undistortion_maps_.SetCameraInfo(in_message);
 
 	fx_ = static_cast<float>(in_message.P[0]);
 	fy_ = static_cast<float>(in_message.P[5]);
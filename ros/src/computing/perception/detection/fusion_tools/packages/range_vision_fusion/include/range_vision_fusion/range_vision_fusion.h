@@ -70,6 +70,8 @@
 
 #include "autoware_msgs/DetectedObjectArray.h"
 
+#include "image_processor/undistortion_maps.h"
+
 class RosRangeVisionFusionApp
 {
     ros::NodeHandle                     node_handle_;
@@ -88,8 +90,7 @@ class RosRangeVisionFusionApp
     tf::StampedTransform                camera_lidar_tf_;
 
     cv::Size                            image_size_;
-    cv::Mat                             camera_instrinsics_;
-    cv::Mat                             distortion_coefficients_;
+    image_processor::UndistortionMaps   undistortion_maps_;
 
     cv::Mat                             image_;
     ros::Subscriber                     image_subscriber_;
@@ -572,8 +572,7 @@ void RosRangeVisionFusionApp::ImageCallback(const sensor_msgs::Image::ConstPtr &
     cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(in_image_msg, "bgr8");
     cv::Mat in_image = cv_image->image;
 
-    cv::Mat undistorted_image;
-    cv::undistort(in_image, image_, camera_instrinsics_, distortion_coefficients_);
+    undistortion_maps_.Undistort(in_image, image_);
 };
 
 void
@@ -582,20 +581,7 @@ RosRangeVisionFusionApp::IntrinsicsCallback(const sensor_msgs::CameraInfo &in_me
     image_size_.height = in_message.height;
     image_size_.width = in_message.width;
 
-    camera_instrinsics_ = cv::Mat(3, 3, CV_64F);
-    for (int row = 0; row < 3; row++)
-    {
-        for (int col = 0; col < 3; col++)
-        {
-            camera_instrinsics_.at<double>(row, col) = in_message.K[row * 3 + col];
-        }
-    }
-
-    distortion_coefficients_ = cv::Mat(1, 5, CV_64F);
-    for (int col = 0; col < 5; col++)
-    {
-        distortion_coefficients_.at<double>(col) = in_message.D[col];
-    }
+    undistortion_maps_.SetCameraInfo(in_message);
 
     fx_ = static_cast<float>(in_message.P[0]);
     fy_ = static_cast<float>(in_message.P[5]);
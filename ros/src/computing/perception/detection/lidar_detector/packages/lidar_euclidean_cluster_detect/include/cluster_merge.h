@@ -0,0 +1,44 @@
+#ifndef CLUSTER_MERGE_H_
+#define CLUSTER_MERGE_H_
+
+#include <vector>
+
+#include <std_msgs/Header.h>
+
+#include "cluster.h"
+#include "grid_euclidean_clustering.h"
+
+/* \brief Merges the clusters whose XY centroids are closer than a threshold.
+ *
+ * The centroids are indexed in a GridEuclideanCluster, so only clusters in neighbour cells are compared, and each
+ * connected group is merged into one cluster. Merged centroids move, so this is repeated until no group has more than
+ * one cluster. The grid buffers are kept between calls.
+ * */
+class ClusterMerge
+{
+public:
+  ClusterMerge();
+
+  void setThreshold(double threshold);
+
+  /* \brief Colors of the merged clusters, picked by their index in the output */
+  void setColors(const std::vector<cv::Scalar>& colors);
+  void setPoseEstimation(bool pose_estimation);
+
+  /* \brief Appends the merged clusters to out_clusters, clusters with no close neighbour are appended as they are */
+  void mergeAll(const std::vector<ClusterPtr>& in_clusters, const std_msgs::Header& in_header,
+                std::vector<ClusterPtr>& out_clusters);
+
+  /* \brief Merges the clusters of in_merge_indices into one cluster with id in_id, appended to out_clusters, and
+   * marks them in in_out_merged_clusters */
+  void mergeClusters(const std::vector<ClusterPtr>& in_clusters, const std::vector<size_t>& in_merge_indices,
+                     size_t in_id, const std_msgs::Header& in_header, std::vector<ClusterPtr>& out_clusters,
+                     std::vector<bool>& in_out_merged_clusters) const;
+
+private:
+  GridEuclideanCluster grid_;
+  std::vector<cv::Scalar> colors_;
+  bool pose_estimation_;
+};
+
+#endif  // CLUSTER_MERGE_H_
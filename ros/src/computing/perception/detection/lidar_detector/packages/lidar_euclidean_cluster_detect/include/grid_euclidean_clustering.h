@@ -0,0 +1,67 @@
+#ifndef GRID_EUCLIDEAN_H_
+#define GRID_EUCLIDEAN_H_
+
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+/* \brief CPU Euclidean clustering on the XY plane, using a hash grid and a concurrent union-find.
+ *
+ * The cloud can be split in range bands, each one with its own distance threshold. All the bands are clustered
+ * in a single pass, giving the same clusters as running pcl::EuclideanClusterExtraction on each band separately.
+ * Grid cells are threshold/sqrt(2) wide, so the points of a cell are always connected and two neighbour cells
+ * are joined as soon as one pair of their points is close enough. Cells are processed with OpenMP.
+ * The buffers are kept between calls to avoid reallocating them on each frame.
+ * */
+class GridEuclideanCluster
+{
+public:
+  GridEuclideanCluster();
+
+  void setInputCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& in_cloud_ptr);
+
+  /* \brief Uses a single distance threshold for the whole cloud */
+  void setThreshold(double threshold);
+
+  /* \brief Band i contains the points with XY range below ranges[i] and not in a previous band, the points
+   * farther than the last range form an extra band, so thresholds must contain ranges.size() + 1 values */
+  void setThresholds(const std::vector<double>& ranges, const std::vector<double>& thresholds);
+
+  void setMinClusterPts(int min_cluster_pts);
+  void setMaxClusterPts(int max_cluster_pts);
+  void extractClusters();
+
+  /* \brief Indices of the points of each cluster in ascending order. Clusters are sorted by band and then by
+   * decreasing size */
+  const std::vector<std::vector<int> >& getOutput() const;
+
+private:
+  pcl::PointCloud<pcl::PointXYZ>::ConstPtr cloud_ptr_;
+  std::vector<double> ranges_;
+  std::vector<double> thresholds_;
+  std::vector<double> cell_sizes_;
+  int min_cluster_pts_;
+  int max_cluster_pts_;
+
+  std::unique_ptr<std::atomic<int>[]> parent_;
+  size_t parent_capacity_;
+  std::vector<std::pair<uint64_t, int> > cell_points_;  // (cell key, point index) sorted by key
+  std::vector<uint64_t> cell_keys_;                     // key of each non empty cell
+  std::vector<int> cell_begin_;                         // first position of each cell in cell_points_
+  std::vector<int> cluster_slot_;                       // output cluster of each union-find root, or -1
+  std::vector<int> cluster_band_;
+  std::vector<std::vector<int> > clusters_;
+
+  int find(int point);
+  void unite(int point_a, int point_b);
+  int bandOf(float range) const;
+  static uint64_t cellKey(int band, int64_t cell_x, int64_t cell_y);
+  int findCell(uint64_t key) const;
+};
+
+#endif  // GRID_EUCLIDEAN_H_
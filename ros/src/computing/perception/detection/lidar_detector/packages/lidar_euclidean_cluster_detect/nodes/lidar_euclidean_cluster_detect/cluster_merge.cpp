@@ -0,0 +1,104 @@
+/*
+ * cluster_merge.cpp
+ *
+ * Merge of the clusters with close centroids, shared by lidar_euclidean_cluster_detect and cluster_merge_benchmark
+ */
+
+#include "cluster_merge.h"
+
+ClusterMerge::ClusterMerge() : colors_(1, cv::Scalar(255, 255, 255)), pose_estimation_(false)
+{
+}
+
+void ClusterMerge::setThreshold(double threshold)
+{
+  grid_.setThreshold(threshold);
+}
+
+void ClusterMerge::setColors(const std::vector<cv::Scalar>& colors)
+{
+  if (!colors.empty())
+    colors_ = colors;
+}
+
+void ClusterMerge::setPoseEstimation(bool pose_estimation)
+{
+  pose_estimation_ = pose_estimation;
+}
+
+void ClusterMerge::mergeClusters(const std::vector<ClusterPtr>& in_clusters, const std::vector<size_t>& in_merge_indices,
+                                 size_t in_id, const std_msgs::Header& in_header,
+                                 std::vector<ClusterPtr>& out_clusters,
+                                 std::vector<bool>& in_out_merged_clusters) const
+{
+  pcl::PointCloud<pcl::PointXYZRGB> sum_cloud;
+  pcl::PointCloud<pcl::PointXYZ> mono_cloud;
+  ClusterPtr merged_cluster(new Cluster());
+  for (size_t i = 0; i < in_merge_indices.size(); i++)
+  {
+    sum_cloud += *(in_clusters[in_merge_indices[i]]->GetCloud());
+    in_out_merged_clusters[in_merge_indices[i]] = true;
+  }
+  std::vector<int> indices(sum_cloud.points.size(), 0);
+  for (size_t i = 0; i < sum_cloud.points.size(); i++)
+  {
+    indices[i] = i;
+  }
+
+  if (sum_cloud.points.size() > 0)
+  {
+    pcl::copyPointCloud(sum_cloud, mono_cloud);
+    const cv::Scalar& color = colors_[in_id % colors_.size()];
+    merged_cluster->SetCloud(mono_cloud.makeShared(), indices, in_header, in_id, (int)color.val[0],
+                             (int)color.val[1], (int)color.val[2], "", pose_estimation_);
+    out_clusters.push_back(merged_cluster);
+  }
+}
+
+void ClusterMerge::mergeAll(const std::vector<ClusterPtr>& in_clusters, const std_msgs::Header& in_header,
+                            std::vector<ClusterPtr>& out_clusters)
+{
+  std::vector<ClusterPtr> current_clusters = in_clusters;
+  while (current_clusters.size() > 1)
+  {
+    pcl::PointCloud<pcl::PointXYZ>::Ptr centroids_ptr(new pcl::PointCloud<pcl::PointXYZ>);
+    centroids_ptr->points.resize(current_clusters.size());
+    for (size_t i = 0; i < current_clusters.size(); i++)
+    {
+      centroids_ptr->points[i] = current_clusters[i]->GetCentroid();
+    }
+    grid_.setInputCloud(centroids_ptr);
+    grid_.extractClusters();
+    const std::vector<std::vector<int> >& groups = grid_.getOutput();
+
+    bool merged = false;
+    for (size_t k = 0; k < groups.size() && !merged; k++)
+    {
+      merged = groups[k].size() > 1;
+    }
+    if (!merged)
+      break;
+
+    std::vector<ClusterPtr> merged_clusters;
+    std::vector<bool> visited_clusters(current_clusters.size(), false);
+    for (size_t k = 0; k < groups.size(); k++)
+    {
+      if (groups[k].size() > 1)
+      {
+        std::vector<size_t> merge_indices(groups[k].begin(), groups[k].end());
+        mergeClusters(current_clusters, merge_indices, merged_clusters.size(), in_header, merged_clusters,
+                      visited_clusters);
+      }
+    }
+    for (size_t i = 0; i < current_clusters.size(); i++)
+    {
+      // clusters with no close neighbour, or a non finite centroid, are kept as they are
+      if (!visited_clusters[i])
+      {
+        merged_clusters.push_back(current_clusters[i]);
+      }
+    }
+    current_clusters.swap(merged_clusters);
+  }
+  out_clusters.insert(out_clusters.end(), current_clusters.begin(), current_clusters.end());
+}
@@ -0,0 +1,175 @@
+// Replay the point clouds of a bag file, cluster them with GridEuclideanCluster and time the cluster merge stage on
+// each frame: the grid merge of ClusterMerge against the former all-pairs merge, which ran twice. The bag should hold
+// clouds without the ground, as the node clusters them, e.g. /points_no_ground.
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include "cluster.h"
+#include "cluster_merge.h"
+#include "grid_euclidean_clustering.h"
+
+// the merge stage before the grid, kept here as the reference
+static void checkClusterMergePairwise(size_t in_cluster_id, std::vector<ClusterPtr>& in_clusters,
+                                      std::vector<bool>& in_out_visited_clusters,
+                                      std::vector<size_t>& out_merge_indices, double in_merge_threshold)
+{
+  pcl::PointXYZ point_a = in_clusters[in_cluster_id]->GetCentroid();
+  for (size_t i = 0; i < in_clusters.size(); i++)
+  {
+    if (i != in_cluster_id && !in_out_visited_clusters[i])
+    {
+      pcl::PointXYZ point_b = in_clusters[i]->GetCentroid();
+      double distance = sqrt(pow(point_b.x - point_a.x, 2) + pow(point_b.y - point_a.y, 2));
+      if (distance <= in_merge_threshold)
+      {
+        in_out_visited_clusters[i] = true;
+        out_merge_indices.push_back(i);
+        checkClusterMergePairwise(i, in_clusters, in_out_visited_clusters, out_merge_indices, in_merge_threshold);
+      }
+    }
+  }
+}
+
+static void checkAllForMergePairwise(const ClusterMerge& in_merge, const std_msgs::Header& in_header,
+                                     std::vector<ClusterPtr>& in_clusters, std::vector<ClusterPtr>& out_clusters,
+                                     float in_merge_threshold)
+{
+  std::vector<bool> visited_clusters(in_clusters.size(), false);
+  std::vector<bool> merged_clusters(in_clusters.size(), false);
+  size_t current_index = 0;
+  for (size_t i = 0; i < in_clusters.size(); i++)
+  {
+    if (!visited_clusters[i])
+    {
+      visited_clusters[i] = true;
+      std::vector<size_t> merge_indices;
+      checkClusterMergePairwise(i, in_clusters, visited_clusters, merge_indices, in_merge_threshold);
+      in_merge.mergeClusters(in_clusters, merge_indices, current_index++, in_header, out_clusters, merged_clusters);
+    }
+  }
+  for (size_t i = 0; i < in_clusters.size(); i++)
+  {
+    if (!merged_clusters[i])
+    {
+      out_clusters.push_back(in_clusters[i]);
+    }
+  }
+}
+
+static void printTimes(const char* in_name, std::vector<double>& in_times)
+{
+  double total = 0;
+  for (double t : in_times)
+    total += t;
+  std::sort(in_times.begin(), in_times.end());
+  printf("%-9s mean %.3f ms, median %.3f ms, max %.3f ms\n", in_name, total / in_times.size(),
+         in_times[in_times.size() / 2], in_times.back());
+}
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "cluster_merge_benchmark");
+
+  if (argc < 2)
+  {
+    std::cerr << "Usage: cluster_merge_benchmark BAG [_points_node:=/points_no_ground] [_repeat:=N]"
+                 " [_clustering_distance:=0.75] [_cluster_merge_threshold:=1.5]"
+                 " [_cluster_size_min:=20] [_cluster_size_max:=100000]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ros::NodeHandle private_nh("~");
+  std::string points_topic;
+  int repeat, cluster_size_min, cluster_size_max;
+  double clustering_distance, cluster_merge_threshold;
+  private_nh.param<std::string>("points_node", points_topic, "/points_no_ground");
+  private_nh.param("repeat", repeat, 1);
+  private_nh.param("clustering_distance", clustering_distance, 0.75);
+  private_nh.param("cluster_merge_threshold", cluster_merge_threshold, 1.5);
+  private_nh.param("cluster_size_min", cluster_size_min, 20);
+  private_nh.param("cluster_size_max", cluster_size_max, 100000);
+
+  std::vector<pcl::PointCloud<pcl::PointXYZ>::Ptr> frames;
+  try
+  {
+    rosbag::Bag bag(argv[1], rosbag::bagmode::Read);
+    rosbag::View view(bag, rosbag::TopicQuery(points_topic));
+    for (const rosbag::MessageInstance& m : view)
+    {
+      sensor_msgs::PointCloud2::ConstPtr cloud_msg = m.instantiate<sensor_msgs::PointCloud2>();
+      if (cloud_msg == nullptr)
+        continue;
+      pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
+      pcl::fromROSMsg(*cloud_msg, *cloud_ptr);
+      frames.push_back(cloud_ptr);
+    }
+  }
+  catch (const rosbag::BagException& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (frames.empty())
+  {
+    std::cerr << "No point cloud on " << points_topic << " in " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  GridEuclideanCluster grid_cluster;
+  grid_cluster.setThreshold(clustering_distance);
+  grid_cluster.setMinClusterPts(cluster_size_min);
+  grid_cluster.setMaxClusterPts(cluster_size_max);
+  ClusterMerge cluster_merge;
+  cluster_merge.setThreshold(cluster_merge_threshold);
+
+  std::vector<double> grid_times, pairwise_times;
+  size_t clusters_num = 0, grid_clusters_num = 0, pairwise_clusters_num = 0;
+  for (int r = 0; r < repeat; r++)
+  {
+    for (const pcl::PointCloud<pcl::PointXYZ>::Ptr& frame : frames)
+    {
+      std_msgs::Header header = pcl_conversions::fromPCL(frame->header);
+      grid_cluster.setInputCloud(frame);
+      grid_cluster.extractClusters();
+      const std::vector<std::vector<int> >& cluster_indices = grid_cluster.getOutput();
+      std::vector<ClusterPtr> all_clusters(cluster_indices.size());
+      for (size_t k = 0; k < cluster_indices.size(); k++)
+      {
+        all_clusters[k].reset(new Cluster());
+        all_clusters[k]->SetCloud(frame, cluster_indices[k], header, k, 255, 255, 255, "", false);
+      }
+      clusters_num += all_clusters.size();
+
+      std::vector<ClusterPtr> grid_clusters;
+      ros::WallTime start = ros::WallTime::now();
+      cluster_merge.mergeAll(all_clusters, header, grid_clusters);
+      grid_times.push_back((ros::WallTime::now() - start).toSec() * 1e3);
+      grid_clusters_num += grid_clusters.size();
+
+      std::vector<ClusterPtr> mid_clusters, pairwise_clusters;
+      start = ros::WallTime::now();
+      checkAllForMergePairwise(cluster_merge, header, all_clusters, mid_clusters, cluster_merge_threshold);
+      checkAllForMergePairwise(cluster_merge, header, mid_clusters, pairwise_clusters, cluster_merge_threshold);
+      pairwise_times.push_back((ros::WallTime::now() - start).toSec() * 1e3);
+      pairwise_clusters_num += pairwise_clusters.size();
+    }
+  }
+
+  size_t merges = grid_times.size();
+  printf("%lu frames, %.1f clusters before the merge, %.1f after the grid merge, %.1f after the pairwise merge\n",
+         (unsigned long)merges, (double)clusters_num / merges, (double)grid_clusters_num / merges,
+         (double)pairwise_clusters_num / merges);
+  printTimes("grid", grid_times);
+  printTimes("pairwise", pairwise_times);
+
+  return EXIT_SUCCESS;
+}
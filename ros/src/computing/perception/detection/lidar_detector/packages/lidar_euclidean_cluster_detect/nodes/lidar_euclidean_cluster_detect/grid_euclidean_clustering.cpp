@@ -0,0 +1,276 @@
+/*
+ * grid_euclidean_clustering.cpp
+ *
+ * Hash grid and union-find Euclidean clustering, CPU counterpart of gpu_euclidean_clustering.cu
+ */
+
+#include "grid_euclidean_clustering.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+const int CELL_BITS = 28;
+const int64_t CELL_OFFSET = int64_t(1) << (CELL_BITS - 1);
+const uint64_t CELL_MASK = (uint64_t(1) << CELL_BITS) - 1;
+
+// Cells are threshold/sqrt(2) wide, so points closer than the threshold are at most two cells apart.
+// Each neighbour pair is visited once, from the cell with the smaller key.
+const int NEIGHBOUR_NUM = 12;
+const int NEIGHBOUR_OFFSETS[NEIGHBOUR_NUM][2] = { { 1, 0 },  { 2, 0 },  { -2, 1 }, { -1, 1 }, { 0, 1 }, { 1, 1 },
+                                                  { 2, 1 },  { -2, 2 }, { -1, 2 }, { 0, 2 },  { 1, 2 }, { 2, 2 } };
+}
+
+GridEuclideanCluster::GridEuclideanCluster()
+  : min_cluster_pts_(1), max_cluster_pts_(std::numeric_limits<int>::max()), parent_capacity_(0)
+{
+  setThreshold(0.5);
+}
+
+void GridEuclideanCluster::setInputCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& in_cloud_ptr)
+{
+  cloud_ptr_ = in_cloud_ptr;
+}
+
+void GridEuclideanCluster::setThreshold(double threshold)
+{
+  setThresholds(std::vector<double>(), std::vector<double>(1, threshold));
+}
+
+void GridEuclideanCluster::setThresholds(const std::vector<double>& ranges, const std::vector<double>& thresholds)
+{
+  ranges_ = ranges;
+  thresholds_ = thresholds;
+  thresholds_.resize(ranges_.size() + 1, thresholds.empty() ? 0.5 : thresholds.back());
+  cell_sizes_.resize(thresholds_.size());
+  for (size_t i = 0; i < thresholds_.size(); i++)
+  {
+    cell_sizes_[i] = thresholds_[i] / std::sqrt(2.0);
+  }
+}
+
+void GridEuclideanCluster::setMinClusterPts(int min_cluster_pts)
+{
+  min_cluster_pts_ = min_cluster_pts;
+}
+
+void GridEuclideanCluster::setMaxClusterPts(int max_cluster_pts)
+{
+  max_cluster_pts_ = max_cluster_pts;
+}
+
+const std::vector<std::vector<int> >& GridEuclideanCluster::getOutput() const
+{
+  return clusters_;
+}
+
+int GridEuclideanCluster::bandOf(float range) const
+{
+  int band = 0;
+  while (band < (int)ranges_.size() && range >= ranges_[band])
+  {
+    band++;
+  }
+  return band;
+}
+
+uint64_t GridEuclideanCluster::cellKey(int band, int64_t cell_x, int64_t cell_y)
+{
+  return ((uint64_t)band << (2 * CELL_BITS)) | (((uint64_t)(cell_x + CELL_OFFSET) & CELL_MASK) << CELL_BITS) |
+         ((uint64_t)(cell_y + CELL_OFFSET) & CELL_MASK);
+}
+
+int GridEuclideanCluster::findCell(uint64_t key) const
+{
+  std::vector<uint64_t>::const_iterator it = std::lower_bound(cell_keys_.begin(), cell_keys_.end(), key);
+  if (it == cell_keys_.end() || *it != key)
+    return -1;
+  return it - cell_keys_.begin();
+}
+
+int GridEuclideanCluster::find(int point)
+{
+  int parent = parent_[point].load(std::memory_order_relaxed);
+  while (parent != point)
+  {
+    // path halving, a failed exchange only means another thread compressed the path first
+    int grandparent = parent_[parent].load(std::memory_order_relaxed);
+    parent_[point].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+    point = parent;
+    parent = parent_[point].load(std::memory_order_relaxed);
+  }
+  return point;
+}
+
+void GridEuclideanCluster::unite(int point_a, int point_b)
+{
+  while (true)
+  {
+    point_a = find(point_a);
+    point_b = find(point_b);
+    if (point_a == point_b)
+      return;
+    // always hang the larger root below the smaller one, roots end up being the smallest index of their cluster
+    if (point_a < point_b)
+      std::swap(point_a, point_b);
+    int expected = point_a;
+    if (parent_[point_a].compare_exchange_strong(expected, point_b))
+      return;
+  }
+}
+
+void GridEuclideanCluster::extractClusters()
+{
+  clusters_.clear();
+  if (!cloud_ptr_)
+    return;
+
+  const std::vector<pcl::PointXYZ, Eigen::aligned_allocator<pcl::PointXYZ> >& points = cloud_ptr_->points;
+  const int size = points.size();
+  if (size == 0)
+    return;
+
+  if (parent_capacity_ < (size_t)size)
+  {
+    parent_.reset(new std::atomic<int>[size]);
+    parent_capacity_ = size;
+  }
+  cell_points_.resize(size);
+
+  // band and grid cell of each point
+  const uint64_t invalid_key = std::numeric_limits<uint64_t>::max();
+#pragma omp parallel for
+  for (int i = 0; i < size; i++)
+  {
+    parent_[i].store(i, std::memory_order_relaxed);
+    const pcl::PointXYZ& point = points[i];
+    if (!std::isfinite(point.x) || !std::isfinite(point.y))
+    {
+      cell_points_[i] = std::make_pair(invalid_key, i);
+      continue;
+    }
+    int band = bandOf(std::sqrt(point.x * point.x + point.y * point.y));
+    int64_t cell_x = (int64_t)std::floor(point.x / cell_sizes_[band]);
+    int64_t cell_y = (int64_t)std::floor(point.y / cell_sizes_[band]);
+    cell_points_[i] = std::make_pair(cellKey(band, cell_x, cell_y), i);
+  }
+
+  std::sort(cell_points_.begin(), cell_points_.end());
+
+  cell_keys_.clear();
+  cell_begin_.clear();
+  int valid_size = size;
+  for (int i = 0; i < size; i++)
+  {
+    if (cell_points_[i].first == invalid_key)
+    {
+      valid_size = i;
+      break;
+    }
+    if (i == 0 || cell_points_[i].first != cell_points_[i - 1].first)
+    {
+      cell_keys_.push_back(cell_points_[i].first);
+      cell_begin_.push_back(i);
+    }
+  }
+  cell_begin_.push_back(valid_size);
+  const int cell_num = cell_keys_.size();
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for (int cell = 0; cell < cell_num; cell++)
+  {
+    const int begin = cell_begin_[cell];
+    const int end = cell_begin_[cell + 1];
+
+    // the diagonal of a cell is the threshold, all its points belong to the same cluster
+    for (int i = begin + 1; i < end; i++)
+    {
+      unite(cell_points_[begin].second, cell_points_[i].second);
+    }
+
+    const uint64_t key = cell_keys_[cell];
+    const int band = key >> (2 * CELL_BITS);
+    const int64_t cell_x = (int64_t)((key >> CELL_BITS) & CELL_MASK) - CELL_OFFSET;
+    const int64_t cell_y = (int64_t)(key & CELL_MASK) - CELL_OFFSET;
+    const double squared_threshold = thresholds_[band] * thresholds_[band];
+
+    for (int n = 0; n < NEIGHBOUR_NUM; n++)
+    {
+      int neighbour = findCell(cellKey(band, cell_x + NEIGHBOUR_OFFSETS[n][0], cell_y + NEIGHBOUR_OFFSETS[n][1]));
+      if (neighbour < 0)
+        continue;
+      const int neighbour_begin = cell_begin_[neighbour];
+      const int neighbour_end = cell_begin_[neighbour + 1];
+      if (find(cell_points_[begin].second) == find(cell_points_[neighbour_begin].second))
+        continue;
+
+      // one close pair is enough, both cells are fully connected already
+      bool joined = false;
+      for (int i = begin; i < end && !joined; i++)
+      {
+        const pcl::PointXYZ& point_a = points[cell_points_[i].second];
+        for (int j = neighbour_begin; j < neighbour_end; j++)
+        {
+          const pcl::PointXYZ& point_b = points[cell_points_[j].second];
+          double dx = point_a.x - point_b.x;
+          double dy = point_a.y - point_b.y;
+          if (dx * dx + dy * dy <= squared_threshold)
+          {
+            unite(cell_points_[i].second, cell_points_[j].second);
+            joined = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // count the points of each cluster, roots are the smallest index of their cluster
+  cluster_slot_.assign(size, 0);
+  for (int i = 0; i < valid_size; i++)
+  {
+    cluster_slot_[find(cell_points_[i].second)]++;
+  }
+  cluster_band_.clear();
+  for (int i = 0; i < size; i++)
+  {
+    int cluster_size = cluster_slot_[i];
+    if (cluster_size > 0 && cluster_size >= min_cluster_pts_ && cluster_size <= max_cluster_pts_)
+    {
+      cluster_slot_[i] = clusters_.size();
+      clusters_.push_back(std::vector<int>());
+      clusters_.back().reserve(cluster_size);
+      cluster_band_.push_back(bandOf(std::sqrt(points[i].x * points[i].x + points[i].y * points[i].y)));
+    }
+    else
+    {
+      cluster_slot_[i] = -1;
+    }
+  }
+  for (int i = 0; i < size; i++)
+  {
+    if (std::isfinite(points[i].x) && std::isfinite(points[i].y))
+    {
+      int slot = cluster_slot_[find(i)];
+      if (slot >= 0)
+        clusters_[slot].push_back(i);
+    }
+  }
+
+  std::vector<int> order(clusters_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    if (cluster_band_[a] != cluster_band_[b])
+      return cluster_band_[a] < cluster_band_[b];
+    return clusters_[a].size() > clusters_[b].size();
+  });
+  std::vector<std::vector<int> > sorted_clusters(clusters_.size());
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    sorted_clusters[i].swap(clusters_[order[i]]);
+  }
+  clusters_.swap(sorted_clusters);
+}
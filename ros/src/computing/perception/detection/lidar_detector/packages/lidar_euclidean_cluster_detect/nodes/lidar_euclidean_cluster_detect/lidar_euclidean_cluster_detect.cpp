@@ -1,4 +1,5 @@
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <string>
 #include <sstream>
@@ -83,6 +84,8 @@
 #endif
 
 #include "cluster.h"
+#include "cluster_merge.h"
+#include "grid_euclidean_clustering.h"
 
 #ifdef GPU_CLUSTERING
 
@@ -147,6 +150,9 @@ static double _cluster_merge_threshold;
 static double _clustering_distance;
 
 static bool _use_gpu;
+static bool _use_grid_clustering;
+static GridEuclideanCluster _grid_cluster;
+static ClusterMerge _cluster_merge;
 static std::chrono::system_clock::time_point _start, _end;
 
 std::vector<std::vector<geometry_msgs::Point>> _way_area_points;
@@ -158,10 +164,10 @@ static bool _use_multiple_thres;
 std::vector<double> _clustering_distances;
 std::vector<double> _clustering_ranges;
 
-tf::StampedTransform* _transform;
+std::shared_ptr<tf::StampedTransform> _transform;
 tf::StampedTransform* _velodyne_output_transform;
-tf::TransformListener* _transform_listener;
-tf::TransformListener* _vectormap_transform_listener;
+std::shared_ptr<tf::TransformListener> _transform_listener;
+std::shared_ptr<tf::TransformListener> _vectormap_transform_listener;
 
 tf::StampedTransform findTransform(const std::string& in_target_frame, const std::string& in_source_frame)
 {
@@ -373,21 +379,20 @@ void publishBoundingBoxArray(const ros::Publisher* in_publisher,
   }
 }
 
+// Clouds are published as pcl types, subscribers in the same nodelet manager receive them without serialization.
+// The callers only read their clouds once published, so they are published without a copy and must not be modified
+// afterwards.
 void publishCloud(const ros::Publisher* in_publisher, const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_to_publish_ptr)
 {
-  sensor_msgs::PointCloud2 cloud_msg;
-  pcl::toROSMsg(*in_cloud_to_publish_ptr, cloud_msg);
-  cloud_msg.header = _velodyne_header;
-  in_publisher->publish(cloud_msg);
+  in_cloud_to_publish_ptr->header = pcl_conversions::toPCL(_velodyne_header);
+  in_publisher->publish(in_cloud_to_publish_ptr);
 }
 
 void publishColorCloud(const ros::Publisher* in_publisher,
                        const pcl::PointCloud<pcl::PointXYZRGB>::Ptr in_cloud_to_publish_ptr)
 {
-  sensor_msgs::PointCloud2 cloud_msg;
-  pcl::toROSMsg(*in_cloud_to_publish_ptr, cloud_msg);
-  cloud_msg.header = _velodyne_header;
-  in_publisher->publish(cloud_msg);
+  in_cloud_to_publish_ptr->header = pcl_conversions::toPCL(_velodyne_header);
+  in_publisher->publish(in_cloud_to_publish_ptr);
 }
 
 void keepLanePoints(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
@@ -539,88 +544,31 @@ std::vector<ClusterPtr> clusterAndColor(const pcl::PointCloud<pcl::PointXYZ>::Pt
   return clusters;
 }
 
-void checkClusterMerge(size_t in_cluster_id, std::vector<ClusterPtr>& in_clusters,
-                       std::vector<bool>& in_out_visited_clusters, std::vector<size_t>& out_merge_indices,
-                       double in_merge_threshold)
+// Clusters the whole cloud with the grid engine, using the per range thresholds in the same pass if enabled
+std::vector<ClusterPtr> clusterAndColorGrid(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr)
 {
-  // std::cout << "checkClusterMerge" << std::endl;
-  pcl::PointXYZ point_a = in_clusters[in_cluster_id]->GetCentroid();
-  for (size_t i = 0; i < in_clusters.size(); i++)
-  {
-    if (i != in_cluster_id && !in_out_visited_clusters[i])
-    {
-      pcl::PointXYZ point_b = in_clusters[i]->GetCentroid();
-      double distance = sqrt(pow(point_b.x - point_a.x, 2) + pow(point_b.y - point_a.y, 2));
-      if (distance <= in_merge_threshold)
-      {
-        in_out_visited_clusters[i] = true;
-        out_merge_indices.push_back(i);
-        // std::cout << "Merging " << in_cluster_id << " with " << i << " dist:" << distance << std::endl;
-        checkClusterMerge(i, in_clusters, in_out_visited_clusters, out_merge_indices, in_merge_threshold);
-      }
-    }
-  }
-}
+  if (_use_multiple_thres)
+    _grid_cluster.setThresholds(_clustering_ranges, _clustering_distances);
+  else
+    _grid_cluster.setThreshold(_clustering_distance);
+  _grid_cluster.setMinClusterPts(_cluster_size_min);
+  _grid_cluster.setMaxClusterPts(_cluster_size_max);
+  _grid_cluster.setInputCloud(in_cloud_ptr);
+  _grid_cluster.extractClusters();
 
-void mergeClusters(const std::vector<ClusterPtr>& in_clusters, std::vector<ClusterPtr>& out_clusters,
-                   std::vector<size_t> in_merge_indices, const size_t& current_index,
-                   std::vector<bool>& in_out_merged_clusters)
-{
-  // std::cout << "mergeClusters:" << in_merge_indices.size() << std::endl;
-  pcl::PointCloud<pcl::PointXYZRGB> sum_cloud;
-  pcl::PointCloud<pcl::PointXYZ> mono_cloud;
-  ClusterPtr merged_cluster(new Cluster());
-  for (size_t i = 0; i < in_merge_indices.size(); i++)
-  {
-    sum_cloud += *(in_clusters[in_merge_indices[i]]->GetCloud());
-    in_out_merged_clusters[in_merge_indices[i]] = true;
-  }
-  std::vector<int> indices(sum_cloud.points.size(), 0);
-  for (size_t i = 0; i < sum_cloud.points.size(); i++)
-  {
-    indices[i] = i;
-  }
+  const std::vector<std::vector<int> >& cluster_indices = _grid_cluster.getOutput();
+  std::vector<ClusterPtr> clusters(cluster_indices.size());
 
-  if (sum_cloud.points.size() > 0)
+#pragma omp parallel for schedule(dynamic)
+  for (size_t k = 0; k < cluster_indices.size(); k++)
   {
-    pcl::copyPointCloud(sum_cloud, mono_cloud);
-    // std::cout << "mergedClusters " << sum_cloud.points.size() << " mono:" << mono_cloud.points.size() << std::endl;
-    // cluster->SetCloud(in_cloud_ptr, it->indices, _velodyne_header, k, (int)_colors[k].val[0], (int)_colors[k].val[1],
-    // (int)_colors[k].val[2], "", _pose_estimation);
-    merged_cluster->SetCloud(mono_cloud.makeShared(), indices, _velodyne_header, current_index,
-                             (int)_colors[current_index].val[0], (int)_colors[current_index].val[1],
-                             (int)_colors[current_index].val[2], "", _pose_estimation);
-    out_clusters.push_back(merged_cluster);
-  }
-}
-
-void checkAllForMerge(std::vector<ClusterPtr>& in_clusters, std::vector<ClusterPtr>& out_clusters,
-                      float in_merge_threshold)
-{
-  // std::cout << "checkAllForMerge" << std::endl;
-  std::vector<bool> visited_clusters(in_clusters.size(), false);
-  std::vector<bool> merged_clusters(in_clusters.size(), false);
-  size_t current_index = 0;
-  for (size_t i = 0; i < in_clusters.size(); i++)
-  {
-    if (!visited_clusters[i])
-    {
-      visited_clusters[i] = true;
-      std::vector<size_t> merge_indices;
-      checkClusterMerge(i, in_clusters, visited_clusters, merge_indices, in_merge_threshold);
-      mergeClusters(in_clusters, out_clusters, merge_indices, current_index++, merged_clusters);
-    }
-  }
-  for (size_t i = 0; i < in_clusters.size(); i++)
-  {
-    // check for clusters not merged, add them to the output
-    if (!merged_clusters[i])
-    {
-      out_clusters.push_back(in_clusters[i]);
-    }
+    const cv::Scalar& color = _colors[k % _colors.size()];
+    ClusterPtr cluster(new Cluster());
+    cluster->SetCloud(in_cloud_ptr, cluster_indices[k], _velodyne_header, k, (int)color.val[0], (int)color.val[1],
+                      (int)color.val[2], "", _pose_estimation);
+    clusters[k] = cluster;
   }
-
-  // ClusterPtr cluster(new Cluster());
+  return clusters;
 }
 
 void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
@@ -642,7 +590,11 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
 
   std::vector<ClusterPtr> all_clusters;
 
-  if (!_use_multiple_thres)
+  if (_use_grid_clustering)
+  {
+    all_clusters = clusterAndColorGrid(in_cloud_ptr);
+  }
+  else if (!_use_multiple_thres)
   {
     pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
 
@@ -736,18 +688,13 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
   // Clusters can be merged or checked in here
   //....
   // check for mergable clusters
-  std::vector<ClusterPtr> mid_clusters;
   std::vector<ClusterPtr> final_clusters;
 
-  if (all_clusters.size() > 0)
-    checkAllForMerge(all_clusters, mid_clusters, _cluster_merge_threshold);
-  else
-    mid_clusters = all_clusters;
-
-  if (mid_clusters.size() > 0)
-    checkAllForMerge(mid_clusters, final_clusters, _cluster_merge_threshold);
-  else
-    final_clusters = mid_clusters;
+  _start = std::chrono::system_clock::now();
+  _cluster_merge.mergeAll(all_clusters, _velodyne_header, final_clusters);
+  _end = std::chrono::system_clock::now();
+  ROS_DEBUG("cluster merge: %zu -> %zu clusters in %.3f ms", all_clusters.size(), final_clusters.size(),
+            std::chrono::duration<double, std::milli>(_end - _start).count());
 
   tf::StampedTransform vectormap_transform;
   if (_use_vector_map)
@@ -912,7 +859,7 @@ void removeFloor(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
   extract.filter(*out_onlyfloor_cloud_ptr);
 }
 
-void downsampleCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+void downsampleCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr in_cloud_ptr,
                      pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr, float in_leaf_size = 0.2)
 {
   pcl::VoxelGrid<pcl::PointXYZ> sor;
@@ -921,7 +868,7 @@ void downsampleCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
   sor.filter(*out_cloud_ptr);
 }
 
-void clipCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+void clipCloud(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr in_cloud_ptr,
                pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr, float in_min_height = -1.3, float in_max_height = 0.5)
 {
   out_cloud_ptr->points.clear();
@@ -999,7 +946,7 @@ void differenceNormalsSegmentation(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_
   pcl::copyPointCloud<pcl::PointNormal, pcl::PointXYZ>(*diffnormals_cloud, *out_cloud_ptr);
 }
 
-void removePointsUpTo(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+void removePointsUpTo(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr in_cloud_ptr,
                       pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr, const double in_distance)
 {
   out_cloud_ptr->points.clear();
@@ -1013,7 +960,7 @@ void removePointsUpTo(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
   }
 }
 
-void velodyne_callback(const sensor_msgs::PointCloud2ConstPtr& in_sensor_cloud)
+void velodyne_callback(const pcl::PointCloud<pcl::PointXYZ>::ConstPtr& in_sensor_cloud)
 {
   //_start = std::chrono::system_clock::now();
 
@@ -1021,9 +968,10 @@ void velodyne_callback(const sensor_msgs::PointCloud2ConstPtr& in_sensor_cloud)
   {
     _using_sensor_cloud = true;
 
-    pcl::PointCloud<pcl::PointXYZ>::Ptr current_sensor_cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
-    pcl::PointCloud<pcl::PointXYZ>::Ptr removed_points_cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
-    pcl::PointCloud<pcl::PointXYZ>::Ptr downsampled_cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
+    // the input cloud may be shared with other nodelets, so it is only read
+    pcl::PointCloud<pcl::PointXYZ>::ConstPtr current_sensor_cloud_ptr = in_sensor_cloud;
+    pcl::PointCloud<pcl::PointXYZ>::ConstPtr removed_points_cloud_ptr;
+    pcl::PointCloud<pcl::PointXYZ>::ConstPtr downsampled_cloud_ptr;
     pcl::PointCloud<pcl::PointXYZ>::Ptr inlanes_cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
     pcl::PointCloud<pcl::PointXYZ>::Ptr nofloor_cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
     pcl::PointCloud<pcl::PointXYZ>::Ptr onlyfloor_cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
@@ -1037,19 +985,23 @@ void velodyne_callback(const sensor_msgs::PointCloud2ConstPtr& in_sensor_cloud)
     jsk_recognition_msgs::PolygonArray polygon_array;
     jsk_rviz_plugins::PictogramArray pictograms_array;
 
-    pcl::fromROSMsg(*in_sensor_cloud, *current_sensor_cloud_ptr);
-
-    _velodyne_header = in_sensor_cloud->header;
+    _velodyne_header = pcl_conversions::fromPCL(in_sensor_cloud->header);
 
     if (_remove_points_upto > 0.0)
     {
-      removePointsUpTo(current_sensor_cloud_ptr, removed_points_cloud_ptr, _remove_points_upto);
+      pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
+      removePointsUpTo(current_sensor_cloud_ptr, cloud_ptr, _remove_points_upto);
+      removed_points_cloud_ptr = cloud_ptr;
     }
     else
       removed_points_cloud_ptr = current_sensor_cloud_ptr;
 
     if (_downsample_cloud)
-      downsampleCloud(removed_points_cloud_ptr, downsampled_cloud_ptr, _leaf_size);
+    {
+      pcl::PointCloud<pcl::PointXYZ>::Ptr cloud_ptr(new pcl::PointCloud<pcl::PointXYZ>);
+      downsampleCloud(removed_points_cloud_ptr, cloud_ptr, _leaf_size);
+      downsampled_cloud_ptr = cloud_ptr;
+    }
     else
       downsampled_cloud_ptr = removed_points_cloud_ptr;
 
@@ -1185,21 +1137,16 @@ void wayarea_gridmap_callback(const grid_map_msgs::GridMap& message)
   grid_map::GridMapRosConverter::fromMessage(message, _wayarea_gridmap);
 }
 
-int main(int argc, char** argv)
-{
-  // Initialize ROS
-  ros::init(argc, argv, "euclidean_cluster");
+static ros::Subscriber _sub_points;
+static ros::Subscriber _sub_wayarea;
 
-  ros::NodeHandle h;
-  ros::NodeHandle private_nh("~");
-
-  tf::StampedTransform transform;
-  tf::TransformListener listener;
-  tf::TransformListener vectormap_tf_listener;
-
-  _vectormap_transform_listener = &vectormap_tf_listener;
-  _transform = &transform;
-  _transform_listener = &listener;
+// Sets up publishers, parameters and subscribers, shared by the node and the nodelet.
+// The state is global, so only one instance can run per process.
+void initialize(ros::NodeHandle& h, ros::NodeHandle& private_nh)
+{
+  _vectormap_transform_listener = std::make_shared<tf::TransformListener>(h);
+  _transform = std::make_shared<tf::StampedTransform>();
+  _transform_listener = std::make_shared<tf::TransformListener>(h);
 
 #if (CV_MAJOR_VERSION == 3)
   generateColors(_colors, 255);
@@ -1207,12 +1154,12 @@ int main(int argc, char** argv)
   cv::generateColors(_colors, 255);
 #endif
 
-  _pub_cluster_cloud = h.advertise<sensor_msgs::PointCloud2>("/points_cluster", 1);
-  _pub_ground_cloud = h.advertise<sensor_msgs::PointCloud2>("/points_ground", 1);
+  _pub_cluster_cloud = h.advertise<pcl::PointCloud<pcl::PointXYZRGB> >("/points_cluster", 1);
+  _pub_ground_cloud = h.advertise<pcl::PointCloud<pcl::PointXYZ> >("/points_ground", 1);
   _centroid_pub = h.advertise<autoware_msgs::Centroids>("/cluster_centroids", 1);
   _marker_pub = h.advertise<visualization_msgs::Marker>("centroid_marker", 1);
 
-  _pub_points_lanes_cloud = h.advertise<sensor_msgs::PointCloud2>("/points_lanes", 1);
+  _pub_points_lanes_cloud = h.advertise<pcl::PointCloud<pcl::PointXYZ> >("/points_lanes", 1);
   _pub_jsk_boundingboxes = h.advertise<jsk_recognition_msgs::BoundingBoxArray>("/bounding_boxes", 1);
   _pub_jsk_hulls = h.advertise<jsk_recognition_msgs::PolygonArray>("/cluster_hulls", 1);
   _pub_clusters_message = h.advertise<autoware_msgs::CloudClusterArray>("/cloud_clusters", 1);
@@ -1290,6 +1237,11 @@ int main(int argc, char** argv)
   private_nh.param("use_gpu", _use_gpu, false);
   ROS_INFO("use_gpu: %d", _use_gpu);
 
+  private_nh.param("use_grid_clustering", _use_grid_clustering, false);
+  ROS_INFO("use_grid_clustering: %d", _use_grid_clustering);
+  if (_use_grid_clustering && _use_gpu)
+    ROS_WARN("use_grid_clustering is enabled, use_gpu will be ignored");
+
   private_nh.param("use_multiple_thres", _use_multiple_thres, false);
   ROS_INFO("use_multiple_thres: %d", _use_multiple_thres);
 
@@ -1328,10 +1280,14 @@ int main(int argc, char** argv)
     }
   }
 
+  _cluster_merge.setThreshold(_cluster_merge_threshold);
+  _cluster_merge.setColors(_colors);
+  _cluster_merge.setPoseEstimation(_pose_estimation);
+
   _velodyne_transform_available = false;
 
   // Create a ROS subscriber for the input point cloud
-  ros::Subscriber sub = h.subscribe(points_topic, 1, velodyne_callback);
+  _sub_points = h.subscribe(points_topic, 1, velodyne_callback);
 
   private_nh.param<std::string>("wayarea_gridmap_topic", gridmap_topic, "grid_map_wayarea");
   ROS_INFO("wayarea_gridmap_topic: %s", gridmap_topic.c_str());
@@ -1339,7 +1295,7 @@ int main(int argc, char** argv)
   ROS_INFO("wayarea_gridmap_layer: %s", _gridmap_layer.c_str());
   private_nh.param<int>("wayarea_no_road_value", _gridmap_no_road_value, _grid_max_value);
   ROS_INFO("wayarea_no_road_value: %ds", _gridmap_no_road_value);
-  ros::Subscriber wayarea_sub = h.subscribe(gridmap_topic, 1, wayarea_gridmap_callback);
+  _sub_wayarea = h.subscribe(gridmap_topic, 1, wayarea_gridmap_callback);
 
   _visualization_marker.header.frame_id = "velodyne";
   _visualization_marker.header.stamp = ros::Time();
@@ -1356,7 +1312,43 @@ int main(int argc, char** argv)
   _visualization_marker.color.b = 1.0;
   // marker.lifetime = ros::Duration(0.1);
   _visualization_marker.frame_locked = true;
+}
+
+#ifndef EUCLIDEAN_CLUSTER_NODELET
+
+int main(int argc, char** argv)
+{
+  // Initialize ROS
+  ros::init(argc, argv, "euclidean_cluster");
+
+  ros::NodeHandle h;
+  ros::NodeHandle private_nh("~");
+
+  initialize(h, private_nh);
 
   // Spin
   ros::spin();
 }
+
+#else
+
+#include <pluginlib/class_list_macros.h>
+#include <nodelet/nodelet.h>
+
+namespace lidar_euclidean_cluster_detect
+{
+class EuclideanClusterNodelet : public nodelet::Nodelet
+{
+private:
+  virtual void onInit()
+  {
+    ros::NodeHandle h = getNodeHandle();
+    ros::NodeHandle private_nh = getPrivateNodeHandle();
+    initialize(h, private_nh);
+  }
+};
+}  // namespace lidar_euclidean_cluster_detect
+
+PLUGINLIB_EXPORT_CLASS(lidar_euclidean_cluster_detect::EuclideanClusterNodelet, nodelet::Nodelet)
+
+#endif  // EUCLIDEAN_CLUSTER_NODELET
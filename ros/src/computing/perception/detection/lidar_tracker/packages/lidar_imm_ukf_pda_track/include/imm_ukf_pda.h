@@ -45,6 +45,8 @@
 
 #include <visualization_msgs/MarkerArray.h>
 
+#include <std_msgs/Float32.h>
+
 #include "autoware_msgs/DetectedObject.h"
 #include "autoware_msgs/DetectedObjectArray.h"
 
@@ -57,7 +59,7 @@ private:
   bool init_;
   double timestamp_;
 
-  std::vector<UKF> targets_;
+  std::vector<UKF, Eigen::aligned_allocator<UKF> > targets_;
 
   // probabilistic data association params
   double gating_thres_;
@@ -86,6 +88,18 @@ private:
   // prevent explode param for ukf
   double prevent_explosion_thres_;
 
+  // uniform grid over the detections of the current frame, only the cells overlapping the gate of a target are
+  // checked in the measurement validation
+  double association_cell_size_;
+  double grid_cell_size_;
+  double grid_min_x_;
+  double grid_min_y_;
+  int grid_cols_;
+  int grid_rows_;
+  std::vector<int> grid_cell_begin_;  // first position of each cell in grid_objects_, plus the end
+  std::vector<int> grid_objects_;     // object indices sorted by cell
+  std::vector<int> gate_candidates_;
+
   std::string input_topic_;
   std::string output_topic_;
 
@@ -103,6 +117,7 @@ private:
   ros::Publisher pub_adas_prediction_array_;
   ros::Publisher pub_points_array_;
   ros::Publisher pub_texts_array_;
+  ros::Publisher pub_association_time_;
 
   void callback(const autoware_msgs::DetectedObjectArray& input);
   void setPredictionObject();
@@ -112,8 +127,11 @@ private:
                              autoware_msgs::DetectedObjectArray& transformed_input);
   void transformPoseToLocal(jsk_recognition_msgs::BoundingBoxArray& jskbboxes_output,
                             autoware_msgs::DetectedObjectArray& detected_objects_output);
+  void buildAssociationGrid(const autoware_msgs::DetectedObjectArray& input);
+  void getGateCandidates(const UKF::MeasVector& max_det_z, const UKF::MeasMatrix& max_det_s,
+                         std::vector<int>& candidates);
   void measurementValidation(const autoware_msgs::DetectedObjectArray& input, UKF& target, const bool second_init,
-                             const Eigen::VectorXd& max_det_z, const Eigen::MatrixXd& max_det_s,
+                             const UKF::MeasVector& max_det_z, const UKF::MeasMatrix& max_det_s,
                              std::vector<autoware_msgs::DetectedObject>& object_vec, std::vector<bool>& matching_vec);
   void getNearestEuclidCluster(const UKF& target, const std::vector<autoware_msgs::DetectedObject>& object_vec,
                                autoware_msgs::DetectedObject& object, double& min_dist);
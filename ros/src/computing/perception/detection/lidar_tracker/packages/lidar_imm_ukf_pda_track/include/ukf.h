@@ -32,6 +32,7 @@
 #define OBJECT_TRACKING_UKF_H
 
 #include "Eigen/Dense"
+#include "Eigen/StdVector"
 #include <ros/ros.h>
 #include <vector>
 #include <string>
@@ -68,43 +69,61 @@ class UKF
   */
 
 public:
+  // state: [pos1 pos2 vel_abs yaw_angle yaw_rate], lidar measurement: [pos1 pos2]
+  // fixed sizes so that the filter runs without heap allocations. 2x2 inverses and determinants are computed with
+  // partialPivLu(), as Eigen does for dynamic sizes, so the results do not change bit by bit
+  static const int NUM_STATE = 5;
+  static const int NUM_MEAS = 2;
+  static const int NUM_SIGMA = 2 * NUM_STATE + 1;
+
+  typedef Eigen::Matrix<double, NUM_STATE, 1> StateVector;
+  typedef Eigen::Matrix<double, NUM_STATE, NUM_STATE> StateMatrix;
+  typedef Eigen::Matrix<double, NUM_STATE, NUM_SIGMA> SigmaMatrix;
+  typedef Eigen::Matrix<double, NUM_SIGMA, 1> WeightVector;
+  typedef Eigen::Matrix<double, NUM_MEAS, 1> MeasVector;
+  typedef Eigen::Matrix<double, NUM_MEAS, NUM_MEAS> MeasMatrix;
+  typedef Eigen::Matrix<double, NUM_MEAS, NUM_SIGMA> MeasSigmaMatrix;
+  typedef Eigen::Matrix<double, NUM_STATE, NUM_MEAS> GainMatrix;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
   int ukf_id_;
 
   //* initially set to false, set to true in first call of ProcessMeasurement
   bool is_initialized_;
 
   //* state vector: [pos1 pos2 vel_abs yaw_angle yaw_rate] in SI units and rad
-  Eigen::MatrixXd x_merge_;
+  StateVector x_merge_;
 
   //* state vector: [pos1 pos2 vel_abs yaw_angle yaw_rate] in SI units and rad
-  Eigen::MatrixXd x_cv_;
+  StateVector x_cv_;
 
   //* state vector: [pos1 pos2 vel_abs yaw_angle yaw_rate] in SI units and rad
-  Eigen::MatrixXd x_ctrv_;
+  StateVector x_ctrv_;
 
   //* state vector: [pos1 pos2 vel_abs yaw_angle yaw_rate] in SI units and rad
-  Eigen::MatrixXd x_rm_;
+  StateVector x_rm_;
 
   //* state covariance matrix
-  Eigen::MatrixXd p_merge_;
+  StateMatrix p_merge_;
 
   //* state covariance matrix
-  Eigen::MatrixXd p_cv_;
+  StateMatrix p_cv_;
 
   //* state covariance matrix
-  Eigen::MatrixXd p_ctrv_;
+  StateMatrix p_ctrv_;
 
   //* state covariance matrix
-  Eigen::MatrixXd p_rm_;
+  StateMatrix p_rm_;
 
   //* predicted sigma points matrix
-  Eigen::MatrixXd x_sig_pred_cv_;
+  SigmaMatrix x_sig_pred_cv_;
 
   //* predicted sigma points matrix
-  Eigen::MatrixXd x_sig_pred_ctrv_;
+  SigmaMatrix x_sig_pred_ctrv_;
 
   //* predicted sigma points matrix
-  Eigen::MatrixXd x_sig_pred_rm_;
+  SigmaMatrix x_sig_pred_rm_;
 
   //* time when the state is true, in us
   long long time_;
@@ -128,8 +147,8 @@ public:
   double std_laspy_;
 
   //* Weights of sigma points
-  Eigen::VectorXd weights_c_;
-  Eigen::VectorXd weights_s_;
+  WeightVector weights_c_;
+  WeightVector weights_s_;
 
   //* State dimension
   int n_x_;
@@ -168,17 +187,17 @@ public:
 
   std::vector<double> p3_;
 
-  Eigen::VectorXd z_pred_cv_;
-  Eigen::VectorXd z_pred_ctrv_;
-  Eigen::VectorXd z_pred_rm_;
+  MeasVector z_pred_cv_;
+  MeasVector z_pred_ctrv_;
+  MeasVector z_pred_rm_;
 
-  Eigen::MatrixXd s_cv_;
-  Eigen::MatrixXd s_ctrv_;
-  Eigen::MatrixXd s_rm_;
+  MeasMatrix s_cv_;
+  MeasMatrix s_ctrv_;
+  MeasMatrix s_rm_;
 
-  Eigen::MatrixXd k_cv_;
-  Eigen::MatrixXd k_ctrv_;
-  Eigen::MatrixXd k_rm_;
+  GainMatrix k_cv_;
+  GainMatrix k_ctrv_;
+  GainMatrix k_rm_;
 
   double pd_;
   double pg_;
@@ -202,7 +221,7 @@ public:
   std::vector<double> bb_area_history_;
 
   // for env classification
-  Eigen::VectorXd init_meas_;
+  MeasVector init_meas_;
   std::vector<double> vel_history_;
 
   std::vector<Eigen::VectorXd> local2local_;
@@ -212,37 +231,37 @@ public:
 
   int tracking_num_;
 
-  Eigen::VectorXd cv_meas_;
-  Eigen::VectorXd ctrv_meas_;
-  Eigen::VectorXd rm_meas_;
+  MeasVector cv_meas_;
+  MeasVector ctrv_meas_;
+  MeasVector rm_meas_;
 
-  Eigen::MatrixXd q_cv_;
-  Eigen::MatrixXd q_ctrv_;
-  Eigen::MatrixXd q_rm_;
+  StateMatrix q_cv_;
+  StateMatrix q_ctrv_;
+  StateMatrix q_rm_;
 
-  Eigen::MatrixXd r_cv_;
-  Eigen::MatrixXd r_ctrv_;
-  Eigen::MatrixXd r_rm_;
+  MeasMatrix r_cv_;
+  MeasMatrix r_ctrv_;
+  MeasMatrix r_rm_;
 
   double nis_cv_;
   double nis_ctrv_;
   double nis_rm_;
 
-  Eigen::MatrixXd new_x_sig_cv_;
-  Eigen::MatrixXd new_x_sig_ctrv_;
-  Eigen::MatrixXd new_x_sig_rm_;
+  SigmaMatrix new_x_sig_cv_;
+  SigmaMatrix new_x_sig_ctrv_;
+  SigmaMatrix new_x_sig_rm_;
 
-  Eigen::MatrixXd new_z_sig_cv_;
-  Eigen::MatrixXd new_z_sig_ctrv_;
-  Eigen::MatrixXd new_z_sig_rm_;
+  MeasSigmaMatrix new_z_sig_cv_;
+  MeasSigmaMatrix new_z_sig_ctrv_;
+  MeasSigmaMatrix new_z_sig_rm_;
 
-  Eigen::VectorXd new_z_pred_cv_;
-  Eigen::VectorXd new_z_pred_ctrv_;
-  Eigen::VectorXd new_z_pred_rm_;
+  MeasVector new_z_pred_cv_;
+  MeasVector new_z_pred_ctrv_;
+  MeasVector new_z_pred_rm_;
 
-  Eigen::MatrixXd new_s_cv_;
-  Eigen::MatrixXd new_s_ctrv_;
-  Eigen::MatrixXd new_s_rm_;
+  MeasMatrix new_s_cv_;
+  MeasMatrix new_s_ctrv_;
+  MeasMatrix new_s_rm_;
 
   /**
    * Constructor
@@ -251,7 +270,7 @@ public:
 
   void updateYawWithHighProb();
 
-  void initialize(const Eigen::VectorXd& z, const double timestamp, const int target_ind);
+  void initialize(const MeasVector& z, const double timestamp, const int target_ind);
 
   void updateModeProb(const std::vector<double>& lambda_vec);
 
@@ -265,7 +284,7 @@ public:
 
   void predictionIMMUKF(const double dt);
 
-  void findMaxZandS(Eigen::VectorXd& max_det_z, Eigen::MatrixXd& max_det_s);
+  void findMaxZandS(MeasVector& max_det_z, MeasMatrix& max_det_s);
 
   void updateLikelyMeasurementForCTRV(const std::vector<autoware_msgs::DetectedObject>& object_vec);
 
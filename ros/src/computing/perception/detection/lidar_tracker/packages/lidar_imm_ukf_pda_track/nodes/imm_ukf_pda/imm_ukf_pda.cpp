@@ -28,6 +28,7 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <chrono>
 #include <stdio.h>
 #include <ros/package.h>
@@ -38,6 +39,8 @@ ImmUkfPda::ImmUkfPda()
   : target_id_(0)
   ,  // assign unique ukf_id_ to each tracking targets
   init_(false)
+  , grid_cols_(0)
+  , grid_rows_(0)
 {
   ros::NodeHandle private_nh_("~");
   private_nh_.param<std::string>("pointcloud_frame", pointcloud_frame_, "velodyne");
@@ -49,6 +52,7 @@ ImmUkfPda::ImmUkfPda()
   private_nh_.param<double>("distance_thres", distance_thres_, 99);
   private_nh_.param<double>("static_velocity_thres", static_velocity_thres_, 0.5);
   private_nh_.param<double>("prevent_explosion_thres", prevent_explosion_thres_, 1000);
+  private_nh_.param<double>("association_cell_size", association_cell_size_, 2.0);
   private_nh_.param<bool>("use_sukf", use_sukf_, false);
   private_nh_.param<bool>("is_debug", is_debug_, false);
 }
@@ -65,6 +69,9 @@ void ImmUkfPda::run()
   pub_texts_array_ =
       node_handle_.advertise<visualization_msgs::MarkerArray>("/detection/lidar_tracker/debug_texts_markers", 1);
 
+  // time spent in the data association of each frame, in ms
+  pub_association_time_ = node_handle_.advertise<std_msgs::Float32>("/detection/lidar_tracker/time_association", 1);
+
   sub_detected_array_ = node_handle_.subscribe("/detection/lidar_objects", 1, &ImmUkfPda::callback, this);
 }
 
@@ -182,9 +189,123 @@ void ImmUkfPda::transformPoseToLocal(jsk_recognition_msgs::BoundingBoxArray& jsk
   jskbboxes_output.header.frame_id = pointcloud_frame_;
 }
 
+void ImmUkfPda::buildAssociationGrid(const autoware_msgs::DetectedObjectArray& input)
+{
+  const int num_objects = input.objects.size();
+  grid_cols_ = grid_rows_ = 0;
+  grid_objects_.clear();
+
+  double max_x = -std::numeric_limits<double>::max();
+  double max_y = -std::numeric_limits<double>::max();
+  grid_min_x_ = grid_min_y_ = std::numeric_limits<double>::max();
+  for (int i = 0; i < num_objects; i++)
+  {
+    double x = input.objects[i].pose.position.x;
+    double y = input.objects[i].pose.position.y;
+    // objects with a non finite position can not be inside any gate
+    if (!std::isfinite(x) || !std::isfinite(y))
+    {
+      continue;
+    }
+    grid_min_x_ = std::min(grid_min_x_, x);
+    grid_min_y_ = std::min(grid_min_y_, y);
+    max_x = std::max(max_x, x);
+    max_y = std::max(max_y, y);
+  }
+  if (max_x < grid_min_x_)
+  {
+    return;
+  }
+
+  // keep the grid small when the detections are spread over a large area
+  const double max_cells = std::max(1024, 4 * num_objects);
+  grid_cell_size_ = std::max(association_cell_size_, 0.1);
+  while (((max_x - grid_min_x_) / grid_cell_size_ + 1) * ((max_y - grid_min_y_) / grid_cell_size_ + 1) > max_cells)
+  {
+    grid_cell_size_ *= 2;
+  }
+  grid_cols_ = static_cast<int>((max_x - grid_min_x_) / grid_cell_size_) + 1;
+  grid_rows_ = static_cast<int>((max_y - grid_min_y_) / grid_cell_size_) + 1;
+
+  // counting sort of the objects by cell, the objects of a cell keep their input order
+  std::vector<int> object_cells(num_objects, -1);
+  grid_cell_begin_.assign(grid_cols_ * grid_rows_ + 1, 0);
+  for (int i = 0; i < num_objects; i++)
+  {
+    double x = input.objects[i].pose.position.x;
+    double y = input.objects[i].pose.position.y;
+    if (!std::isfinite(x) || !std::isfinite(y))
+    {
+      continue;
+    }
+    int col = std::min(static_cast<int>((x - grid_min_x_) / grid_cell_size_), grid_cols_ - 1);
+    int row = std::min(static_cast<int>((y - grid_min_y_) / grid_cell_size_), grid_rows_ - 1);
+    object_cells[i] = row * grid_cols_ + col;
+    grid_cell_begin_[object_cells[i] + 1]++;
+  }
+  for (size_t c = 1; c < grid_cell_begin_.size(); c++)
+  {
+    grid_cell_begin_[c] += grid_cell_begin_[c - 1];
+  }
+  grid_objects_.resize(grid_cell_begin_.back());
+  std::vector<int> cell_fill(grid_cell_begin_.begin(), grid_cell_begin_.end() - 1);
+  for (int i = 0; i < num_objects; i++)
+  {
+    if (object_cells[i] >= 0)
+    {
+      grid_objects_[cell_fill[object_cells[i]]++] = i;
+    }
+  }
+}
+
+void ImmUkfPda::getGateCandidates(const UKF::MeasVector& max_det_z, const UKF::MeasMatrix& max_det_s,
+                                  std::vector<int>& candidates)
+{
+  candidates.clear();
+  if (grid_cols_ == 0)
+  {
+    return;
+  }
+
+  // the gate diff^T * S^-1 * diff < gating_thres_ is an ellipse whose bounding box has half sizes
+  // sqrt(gating_thres_ * S(0, 0)) and sqrt(gating_thres_ * S(1, 1)), enlarged a little against rounding errors
+  double half_x = 1.001 * sqrt(gating_thres_ * max_det_s(0, 0)) + 1e-6;
+  double half_y = 1.001 * sqrt(gating_thres_ * max_det_s(1, 1)) + 1e-6;
+  if (!(max_det_s.partialPivLu().determinant() > 0) || !std::isfinite(half_x) || !std::isfinite(half_y) ||
+      !std::isfinite(max_det_z(0)) || !std::isfinite(max_det_z(1)))
+  {
+    // S is not positive definite so the gate is not a bounded ellipse, check every object
+    candidates = grid_objects_;
+    std::sort(candidates.begin(), candidates.end());
+    return;
+  }
+
+  double min_col = (max_det_z(0) - half_x - grid_min_x_) / grid_cell_size_;
+  double max_col = (max_det_z(0) + half_x - grid_min_x_) / grid_cell_size_;
+  double min_row = (max_det_z(1) - half_y - grid_min_y_) / grid_cell_size_;
+  double max_row = (max_det_z(1) + half_y - grid_min_y_) / grid_cell_size_;
+  if (max_col < 0 || min_col >= grid_cols_ || max_row < 0 || min_row >= grid_rows_)
+  {
+    return;
+  }
+  int first_col = static_cast<int>(std::max(min_col, 0.0));
+  int last_col = static_cast<int>(std::min(max_col, grid_cols_ - 1.0));
+  int first_row = static_cast<int>(std::max(min_row, 0.0));
+  int last_row = static_cast<int>(std::min(max_row, grid_rows_ - 1.0));
+
+  for (int row = first_row; row <= last_row; row++)
+  {
+    int cell_begin = grid_cell_begin_[row * grid_cols_ + first_col];
+    int cell_end = grid_cell_begin_[row * grid_cols_ + last_col + 1];
+    candidates.insert(candidates.end(), grid_objects_.begin() + cell_begin, grid_objects_.begin() + cell_end);
+  }
+  // same order as a scan of the whole input
+  std::sort(candidates.begin(), candidates.end());
+}
+
 void ImmUkfPda::measurementValidation(const autoware_msgs::DetectedObjectArray& input, UKF& target,
-                                      const bool second_init, const Eigen::VectorXd& max_det_z,
-                                      const Eigen::MatrixXd& max_det_s,
+                                      const bool second_init, const UKF::MeasVector& max_det_z,
+                                      const UKF::MeasMatrix& max_det_s,
                                       std::vector<autoware_msgs::DetectedObject>& object_vec,
                                       std::vector<bool>& matching_vec)
 {
@@ -193,16 +314,18 @@ void ImmUkfPda::measurementValidation(const autoware_msgs::DetectedObjectArray&
   bool second_init_done = false;
   double smallest_nis = std::numeric_limits<double>::max();
   autoware_msgs::DetectedObject smallest_meas_object;
-  for (size_t i = 0; i < input.objects.size(); i++)
+  getGateCandidates(max_det_z, max_det_s, gate_candidates_);
+  for (size_t candidate = 0; candidate < gate_candidates_.size(); candidate++)
   {
+    int i = gate_candidates_[candidate];
     double x = input.objects[i].pose.position.x;
     double y = input.objects[i].pose.position.y;
 
-    Eigen::VectorXd meas = Eigen::VectorXd(2);
+    UKF::MeasVector meas;
     meas << x, y;
 
-    Eigen::VectorXd diff = meas - max_det_z;
-    double nis = diff.transpose() * max_det_s.inverse() * diff;
+    UKF::MeasVector diff = meas - max_det_z;
+    double nis = diff.transpose() * max_det_s.partialPivLu().inverse() * diff;
 
     if (nis < gating_thres_)
     {  // x^2 99% range
@@ -384,7 +507,7 @@ void ImmUkfPda::initTracker(const autoware_msgs::DetectedObjectArray& input, dou
   {
     double px = input.objects[i].pose.position.x;
     double py = input.objects[i].pose.position.y;
-    Eigen::VectorXd init_meas = Eigen::VectorXd(2);
+    UKF::MeasVector init_meas;
     init_meas << px, py;
 
     UKF ukf;
@@ -478,21 +601,21 @@ void ImmUkfPda::probabilisticDataAssociation(const autoware_msgs::DetectedObject
                                              bool& is_skip_target)
 {
   double det_s = 0;
-  Eigen::VectorXd max_det_z;
-  Eigen::MatrixXd max_det_s;
+  UKF::MeasVector max_det_z;
+  UKF::MeasMatrix max_det_s;
   is_skip_target = false;
 
   if (use_sukf_)
   {
     max_det_z = target.z_pred_ctrv_;
     max_det_s = target.s_ctrv_;
-    det_s = max_det_s.determinant();
+    det_s = max_det_s.partialPivLu().determinant();
   }
   else
   {
     // find maxDetS associated with predZ
     target.findMaxZandS(max_det_z, max_det_s);
-    det_s = max_det_s.determinant();
+    det_s = max_det_s.partialPivLu().determinant();
   }
 
   // prevent ukf not to explode
@@ -547,7 +670,7 @@ void ImmUkfPda::makeNewTargets(const double timestamp, const autoware_msgs::Dete
     {
       double px = input.objects[i].pose.position.x;
       double py = input.objects[i].pose.position.y;
-      Eigen::VectorXd init_meas = Eigen::VectorXd(2);
+      UKF::MeasVector init_meas;
       init_meas << px, py;
 
       UKF ukf;
@@ -632,7 +755,7 @@ void ImmUkfPda::makeOutput(const autoware_msgs::DetectedObjectArray& input,
 
 void ImmUkfPda::removeUnnecessaryTarget()
 {
-  std::vector<UKF> temp_targets;
+  std::vector<UKF, Eigen::aligned_allocator<UKF> > temp_targets;
   for (size_t i = 0; i < targets_.size(); i++)
   {
     if (targets_[i].tracking_num_ != TrackingState::Die)
@@ -640,7 +763,7 @@ void ImmUkfPda::removeUnnecessaryTarget()
       temp_targets.push_back(targets_[i]);
     }
   }
-  std::vector<UKF>().swap(targets_);
+  std::vector<UKF, Eigen::aligned_allocator<UKF> >().swap(targets_);
   targets_ = temp_targets;
 }
 
@@ -771,7 +894,13 @@ void ImmUkfPda::tracker(const autoware_msgs::DetectedObjectArray& input,
   std::vector<bool> matching_vec(input.objects.size(), false);
 
   // start UKF process
-  for (size_t i = 0; i < targets_.size(); i++)
+  // targets only depend on each other through matching_vec in the data association, so the prediction and update
+  // steps run in parallel for all the targets and the association runs in between, in the same order as before
+  const int num_targets = targets_.size();
+  std::vector<char> is_active_target(num_targets, false);
+
+#pragma omp parallel for
+  for (int i = 0; i < num_targets; i++)
   {
     // reset is_vis_bb_ to false
     targets_[i].is_vis_bb_ = false;
@@ -793,31 +922,50 @@ void ImmUkfPda::tracker(const autoware_msgs::DetectedObjectArray& input,
     {
       // standard ukf prediction step
       targets_[i].predictionSUKF(dt);
-      // data association
-      bool is_skip_target;
-      std::vector<autoware_msgs::DetectedObject> object_vec;
-      probabilisticDataAssociation(input, dt, matching_vec, object_vec, targets_[i], is_skip_target);
-      if (is_skip_target)
-      {
-        continue;
-      }
-      // standard ukf update step
-      targets_[i].updateSUKF(object_vec);
     }
     else  // immukfpda filter
     {
       // immukf prediction step
       targets_[i].predictionIMMUKF(dt);
-      // data association
-      bool is_skip_target;
-      std::vector<autoware_msgs::DetectedObject> object_vec;
-      probabilisticDataAssociation(input, dt, matching_vec, object_vec, targets_[i], is_skip_target);
-      if (is_skip_target)
-      {
-        continue;
-      }
+    }
+    is_active_target[i] = true;
+  }
+
+  // data association
+  std::chrono::system_clock::time_point association_start = std::chrono::system_clock::now();
+  buildAssociationGrid(input);
+  std::vector<std::vector<autoware_msgs::DetectedObject> > object_vecs(num_targets);
+  for (int i = 0; i < num_targets; i++)
+  {
+    if (!is_active_target[i])
+    {
+      continue;
+    }
+    bool is_skip_target;
+    probabilisticDataAssociation(input, dt, matching_vec, object_vecs[i], targets_[i], is_skip_target);
+    is_active_target[i] = !is_skip_target;
+  }
+  std_msgs::Float32 association_time;
+  association_time.data =
+      std::chrono::duration<float, std::milli>(std::chrono::system_clock::now() - association_start).count();
+  pub_association_time_.publish(association_time);
+
+#pragma omp parallel for
+  for (int i = 0; i < num_targets; i++)
+  {
+    if (!is_active_target[i])
+    {
+      continue;
+    }
+    if (use_sukf_)
+    {
+      // standard ukf update step
+      targets_[i].updateSUKF(object_vecs[i]);
+    }
+    else  // immukfpda filter
+    {
       // immukf update step
-      targets_[i].updateIMMUKF(detection_probability_, gate_probability_, gating_thres_, object_vec);
+      targets_[i].updateIMMUKF(detection_probability_, gate_probability_, gating_thres_, object_vecs[i]);
     }
   }
   // end UKF process
@@ -35,30 +35,6 @@
 */
 UKF::UKF()
 {
-  // initial state vector
-  x_merge_ = Eigen::MatrixXd(5, 1);
-
-  // initial state vector
-  x_cv_ = Eigen::MatrixXd(5, 1);
-
-  // initial state vector
-  x_ctrv_ = Eigen::MatrixXd(5, 1);
-
-  // initial state vector
-  x_rm_ = Eigen::MatrixXd(5, 1);
-
-  // initial covariance matrix
-  p_merge_ = Eigen::MatrixXd(5, 5);
-
-  // initial covariance matrix
-  p_cv_ = Eigen::MatrixXd(5, 5);
-
-  // initial covariance matrix
-  p_ctrv_ = Eigen::MatrixXd(5, 5);
-
-  // initial covariance matrix
-  p_rm_ = Eigen::MatrixXd(5, 5);
-
   // Process noise standard deviation longitudinal acceleration in m/s^2
   std_a_cv_ = 2;
   std_a_ctrv_ = 2;
@@ -81,19 +57,6 @@ UKF::UKF()
   // state dimension
   n_x_ = 5;
 
-  // predicted sigma points matrix
-  x_sig_pred_cv_ = Eigen::MatrixXd(n_x_, 2 * n_x_ + 1);
-
-  // predicted sigma points matrix
-  x_sig_pred_ctrv_ = Eigen::MatrixXd(n_x_, 2 * n_x_ + 1);
-
-  // predicted sigma points matrix
-  x_sig_pred_rm_ = Eigen::MatrixXd(n_x_, 2 * n_x_ + 1);
-
-  // create vector for weights
-  weights_c_ = Eigen::VectorXd(2 * n_x_ + 1);
-  weights_s_ = Eigen::VectorXd(2 * n_x_ + 1);
-
   // transition probability
   p1_.push_back(0.9);
   p1_.push_back(0.05);
@@ -123,18 +86,6 @@ UKF::UKF()
   mode_prob_ctrv_ = 0.33;
   mode_prob_rm_ = 0.33;
 
-  z_pred_cv_ = Eigen::VectorXd(2);
-  z_pred_ctrv_ = Eigen::VectorXd(2);
-  z_pred_rm_ = Eigen::VectorXd(2);
-
-  s_cv_ = Eigen::MatrixXd(2, 2);
-  s_ctrv_ = Eigen::MatrixXd(2, 2);
-  s_rm_ = Eigen::MatrixXd(2, 2);
-
-  k_cv_ = Eigen::MatrixXd(5, 2);
-  k_ctrv_ = Eigen::MatrixXd(5, 2);
-  k_rm_ = Eigen::MatrixXd(5, 2);
-
   pd_ = 0.9;
   pg_ = 0.99;
 
@@ -151,46 +102,14 @@ UKF::UKF()
   bb_yaw_ = 0;
   bb_area_ = 0;
 
-  // for static classification
-  init_meas_ = Eigen::VectorXd(2);
-
   x_merge_yaw_ = 0;
 
-  // for raukf
-  cv_meas_ = Eigen::VectorXd(2);
-  ctrv_meas_ = Eigen::VectorXd(2);
-  rm_meas_ = Eigen::VectorXd(2);
-
-  r_cv_ = Eigen::MatrixXd(2, 2);
-  r_ctrv_ = Eigen::MatrixXd(2, 2);
-  r_rm_ = Eigen::MatrixXd(2, 2);
-
-  q_cv_ = Eigen::MatrixXd(5, 5);
-  q_ctrv_ = Eigen::MatrixXd(5, 5);
-  q_rm_ = Eigen::MatrixXd(5, 5);
-
   nis_cv_ = 0;
   nis_ctrv_ = 0;
   nis_rm_ = 0;
-
-  new_x_sig_cv_ = Eigen::MatrixXd(n_x_, 2 * n_x_ + 1);
-  new_x_sig_ctrv_ = Eigen::MatrixXd(n_x_, 2 * n_x_ + 1);
-  new_x_sig_rm_ = Eigen::MatrixXd(n_x_, 2 * n_x_ + 1);
-
-  new_z_sig_cv_ = Eigen::MatrixXd(2, 2 * n_x_ + 1);
-  new_z_sig_ctrv_ = Eigen::MatrixXd(2, 2 * n_x_ + 1);
-  new_z_sig_rm_ = Eigen::MatrixXd(2, 2 * n_x_ + 1);
-
-  new_z_pred_cv_ = Eigen::VectorXd(2);
-  new_z_pred_ctrv_ = Eigen::VectorXd(2);
-  new_z_pred_rm_ = Eigen::VectorXd(2);
-
-  new_s_cv_ = Eigen::MatrixXd(2, 2);
-  new_s_ctrv_ = Eigen::MatrixXd(2, 2);
-  new_s_rm_ = Eigen::MatrixXd(2, 2);
 }
 
-void UKF::initialize(const Eigen::VectorXd& z, const double timestamp, const int target_id)
+void UKF::initialize(const MeasVector& z, const double timestamp, const int target_id)
 {
   ukf_id_ = target_id;
 
@@ -330,12 +249,12 @@ void UKF::mixingProbability()
 
 void UKF::interaction()
 {
-  Eigen::MatrixXd x_pre_cv = x_cv_;
-  Eigen::MatrixXd x_pre_ctrv = x_ctrv_;
-  Eigen::MatrixXd x_pre_rm = x_rm_;
-  Eigen::MatrixXd p_pre_cv = p_cv_;
-  Eigen::MatrixXd p_pre_ctrv = p_ctrv_;
-  Eigen::MatrixXd p_pre_rm = p_rm_;
+  StateVector x_pre_cv = x_cv_;
+  StateVector x_pre_ctrv = x_ctrv_;
+  StateVector x_pre_rm = x_rm_;
+  StateMatrix p_pre_cv = p_cv_;
+  StateMatrix p_pre_ctrv = p_ctrv_;
+  StateMatrix p_pre_rm = p_rm_;
   x_cv_ = mode_match_prob_cv2cv_ * x_pre_cv + mode_match_prob_ctrv2cv_ * x_pre_ctrv + mode_match_prob_rm2cv_ * x_pre_rm;
   x_ctrv_ = mode_match_prob_cv2ctrv_ * x_pre_cv + mode_match_prob_ctrv2ctrv_ * x_pre_ctrv +
             mode_match_prob_rm2ctrv_ * x_pre_rm;
@@ -412,11 +331,11 @@ void UKF::predictionIMMUKF(const double dt)
   updateLidar(MotionModel::RM);
 }
 
-void UKF::findMaxZandS(Eigen::VectorXd& max_det_z, Eigen::MatrixXd& max_det_s)
+void UKF::findMaxZandS(MeasVector& max_det_z, MeasMatrix& max_det_s)
 {
-  double cv_det = s_cv_.determinant();
-  double ctrv_det = s_ctrv_.determinant();
-  double rm_det = s_rm_.determinant();
+  double cv_det = s_cv_.partialPivLu().determinant();
+  double ctrv_det = s_ctrv_.partialPivLu().determinant();
+  double rm_det = s_rm_.partialPivLu().determinant();
 
   if (cv_det > ctrv_det)
   {
@@ -461,30 +380,30 @@ void UKF::updateEachMotion(const double detection_probability, const double gate
   std::vector<double> e_ctrv_vec;
   std::vector<double> e_rm_vec;
 
-  std::vector<Eigen::VectorXd> diff_cv_vec;
-  std::vector<Eigen::VectorXd> diff_ctrv_vec;
-  std::vector<Eigen::VectorXd> diff_rm_vec;
+  std::vector<MeasVector, Eigen::aligned_allocator<MeasVector> > diff_cv_vec;
+  std::vector<MeasVector, Eigen::aligned_allocator<MeasVector> > diff_ctrv_vec;
+  std::vector<MeasVector, Eigen::aligned_allocator<MeasVector> > diff_rm_vec;
 
-  std::vector<Eigen::VectorXd> meas_vec;
+  std::vector<MeasVector, Eigen::aligned_allocator<MeasVector> > meas_vec;
 
   for (size_t i = 0; i < num_meas; i++)
   {
-    Eigen::VectorXd meas = Eigen::VectorXd(2);
+    MeasVector meas;
     meas(0) = object_vec[i].pose.position.x;
     meas(1) = object_vec[i].pose.position.y;
     meas_vec.push_back(meas);
 
-    Eigen::VectorXd diff_cv = meas - z_pred_cv_;
-    Eigen::VectorXd diff_ctrv = meas - z_pred_ctrv_;
-    Eigen::VectorXd diff_rm = meas - z_pred_rm_;
+    MeasVector diff_cv = meas - z_pred_cv_;
+    MeasVector diff_ctrv = meas - z_pred_ctrv_;
+    MeasVector diff_rm = meas - z_pred_rm_;
 
     diff_cv_vec.push_back(diff_cv);
     diff_ctrv_vec.push_back(diff_ctrv);
     diff_rm_vec.push_back(diff_rm);
 
-    double e_cv = exp(-0.5 * diff_cv.transpose() * s_cv_.inverse() * diff_cv);
-    double e_ctrv = exp(-0.5 * diff_ctrv.transpose() * s_ctrv_.inverse() * diff_ctrv);
-    double e_rm = exp(-0.5 * diff_rm.transpose() * s_rm_.inverse() * diff_rm);
+    double e_cv = exp(-0.5 * diff_cv.transpose() * s_cv_.partialPivLu().inverse() * diff_cv);
+    double e_ctrv = exp(-0.5 * diff_ctrv.transpose() * s_ctrv_.partialPivLu().inverse() * diff_ctrv);
+    double e_rm = exp(-0.5 * diff_rm.transpose() * s_rm_.partialPivLu().inverse() * diff_rm);
 
     e_cv_vec.push_back(e_cv);
     e_ctrv_vec.push_back(e_ctrv);
@@ -525,12 +444,9 @@ void UKF::updateEachMotion(const double detection_probability, const double gate
     beta_ctrv.push_back(temp_ctrv);
     beta_rm.push_back(temp_rm);
   }
-  Eigen::VectorXd sigma_x_cv;
-  Eigen::VectorXd sigma_x_ctrv;
-  Eigen::VectorXd sigma_x_rm;
-  sigma_x_cv.setZero(2);
-  sigma_x_ctrv.setZero(2);
-  sigma_x_rm.setZero(2);
+  MeasVector sigma_x_cv = MeasVector::Zero();
+  MeasVector sigma_x_ctrv = MeasVector::Zero();
+  MeasVector sigma_x_rm = MeasVector::Zero();
 
   for (size_t i = 0; i < num_meas; i++)
   {
@@ -539,12 +455,9 @@ void UKF::updateEachMotion(const double detection_probability, const double gate
     sigma_x_rm += beta_rm[i] * diff_rm_vec[i];
   }
 
-  Eigen::MatrixXd sigma_p_cv;
-  Eigen::MatrixXd sigma_p_ctrv;
-  Eigen::MatrixXd sigma_p_rm;
-  sigma_p_cv.setZero(2, 2);
-  sigma_p_ctrv.setZero(2, 2);
-  sigma_p_rm.setZero(2, 2);
+  MeasMatrix sigma_p_cv = MeasMatrix::Zero();
+  MeasMatrix sigma_p_ctrv = MeasMatrix::Zero();
+  MeasMatrix sigma_p_rm = MeasMatrix::Zero();
 
   for (size_t i = 0; i < num_meas; i++)
   {
@@ -572,9 +485,9 @@ void UKF::updateEachMotion(const double detection_probability, const double gate
   while (x_rm_(3) < -M_PI)
     x_rm_(3) += 2. * M_PI;
 
-  Eigen::MatrixXd p_pre_cv = p_cv_;
-  Eigen::MatrixXd p_pre_ctrv = p_ctrv_;
-  Eigen::MatrixXd p_pre_rm = p_rm_;
+  StateMatrix p_pre_cv = p_cv_;
+  StateMatrix p_pre_ctrv = p_ctrv_;
+  StateMatrix p_pre_rm = p_rm_;
 
   if (num_meas != 0)
   {
@@ -593,24 +506,24 @@ void UKF::updateEachMotion(const double detection_probability, const double gate
     p_rm_ = p_pre_rm - k_rm_ * s_rm_ * k_rm_.transpose();
   }
 
-  Eigen::VectorXd max_det_z;
-  Eigen::MatrixXd max_det_s;
+  MeasVector max_det_z;
+  MeasMatrix max_det_s;
 
   findMaxZandS(max_det_z, max_det_s);
-  double Vk = M_PI * sqrt(gating_thres * max_det_s.determinant());
+  double Vk = M_PI * sqrt(gating_thres * max_det_s.partialPivLu().determinant());
 
   double lambda_cv, lambda_ctrv, lambda_rm;
   if (num_meas != 0)
   {
-    lambda_cv =
-        (1 - gate_probability * detection_probability) / pow(Vk, num_meas) +
-        detection_probability * pow(Vk, 1 - num_meas) * e_cv_sum / (num_meas * sqrt(2 * M_PI * s_cv_.determinant()));
+    lambda_cv = (1 - gate_probability * detection_probability) / pow(Vk, num_meas) +
+                detection_probability * pow(Vk, 1 - num_meas) * e_cv_sum /
+                    (num_meas * sqrt(2 * M_PI * s_cv_.partialPivLu().determinant()));
     lambda_ctrv = (1 - gate_probability * detection_probability) / pow(Vk, num_meas) +
                   detection_probability * pow(Vk, 1 - num_meas) * e_ctrv_sum /
-                      (num_meas * sqrt(2 * M_PI * s_ctrv_.determinant()));
-    lambda_rm =
-        (1 - gate_probability * detection_probability) / pow(Vk, num_meas) +
-        detection_probability * pow(Vk, 1 - num_meas) * e_rm_sum / (num_meas * sqrt(2 * M_PI * s_rm_.determinant()));
+                      (num_meas * sqrt(2 * M_PI * s_ctrv_.partialPivLu().determinant()));
+    lambda_rm = (1 - gate_probability * detection_probability) / pow(Vk, num_meas) +
+                detection_probability * pow(Vk, 1 - num_meas) * e_rm_sum /
+                    (num_meas * sqrt(2 * M_PI * s_rm_.partialPivLu().determinant()));
   }
   else
   {
@@ -628,16 +541,16 @@ void UKF::updateLikelyMeasurementForCTRV(const std::vector<autoware_msgs::Detect
 {
   double num_meas = object_vec.size();
   std::vector<double> e_ctrv_vec;
-  std::vector<Eigen::VectorXd> meas_vec;
+  std::vector<MeasVector, Eigen::aligned_allocator<MeasVector> > meas_vec;
 
   for (size_t i = 0; i < num_meas; i++)
   {
-    Eigen::VectorXd meas = Eigen::VectorXd(2);
+    MeasVector meas;
     meas(0) = object_vec[i].pose.position.x;
     meas(1) = object_vec[i].pose.position.y;
     meas_vec.push_back(meas);
-    Eigen::VectorXd diff_ctrv = meas - z_pred_ctrv_;
-    double e_ctrv = exp(-0.5 * diff_ctrv.transpose() * s_ctrv_.inverse() * diff_ctrv);
+    MeasVector diff_ctrv = meas - z_pred_ctrv_;
+    double e_ctrv = exp(-0.5 * diff_ctrv.transpose() * s_ctrv_.partialPivLu().inverse() * diff_ctrv);
     e_ctrv_vec.push_back(e_ctrv);
   }
   // for noise estimation
@@ -659,14 +572,14 @@ void UKF::updateSUKF(const std::vector<autoware_msgs::DetectedObject>& object_ve
   // get most likely measurement ctrv_meas_
   updateLikelyMeasurementForCTRV(object_vec);
 
-  Eigen::VectorXd z = Eigen::VectorXd(2);
+  MeasVector z;
   z << ctrv_meas_(0), ctrv_meas_(1);
 
-  Eigen::VectorXd x = x_ctrv_.col(0);
-  Eigen::VectorXd z_pred = z_pred_ctrv_;
-  Eigen::MatrixXd k = k_ctrv_;
-  Eigen::MatrixXd p = p_ctrv_;
-  Eigen::MatrixXd s = s_ctrv_;
+  StateVector x = x_ctrv_.col(0);
+  MeasVector z_pred = z_pred_ctrv_;
+  GainMatrix k = k_ctrv_;
+  StateMatrix p = p_ctrv_;
+  MeasMatrix s = s_ctrv_;
 
   x_ctrv_.col(0) = x + k * (z - z_pred);
   p_ctrv_ = p - k * s_ctrv_ * k.transpose();
@@ -807,10 +720,10 @@ void UKF::prediction(const double delta_t, const int model_ind)
   /*****************************************************************************
  *  Initialize model parameters
  ****************************************************************************/
-  Eigen::MatrixXd x(x_cv_.rows(), 1);
-  Eigen::MatrixXd p(p_cv_.rows(), p_cv_.cols());
-  Eigen::MatrixXd q(p_cv_.rows(), p_cv_.cols());
-  Eigen::MatrixXd x_sig_pred(x_sig_pred_cv_.rows(), x_sig_pred_cv_.cols());
+  StateVector x;
+  StateMatrix p;
+  StateMatrix q;
+  SigmaMatrix x_sig_pred;
   if (model_ind == MotionModel::CV)
   {
     x = x_cv_.col(0);
@@ -837,17 +750,17 @@ void UKF::prediction(const double delta_t, const int model_ind)
   *  Create Sigma Points
   ****************************************************************************/
 
-  Eigen::MatrixXd x_sig = Eigen::MatrixXd(n_x_, 2 * n_x_ + 1);
+  SigmaMatrix x_sig;
 
   // create square root matrix
-  Eigen::MatrixXd L = p.llt().matrixL();
+  StateMatrix L = p.llt().matrixL();
 
   // create augmented sigma points
   x_sig.col(0) = x;
   for (int i = 0; i < n_x_; i++)
   {
-    Eigen::VectorXd pred1 = x + sqrt(lambda_ + n_x_) * L.col(i);
-    Eigen::VectorXd pred2 = x - sqrt(lambda_ + n_x_) * L.col(i);
+    StateVector pred1 = x + sqrt(lambda_ + n_x_) * L.col(i);
+    StateVector pred2 = x - sqrt(lambda_ + n_x_) * L.col(i);
 
     while (pred1(3) > M_PI)
       pred1(3) -= 2. * M_PI;
@@ -911,7 +824,7 @@ void UKF::prediction(const double delta_t, const int model_ind)
   for (int i = 0; i < 2 * n_x_ + 1; i++)
   {  // iterate over sigma points
     // state difference
-    Eigen::VectorXd x_diff = x_sig_pred.col(i) - x;
+    StateVector x_diff = x_sig_pred.col(i) - x;
     // angle normalization
     while (x_diff(3) > M_PI)
       x_diff(3) -= 2. * M_PI;
@@ -950,10 +863,9 @@ void UKF::updateLidar(const int model_ind)
   /*****************************************************************************
  *  Initialize model parameters
  ****************************************************************************/
-  Eigen::VectorXd x(x_cv_.rows());
-  Eigen::MatrixXd P(p_cv_.rows(), p_cv_.cols());
-  Eigen::MatrixXd r(2, 2);
-  Eigen::MatrixXd x_sig_pred(x_sig_pred_cv_.rows(), x_sig_pred_cv_.cols());
+  StateVector x;
+  MeasMatrix r;
+  SigmaMatrix x_sig_pred;
   if (model_ind == MotionModel::CV)
   {
     x = x_cv_.col(0);
@@ -974,10 +886,8 @@ void UKF::updateLidar(const int model_ind)
   }
 
   // set measurement dimension, lidar can measure p_x and p_y
-  int n_z = 2;
-
   // create matrix for sigma points in measurement space
-  Eigen::MatrixXd z_sig = Eigen::MatrixXd(n_z, 2 * n_x_ + 1);
+  MeasSigmaMatrix z_sig;
 
   // transform sigma points into measurement space
   for (int i = 0; i < 2 * n_x_ + 1; i++)
@@ -992,7 +902,7 @@ void UKF::updateLidar(const int model_ind)
   }
 
   // mean predicted measurement
-  Eigen::VectorXd z_pred = Eigen::VectorXd(n_z);
+  MeasVector z_pred;
   z_pred.fill(0.0);
   for (int i = 0; i < 2 * n_x_ + 1; i++)
   {
@@ -1000,12 +910,12 @@ void UKF::updateLidar(const int model_ind)
   }
 
   // measurement covariance matrix S
-  Eigen::MatrixXd S = Eigen::MatrixXd(n_z, n_z);
+  MeasMatrix S;
   S.fill(0.0);
   for (int i = 0; i < 2 * n_x_ + 1; i++)
   {  // 2n+1 simga points
     // residual
-    Eigen::VectorXd z_diff = z_sig.col(i) - z_pred;
+    MeasVector z_diff = z_sig.col(i) - z_pred;
     S = S + weights_c_(i) * z_diff * z_diff.transpose();
   }
 
@@ -1013,7 +923,7 @@ void UKF::updateLidar(const int model_ind)
   S = S + r;
 
   // create matrix for cross correlation Tc
-  Eigen::MatrixXd Tc = Eigen::MatrixXd(n_x_, n_z);
+  GainMatrix Tc;
 
   /*****************************************************************************
   *  UKF Update for Lidar
@@ -1023,9 +933,9 @@ void UKF::updateLidar(const int model_ind)
   for (int i = 0; i < 2 * n_x_ + 1; i++)
   {  // 2n+1 simga points
     // residual
-    Eigen::VectorXd z_diff = z_sig.col(i) - z_pred;
+    MeasVector z_diff = z_sig.col(i) - z_pred;
     // state difference
-    Eigen::VectorXd x_diff = x_sig_pred.col(i) - x;
+    StateVector x_diff = x_sig_pred.col(i) - x;
 
     while (x_diff(3) > M_PI)
       x_diff(3) -= 2. * M_PI;
@@ -1035,7 +945,7 @@ void UKF::updateLidar(const int model_ind)
     Tc = Tc + weights_c_(i) * x_diff * z_diff.transpose();
   }
 
-  Eigen::MatrixXd K = Tc * S.inverse();
+  GainMatrix K = Tc * S.partialPivLu().inverse();
 
   /*****************************************************************************
   *  Update model parameters
@@ -7,6 +7,10 @@
 
 
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
 #include <ros/ros.h>
 #include "Rate.h"
 #include "libvectormap/vector_map.h"
@@ -58,6 +62,13 @@ static ros::ServiceClient g_ros_client;
 
 #define SignalLampRadius 0.3
 
+/* clipping planes of the projection [m] */
+static constexpr float NEAR_PLANE = 1.0;
+static constexpr float FAR_PLANE = 200.0;
+
+/* size of the cells of the signal index [m] */
+static constexpr double SIGNAL_CELL_SIZE = 50.0;
+
 /* Define utility class to use vector map server */
 namespace
 {
@@ -96,8 +107,98 @@ namespace
 			waypoints_ = waypoints;
 		}
 	}; // Class VectorMapClient
+
+	/* Signals of the whole vector map, bucketed on a grid of the map xy plane
+	   so that only the signals around the camera frustum are projected */
+	class SignalIndex
+	{
+	public:
+		struct Entry
+		{
+			Signal signal;
+			Point3 center;
+			double hang;
+			double vang;
+		};
+
+	private:
+		std::vector<Entry> entries_;    // in the order of the signal ids
+		std::unordered_map<uint64_t, std::vector<int>> cells_;
+		double cell_size_;
+		size_t signals_size_, vectors_size_, points_size_;    // of the map the index was built from
+
+		static int64_t cellIndex(double val, double cell_size)
+		{
+			return static_cast<int64_t>(std::floor(val / cell_size));
+		}
+
+		static uint64_t cellKey(int64_t ix, int64_t iy)
+		{
+			return (static_cast<uint64_t>(ix) << 32) ^ (static_cast<uint64_t>(iy) & 0xffffffff);
+		}
+
+	public:
+		SignalIndex() : cell_size_(SIGNAL_CELL_SIZE), signals_size_(0), vectors_size_(0), points_size_(0)
+		{
+		}
+
+		/* the map keeps growing while its topics are received */
+		bool isStale(const VectorMap &map) const
+		{
+			return map.signals.size() != signals_size_ || map.vectors.size() != vectors_size_ ||
+			       map.points.size() != points_size_;
+		}
+
+		size_t size() const
+		{
+			return entries_.size();
+		}
+
+		const Entry &at(int idx) const
+		{
+			return entries_[idx];
+		}
+
+		void build(VectorMap &map)
+		{
+			entries_.clear();
+			cells_.clear();
+			for (const auto &signal_map : map.signals)
+			{
+				Entry entry;
+				entry.signal = signal_map.second;
+				entry.center = map.getPoint(map.vectors[entry.signal.vid].pid);
+				entry.hang = map.vectors[entry.signal.vid].hang;
+				entry.vang = map.vectors[entry.signal.vid].vang;
+
+				cells_[cellKey(cellIndex(entry.center.x(), cell_size_), cellIndex(entry.center.y(), cell_size_))]
+					.push_back(entries_.size());
+				entries_.push_back(entry);
+			}
+			signals_size_ = map.signals.size();
+			vectors_size_ = map.vectors.size();
+			points_size_ = map.points.size();
+		}
+
+		/* indices of the signals in the rectangle of the xy plane, in the order of the signal ids */
+		void query(double min_x, double min_y, double max_x, double max_y, std::vector<int> &indices) const
+		{
+			indices.clear();
+			for (int64_t ix = cellIndex(min_x, cell_size_); ix <= cellIndex(max_x, cell_size_); ix++)
+			{
+				for (int64_t iy = cellIndex(min_y, cell_size_); iy <= cellIndex(max_y, cell_size_); iy++)
+				{
+					auto cell = cells_.find(cellKey(ix, iy));
+					if (cell != cells_.end())
+						indices.insert(indices.end(), cell->second.begin(), cell->second.end());
+				}
+			}
+			std::sort(indices.begin(), indices.end());
+		}
+	}; // Class SignalIndex
 } // namespace
 static VectorMapClient g_vector_map_client;
+static SignalIndex g_signal_index;
 
 
 /* Callback function to shift projection result */
@@ -216,8 +317,8 @@ Point3 transform(const Point3 &psrc, tf::StampedTransform &tfsource)
  */
 bool project2(const Point3 &pt, int &u, int &v, bool useOpenGLCoord = false)
 {
-	float nearPlane = 1.0;
-	float farPlane = 200.0;
+	float nearPlane = NEAR_PLANE;
+	float farPlane = FAR_PLANE;
 	Point3 _pt = transform(pt, trf);
 	float _u = _pt.x() * fx / _pt.z() + cx;
 	float _v = _pt.y() * fy / _pt.z() + cy;
@@ -271,10 +372,92 @@ double GetSignalAngleInCameraSystem(double hang, double vang)
 }  // double GetSignalAngleInCameraSystem()
 
 
+/*
+ * Project a signal and add it to signalsInFrame if it is in the image and faces the camera
+ */
+static void echoSignal(const Signal &signal, const Point3 &signalcenter, double hang, double vang,
+                       bool useOpenGLCoord, autoware_msgs::Signals &signalsInFrame)
+{
+	Point3 signalcenterx(signalcenter.x(), signalcenter.y(), signalcenter.z() + SignalLampRadius);
+
+	int u, v;
+	if (project2(signalcenter, u, v, useOpenGLCoord) == true)
+	{
+		// std::cout << u << ", " << v << ", " << std::endl;
+
+		int radius;
+		int ux, vx;
+		project2(signalcenterx, ux, vx, useOpenGLCoord);
+		radius = (int) distance(ux, vx, u, v);
+
+		autoware_msgs::ExtractedPosition sign;
+		sign.signalId = signal.id;
+
+		sign.u = u + adjust_proj_x; // shift project position by configuration value from runtime manager
+		sign.v = v + adjust_proj_y; // shift project position by configuration value from runtime manager
+
+		sign.radius = radius;
+		sign.x = signalcenter.x(), sign.y = signalcenter.y(), sign.z = signalcenter.z();
+		sign.hang = hang; // hang is expressed in [0, 360] degree
+		sign.type = signal.type, sign.linkId = signal.linkid;
+		sign.plId = signal.plid;
+
+		// Get holizontal angle of signal in camera corrdinate system
+		double signal_angle = GetSignalAngleInCameraSystem(hang + 180.0f,
+		                                                   vang + 180.0f);
+
+		// signal_angle will be zero if signal faces to x-axis
+		// Target signal should be face to -50 <= z-axis (= 90 degree) <= +50
+		if (isRange(-50, 50, signal_angle - 90))
+		{
+			signalsInFrame.Signals.push_back(sign);
+		}
+	}
+}
+
+
+/*
+ * Bounds in the map xy plane of the part of the camera frustum where project2 accepts points
+ */
+static bool getFrustumBounds(double &min_x, double &min_y, double &max_x, double &max_y)
+{
+	if (fx <= 0 || fy <= 0)
+		return false;
+
+	/* the frustum is inside the pyramid from the camera center to the corners of the far plane,
+	   the image is widened by a pixel as project2 truncates the coordinates */
+	tf::Transform camera_to_map = trf.inverse();
+	tf::Vector3 camera_center = camera_to_map.getOrigin();
+	min_x = max_x = camera_center.x();
+	min_y = max_y = camera_center.y();
+	const double corners_u[2] = {-1.0, imageWidth + 1.0};
+	const double corners_v[2] = {-1.0, imageHeight + 1.0};
+	for (double u : corners_u)
+	{
+		for (double v : corners_v)
+		{
+			tf::Vector3 corner(FAR_PLANE * (u - cx) / fx, FAR_PLANE * (v - cy) / fy, FAR_PLANE);
+			corner = camera_to_map * corner;
+			min_x = std::min(min_x, corner.x());
+			min_y = std::min(min_y, corner.y());
+			max_x = std::max(max_x, corner.x());
+			max_y = std::max(max_y, corner.y());
+		}
+	}
+
+	/* margin for the rounding of the map coordinates */
+	min_x -= 1.0;
+	min_y -= 1.0;
+	max_x += 1.0;
+	max_y += 1.0;
+	return true;
+}
+
+
 void echoSignals2(ros::Publisher &pub, bool useOpenGLCoord = false)
 {
-	int countPoint = 0;
 	autoware_msgs::Signals signalsInFrame;
+	double min_x, min_y, max_x, max_y;
 
 	/* Get signals on the path if vecter_map_server is enabled */
 	if (g_use_vector_map_server)
@@ -309,47 +492,39 @@ void echoSignals2(ros::Publisher &pub, bool useOpenGLCoord = false)
 		}
 	}
 
-	for (const auto& signal_map : vmap.signals)
+	if (g_use_vector_map_server)
 	{
-		const Signal signal = signal_map.second;
-		int pid = vmap.vectors[signal.vid].pid;
-
-		Point3 signalcenter = vmap.getPoint(pid);
-		Point3 signalcenterx(signalcenter.x(), signalcenter.y(), signalcenter.z() + SignalLampRadius);
-
-		int u, v;
-		if (project2(signalcenter, u, v, useOpenGLCoord) == true)
+		for (const auto& signal_map : vmap.signals)
 		{
-			countPoint++;
-			// std::cout << u << ", " << v << ", " << std::endl;
-
-			int radius;
-			int ux, vx;
-			project2(signalcenterx, ux, vx, useOpenGLCoord);
-			radius = (int) distance(ux, vx, u, v);
-
-			autoware_msgs::ExtractedPosition sign;
-			sign.signalId = signal.id;
-
-			sign.u = u + adjust_proj_x; // shift project position by configuration value from runtime manager
-			sign.v = v + adjust_proj_y; // shift project position by configuration value from runtime manager
+			const Signal signal = signal_map.second;
+			int pid = vmap.vectors[signal.vid].pid;
 
-			sign.radius = radius;
-			sign.x = signalcenter.x(), sign.y = signalcenter.y(), sign.z = signalcenter.z();
-			sign.hang = vmap.vectors[signal.vid].hang; // hang is expressed in [0, 360] degree
-			sign.type = signal.type, sign.linkId = signal.linkid;
-			sign.plId = signal.plid;
+			echoSignal(signal, vmap.getPoint(pid), vmap.vectors[signal.vid].hang, vmap.vectors[signal.vid].vang,
+			           useOpenGLCoord, signalsInFrame);
+		}
+	}
+	else
+	{
+		/* project the signals around the camera frustum only */
+		if (g_signal_index.isStale(vmap))
+			g_signal_index.build(vmap);
 
-			// Get holizontal angle of signal in camera corrdinate system
-			double signal_angle = GetSignalAngleInCameraSystem(vmap.vectors[signal.vid].hang + 180.0f,
-			                                                   vmap.vectors[signal.vid].vang + 180.0f);
+		static std::vector<int> indices;
+		if (getFrustumBounds(min_x, min_y, max_x, max_y))
+		{
+			g_signal_index.query(min_x, min_y, max_x, max_y, indices);
+		}
+		else
+		{
+			indices.resize(g_signal_index.size());
+			for (size_t i = 0; i < indices.size(); i++)
+				indices[i] = i;
+		}
 
-			// signal_angle will be zero if signal faces to x-axis
-			// Target signal should be face to -50 <= z-axis (= 90 degree) <= +50
-			if (isRange(-50, 50, signal_angle - 90))
-			{
-				signalsInFrame.Signals.push_back(sign);
-			}
+		for (int idx : indices)
+		{
+			const SignalIndex::Entry &entry = g_signal_index.at(idx);
+			echoSignal(entry.signal, entry.center, entry.hang, entry.vang, useOpenGLCoord, signalsInFrame);
 		}
 	}
 	signalsInFrame.header.stamp = ros::Time::now();
@@ -37,5 +37,29 @@ struct thresholdSet {
   hsvSet Green;
 };
 
+/* default thresholds of region_tlr, tuned for daytime */
+static inline void setDaytimeThresholds(thresholdSet *th) {
+  th->Red.Hue.upper = (double) DAYTIME_RED_UPPER;
+  th->Red.Hue.lower = (double) DAYTIME_RED_LOWER;
+  th->Red.Sat.upper = 1.0f;
+  th->Red.Sat.lower = DAYTIME_S_SIGNAL_THRESHOLD;
+  th->Red.Val.upper = 1.0f;
+  th->Red.Val.lower = DAYTIME_V_SIGNAL_THRESHOLD;
+
+  th->Yellow.Hue.upper = (double) DAYTIME_YELLOW_UPPER;
+  th->Yellow.Hue.lower = (double) DAYTIME_YELLOW_LOWER;
+  th->Yellow.Sat.upper = 1.0f;
+  th->Yellow.Sat.lower = DAYTIME_S_SIGNAL_THRESHOLD;
+  th->Yellow.Val.upper = 1.0f;
+  th->Yellow.Val.lower = DAYTIME_V_SIGNAL_THRESHOLD;
+
+  th->Green.Hue.upper = (double) DAYTIME_GREEN_UPPER;
+  th->Green.Hue.lower = (double) DAYTIME_GREEN_LOWER;
+  th->Green.Sat.upper = 1.0f;
+  th->Green.Sat.lower = DAYTIME_S_SIGNAL_THRESHOLD;
+  th->Green.Val.upper = 1.0f;
+  th->Green.Val.lower = DAYTIME_V_SIGNAL_THRESHOLD;
+}
+
 //#define SHOW_DEBUG_INFO
 #endif
@@ -40,9 +40,6 @@ static void colorExtraction(const cv::Mat& src, // input HSV image
                             const double   sat_lower, const double sat_upper, // satulation thresholds
                             const double   val_lower, const double val_upper) // value thresholds
 {
-  /* create imput image copy */
-  cv::Mat input_img = src.clone();
-
   *dst = cv::Scalar::all(0);
 
   /*
@@ -60,8 +57,8 @@ static void colorExtraction(const cv::Mat& src, // input HSV image
     }
 
   /* apply LUT to input image */
-  cv::Mat extracted(input_img.rows, input_img.cols, CV_8UC3);
-  LUT(input_img, lut, extracted);
+  cv::Mat extracted(src.rows, src.cols, CV_8UC3);
+  LUT(src, lut, extracted);
 
   /* divide image into each channel */
   std::vector<cv::Mat> channels;
@@ -350,46 +347,53 @@ static cv::Mat signalDetect_inROI(const cv::Mat& roi,
 } /* static void signalDetect_inROI() */
 
 
-/* constructor for non initialize value */
-TrafficLightDetector::TrafficLightDetector() {}
-
-
-void TrafficLightDetector::brightnessDetect(const cv::Mat &input) {
-
-  cv::Mat tmpImage;
-  input.copyTo(tmpImage);
-
-  /* contrast correction */
-  cv::Mat tmp;
-  cvtColor(tmpImage, tmp, CV_BGR2HSV);
-  std::vector<cv::Mat> hsv_channel;
-  split(tmp, hsv_channel);
-
+/* contrast correction of the value channel, the same for all frames */
+TrafficLightDetector::TrafficLightDetector() : contrastLut(cv::Size(256, 1), CV_8U) {
   float correction_factor = 10.0;
-  uchar lut[256];
   for (int i=0; i<256; i++) {
-    lut[i] = 255.0 / (1 + exp(-correction_factor*(i-128)/255));
+    contrastLut.at<uchar>(i) = 255.0 / (1 + exp(-correction_factor*(i-128)/255));
   }
+}
+
 
-  LUT(hsv_channel[2], cv::Mat(cv::Size(256, 1), CV_8U, lut), hsv_channel[2]);
-  merge(hsv_channel, tmp);
-  cvtColor(tmp, tmpImage, CV_HSV2BGR);
+void TrafficLightDetector::brightnessDetect(const cv::Mat &input) {
 
-  for (int i = 0; i < static_cast<int>(contexts.size()); i++) {
+  /* only the regions of interest are processed, the lamps independently of each other */
+  const int contexts_num = static_cast<int>(contexts.size());
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < contexts_num; i++) {
     Context context = contexts.at(i);
 
     if (context.topLeft.x > context.botRight.x)
       continue;
 
     /* extract region of interest from input image */
-    cv::Mat roi = tmpImage(cv::Rect(context.topLeft, context.botRight));
+    cv::Rect roi_rect(context.topLeft, context.botRight);
+
+    /* contrast correction */
+    cv::Mat roi;
+    cvtColor(input(roi_rect), roi, CV_BGR2HSV);
+    std::vector<cv::Mat> hsv_channel;
+    split(roi, hsv_channel);
+    LUT(hsv_channel[2], contrastLut, hsv_channel[2]);
+    merge(hsv_channel, roi);
+    cvtColor(roi, roi, CV_HSV2BGR);
+
+    /* the regions of the previous lamps are cleared once processed */
+    for (int j = 0; j < i; j++) {
+      if (contexts.at(j).topLeft.x > contexts.at(j).botRight.x)
+        continue;
+      cv::Rect overlap = roi_rect & cv::Rect(contexts.at(j).topLeft, contexts.at(j).botRight);
+      if (overlap.area() > 0)
+        roi(overlap - roi_rect.tl()).setTo(cv::Scalar(0));
+    }
 
     /* convert color space (BGR -> HSV) */
     cv::Mat roi_HSV;
     cvtColor(roi, roi_HSV, CV_BGR2HSV);
 
     /* search the place where traffic signals seem to be */
-    cv::Mat    signalMask    = signalDetect_inROI(roi_HSV, input.clone(),
+    cv::Mat    signalMask    = signalDetect_inROI(roi_HSV, input,
                                                   context.lampRadius,
                                                   context.topLeft,
                                                   context.leftTurnSignal || context.rightTurnSignal);
@@ -399,8 +403,7 @@ void TrafficLightDetector::brightnessDetect(const cv::Mat &input) {
     roi.copyTo(extracted_HSV, signalMask);
 
 #ifdef SHOW_DEBUG_INFO
-    extracted_HSV.copyTo(roi);
-    imshow("tmpImage", tmpImage);
+    imshow("tmpImage", extracted_HSV);
     cv::waitKey(5);
 #endif
 
@@ -456,8 +459,6 @@ void TrafficLightDetector::brightnessDetect(const cv::Mat &input) {
 
     int currentLightsCode = getCurrentLightsCode(isRed_bright, isYellow_bright, isGreen_bright);
     contexts.at(i).lightState = determineState(contexts.at(i).lightState, currentLightsCode, &(contexts.at(i).stateJudgeCount));
-
-    roi.setTo(cv::Scalar(0));
   }
 }
 
@@ -33,6 +33,8 @@ public:
 	void brightnessDetect(const cv::Mat &input);
 	void colorDetect(const cv::Mat &input, cv::Mat &output, const cv::Rect coords, int Hmin, int Hmax);
 	std::vector<Context> contexts;
+private:
+	cv::Mat contrastLut;
 };
 
 enum daytime_Hue_threshold {
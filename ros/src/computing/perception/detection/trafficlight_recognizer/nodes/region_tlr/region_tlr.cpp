@@ -158,7 +158,7 @@ static void image_raw_cb(const sensor_msgs::Image &image_source)
 {
 	cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(image_source, sensor_msgs::image_encodings::BGR8);
 	//  cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(image_source);
-	frame = cv_image->image.clone();
+	frame = cv_image->image;
 
 	/* Draw superimpose result on image */
 	cv::Mat targetScope = frame.clone();
@@ -459,27 +459,7 @@ int main(int argc, char *argv[])
 	cv::startWindowThread();
 #endif
 
-	thSet.Red.Hue.upper = (double) DAYTIME_RED_UPPER;
-	thSet.Red.Hue.lower = (double) DAYTIME_RED_LOWER;
-	thSet.Red.Sat.upper = 1.0f;
-	thSet.Red.Sat.lower = DAYTIME_S_SIGNAL_THRESHOLD;
-	thSet.Red.Val.upper = 1.0f;
-	thSet.Red.Val.lower = DAYTIME_V_SIGNAL_THRESHOLD;
-
-	thSet.Yellow.Hue.upper = (double) DAYTIME_YELLOW_UPPER;
-	thSet.Yellow.Hue.lower = (double) DAYTIME_YELLOW_LOWER;
-	thSet.Yellow.Sat.upper = 1.0f;
-	thSet.Yellow.Sat.lower = DAYTIME_S_SIGNAL_THRESHOLD;
-	thSet.Yellow.Val.upper = 1.0f;
-	thSet.Yellow.Val.lower = DAYTIME_V_SIGNAL_THRESHOLD;
-
-	thSet.Green.Hue.upper = (double) DAYTIME_GREEN_UPPER;
-	thSet.Green.Hue.lower = (double) DAYTIME_GREEN_LOWER;
-	thSet.Green.Sat.upper = 1.0f;
-	thSet.Green.Sat.lower = DAYTIME_S_SIGNAL_THRESHOLD;
-	thSet.Green.Val.upper = 1.0f;
-	thSet.Green.Val.lower = DAYTIME_V_SIGNAL_THRESHOLD;
-
+	setDaytimeThresholds(&thSet);
 
 	ros::init(argc, argv, "region_tlr");
 
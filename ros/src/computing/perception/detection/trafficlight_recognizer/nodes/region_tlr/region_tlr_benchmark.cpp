@@ -0,0 +1,108 @@
+// Replay the images and the projected signals (/roi_signal) of a bag file through the recognition of
+// region_tlr and report the time of each recognition. A signal message is recognized on the last image
+// recorded before it, as the node does. Set OMP_NUM_THREADS to compare thread counts.
+
+#include <float.h>
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <cv_bridge/cv_bridge.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/image_encodings.h>
+#include <autoware_msgs/Signals.h>
+
+#include "RegionTLR.h"
+
+thresholdSet thSet;
+
+int main(int argc, char *argv[])
+{
+	ros::init(argc, argv, "region_tlr_benchmark");
+
+	if (argc < 2)
+	{
+		std::cerr << "Usage: rosrun trafficlight_recognizer region_tlr_benchmark BAG [_image_raw_topic:=/image_raw] [_repeat:=N]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	ros::NodeHandle private_nh("~");
+	std::string image_topic_name;
+	int repeat;
+	private_nh.param<std::string>("image_raw_topic", image_topic_name, "/image_raw");
+	private_nh.param<int>("repeat", repeat, 1);
+
+	setDaytimeThresholds(&thSet);
+
+	/* pair each signal message with the last image */
+	std::vector<cv::Mat> frames;
+	std::vector<autoware_msgs::Signals::ConstPtr> signals;
+	try
+	{
+		rosbag::Bag bag(argv[1], rosbag::bagmode::Read);
+		std::vector<std::string> topics = {image_topic_name, "/roi_signal"};
+		rosbag::View view(bag, rosbag::TopicQuery(topics));
+
+		cv::Mat frame;
+		for (const rosbag::MessageInstance &m : view)
+		{
+			sensor_msgs::Image::ConstPtr image = m.instantiate<sensor_msgs::Image>();
+			if (image != nullptr)
+			{
+				frame = cv_bridge::toCvCopy(image, sensor_msgs::image_encodings::BGR8)->image;
+				continue;
+			}
+
+			autoware_msgs::Signals::ConstPtr extracted_pos = m.instantiate<autoware_msgs::Signals>();
+			if (extracted_pos != nullptr && !frame.empty())
+			{
+				frames.push_back(frame);
+				signals.push_back(extracted_pos);
+			}
+		}
+	}
+	catch (const rosbag::BagException &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (signals.empty())
+	{
+		std::cerr << "No /roi_signal message after an image on " << image_topic_name << " in " << argv[1] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<double> times;
+	size_t contexts_num = 0;
+	for (int r = 0; r < repeat; r++)
+	{
+		/* the light states evolve from the first message again */
+		TrafficLightDetector detector;
+		for (size_t i = 0; i < signals.size(); i++)
+		{
+			Context::SetContexts(detector.contexts, signals[i], frames[i].rows, frames[i].cols);
+			contexts_num += detector.contexts.size();
+
+			ros::WallTime start = ros::WallTime::now();
+			detector.brightnessDetect(frames[i]);
+			times.push_back((ros::WallTime::now() - start).toSec() * 1e3);
+		}
+	}
+
+	double total = 0;
+	for (double t : times)
+		total += t;
+	std::sort(times.begin(), times.end());
+
+	printf("%lu recognitions on %dx%d images, %.2f signals each\n", (unsigned long) times.size(),
+	       frames[0].cols, frames[0].rows, (double) contexts_num / times.size());
+	printf("mean %.3f ms, median %.3f ms, max %.3f ms\n", total / times.size(), times[times.size() / 2],
+	       times.back());
+
+	return EXIT_SUCCESS;
+}
@@ -7,29 +7,75 @@
 //C++ library (thread-functions are only supported by windows)
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
-#include <pthread.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 //Original header
 #include "MODEL_info.h"		//File information
 #include "common.hpp"
 #include "switch_float.h"
+#include "thread_pool.hpp"
+
+//number of output columns convolved by one task
+#define CONV_COLUMNS 8
 
 struct thread_data {
 	FLOAT *A;
 	FLOAT *B;
 	FLOAT *C;
 	FLOAT *F;
-	FLOAT *T;
 	int A_dims[3];
 	int B_dims[3];
 	int C_dims[2];
+	int sym;
+	int task_begin;	//first task of the filter
+};
+
+struct conv_data {
+	thread_data *td;
+	int len;
 };
 
-//thread process
-// convolve A and B(non_symmetric)
-static void* process(void *thread_arg) {
-	thread_data *args = (thread_data *)thread_arg;
+#if defined(__SSE2__) && defined(FLOAT_IS_float)
+// add to dst[0..7] the dot products of B (B_h*B_w) with the windows of A
+// at the rows 0..7, each sum taken in the same order as the switch below
+static inline void conv8(const FLOAT *A_off, const FLOAT *B_off, int A_h, int B_h, int B_w, FLOAT *dst)
+{
+	__m128 val0 = _mm_setzero_ps();
+	__m128 val1 = _mm_setzero_ps();
+	for (int xp = 0; xp < B_w; xp++)
+	{
+		if (B_h <= 20)
+		{
+			for (int yp = B_h - 1; yp >= 0; yp--)
+			{
+				__m128 b = _mm_set1_ps(B_off[yp]);
+				val0 = _mm_add_ps(val0, _mm_mul_ps(_mm_loadu_ps(A_off + yp), b));
+				val1 = _mm_add_ps(val1, _mm_mul_ps(_mm_loadu_ps(A_off + yp + 4), b));
+			}
+		}
+		else
+		{
+			for (int yp = 0; yp < B_h; yp++)
+			{
+				__m128 b = _mm_set1_ps(B_off[yp]);
+				val0 = _mm_add_ps(val0, _mm_mul_ps(_mm_loadu_ps(A_off + yp), b));
+				val1 = _mm_add_ps(val1, _mm_mul_ps(_mm_loadu_ps(A_off + yp + 4), b));
+			}
+		}
+		A_off += A_h;
+		B_off += B_h;
+	}
+	_mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), val0));
+	_mm_storeu_ps(dst + 4, _mm_add_ps(_mm_loadu_ps(dst + 4), val1));
+}
+#endif
+
+// convolve A and B(non_symmetric), columns [x0,x1) of the output
+static void process(thread_data *args,int x0,int x1) {
 	FLOAT *A = args->A;	//feature
 	FLOAT *B = args->B;	//filter
 	FLOAT *C = args->C;	//output
@@ -43,15 +89,20 @@ static void* process(void *thread_arg) {
 
 	for (int f = 0; f < num_features; f++)
 	{
-		FLOAT *dst = C;
+		FLOAT *dst = C + x0*C_dims[0];
 		FLOAT *A_src = A + f*A_SQ;
 		FLOAT *B_src = B + f*B_SQ;
-		int XA0 = 0;
-		for (int x = 0; x < C_dims[1]; x++)
+		int XA0 = x0*A_dims[0];
+		for (int x = x0; x < x1; x++)
 		{
 			FLOAT *A_src2 =A_src+XA0;
 			XA0+=A_dims[0];
-			for (int y = 0; y < C_dims[0]; y++)
+			int y = 0;
+#if defined(__SSE2__) && defined(FLOAT_IS_float)
+			for (; y + 8 <= C_dims[0]; y += 8, dst += 8)
+				conv8(A_src2+y, B_src, A_dims[0], B_dims[0], B_dims[1], dst);
+#endif
+			for (; y < C_dims[0]; y++)
 			{
 				FLOAT val = 0;
 				FLOAT *A_off = A_src2+y;
@@ -98,20 +149,16 @@ static void* process(void *thread_arg) {
 		A_src+=A_SQ;
 		B_src+=B_SQ;
 	}
-
-	pthread_exit((void*)thread_arg);
-	return nullptr;
 }
 
-// convolve A and B when B is symmetric
-static void* processS(void *thread_arg)
+// convolve A and B when B is symmetric, columns [x0,x1) of the output
+// T is a buffer of A_dims[0]*width1
+static void processS(thread_data *args,int x0,int x1,FLOAT *T)
 {
-	thread_data *args = (thread_data *)thread_arg;
 	FLOAT *A = args->A;
 	FLOAT *B = args->B;
 	FLOAT *C = args->C;
 	FLOAT *F = args->F;
-	FLOAT *T = args->T;
 	int *A_dims = args->A_dims;
 	int *B_dims = args->B_dims;
 	int *C_dims = args->C_dims;
@@ -128,12 +175,12 @@ static void* processS(void *thread_arg)
 
 	for (int f = 0; f < num_features; f++)
 	{
-		FLOAT *dst = C;
+		FLOAT *dst = C + x0*C_dims[0];
 		FLOAT *A_src = A + f*A_SQ;
 		FLOAT *B_src = B + f*B_SQ;
 		FLOAT *F_src = F + f*A_SQ;
-		int XA = 0;
-		for (int x = 0; x < C_dims[1]; x++)
+		int XA = x0*A_dims[0];
+		for (int x = x0; x < x1; x++)
 		{
 			// generate tmp data for band of output
 			memcpy(T, A_src + XA, CP_L_S);
@@ -149,7 +196,12 @@ static void* processS(void *thread_arg)
 				copy_src++;
 			}
 
-			for (int y = 0; y < C_dims[0]; y++)
+			int y = 0;
+#if defined(__SSE2__) && defined(FLOAT_IS_float)
+			for (; y + 8 <= C_dims[0]; y += 8, dst += 8)
+				conv8(T+y, B_src, A_dims[0], B_dims[0], width1, dst);
+#endif
+			for (; y < C_dims[0]; y++)
 			{
 				FLOAT val = 0;
 				FLOAT *T_off = T+y;
@@ -194,10 +246,37 @@ static void* processS(void *thread_arg)
 			}
 		}
 	}
+}
 
-	pthread_exit((void*)thread_arg);
+// convolve CONV_COLUMNS columns of the output of a filter (task of the pool)
+static void conv_task(void *arg,int task)
+{
+	conv_data *args = (conv_data *)arg;
 
-	return nullptr;
+	//find the filter of the task
+	int ii=args->len-1;
+	while(args->td[ii].task_begin>task) ii--;
+	thread_data *td = &args->td[ii];
+
+	int x0 = (task-td->task_begin)*CONV_COLUMNS;
+	int x1 = x0+CONV_COLUMNS;
+	if(x1>td->C_dims[1]) x1=td->C_dims[1];
+
+	//non_symmetric
+	if(td->sym==0)
+	{
+		process(td,x0,x1);
+	}
+	//symmetric
+	else
+	{
+		int T_dims[2];
+		T_dims[0] = td->A_dims[0];
+		T_dims[1] = (int)(td->B_dims[1]/2.0+0.99);
+		FLOAT *T=(FLOAT*)malloc(sizeof(FLOAT)*T_dims[0]*T_dims[1]);
+		processS(td,x0,x1,T);
+		s_free(T);
+	}
 }
 
 //Input(feat,flipfeat,filter,symmetric info,1,length)
@@ -210,9 +289,8 @@ FLOAT **dpm_ttic_cpu_fconvsMT(FLOAT*feat,FLOAT*flfeat,FLOAT**filter,int *sym_inf
 
 	const int len=end-start+1;
 	FLOAT **Output=(FLOAT**)malloc(sizeof(FLOAT*)*len);		//Output (cell)
-	// start threads
 	thread_data *td = (thread_data *)calloc(len, sizeof(thread_data));
-	pthread_t *ts = (pthread_t *)calloc(len, sizeof(pthread_t));
+	int tasks=0;
 
 	for(int ii=0;ii<len;ii++)
 	{
@@ -239,46 +317,27 @@ FLOAT **dpm_ttic_cpu_fconvsMT(FLOAT*feat,FLOAT*flfeat,FLOAT**filter,int *sym_inf
 		td[ii].C_dims[0]=height;
 		td[ii].C_dims[1]=width;
 		td[ii].C=(FLOAT*)calloc(height*width,sizeof(FLOAT));
+		td[ii].sym = sym_info[ii+start];
 
-		int sym = sym_info[ii+start];
-
-		//non_symmetric
-		if (sym ==0)
-		{
-			if (pthread_create(&ts[ii], NULL, process, (void*)&td[ii]))
-			{
-				printf("Error creating thread\n");
-				exit(0);
-			}
-		}
-		//symmetric
-		else
-		{
-			int T_dims[2];
-			T_dims[0] = td[ii].A_dims[0];
-			T_dims[1] = (int)(td[ii].B_dims[1]/2.0+0.99);
-			td[ii].T=(FLOAT*)calloc(T_dims[0]*T_dims[1],sizeof(FLOAT));
-			if (pthread_create(&ts[ii], NULL, processS, (void*)&td[ii]))
-			{
-				printf("Error creating thread\n");
-				exit(0);
-			}
-		}
+		//split the output in bands of columns
+		td[ii].task_begin=tasks;
+		tasks+=(width+CONV_COLUMNS-1)/CONV_COLUMNS;
 
 		M_size[ii*2]=height;
 		M_size[ii*2+1]=width;
-
 	}
 
-	//close handle and get output
+	//convolve all filters on the worker threads
+	conv_data cd;
+	cd.td = td;
+	cd.len = len;
+	dpm_ttic_cpu_parallel_for(tasks,conv_task,&cd);
+
+	//get output
 	for (int i = 0; i < len; i++)
 	{
-		pthread_join(ts[i], NULL);
-
 		Output[i]=td[i].C;
-		s_free(td[i].T);
 	}
 	s_free(td);
-	s_free(ts);
 	return(Output);
 }
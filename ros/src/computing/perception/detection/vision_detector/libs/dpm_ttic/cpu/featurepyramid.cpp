@@ -15,7 +15,10 @@
 
 #include <time.h>
 #include <iostream>
-#include <pthread.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
@@ -25,6 +28,7 @@ using namespace std;
 #include "common.hpp"
 #include "resize.hpp"
 #include "featurepyramid.hpp"
+#include "thread_pool.hpp"
 
 //definition of constant
 #define eps 0.0001
@@ -34,15 +38,26 @@ static const FLOAT Hcos[9]={1.0000,0.9397,0.7660,0.5000,0.1736,-0.1736,-0.5000,-
 static const FLOAT Hsin[9]={0.0000,0.3420,0.6428,0.8660,0.9848,0.9848,0.8660,0.6428,0.3420};
 
 //definition of structure
-struct thread_data {
+struct level_data {
 	FLOAT *IM;
 	int ISIZE[3];
 	int FSIZE[2];
-	int F_C;
 	int sbin;
 	FLOAT *Out;
 };
 
+struct pyramid_data {
+	FLOAT *D_I;
+	int *INSIZE;
+	int interval;
+	int max_scale;
+	int sbin;
+	FLOAT sc;
+	FLOAT *scale;
+	FLOAT **RIM_S;
+	level_data *levels;
+};
+
 //inline functions(Why does not use stddard libary)
 static inline int max_i(int x,int y)
 {
@@ -135,6 +150,88 @@ int *dpm_ttic_cpu_ini_featsize(Model_info *MI)
 	return(featsize);
 }
 
+//gradient of the pixel s (channel with strongest gradient) and its orientation (one of 18)
+static inline void calc_gradient(const FLOAT *s,int step,int square,FLOAT *mag,int *ori)
+{
+	//first color channel
+	FLOAT dy=*(s+1)-*(s-1);
+	FLOAT dx=*(s+step)-*(s-step);
+	FLOAT v=dx*dx+dy*dy;
+
+	//second color channel
+	s+=square;
+	FLOAT dy2=*(s+1)-*(s-1);
+	FLOAT dx2=*(s+step)-*(s-step);
+	FLOAT v2=dx2*dx2+dy2*dy2;
+
+	//third color channel
+	s+=square;
+	FLOAT dy3=*(s+1)-*(s-1);
+	FLOAT dx3=*(s+step)-*(s-step);
+	FLOAT v3=dx3*dx3+dy3*dy3;
+
+	//pick channel with strongest gradient
+	if(v2>v){v=v2;dx=dx2;dy=dy2;}
+	if(v3>v){v=v3;dx=dx3;dy=dy3;}
+
+	FLOAT best_dot=0.0;
+	int best_o=0;
+
+	//snap to one of 18 orientations
+	for(int o=0;o<9;o++)
+	{
+		FLOAT dot=Hcos[o]*dx+Hsin[o]*dy;
+		if(dot>best_dot)		{best_dot=dot;best_o=o;}
+		else if (-dot>best_dot)	{best_dot=-dot;best_o=o+9;}
+	}
+
+	*mag=sqrt(v);
+	*ori=best_o;
+}
+
+#if defined(__SSE2__) && defined(FLOAT_IS_float)
+//calc_gradient for the 4 pixels s[0..3] of a column (same results)
+static inline void calc_gradient4(const FLOAT *s,int step,int square,FLOAT *mag,int *ori)
+{
+	__m128 dy=_mm_sub_ps(_mm_loadu_ps(s+1),_mm_loadu_ps(s-1));
+	__m128 dx=_mm_sub_ps(_mm_loadu_ps(s+step),_mm_loadu_ps(s-step));
+	__m128 v=_mm_add_ps(_mm_mul_ps(dx,dx),_mm_mul_ps(dy,dy));
+
+	//pick channel with strongest gradient
+	for(int c=1;c<3;c++)
+	{
+		s+=square;
+		__m128 dy2=_mm_sub_ps(_mm_loadu_ps(s+1),_mm_loadu_ps(s-1));
+		__m128 dx2=_mm_sub_ps(_mm_loadu_ps(s+step),_mm_loadu_ps(s-step));
+		__m128 v2=_mm_add_ps(_mm_mul_ps(dx2,dx2),_mm_mul_ps(dy2,dy2));
+		__m128 m=_mm_cmpgt_ps(v2,v);
+		v=_mm_or_ps(_mm_and_ps(m,v2),_mm_andnot_ps(m,v));
+		dx=_mm_or_ps(_mm_and_ps(m,dx2),_mm_andnot_ps(m,dx));
+		dy=_mm_or_ps(_mm_and_ps(m,dy2),_mm_andnot_ps(m,dy));
+	}
+
+	//snap to one of 18 orientations
+	const __m128 sign=_mm_set1_ps(-0.0f);
+	__m128 best_dot=_mm_setzero_ps();
+	__m128i best_o=_mm_setzero_si128();
+	for(int o=0;o<9;o++)
+	{
+		__m128 dot=_mm_add_ps(_mm_mul_ps(_mm_set1_ps(Hcos[o]),dx),_mm_mul_ps(_mm_set1_ps(Hsin[o]),dy));
+		__m128i m=_mm_castps_si128(_mm_cmpgt_ps(dot,best_dot));
+		best_dot=_mm_max_ps(dot,best_dot);
+		best_o=_mm_or_si128(_mm_and_si128(m,_mm_set1_epi32(o)),_mm_andnot_si128(m,best_o));
+
+		__m128 ndot=_mm_xor_ps(dot,sign);
+		m=_mm_castps_si128(_mm_cmpgt_ps(ndot,best_dot));
+		best_dot=_mm_max_ps(ndot,best_dot);
+		best_o=_mm_or_si128(_mm_and_si128(m,_mm_set1_epi32(o+9)),_mm_andnot_si128(m,best_o));
+	}
+
+	_mm_storeu_ps(mag,_mm_sqrt_ps(v));
+	_mm_storeu_si128((__m128i*)ori,best_o);
+}
+#endif
+
 //calculate HOG features from Image
 //HOG features are calculated for each block(BSL*BSL pixels)
 static FLOAT *calc_feature(FLOAT *SRC,int *ISIZE,int *FTSIZE,int sbin)
@@ -170,6 +267,26 @@ static FLOAT *calc_feature(FLOAT *SRC,int *ISIZE,int *FTSIZE,int sbin)
 	//feature(Output)
 	FLOAT *feat=(FLOAT*)calloc(OUT_SIZE[0]*OUT_SIZE[1]*OUT_SIZE[2],sizeof(FLOAT));
 
+	//interpolation parameters of the rows (the same for all columns)
+	const int ROWS = max_i(vis_R[0],1);
+	int *IYP = (int*)malloc(sizeof(int)*ROWS);
+	FLOAT *VY0 = (FLOAT*)malloc(sizeof(FLOAT)*ROWS);
+	FLOAT *VY1 = (FLOAT*)malloc(sizeof(FLOAT)*ROWS);
+	for(int y=1;y<vis_R[0];y++)
+	{
+		FLOAT yp=((FLOAT)y+0.5)/SBIN-0.5;
+		IYP[y]=(int)floor(yp);
+		VY0[y]=yp-(FLOAT)IYP[y];
+		VY1[y]=1.0-VY0[y];
+	}
+
+	//gradient magnitude and orientation of a column
+	FLOAT *MAG = (FLOAT*)malloc(sizeof(FLOAT)*ROWS);
+	int *ORI = (int*)malloc(sizeof(int)*ROWS);
+
+	//rows which do not need clamping to the image
+	const int Y_END = min_i(vis_R[0],vp0+1);
+
 	//calculate HOG histgram
 	for(int x=1;x<vis_R[1];x++)
 	{
@@ -187,49 +304,21 @@ static FLOAT *calc_feature(FLOAT *SRC,int *ISIZE,int *FTSIZE,int sbin)
 		int YC=min_i(x,vp1)*dims[0];
 		FLOAT *SRC_YC = SRC+YC;
 
-		for(int y=1;y<vis_R[0];y++)
-		{
-			//first color channel
-			FLOAT *s=SRC_YC+min_i(y,vp0);
-			FLOAT dy=*(s+1)-*(s-1);
-			FLOAT dx=*(s+dims[0])-*(s-dims[0]);
-			FLOAT v=dx*dx+dy*dy;
-
-			//second color channel
-			s+=SQUARE;
-			FLOAT dy2=*(s+1)-*(s-1);
-			FLOAT dx2=*(s+dims[0])-*(s-dims[0]);
-			FLOAT v2=dx2*dx2+dy2*dy2;
-
-			//third color channel
-			s+=SQUARE;
-			FLOAT dy3=*(s+1)-*(s-1);
-			FLOAT dx3=*(s+dims[0])-*(s-dims[0]);
-			FLOAT v3=dx3*dx3+dy3*dy3;
-
-			//pick channel with strongest gradient
-			if(v2>v){v=v2;dx=dx2;dy=dy2;}
-			if(v3>v){v=v3;dx=dx3;dy=dy3;}
-
-			FLOAT best_dot=0.0;
-			int best_o=0;
-
-			//snap to one of 18 orientations
-			for(int o=0;o<9;o++)
-			{
-				FLOAT dot=Hcos[o]*dx+Hsin[o]*dy;
-				if(dot>best_dot)		{best_dot=dot;best_o=o;}
-				else if (-dot>best_dot)	{best_dot=-dot;best_o=o+9;}
-			}
+		int y=1;
+#if defined(__SSE2__) && defined(FLOAT_IS_float)
+		for(;y+4<=Y_END;y+=4) calc_gradient4(SRC_YC+y,dims[0],SQUARE,MAG+y,ORI+y);
+#endif
+		for(;y<vis_R[0];y++) calc_gradient(SRC_YC+min_i(y,vp0),dims[0],SQUARE,MAG+y,ORI+y);
 
+		for(y=1;y<vis_R[0];y++)
+		{
 			//Add to 4 histgrams around pixel using linear interpolation
-			FLOAT yp=((FLOAT)y+0.5)/SBIN-0.5;
-			int iyp=(int)floor(yp);
+			int iyp=IYP[y];
 			int iypp=iyp+1;
-			FLOAT vy0=yp-(FLOAT)iyp;
-			FLOAT vy1=1.0-vy0;
-			v=sqrt(v);
-			int ODim=best_o*BLOCK_SQ;
+			FLOAT vy0=VY0[y];
+			FLOAT vy1=VY1[y];
+			FLOAT v=MAG[y];
+			int ODim=ORI[y]*BLOCK_SQ;
 			FLOAT *Htemp = HHist+ODim;
 			FLOAT vx1Xv =vx1*v;
 			FLOAT vx0Xv = vx0*v;
@@ -259,6 +348,11 @@ static FLOAT *calc_feature(FLOAT *SRC,int *ISIZE,int *FTSIZE,int sbin)
 			}
 		}
 	}
+	s_free(IYP);
+	s_free(VY0);
+	s_free(VY1);
+	s_free(MAG);
+	s_free(ORI);
 
 	//compute energy in each block by summing over orientations
 	for(int kk=0;kk<9;kk++)
@@ -400,27 +494,58 @@ static FLOAT *Ipl_to_FLOAT(IplImage *Input)	//get intensity data (FLOAT) of inpu
 	return(Output);
 }
 
-// feature calculation
-static void* feat_calc(void *thread_arg)
+// feature calculation of a level (task of the pool)
+static void feat_calc(void *arg,int level)
 {
-	thread_data *args = (thread_data *)thread_arg;
-	FLOAT *Out =calc_feature(args->IM,args->ISIZE,args->FSIZE,args->sbin);
-	args->Out =Out;
-	//_endthreadex(0);
-	//return(0);
-	pthread_exit((void*)thread_arg);
+	level_data *args = (level_data *)arg + level;
+	args->Out = calc_feature(args->IM,args->ISIZE,args->FSIZE,args->sbin);
 }
 
-//void initialize thread data
-static void ini_thread_data(thread_data *TD,FLOAT *IM,int *INSIZE,int sbin,int level)
+//initialize level data
+static void ini_level_data(level_data *LD,FLOAT *IM,int *INSIZE,int sbin)
 {
-	TD->IM=IM;
-	//memcpy_s(TD->ISIZE,sizeof(int)*3,INSIZE,sizeof(int)*3);
-	memcpy(TD->ISIZE, INSIZE,sizeof(int)*3);
-	TD->FSIZE[0]=0;
-	TD->FSIZE[1]=0;
-	TD->sbin=sbin;
-	TD->F_C=level;
+	LD->IM=IM;
+	memcpy(LD->ISIZE, INSIZE,sizeof(int)*3);
+	LD->FSIZE[0]=0;
+	LD->FSIZE[1]=0;
+	LD->sbin=sbin;
+	LD->Out=nullptr;
+}
+
+// resized images of the ii-th octave step (task of the pool)
+static void resize_calc(void *arg,int ii)
+{
+	pyramid_data *args = (pyramid_data *)arg;
+	const int interval = args->interval;
+	const int sbin = args->sbin;
+	const int sbin2 = (int)floor((double)sbin/2.0);
+	FLOAT **RIM_S = args->RIM_S;
+	FLOAT *scale = args->scale;
+	int RISIZE[3]={0,0,0},OUTSIZE[3] ={0,0,0};
+
+	FLOAT st = 1.0/pow(args->sc,ii);
+	RIM_S[ii] = dpm_ttic_cpu_resize(args->D_I,args->INSIZE,RISIZE,st);
+
+	//"first" 2x interval
+	ini_level_data(&args->levels[ii],RIM_S[ii],RISIZE,sbin2);
+	*(scale+ii)=st*2;									//save scale
+
+	//"second" 1x interval
+	RIM_S[ii+interval]=RIM_S[ii];
+	ini_level_data(&args->levels[ii+interval],RIM_S[ii+interval],RISIZE,sbin);
+	*(scale+ii+interval)=st;							//save scale
+
+	//remained resolutions (for root_only)
+	FLOAT *RIM_T = RIM_S[ii];		//get original image (just a copy)
+	for(int jj=ii+interval;jj<args->max_scale;jj+=interval)
+	{
+		//resize image (FLOAT)
+		RIM_S[jj+interval] = dpm_ttic_cpu_resize(RIM_T,RISIZE,OUTSIZE,0.5);
+		memcpy(RISIZE, OUTSIZE,sizeof(int)*3);
+		ini_level_data(&args->levels[jj+interval],RIM_S[jj+interval],RISIZE,sbin);
+		*(scale+jj+interval)=0.5*(*(scale+jj));			//save scale
+		RIM_T = RIM_S[jj+interval];
+	}
 }
 
 //calculate feature pyramid (extended to main.cpp)
@@ -429,99 +554,45 @@ FLOAT **dpm_ttic_cpu_calc_f_pyramid(IplImage *Image,Model_info *MI,int *FTSIZE,F
 	//constant parameters
 	const int max_scale = MI->max_scale;
 	const int interval = MI->interval;
-	const int sbin = MI->sbin;
-	const int sbin2 = (int)floor((double)sbin/2.0);
 	const int LEN = max_scale+interval;
-	const FLOAT sc = pow(2,(1.0/(double)interval));
 	int INSIZE[3]={Image->height,Image->width,Image->nChannels};
-	int RISIZE[3]={0,0,0},OUTSIZE[3] ={0,0,0};
-
-	//Original image (FLOAT)
-	FLOAT *D_I = Ipl_to_FLOAT(Image);
 
 	//features
 	FLOAT **feat=(FLOAT**)malloc(sizeof(FLOAT*)*LEN);		//Model information
 
-	//thread for feature calculation
-	thread_data *td = (thread_data *)calloc(LEN, sizeof(thread_data));
-	pthread_t *ts = (pthread_t *)calloc(LEN, sizeof(pthread_t));
+	pyramid_data pd;
+	pd.D_I = Ipl_to_FLOAT(Image);		//Original image (FLOAT)
+	pd.INSIZE = INSIZE;
+	pd.interval = interval;
+	pd.max_scale = max_scale;
+	pd.sbin = MI->sbin;
+	pd.sc = pow(2,(1.0/(double)interval));
+	pd.scale = scale;
+	pd.RIM_S = (FLOAT**)calloc(LEN,sizeof(FLOAT*));
+	pd.levels = (level_data *)calloc(LEN, sizeof(level_data));
 
-	FLOAT **RIM_S =(FLOAT**)calloc(LEN,sizeof(FLOAT*));
+	//resize the image for all levels, each octave step is a chain of 0.5 resizes
+	dpm_ttic_cpu_parallel_for(interval,resize_calc,&pd);
 
-	int *RI_S = (int*)calloc(interval*3,sizeof(int));
-	FLOAT *RIM_T;
-	int t_count=0;
+	//calculate features of all levels, the larger (first) levels are taken first
+	dpm_ttic_cpu_parallel_for(LEN,feat_calc,pd.levels);
 
-	//calculate resized image
-	for(int ii=0;ii<interval;ii++)
-	{
-		FLOAT st = 1.0/pow(sc,ii);
-		RIM_S[ii] = dpm_ttic_cpu_resize(D_I,INSIZE,RISIZE,st);
-		memcpy(RI_S+ii*3, RISIZE,sizeof(int)*3);
-	}
-
-	for(int ii=0;ii<interval;ii++)
-	{
-		FLOAT st = 1.0/pow(sc,ii);
-		memcpy(RISIZE, RI_S+ii*3,sizeof(int)*3);
-
-		//"first" 2x interval
-		ini_thread_data(&td[t_count],RIM_S[ii],RISIZE,sbin2,ii);  //initialize thread
-		if( pthread_create(&ts[t_count], NULL, feat_calc, (void*)&td[t_count]))
-		{printf("Error thread\n");exit(0);}
-		*(scale+ii)=st*2;									//save scale
-		t_count++;
-
-		//"second" 1x interval
-		RIM_S[ii+interval]=RIM_S[ii];
-
-		ini_thread_data(&td[t_count],RIM_S[ii+interval],RISIZE,sbin,ii+interval);	//initialize thread
-		//ts[t_count]=(HANDLE)_beginthreadex(NULL,0,feat_calc,(void*)&td[t_count],0,&threadID);
-		if(pthread_create(&ts[t_count], NULL, feat_calc, (void*)&td[t_count]))
-			//if (ts[t_count]==INVALID_HANDLE_VALUE)
-		{printf("Error thread\n");exit(0);}
-		*(scale+ii+interval)=st;							//save scale
-		t_count++;
-
-		//remained resolutions (for root_only)
-		RIM_T = RIM_S[ii];		//get original image (just a copy)
-		for(int jj=ii+interval;jj<max_scale;jj+=interval)
-		{
-			//resize image (FLOAT)
-			RIM_S[jj+interval] = dpm_ttic_cpu_resize(RIM_T,RISIZE,OUTSIZE,0.5);
-			memcpy(RISIZE, OUTSIZE,sizeof(int)*3);
-			ini_thread_data(&td[t_count],RIM_S[jj+interval],RISIZE,sbin,jj+interval); //initialize thread
-			//ts[t_count]=(HANDLE)_beginthreadex(NULL,0,feat_calc,(void*)&td[t_count],0,&threadID);
-			if(pthread_create(&ts[t_count], NULL, feat_calc, (void*)&td[t_count]))
-				//if (ts[t_count]==INVALID_HANDLE_VALUE)
-			{printf("Error thread\n");exit(0);}
-			*(scale+jj+interval)=0.5*(*(scale+jj));			//save scale
-			RIM_T = RIM_S[jj+interval];
-			t_count++;
-		}
-	}
-
-
-	//get thread data
 	for(int ss=0;ss<LEN;ss++)
 	{
-		pthread_join(ts[ss], NULL);
-		feat[td[ss].F_C]=td[ss].Out;
-		memcpy(&FTSIZE[td[ss].F_C*2], td[ss].FSIZE,sizeof(int)*2);
+		feat[ss]=pd.levels[ss].Out;
+		memcpy(&FTSIZE[ss*2], pd.levels[ss].FSIZE,sizeof(int)*2);
 	}
 
 	//release original image
-	s_free(D_I);
+	s_free(pd.D_I);
 
 	//release resized image
-	for(int ss=0;ss<interval;ss++) s_free(RIM_S[ss]);
-	for(int ss=interval*2;ss<LEN;ss++) s_free(RIM_S[ss]);
-	s_free(RI_S);
-	s_free(RIM_S);
-
-	//release thread information
-	s_free(td);
-	s_free(ts);
+	for(int ss=0;ss<interval;ss++) s_free(pd.RIM_S[ss]);
+	for(int ss=interval*2;ss<LEN;ss++) s_free(pd.RIM_S[ss]);
+	s_free(pd.RIM_S);
+
+	//release level information
+	s_free(pd.levels);
 
 	return(feat);
 }
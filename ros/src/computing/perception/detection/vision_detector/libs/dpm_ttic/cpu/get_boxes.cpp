@@ -16,6 +16,7 @@
 #include "get_boxes.hpp"
 #include "dt.hpp"
 #include "fconvsMT.hpp"
+#include "thread_pool.hpp"
 
 static void free_rootmatch(FLOAT **rootmatch, MODEL *MO)
 {
@@ -196,6 +197,40 @@ static void calc_a_score(FLOAT *ac_score,FLOAT *score,int *ssize,int *rsize,Mode
 	}
 }
 
+struct part_dt_data {
+	MODEL *MO;
+	int component;
+	FLOAT **partmatch;
+	int *pm_size;
+	int **Ix;
+	int **Iy;
+	FLOAT **M;
+};
+
+//decide position of a part for all pixels (task of the pool)
+static void part_dt(void *arg,int kk)
+{
+	part_dt_data *args = (part_dt_data *)arg;
+	Model_info *MI = args->MO->MI;
+	int DID_4 = MI->didx[args->component][kk]*4;
+	int PIDX = MI->pidx[args->component][kk];
+	//set part-match
+	FLOAT *match = args->partmatch[PIDX];
+	//size of part-matching
+	int PSSIZE[2] ={args->pm_size[PIDX*2],args->pm_size[PIDX*2+1]};
+
+	FLOAT *Q = match;
+	for(int ss=0;ss<PSSIZE[0]*PSSIZE[1];ss++) *(Q++)*=-1;
+
+	//index matrix
+	args->Ix[kk] =(int*)malloc(sizeof(int)*PSSIZE[0]*PSSIZE[1]);
+	args->Iy[kk] =(int*)malloc(sizeof(int)*PSSIZE[0]*PSSIZE[1]);
+
+	args->M[kk] = dpm_ttic_cpu_dt(match,MI->def[DID_4],MI->def[DID_4+1],
+				      MI->def[DID_4+2],MI->def[DID_4+3],
+				      PSSIZE,args->Ix[kk],args->Iy[kk]);
+}
+
 //free detected boxes result
 static void free_boxes(FLOAT **boxes, int LofFeat)
 {
@@ -347,36 +382,37 @@ FLOAT *dpm_ttic_cpu_get_boxes(FLOAT **features,FLOAT *scales,int *FSIZE,MODEL *M
 				for (int kk=0;kk<numpart[jj];kk++)
 				{
 					int DIDX = MO->MI->didx[jj][kk];
-					int DID_4 = DIDX*4;
-					int PIDX = MO->MI->pidx[jj][kk];
 					//anchor
 					ax[kk] = MO->MI->anchor[DIDX*2]+1;
 					ay[kk] = MO->MI->anchor[DIDX*2+1]+1;
-					//set part-match
-					FLOAT *match = partmatch[PIDX];
-					//size of part-matching
-					int PSSIZE[2] ={pm_size[PIDX*2],pm_size[PIDX*2+1]};
-
-					FLOAT *Q = match;
-					for(int ss=0;ss<PSSIZE[0]*PSSIZE[1];ss++) *(Q++)*=-1;
+				}
 
-					//index matrix
-					Ix[kk] =(int*)malloc(sizeof(int)*PSSIZE[0]*PSSIZE[1]);
-					Iy[kk] =(int*)malloc(sizeof(int)*PSSIZE[0]*PSSIZE[1]);
+				//decide position of parts for all pixels
+				part_dt_data pd;
+				pd.MO = MO;
+				pd.component = jj;
+				pd.partmatch = partmatch;
+				pd.pm_size = pm_size;
+				pd.Ix = Ix;
+				pd.Iy = Iy;
+				pd.M = (FLOAT**)malloc(sizeof(FLOAT*)*numpart[jj]);
+
+				gettimeofday(&tv_dt_start, nullptr);
+				dpm_ttic_cpu_parallel_for(numpart[jj],part_dt,&pd);
+				gettimeofday(&tv_dt_end, nullptr);
+				tvsub(&tv_dt_end, &tv_dt_start, &tv);
+				time_dt += tv.tv_sec * 1000.0 + (float)tv.tv_usec / 1000.0;
 
-					//decide position of part for all pixels
-					gettimeofday(&tv_dt_start, nullptr);
-					FLOAT *M = dpm_ttic_cpu_dt(match,MO->MI->def[DID_4],MO->MI->def[DID_4+1],
-								   MO->MI->def[DID_4+2],MO->MI->def[DID_4+3],
-								   PSSIZE,Ix[kk],Iy[kk]);
-					gettimeofday(&tv_dt_end, nullptr);
-					tvsub(&tv_dt_end, &tv_dt_start, &tv);
-					time_dt += tv.tv_sec * 1000.0 + (float)tv.tv_usec / 1000.0;
+				for (int kk=0;kk<numpart[jj];kk++)
+				{
+					int PIDX = MO->MI->pidx[jj][kk];
+					int PSSIZE[2] ={pm_size[PIDX*2],pm_size[PIDX*2+1]};
 
 					//add part score
-					dpm_ttic_add_part_calculation(SCORE,M,R_S,PSSIZE,ax[kk],ay[kk]);
-					s_free(M);
+					dpm_ttic_add_part_calculation(SCORE,pd.M[kk],R_S,PSSIZE,ax[kk],ay[kk]);
+					s_free(pd.M[kk]);
 				}
+				s_free(pd.M);
 			}
 
 			//get all good matches
@@ -0,0 +1,131 @@
+/////thread_pool.cpp   worker threads shared by feature, convolution and dt calculation, part of dpm_ttic
+
+//C++ library
+#include <cstdio>
+#include <cstdlib>
+
+#include <atomic>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "thread_pool.hpp"
+
+//the workers are created once and wait for jobs until the process ends
+struct thread_pool {
+	pthread_mutex_t lock;
+	pthread_cond_t start;		//a new job is posted
+	pthread_cond_t done;		//a worker left the current job
+	unsigned long job;		//number of the current job
+	int pending;			//workers which did not leave the current job yet
+	void (*func)(void *,int);
+	void *arg;
+	int n;
+	std::atomic<int> next;		//next task of the current job
+	int num_workers;
+};
+
+static thread_pool pool;
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t submit_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//true in the workers, and in the caller while it runs tasks
+static thread_local bool in_task = false;
+
+static void run_tasks(void (*func)(void *,int),void *arg,int n)
+{
+	for(int i=pool.next++;i<n;i=pool.next++)
+		func(arg,i);
+}
+
+static void *worker(void *)
+{
+	in_task = true;
+	unsigned long job = 0;
+
+	pthread_mutex_lock(&pool.lock);
+	for(;;)
+	{
+		while(pool.job==job)
+			pthread_cond_wait(&pool.start,&pool.lock);
+		job = pool.job;
+		void (*func)(void *,int) = pool.func;
+		void *arg = pool.arg;
+		int n = pool.n;
+		pthread_mutex_unlock(&pool.lock);
+
+		run_tasks(func,arg,n);
+
+		pthread_mutex_lock(&pool.lock);
+		if(--pool.pending==0)
+			pthread_cond_signal(&pool.done);
+	}
+	return nullptr;
+}
+
+static void init_pool()
+{
+	pthread_mutex_init(&pool.lock,NULL);
+	pthread_cond_init(&pool.start,NULL);
+	pthread_cond_init(&pool.done,NULL);
+	pool.job = 0;
+	pool.pending = 0;
+	pool.next = 0;
+	pool.n = 0;
+
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int num_workers = (cpus>1) ? (int)cpus-1 : 0;		//the caller runs tasks too
+	pool.num_workers = 0;
+	for(int ii=0;ii<num_workers;ii++)
+	{
+		pthread_t thread;
+		if(pthread_create(&thread,NULL,worker,NULL))
+		{
+			printf("Error creating thread\n");
+			break;
+		}
+		pthread_detach(thread);
+		pool.num_workers++;
+	}
+}
+
+int dpm_ttic_cpu_num_threads()
+{
+	pthread_once(&pool_once,init_pool);
+	return pool.num_workers+1;
+}
+
+void dpm_ttic_cpu_parallel_for(int n,void (*func)(void *arg,int i),void *arg)
+{
+	pthread_once(&pool_once,init_pool);
+
+	if(in_task || pool.num_workers==0 || n<2)
+	{
+		for(int i=0;i<n;i++)
+			func(arg,i);
+		return;
+	}
+
+	//one job at a time, every worker takes part in it before the next one is posted
+	pthread_mutex_lock(&submit_lock);
+
+	pthread_mutex_lock(&pool.lock);
+	pool.func = func;
+	pool.arg = arg;
+	pool.n = n;
+	pool.next = 0;
+	pool.pending = pool.num_workers;
+	pool.job++;
+	pthread_cond_broadcast(&pool.start);
+	pthread_mutex_unlock(&pool.lock);
+
+	in_task = true;
+	run_tasks(func,arg,n);
+	in_task = false;
+
+	pthread_mutex_lock(&pool.lock);
+	while(pool.pending>0)
+		pthread_cond_wait(&pool.done,&pool.lock);
+	pthread_mutex_unlock(&pool.lock);
+
+	pthread_mutex_unlock(&submit_lock);
+}
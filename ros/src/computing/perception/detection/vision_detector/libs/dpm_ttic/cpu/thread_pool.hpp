@@ -0,0 +1,11 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+//run func(arg,i) for i in [0,n) on the persistent worker threads and the caller,
+//returns when all calls are done. Calls from inside a task run in the calling thread.
+extern void dpm_ttic_cpu_parallel_for(int n,void (*func)(void *arg,int i),void *arg);
+
+//number of threads running the tasks (workers and caller)
+extern int dpm_ttic_cpu_num_threads();
+
+#endif /* _THREAD_POOL_H_ */
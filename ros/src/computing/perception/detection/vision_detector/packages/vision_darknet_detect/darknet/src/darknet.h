@@ -485,6 +485,9 @@ typedef struct network{
     float *cost;
     float clip;
 
+    double *layer_time;
+    int *profiled;
+
 #ifdef GPU
     float *input_gpu;
     float *truth_gpu;
@@ -609,6 +612,8 @@ data *tile_data(data orig, int divs, int size);
 data select_data(data *orig, int *inds);
 
 void forward_network(network *net);
+void set_network_profiling(network *net, int profile);
+void print_network_profile(network *net, FILE *fp);
 void backward_network(network *net);
 void update_network(network *net);
 
@@ -5,6 +5,11 @@
 #include <stdio.h>
 #include <math.h>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEMM_X86
+#include <immintrin.h>
+#endif
+
 void gemm_bin(int M, int N, int K, float ALPHA, 
         char  *A, int lda, 
         float *B, int ldb,
@@ -142,6 +147,183 @@ void gemm_tt(int M, int N, int K, float ALPHA,
 }
 
 
+#ifdef GEMM_X86
+
+/*
+ * Cache blocked gemm: C += ALPHA*op(A)*op(B).
+ *
+ * op(B) is packed by blocks of GEMM_KC x GEMM_NC into panels of GEMM_NR
+ * columns and op(A) by blocks of M x GEMM_KC into panels of GEMM_MR rows,
+ * so that the micro kernel reads both contiguously: a GEMM_MR x GEMM_NR tile
+ * of C is kept in registers for a whole panel. Tiles of GEMM_MC x GEMM_NT
+ * are spread over the OpenMP threads, the panel of B of a tile stays in L1
+ * and its rows of A in L2.
+ *
+ * The micro kernel needs AVX2 and FMA, which are checked at run time so
+ * that the compiler flags do not matter. Without them, or for small
+ * products not worth packing, gemm_cpu keeps the loops above.
+ */
+
+#define GEMM_MR 6
+#define GEMM_NR 16
+#define GEMM_MC 72
+#define GEMM_KC 256
+#define GEMM_NT 256
+#define GEMM_NC 4096
+
+/* below this M*N*K, packing costs more than it saves */
+#define GEMM_BLOCKED_MIN_FLOPS (64.*64.*64.)
+
+__attribute__((target("avx2,fma")))
+static void gemm_kernel_avx2(int kc, const float *a, const float *b, float *C, int ldc, int mr, int nr)
+{
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    int i, j, p;
+    for(p = 0; p < kc; ++p){
+        __m256 b0 = _mm256_loadu_ps(b);
+        __m256 b1 = _mm256_loadu_ps(b + 8);
+        __m256 ai;
+        ai = _mm256_broadcast_ss(a + 0); c00 = _mm256_fmadd_ps(ai, b0, c00); c01 = _mm256_fmadd_ps(ai, b1, c01);
+        ai = _mm256_broadcast_ss(a + 1); c10 = _mm256_fmadd_ps(ai, b0, c10); c11 = _mm256_fmadd_ps(ai, b1, c11);
+        ai = _mm256_broadcast_ss(a + 2); c20 = _mm256_fmadd_ps(ai, b0, c20); c21 = _mm256_fmadd_ps(ai, b1, c21);
+        ai = _mm256_broadcast_ss(a + 3); c30 = _mm256_fmadd_ps(ai, b0, c30); c31 = _mm256_fmadd_ps(ai, b1, c31);
+        ai = _mm256_broadcast_ss(a + 4); c40 = _mm256_fmadd_ps(ai, b0, c40); c41 = _mm256_fmadd_ps(ai, b1, c41);
+        ai = _mm256_broadcast_ss(a + 5); c50 = _mm256_fmadd_ps(ai, b0, c50); c51 = _mm256_fmadd_ps(ai, b1, c51);
+        a += GEMM_MR;
+        b += GEMM_NR;
+    }
+
+    float c[GEMM_MR][GEMM_NR];
+    _mm256_storeu_ps(c[0], c00); _mm256_storeu_ps(c[0] + 8, c01);
+    _mm256_storeu_ps(c[1], c10); _mm256_storeu_ps(c[1] + 8, c11);
+    _mm256_storeu_ps(c[2], c20); _mm256_storeu_ps(c[2] + 8, c21);
+    _mm256_storeu_ps(c[3], c30); _mm256_storeu_ps(c[3] + 8, c31);
+    _mm256_storeu_ps(c[4], c40); _mm256_storeu_ps(c[4] + 8, c41);
+    _mm256_storeu_ps(c[5], c50); _mm256_storeu_ps(c[5] + 8, c51);
+    if(nr == GEMM_NR){
+        for(i = 0; i < mr; ++i){
+            _mm256_storeu_ps(C + i*ldc, _mm256_add_ps(_mm256_loadu_ps(C + i*ldc), _mm256_loadu_ps(c[i])));
+            _mm256_storeu_ps(C + i*ldc + 8, _mm256_add_ps(_mm256_loadu_ps(C + i*ldc + 8), _mm256_loadu_ps(c[i] + 8)));
+        }
+    } else {
+        for(i = 0; i < mr; ++i){
+            for(j = 0; j < nr; ++j){
+                C[i*ldc + j] += c[i][j];
+            }
+        }
+    }
+}
+
+static int gemm_blocked_supported()
+{
+    static int supported = -1;
+    if(supported < 0){
+        __builtin_cpu_init();
+        supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+    return supported;
+}
+
+/* Packing buffers of the calling thread, only grown. */
+static __thread float *gemm_packed_a = 0;
+static __thread float *gemm_packed_b = 0;
+static __thread size_t gemm_packed_a_size = 0;
+static __thread size_t gemm_packed_b_size = 0;
+
+static float *gemm_buffer(float **buffer, size_t *size, size_t n)
+{
+    if(n > *size){
+        free(*buffer);
+        if(posix_memalign((void **)buffer, 64, n*sizeof(float))) error("gemm: out of memory");
+        *size = n;
+    }
+    return *buffer;
+}
+
+static void gemm_blocked(int TA, int TB, int M, int N, int K, float ALPHA, 
+        float *A, int lda, 
+        float *B, int ldb,
+        float *C, int ldc)
+{
+    int m_panels = (M + GEMM_MR - 1)/GEMM_MR;
+    float *packed_a = gemm_buffer(&gemm_packed_a, &gemm_packed_a_size, (size_t)m_panels*GEMM_MR*GEMM_KC);
+    float *packed_b = gemm_buffer(&gemm_packed_b, &gemm_packed_b_size, (size_t)GEMM_NC*GEMM_KC);
+
+    int jc, pc;
+    for(jc = 0; jc < N; jc += GEMM_NC){
+        int nc = (N - jc < GEMM_NC) ? N - jc : GEMM_NC;
+        int n_panels = (nc + GEMM_NR - 1)/GEMM_NR;
+        for(pc = 0; pc < K; pc += GEMM_KC){
+            int kc = (K - pc < GEMM_KC) ? K - pc : GEMM_KC;
+            int ir, jr, t;
+
+            #pragma omp parallel for
+            for(ir = 0; ir < m_panels; ++ir){
+                float *a = packed_a + (size_t)ir*GEMM_MR*kc;
+                int i, p;
+                for(i = 0; i < GEMM_MR; ++i){
+                    int row = ir*GEMM_MR + i;
+                    if(row >= M){
+                        for(p = 0; p < kc; ++p) a[p*GEMM_MR + i] = 0;
+                    } else if(!TA){
+                        const float *src = A + (size_t)row*lda + pc;
+                        for(p = 0; p < kc; ++p) a[p*GEMM_MR + i] = ALPHA*src[p];
+                    } else {
+                        const float *src = A + (size_t)pc*lda + row;
+                        for(p = 0; p < kc; ++p) a[p*GEMM_MR + i] = ALPHA*src[(size_t)p*lda];
+                    }
+                }
+            }
+
+            #pragma omp parallel for
+            for(jr = 0; jr < n_panels; ++jr){
+                float *b = packed_b + (size_t)jr*GEMM_NR*kc;
+                int col = jc + jr*GEMM_NR;
+                int nr = (N - col < GEMM_NR) ? N - col : GEMM_NR;
+                int j, p;
+                for(p = 0; p < kc; ++p){
+                    float *dst = b + p*GEMM_NR;
+                    if(!TB){
+                        const float *src = B + (size_t)(pc + p)*ldb + col;
+                        for(j = 0; j < nr; ++j) dst[j] = src[j];
+                    } else {
+                        const float *src = B + (size_t)col*ldb + pc + p;
+                        for(j = 0; j < nr; ++j) dst[j] = src[(size_t)j*ldb];
+                    }
+                    for(; j < GEMM_NR; ++j) dst[j] = 0;
+                }
+            }
+
+            int m_tiles = (M + GEMM_MC - 1)/GEMM_MC;
+            int n_tiles = (nc + GEMM_NT - 1)/GEMM_NT;
+            #pragma omp parallel for
+            for(t = 0; t < m_tiles*n_tiles; ++t){
+                int ic = (t % m_tiles)*GEMM_MC;
+                int jt = (t / m_tiles)*GEMM_NT;
+                int i_end = (ic + GEMM_MC < M) ? ic + GEMM_MC : M;
+                int j_end = (jt + GEMM_NT < nc) ? jt + GEMM_NT : nc;
+                int i, j;
+                for(j = jt; j < j_end; j += GEMM_NR){
+                    int nr = (j_end - j < GEMM_NR) ? j_end - j : GEMM_NR;
+                    const float *b = packed_b + (size_t)(j/GEMM_NR)*GEMM_NR*kc;
+                    for(i = ic; i < i_end; i += GEMM_MR){
+                        int mr = (i_end - i < GEMM_MR) ? i_end - i : GEMM_MR;
+                        const float *a = packed_a + (size_t)(i/GEMM_MR)*GEMM_MR*kc;
+                        gemm_kernel_avx2(kc, a, b, C + (size_t)i*ldc + jc + j, ldc, mr, nr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif
+
 void gemm_cpu(int TA, int TB, int M, int N, int K, float ALPHA, 
         float *A, int lda, 
         float *B, int ldb,
@@ -155,6 +337,12 @@ void gemm_cpu(int TA, int TB, int M, int N, int K, float ALPHA,
             C[i*ldc + j] *= BETA;
         }
     }
+#ifdef GEMM_X86
+    if((double)M*N*K >= GEMM_BLOCKED_MIN_FLOPS && gemm_blocked_supported()){
+        gemm_blocked(TA, TB, M, N, K, ALPHA,A,lda, B, ldb,C,ldc);
+        return;
+    }
+#endif
     if(!TA && !TB)
         gemm_nn(M, N, K, ALPHA,A,lda, B, ldb,C,ldc);
     else if(TA && !TB)
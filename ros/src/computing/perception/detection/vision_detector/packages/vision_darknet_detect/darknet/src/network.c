@@ -201,15 +201,56 @@ void forward_network(network *netp)
         if(l.delta){
             fill_cpu(l.outputs * l.batch, 0, l.delta, 1);
         }
+        double start = net.layer_time ? what_time_is_it_now() : 0;
         l.forward(l, net);
+        if(net.layer_time) net.layer_time[i] += what_time_is_it_now() - start;
         net.input = l.output;
         if(l.truth) {
             net.truth = l.output;
         }
     }
+    if(net.profiled) ++*net.profiled;
     calc_network_cost(netp);
 }
 
+/* Time the layers in the forward passes on the CPU, until profiling is off. */
+void set_network_profiling(network *net, int profile)
+{
+    free(net->layer_time);
+    free(net->profiled);
+    net->layer_time = 0;
+    net->profiled = 0;
+    if(profile){
+        net->layer_time = calloc(net->n, sizeof(double));
+        net->profiled = calloc(1, sizeof(int));
+    }
+}
+
+/* Mean time of each layer since the last print, then reset the times. */
+void print_network_profile(network *net, FILE *fp)
+{
+    if(!net->profiled || !*net->profiled) return;
+    int runs = *net->profiled;
+    double total = 0;
+    int i;
+    fprintf(fp, "%5s %-13s %16s    %16s %8s %9s\n", "layer", "type", "input", "output", "ms", "GFLOPS");
+    for(i = 0; i < net->n; ++i){
+        layer l = net->layers[i];
+        double ms = net->layer_time[i]*1000./runs;
+        total += ms;
+        fprintf(fp, "%5d %-13s %4d x%4d x%4d -> %4d x%4d x%4d %8.2f", i, get_layer_string(l.type),
+                l.w, l.h, l.c, l.out_w, l.out_h, l.out_c, ms);
+        if(l.type == CONVOLUTIONAL && ms > 0){
+            double flops = 2.*l.n*l.size*l.size*l.c/l.groups*l.out_h*l.out_w*l.batch;
+            fprintf(fp, " %9.1f", flops/(ms*1e6));
+        }
+        fprintf(fp, "\n");
+        net->layer_time[i] = 0;
+    }
+    fprintf(fp, "total %.2f ms over %d forward passes\n", total, runs);
+    *net->profiled = 0;
+}
+
 void update_network(network *netp)
 {
 #ifdef GPU
@@ -722,6 +763,8 @@ void free_network(network *net)
     free(net->layers);
     if(net->input) free(net->input);
     if(net->truth) free(net->truth);
+    free(net->layer_time);
+    free(net->profiled);
 #ifdef GPU
     if(net->input_gpu) cuda_free(net->input_gpu);
     if(net->truth_gpu) cuda_free(net->truth_gpu);
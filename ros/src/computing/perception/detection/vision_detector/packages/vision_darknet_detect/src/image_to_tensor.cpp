@@ -0,0 +1,154 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "image_to_tensor.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace darknet
+{
+    ImageToTensor::ImageToTensor() :
+            image_width_(0), image_height_(0), network_width_(0), network_height_(0), keep_aspect_(false),
+            scale_x_(1.), scale_y_(1.), left_(0), top_(0), width_(0), height_(0)
+    {
+    }
+
+    // source samples of each destination pixel, with the pixel centers aligned as cv::resize does
+    static void interpolation_table(int in_source_size, int in_size, double in_scale, int in_stride,
+                                    std::vector<int> &out_offset0, std::vector<int> &out_offset1,
+                                    std::vector<float> &out_weight)
+    {
+        out_offset0.resize(in_size);
+        out_offset1.resize(in_size);
+        out_weight.resize(in_size);
+        for (int i = 0; i < in_size; i++)
+        {
+            double source = std::max((i + 0.5) / in_scale - 0.5, 0.);
+            int i0 = std::min((int) source, in_source_size - 1);
+            int i1 = std::min(i0 + 1, in_source_size - 1);
+            out_offset0[i] = i0 * in_stride;
+            out_offset1[i] = i1 * in_stride;
+            out_weight[i] = (i1 > i0) ? (float) (source - i0) : 0.f;
+        }
+    }
+
+    void ImageToTensor::set_size(int in_image_width, int in_image_height, int in_network_width,
+                                 int in_network_height, bool in_keep_aspect)
+    {
+        if (in_image_width == image_width_ && in_image_height == image_height_
+            && in_network_width == network_width_ && in_network_height == network_height_
+            && in_keep_aspect == keep_aspect_)
+        {
+            return;
+        }
+        image_width_ = in_image_width;
+        image_height_ = in_image_height;
+        network_width_ = in_network_width;
+        network_height_ = in_network_height;
+        keep_aspect_ = in_keep_aspect;
+
+        if (keep_aspect_)
+        {
+            scale_x_ = scale_y_ = std::min((double) network_width_ / image_width_,
+                                           (double) network_height_ / image_height_);
+            width_ = std::min(network_width_, (int) std::lround(image_width_ * scale_x_));
+            height_ = std::min(network_height_, (int) std::lround(image_height_ * scale_y_));
+        }
+        else
+        {
+            scale_x_ = (double) network_width_ / image_width_;
+            scale_y_ = (double) network_height_ / image_height_;
+            width_ = network_width_;
+            height_ = network_height_;
+        }
+        left_ = (network_width_ - width_) / 2;
+        top_ = (network_height_ - height_) / 2;
+
+        interpolation_table(image_width_, width_, scale_x_, 3, x_offset0_, x_offset1_, x_weight_);
+        interpolation_table(image_height_, height_, scale_y_, 1, y_row0_, y_row1_, y_weight_);
+        row_buffer_.resize(6 * width_);
+    }
+
+    void ImageToTensor::interpolate_row(const uint8_t *in_row, int in_red, int in_blue, float *out_planes) const
+    {
+        float *red = out_planes, *green = out_planes + width_, *blue = out_planes + 2 * width_;
+        for (int x = 0; x < width_; x++)
+        {
+            const uint8_t *left = in_row + x_offset0_[x], *right = in_row + x_offset1_[x];
+            const float wx = x_weight_[x];
+            red[x] = left[in_red] + wx * (right[in_red] - left[in_red]);
+            green[x] = left[1] + wx * (right[1] - left[1]);
+            blue[x] = left[in_blue] + wx * (right[in_blue] - left[in_blue]);
+        }
+    }
+
+    void ImageToTensor::convert(const uint8_t *in_data, int in_step, bool in_rgb, float *out_tensor) const
+    {
+        const size_t plane = (size_t) network_width_ * network_height_;
+        const int red = in_rgb ? 0 : 2, blue = 2 - red;
+        const float normalize = 1.f / 255.f;
+
+        for (int y = 0; y < network_height_; y++)
+        {
+            float *rows[3] = {out_tensor + (size_t) y * network_width_,
+                              out_tensor + plane + (size_t) y * network_width_,
+                              out_tensor + 2 * plane + (size_t) y * network_width_};
+            if (y < top_ || y >= top_ + height_)
+            {
+                for (int c = 0; c < 3; c++)
+                    std::fill(rows[c], rows[c] + network_width_, 0.f);
+                continue;
+            }
+            for (int c = 0; c < 3; c++)
+            {
+                std::fill(rows[c], rows[c] + left_, 0.f);
+                std::fill(rows[c] + left_ + width_, rows[c] + network_width_, 0.f);
+                rows[c] += left_;
+            }
+
+            // horizontal pass over the two source rows, into planes in the network order
+            const float wy = y_weight_[y - top_];
+            float *upper = &row_buffer_[0], *lower = upper + 3 * width_;
+            interpolate_row(in_data + (size_t) y_row0_[y - top_] * in_step, red, blue, upper);
+            if (wy > 0.f)
+                interpolate_row(in_data + (size_t) y_row1_[y - top_] * in_step, red, blue, lower);
+            else
+                lower = upper;
+
+            for (int c = 0; c < 3; c++)
+            {
+                const float *upper_c = upper + c * width_, *lower_c = lower + c * width_;
+                float *row = rows[c];
+                for (int x = 0; x < width_; x++)
+                    row[x] = (upper_c[x] + wy * (lower_c[x] - upper_c[x])) * normalize;
+            }
+        }
+    }
+}  // namespace darknet
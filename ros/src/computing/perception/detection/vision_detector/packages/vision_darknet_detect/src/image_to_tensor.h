@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef IMAGE_TO_TENSOR_H
+#define IMAGE_TO_TENSOR_H
+
+#include <cstdint>
+#include <vector>
+
+namespace darknet
+{
+    /**
+     * Converts 8 bit BGR or RGB images into the input of a network in a single pass: planar RGB scaled
+     * to [0, 1], resized bilinearly into a box of the input, the rest of the input being black.
+     * The interpolation tables are kept as long as the image and network sizes do not change.
+     */
+    class ImageToTensor
+    {
+    private:
+        int image_width_, image_height_;
+        int network_width_, network_height_;
+        bool keep_aspect_;
+        double scale_x_, scale_y_;//network input pixels per image pixel
+        int left_, top_, width_, height_;//box of the resized image in the network input
+
+        //for each column and row of the box, offsets of the two samples around it and the weight of the second
+        std::vector<int> x_offset0_, x_offset1_;
+        std::vector<float> x_weight_;
+        std::vector<int> y_row0_, y_row1_;
+        std::vector<float> y_weight_;
+        mutable std::vector<float> row_buffer_;//two source rows, interpolated horizontally
+
+        void interpolate_row(const uint8_t *in_row, int in_red, int in_blue, float *out_planes) const;
+
+    public:
+        ImageToTensor();
+
+        /**
+         * @param in_keep_aspect letterbox the image, centered, instead of stretching it to the whole input
+         */
+        void set_size(int in_image_width, int in_image_height, int in_network_width, int in_network_height,
+                      bool in_keep_aspect);
+
+        /**
+         * @param in_data image of the last set_size, 3 bytes per pixel
+         * @param in_step bytes between the rows of in_data
+         * @param in_rgb channels of in_data are in RGB order, BGR otherwise
+         * @param out_tensor 3 planes of network_width x network_height
+         */
+        void convert(const uint8_t *in_data, int in_step, bool in_rgb, float *out_tensor) const;
+
+        double get_scale_x() const { return scale_x_; }
+        double get_scale_y() const { return scale_y_; }
+        int get_left() const { return left_; }
+        int get_top() const { return top_; }
+    };
+}  // namespace darknet
+
+#endif  // IMAGE_TO_TENSOR_H
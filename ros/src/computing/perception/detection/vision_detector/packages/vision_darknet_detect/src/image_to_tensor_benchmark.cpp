@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Time the conversion of camera images into the network input, by ImageToTensor and by the
+// cv_bridge, cv::resize, cv::copyMakeBorder and per pixel copy steps it replaced.
+//
+// usage: image_to_tensor_benchmark [IMAGE_WIDTH IMAGE_HEIGHT NETWORK_SIZE REPEAT]
+// defaults to a 1920x1200 image into the 608x608 input of yolov3.cfg
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <cv_bridge/cv_bridge.h>
+#include <opencv2/opencv.hpp>
+#include <ros/ros.h>
+#include <sensor_msgs/image_encodings.h>
+
+#include "image_to_tensor.h"
+
+static void convert_with_opencv(const sensor_msgs::ImageConstPtr& msg, int network_size, std::vector<float>& out)
+{
+    cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(msg, "bgr8");
+    cv::Mat final_mat;
+    double ratio = (double) network_size / cv_image->image.cols;
+    cv::resize(cv_image->image, final_mat, cv::Size(), ratio, ratio);
+    int top_bottom = abs(final_mat.rows - network_size) / 2;
+    int left_right = abs(final_mat.cols - network_size) / 2;
+    cv::copyMakeBorder(final_mat, final_mat, top_bottom, top_bottom, left_right, left_right,
+                       cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+
+    int h = final_mat.rows, w = final_mat.cols;
+    out.assign(3 * w * h, 0.f);
+    for (int i = 0; i < h; ++i)
+        for (int k = 0; k < 3; ++k)
+            for (int j = 0; j < w; ++j)
+                out[(2 - k) * w * h + i * w + j] = final_mat.at<cv::Vec3b>(i, j)[k] / 255.;
+}
+
+int main(int argc, char **argv)
+{
+    int width = (argc > 1) ? atoi(argv[1]) : 1920;
+    int height = (argc > 2) ? atoi(argv[2]) : 1200;
+    int network_size = (argc > 3) ? atoi(argv[3]) : 608;
+    int repeat = (argc > 4) ? atoi(argv[4]) : 100;
+    if (width <= 0 || height <= 0 || network_size <= 0 || repeat <= 0)
+    {
+        fprintf(stderr, "usage: %s [IMAGE_WIDTH IMAGE_HEIGHT NETWORK_SIZE REPEAT]\n", argv[0]);
+        return 1;
+    }
+
+    cv::Mat mat(height, width, CV_8UC3);
+    cv::randu(mat, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::GaussianBlur(mat, mat, cv::Size(9, 9), 0);
+    sensor_msgs::ImagePtr msg = cv_bridge::CvImage(std_msgs::Header(), sensor_msgs::image_encodings::BGR8, mat).toImageMsg();
+    printf("%dx%d bgr8 image into a %dx%d network input, %d times\n", width, height, network_size, network_size,
+           repeat);
+
+    std::vector<float> reference;
+    ros::WallTime start = ros::WallTime::now();
+    for (int i = 0; i < repeat; ++i)
+        convert_with_opencv(msg, network_size, reference);
+    printf("cv_bridge, cv::resize, copyMakeBorder, copy %8.3f ms\n",
+           (ros::WallTime::now() - start).toSec() * 1e3 / repeat);
+
+    darknet::ImageToTensor image_to_tensor;
+    std::vector<float> tensor(3 * network_size * network_size);
+    start = ros::WallTime::now();
+    for (int i = 0; i < repeat; ++i)
+    {
+        image_to_tensor.set_size(msg->width, msg->height, network_size, network_size, true);
+        image_to_tensor.convert(&msg->data[0], msg->step, false, &tensor[0]);
+    }
+    printf("ImageToTensor                              %8.3f ms\n",
+           (ros::WallTime::now() - start).toSec() * 1e3 / repeat);
+
+    // cv::resize rounds to 8 bits and both take the same box unless the image is taller than the network
+    if (reference.size() == tensor.size())
+    {
+        double max_difference = 0;
+        for (size_t i = 0; i < tensor.size(); ++i)
+            max_difference = std::max(max_difference, (double) std::fabs(tensor[i] - reference[i]));
+        printf("max difference %.4f (%.1f / 255)\n", max_difference, max_difference * 255);
+    }
+    return 0;
+}
@@ -63,6 +63,13 @@ namespace darknet
         darknet_boxes_.resize(output_layer.w * output_layer.h * output_layer.n);
     }
 
+    void Yolo3Detector::set_profiling(int in_frames)
+    {
+        profile_frames_ = in_frames;
+        profiled_frames_ = 0;
+        set_network_profiling(darknet_network_, in_frames > 0);
+    }
+
     Yolo3Detector::~Yolo3Detector()
     {
         free_network(darknet_network_);
@@ -81,35 +88,22 @@ namespace darknet
             exit(-1);
         }
 
-        auto data = msg->data;
-        uint32_t height = msg->height, width = msg->width, offset = msg->step - 3 * width;
-        uint32_t i = 0, j = 0;
-        image im = make_image(width, height, 3);
-
-        for (uint32_t line = height; line; line--)
-        {
-            for (uint32_t column = width; column; column--)
-            {
-                for (uint32_t channel = 0; channel < 3; channel++)
-                    im.data[i + width * height * channel] = data[j++] / 255.;
-                i++;
-            }
-            j += offset;
-        }
-
-        if (darknet_network_->w == (int) width && darknet_network_->h == (int) height)
-        {
-            return im;
-        }
-        image resized = resize_image(im, darknet_network_->w, darknet_network_->h);
-        free_image(im);
-        return resized;
+        ImageToTensor image_to_tensor;
+        image_to_tensor.set_size(msg->width, msg->height, darknet_network_->w, darknet_network_->h, false);
+        image im = make_image(darknet_network_->w, darknet_network_->h, 3);
+        image_to_tensor.convert(&msg->data[0], msg->step, false, im.data);
+        return im;
     }
 
     std::vector< RectClassScore<float> > Yolo3Detector::forward(image& in_darknet_image)
     {
         float * in_data = in_darknet_image.data;
         float *prediction = network_predict(darknet_network_, in_data);
+        if (profile_frames_ > 0 && ++profiled_frames_ == profile_frames_)
+        {
+            print_network_profile(darknet_network_, stderr);
+            profiled_frames_ = 0;
+        }
         layer output_layer = darknet_network_->layers[darknet_network_->n - 1];
 
         output_layer.output = prediction;
@@ -201,67 +195,35 @@ void Yolo3DetectorNode::convert_rect_to_image_obj(std::vector< RectClassScore<fl
     }
 }
 
-void Yolo3DetectorNode::rgbgr_image(image& im)
+image Yolo3DetectorNode::convert_image_msg(const sensor_msgs::ImageConstPtr& msg)
 {
-    int i;
-    for(i = 0; i < im.w*im.h; ++i)
+    // other encodings are converted first, bgr8 and rgb8 are read in place
+    cv_bridge::CvImageConstPtr cv_image;
+    const uint8_t *data = &msg->data[0];
+    int step = msg->step;
+    bool rgb = msg->encoding == sensor_msgs::image_encodings::RGB8;
+    if (!rgb && msg->encoding != sensor_msgs::image_encodings::BGR8)
     {
-        float swap = im.data[i];
-        im.data[i] = im.data[i+im.w*im.h*2];
-        im.data[i+im.w*im.h*2] = swap;
+        cv_image = cv_bridge::toCvShare(msg, sensor_msgs::image_encodings::BGR8);
+        data = cv_image->image.data;
+        step = cv_image->image.step;
     }
-}
-
-image Yolo3DetectorNode::convert_ipl_to_image(const sensor_msgs::ImageConstPtr& msg)
-{
-    cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(msg, "bgr8");//toCvCopy(image_source, sensor_msgs::image_encodings::BGR8);
-    cv::Mat mat_image = cv_image->image;
 
     int network_input_width = yolo_detector_.get_network_width();
     int network_input_height = yolo_detector_.get_network_height();
-
-    int image_height = msg->height,
-            image_width = msg->width;
-
-    IplImage ipl_image;
-    cv::Mat final_mat;
-
-    if (network_input_width!=image_width
-        || network_input_height != image_height)
-    {
-        //final_mat = cv::Mat(network_input_width, network_input_height, CV_8UC3, cv::Scalar(0,0,0));
-        image_ratio_ = (double ) network_input_width /  (double)mat_image.cols;
-
-        cv::resize(mat_image, final_mat, cv::Size(), image_ratio_, image_ratio_);
-        image_top_bottom_border_ = abs(final_mat.rows-network_input_height)/2;
-        image_left_right_border_ = abs(final_mat.cols-network_input_width)/2;
-        cv::copyMakeBorder(final_mat, final_mat,
-                           image_top_bottom_border_, image_top_bottom_border_,
-                           image_left_right_border_, image_left_right_border_,
-                           cv::BORDER_CONSTANT, cv::Scalar(0,0,0));
-    }
-    else
-        final_mat = mat_image;
-
-    ipl_image = final_mat;
-
-    unsigned char *data = (unsigned char *)ipl_image.imageData;
-    int h = ipl_image.height;
-    int w = ipl_image.width;
-    int c = ipl_image.nChannels;
-    int step = ipl_image.widthStep;
-    int i, j, k;
-
-    image darknet_image = make_image(w, h, c);
-
-    for(i = 0; i < h; ++i){
-        for(k= 0; k < c; ++k){
-            for(j = 0; j < w; ++j){
-                darknet_image.data[k*w*h + i*w + j] = data[i*step + j*c + k]/255.;
-            }
-        }
-    }
-    rgbgr_image(darknet_image);
+    image_to_tensor_.set_size(msg->width, msg->height, network_input_width, network_input_height, true);
+    image_ratio_ = image_to_tensor_.get_scale_x();
+    image_top_bottom_border_ = image_to_tensor_.get_top();
+    image_left_right_border_ = image_to_tensor_.get_left();
+
+    input_tensor_.resize(3 * network_input_width * network_input_height);
+    image_to_tensor_.convert(data, step, rgb, &input_tensor_[0]);
+
+    image darknet_image;
+    darknet_image.w = network_input_width;
+    darknet_image.h = network_input_height;
+    darknet_image.c = 3;
+    darknet_image.data = &input_tensor_[0];
     return darknet_image;
 }
 
@@ -269,7 +231,7 @@ void Yolo3DetectorNode::image_callback(const sensor_msgs::ImageConstPtr& in_imag
 {
     std::vector< RectClassScore<float> > detections;
 
-    darknet_image_ = convert_ipl_to_image(in_image_message);
+    darknet_image_ = convert_image_msg(in_image_message);
 
     detections = yolo_detector_.detect(darknet_image_);
 
@@ -280,8 +242,6 @@ void Yolo3DetectorNode::image_callback(const sensor_msgs::ImageConstPtr& in_imag
     convert_rect_to_image_obj(detections, output_message);
 
     publisher_objects_.publish(output_message);
-
-    free(darknet_image_.data);
 }
 
 void Yolo3DetectorNode::config_cb(const autoware_config_msgs::ConfigSsd::ConstPtr& param)
@@ -359,8 +319,13 @@ void Yolo3DetectorNode::Run()
     ROS_INFO("[%s] nms_threshold: %f",__APP_NAME__, nms_threshold_);
 
 
+    int profile_layers;
+    private_node_handle.param<int>("profile_layers", profile_layers, 0);
+    ROS_INFO("[%s] profile_layers: %d",__APP_NAME__, profile_layers);
+
     ROS_INFO("Initializing Yolo on Darknet...");
     yolo_detector_.load(network_definition_file, pretrained_model_file, score_threshold_, nms_threshold_);
+    yolo_detector_.set_profiling(profile_layers);
     ROS_INFO("Initialization complete.");
 
     #if (CV_MAJOR_VERSION <= 2)
@@ -54,6 +54,7 @@
 #include <autoware_msgs/DetectedObjectArray.h>
 
 #include <rect_class_score.h>
+#include "image_to_tensor.h"
 
 #include <opencv2/opencv.hpp>
 
@@ -76,15 +77,19 @@ namespace darknet {
     class Yolo3Detector {
     private:
         double min_confidence_, nms_threshold_;
+        int profile_frames_, profiled_frames_;
         network* darknet_network_;
         std::vector<box> darknet_boxes_;
         std::vector<RectClassScore<float> > forward(image &in_darknet_image);
     public:
-        Yolo3Detector() {}
+        Yolo3Detector() : profile_frames_(0), profiled_frames_(0) {}
 
         void load(std::string &in_model_file, std::string &in_trained_file, double in_min_confidence,
                   double in_nms_threshold);
 
+        // print the time of each layer every in_frames frames, 0 to disable
+        void set_profiling(int in_frames);
+
         ~Yolo3Detector();
 
         image convert_image(const sensor_msgs::ImageConstPtr &in_image_msg);
@@ -108,6 +113,8 @@ class Yolo3DetectorNode {
     darknet::Yolo3Detector          yolo_detector_;
 
     image darknet_image_ = {};
+    darknet::ImageToTensor          image_to_tensor_;
+    std::vector<float>              input_tensor_;//network input, reused between the frames
 
     float                           score_threshold_;
     float                           nms_threshold_;
@@ -122,8 +129,7 @@ class Yolo3DetectorNode {
 
     void                            convert_rect_to_image_obj(std::vector< RectClassScore<float> >& in_objects,
                                       autoware_msgs::DetectedObjectArray& out_message);
-    void                            rgbgr_image(image& im);
-    image                           convert_ipl_to_image(const sensor_msgs::ImageConstPtr& msg);
+    image                           convert_image_msg(const sensor_msgs::ImageConstPtr& msg);
     void                            image_callback(const sensor_msgs::ImageConstPtr& in_image_message);
     void                            config_cb(const autoware_config_msgs::ConfigSsd::ConstPtr& param);
     std::vector<std::string>        read_custom_names_file(const std::string& in_path);
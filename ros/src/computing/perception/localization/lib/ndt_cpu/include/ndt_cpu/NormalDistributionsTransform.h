@@ -20,12 +20,18 @@ public:
 
 	void setOutlierRatio(double olr);
 
+	/* Set the number of threads used to accumulate the score gradient
+	 * and Hessian over the source points. 0 uses all available cores. */
+	void setNumThreads(int num_threads);
+
 	double getStepSize() const;
 
 	float getResolution() const;
 
 	double getOutlierRatio() const;
 
+	int getNumThreads() const;
+
 	double getTransformationProbability() const;
 
 	int getRealIterations();
@@ -38,6 +44,10 @@ public:
 
 	void updateVoxelGrid(typename pcl::PointCloud<PointTargetType>::Ptr new_cloud);
 
+	/* Remove the map points inside voxel columns [min_bx, max_bx] x [min_by, max_by].
+	 * Indexes are measured in number of voxels (floor(coordinate / resolution)). */
+	void clearVoxelGrid(int min_bx, int min_by, int max_bx, int max_by);
+
 protected:
 	void computeTransformation(const Eigen::Matrix<float, 4, 4> &guess);
 
@@ -81,6 +91,18 @@ private:
 	double computeDerivatives(Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
 								typename pcl::PointCloud<PointSourceType> &trans_cloud,
 								Eigen::Matrix<double, 6, 1> pose, bool compute_hessian = true);
+	/* Accumulate score, gradient and Hessian over source points [begin, end) */
+	double accumulateDerivatives(int begin, int end, Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
+									typename pcl::PointCloud<PointSourceType> &trans_cloud, bool compute_hessian);
+
+	/* Accumulate Hessian over source points [begin, end) */
+	void accumulateHessian(int begin, int end, Eigen::Matrix<double, 6, 6> &hessian, typename pcl::PointCloud<PointSourceType> &trans_cloud);
+
+	int getEffectiveThreadNum() const;
+
+	/* Number of source cloud partitions processed in parallel */
+	int computeChunkNum(int points_number) const;
+
 	void computePointDerivatives(Eigen::Vector3d &x, Eigen::Matrix<double, 3, 6> &point_gradient, Eigen::Matrix<double, 18, 6> &point_hessian, bool computeHessian = true);
 	double updateDerivatives(Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
 								Eigen::Matrix<double, 3, 6> point_gradient, Eigen::Matrix<double, 18, 6> point_hessian,
@@ -106,6 +128,7 @@ private:
 
 	int real_iterations_;
 
+	int num_threads_;
 
 	VoxelGrid<PointSourceType> voxel_grid_;
 };
@@ -66,6 +66,11 @@ public:
 
 	void update(typename pcl::PointCloud<PointSourceType>::Ptr new_cloud);
 
+	/* Empty all voxels whose x and y indexes are in [min_bx, max_bx] x [min_by, max_by],
+	 * so that the area can be refilled by update(). Points of the emptied voxels stay in
+	 * the source cloud but no longer contribute to the grid. */
+	void clearVoxels(int min_bx, int min_by, int max_bx, int max_by);
+
 private:
 
 	typedef struct {
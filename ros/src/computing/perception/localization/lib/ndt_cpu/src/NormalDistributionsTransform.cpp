@@ -3,6 +3,9 @@
 #include <cmath>
 #include <iostream>
 #include <pcl/common/transforms.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define V2_ 1
 
@@ -29,6 +32,7 @@ NormalDistributionsTransform<PointSourceType, PointTargetType>::NormalDistributi
 	transformation_epsilon_ = 0.1;
 	max_iterations_ = 35;
 	real_iterations_ = 0;
+	num_threads_ = 1;
 }
 
 template <typename PointSourceType, typename PointTargetType>
@@ -49,6 +53,12 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::setOutlierR
 	outlier_ratio_ = olr;
 }
 
+template <typename PointSourceType, typename PointTargetType>
+void NormalDistributionsTransform<PointSourceType, PointTargetType>::setNumThreads(int num_threads)
+{
+	num_threads_ = (num_threads < 0) ? 1 : num_threads;
+}
+
 template <typename PointSourceType, typename PointTargetType>
 double NormalDistributionsTransform<PointSourceType, PointTargetType>::getStepSize() const
 {
@@ -67,6 +77,12 @@ double NormalDistributionsTransform<PointSourceType, PointTargetType>::getOutlie
 	return outlier_ratio_;
 }
 
+template <typename PointSourceType, typename PointTargetType>
+int NormalDistributionsTransform<PointSourceType, PointTargetType>::getNumThreads() const
+{
+	return num_threads_;
+}
+
 template <typename PointSourceType, typename PointTargetType>
 double NormalDistributionsTransform<PointSourceType, PointTargetType>::getTransformationProbability() const
 {
@@ -186,16 +202,53 @@ double NormalDistributionsTransform<PointSourceType, PointTargetType>::computeDe
 																							typename pcl::PointCloud<PointSourceType> &trans_cloud,
 																							Eigen::Matrix<double, 6, 1> pose, bool compute_hessian)
 {
-	PointSourceType x_pt, x_trans_pt;
-	Eigen::Vector3d x, x_trans;
-	Eigen::Matrix3d c_inv;
-
 	score_gradient.setZero ();
 	hessian.setZero ();
 
 	//Compute Angle Derivatives
 	computeAngleDerivatives(pose);
 
+	int points_number = source_cloud_->points.size();
+	int chunk_num = computeChunkNum(points_number);
+
+	if (chunk_num <= 1) {
+		return accumulateDerivatives(0, points_number, score_gradient, hessian, trans_cloud, compute_hessian);
+	}
+
+	/* Each chunk of the source cloud is accumulated into its own buffers,
+	 * which are then reduced in chunk order so the result does not depend
+	 * on thread scheduling. */
+	std::vector<Eigen::Matrix<double, 6, 1>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 1> > > chunk_gradient(chunk_num, Eigen::Matrix<double, 6, 1>::Zero());
+	std::vector<Eigen::Matrix<double, 6, 6>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6> > > chunk_hessian(chunk_num, Eigen::Matrix<double, 6, 6>::Zero());
+	std::vector<double> chunk_score(chunk_num, 0.0);
+
+#pragma omp parallel for num_threads(getEffectiveThreadNum()) schedule(dynamic, 1)
+	for (int chunk = 0; chunk < chunk_num; chunk++) {
+		int begin = static_cast<int>(static_cast<long long>(points_number) * chunk / chunk_num);
+		int end = static_cast<int>(static_cast<long long>(points_number) * (chunk + 1) / chunk_num);
+
+		chunk_score[chunk] = accumulateDerivatives(begin, end, chunk_gradient[chunk], chunk_hessian[chunk], trans_cloud, compute_hessian);
+	}
+
+	double score = 0;
+
+	for (int chunk = 0; chunk < chunk_num; chunk++) {
+		score += chunk_score[chunk];
+		score_gradient += chunk_gradient[chunk];
+		hessian += chunk_hessian[chunk];
+	}
+
+	return score;
+}
+
+template <typename PointSourceType, typename PointTargetType>
+double NormalDistributionsTransform<PointSourceType, PointTargetType>::accumulateDerivatives(int begin, int end, Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
+																								typename pcl::PointCloud<PointSourceType> &trans_cloud, bool compute_hessian)
+{
+	PointSourceType x_pt, x_trans_pt;
+	Eigen::Vector3d x, x_trans;
+	Eigen::Matrix3d c_inv;
+
 	std::vector<int> neighbor_ids;
 	Eigen::Matrix<double, 3, 6> point_gradient;
 	Eigen::Matrix<double, 18, 6> point_hessian;
@@ -205,7 +258,7 @@ double NormalDistributionsTransform<PointSourceType, PointTargetType>::computeDe
 	point_gradient.block<3, 3>(0, 0).setIdentity();
 	point_hessian.setZero();
 
-	for (int idx = 0; idx < source_cloud_->points.size(); idx++) {
+	for (int idx = begin; idx < end; idx++) {
 		neighbor_ids.clear();
 		x_trans_pt = trans_cloud.points[idx];
 
@@ -231,6 +284,31 @@ double NormalDistributionsTransform<PointSourceType, PointTargetType>::computeDe
 	return score;
 }
 
+template <typename PointSourceType, typename PointTargetType>
+int NormalDistributionsTransform<PointSourceType, PointTargetType>::getEffectiveThreadNum() const
+{
+#ifdef _OPENMP
+	return (num_threads_ > 0) ? num_threads_ : omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+template <typename PointSourceType, typename PointTargetType>
+int NormalDistributionsTransform<PointSourceType, PointTargetType>::computeChunkNum(int points_number) const
+{
+	int thread_num = getEffectiveThreadNum();
+
+	if (thread_num <= 1) {
+		return 1;
+	}
+
+	// Split into a few chunks per thread to balance points with many neighbor voxels
+	int chunk_num = thread_num * 4;
+
+	return (chunk_num < points_number) ? chunk_num : points_number;
+}
+
 template <typename PointSourceType, typename PointTargetType>
 void NormalDistributionsTransform<PointSourceType, PointTargetType>::computePointDerivatives(Eigen::Vector3d &x, Eigen::Matrix<double, 3, 6> &point_gradient, Eigen::Matrix<double, 18, 6> &point_hessian, bool compute_hessian)
 {
@@ -680,22 +758,51 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::updateHessi
 
 template <typename PointSourceType, typename PointTargetType>
 void NormalDistributionsTransform<PointSourceType, PointTargetType>::computeHessian(Eigen::Matrix<double, 6, 6> &hessian, typename pcl::PointCloud<PointSourceType> &trans_cloud, Eigen::Matrix<double, 6, 1> &p)
+{
+	hessian.setZero();
+
+	int points_number = source_cloud_->points.size();
+	int chunk_num = computeChunkNum(points_number);
+
+	if (chunk_num <= 1) {
+		accumulateHessian(0, points_number, hessian, trans_cloud);
+		return;
+	}
+
+	std::vector<Eigen::Matrix<double, 6, 6>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6> > > chunk_hessian(chunk_num, Eigen::Matrix<double, 6, 6>::Zero());
+
+#pragma omp parallel for num_threads(getEffectiveThreadNum()) schedule(dynamic, 1)
+	for (int chunk = 0; chunk < chunk_num; chunk++) {
+		int begin = static_cast<int>(static_cast<long long>(points_number) * chunk / chunk_num);
+		int end = static_cast<int>(static_cast<long long>(points_number) * (chunk + 1) / chunk_num);
+
+		accumulateHessian(begin, end, chunk_hessian[chunk], trans_cloud);
+	}
+
+	for (int chunk = 0; chunk < chunk_num; chunk++) {
+		hessian += chunk_hessian[chunk];
+	}
+}
+
+template <typename PointSourceType, typename PointTargetType>
+void NormalDistributionsTransform<PointSourceType, PointTargetType>::accumulateHessian(int begin, int end, Eigen::Matrix<double, 6, 6> &hessian, typename pcl::PointCloud<PointSourceType> &trans_cloud)
 {
 	PointSourceType x_pt, x_trans_pt;
 	Eigen::Vector3d x, x_trans;
 	Eigen::Matrix3d c_inv;
 
-	hessian.setZero();
-
 	Eigen::Matrix<double, 3, 6> point_gradient;
 	Eigen::Matrix<double, 18, 6> point_hessian;
+	std::vector<int> neighbor_ids;
 
+	point_gradient.setZero();
+	point_gradient.block<3, 3>(0, 0).setIdentity();
+	point_hessian.setZero();
 
-	for (int idx = 0; idx < source_cloud_->points.size(); idx++) {
+	for (int idx = begin; idx < end; idx++) {
+		neighbor_ids.clear();
 		x_trans_pt = trans_cloud.points[idx];
 
-		std::vector<int> neighbor_ids;
-
 		voxel_grid_.radiusSearch(x_trans_pt, resolution_, neighbor_ids);
 
 		for (int i = 0; i < neighbor_ids.size(); i++) {
@@ -712,8 +819,6 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::computeHess
 			updateHessian(hessian, point_gradient, point_hessian, x_trans, c_inv);
 		}
 	}
-
-
 }
 
 template <typename PointSourceType, typename PointTargetType>
@@ -754,6 +859,12 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::updateVoxel
 	voxel_grid_.update(new_cloud);
 }
 
+template <typename PointSourceType, typename PointTargetType>
+void NormalDistributionsTransform<PointSourceType, PointTargetType>::clearVoxelGrid(int min_bx, int min_by, int max_bx, int max_by)
+{
+	voxel_grid_.clearVoxels(min_bx, min_by, max_bx, max_by);
+}
+
 template class NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI>;
 template class NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>;
 
@@ -526,6 +526,11 @@ double VoxelGrid<PointSourceType>::nearestNeighborDistance(PointSourceType q, fl
 
 	int nn_vid = nearestVoxel(q, nn_node_bounds, max_range);
 
+	// The nearest octree node may only cover cleared voxels
+	if (nn_vid < 0) {
+		return DBL_MAX;
+	}
+
 	Eigen::Vector3d c = (*centroid_)[nn_vid];
 	double min_dist = sqrt((q.x - c(0)) * (q.x - c(0)) + (q.y - c(1)) * (q.y - c(1)) + (q.z - c(2)) * (q.z - c(2)));
 
@@ -785,6 +790,34 @@ void VoxelGrid<PointSourceType>::updateVoxelContent(typename pcl::PointCloud<Poi
 	}
 }
 
+template <typename PointSourceType>
+void VoxelGrid<PointSourceType>::clearVoxels(int min_bx, int min_by, int max_bx, int max_by)
+{
+	if (voxel_num_ <= 0) {
+		return;
+	}
+
+	min_bx = (min_bx < real_min_bx_) ? real_min_bx_ : min_bx;
+	min_by = (min_by < real_min_by_) ? real_min_by_ : min_by;
+	max_bx = (max_bx > real_max_bx_) ? real_max_bx_ : max_bx;
+	max_by = (max_by > real_max_by_) ? real_max_by_ : max_by;
+
+	for (int idx = min_bx; idx <= max_bx; idx++) {
+		for (int idy = min_by; idy <= max_by; idy++) {
+			for (int idz = real_min_bz_; idz <= real_max_bz_; idz++) {
+				int vid = voxelId(idx, idy, idz, min_b_x_, min_b_y_, min_b_z_, vgrid_x_, vgrid_y_, vgrid_z_);
+
+				// Release the memory of the point id list as well
+				std::vector<int>().swap((*points_id_)[vid]);
+				(*points_per_voxel_)[vid] = 0;
+				(*centroid_)[vid].setZero();
+				(*tmp_centroid_)[vid].setZero();
+				(*tmp_cov_)[vid].setIdentity();
+			}
+		}
+	}
+}
+
 template class VoxelGrid<pcl::PointXYZI>;
 template class VoxelGrid<pcl::PointXYZ>;
 
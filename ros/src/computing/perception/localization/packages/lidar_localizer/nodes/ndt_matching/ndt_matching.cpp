@@ -38,9 +38,12 @@
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include <nav_msgs/Odometry.h>
 #include <ros/ros.h>
@@ -124,7 +127,8 @@ static int _use_gnss = 1;
 static int init_pos_set = 0;
 
 static pcl::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> ndt;
-static cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> anh_ndt;
+static std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> anh_ndt_ptr =
+    std::make_shared<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>();
 #ifdef CUDA_FOUND
 static std::shared_ptr<gpu::GNormalDistributionsTransform> anh_gpu_ndt_ptr =
     std::make_shared<gpu::GNormalDistributionsTransform>();
@@ -230,6 +234,28 @@ static bool _imu_upside_down = false;
 
 static std::string _imu_topic = "/imu_raw";
 
+// Number of threads used by PCL_ANH (0 = all available cores)
+static int _num_threads = 1;
+
+// Incremental points_map update (PCL_ANH only).
+// The map is divided into square cells of _map_cell_size voxels and only the cells whose
+// content changed are re-voxelized. Updates are applied to a spare NDT object that is
+// swapped with anh_ndt_ptr, so points_callback only waits for a pointer swap.
+static bool _incremental_map_update = false;
+static int _map_cell_size = 20;  // [voxels]
+
+struct MapCell
+{
+  size_t point_num;
+  double sum_x, sum_y, sum_z;
+};
+typedef std::map<std::pair<int, int>, MapCell> MapCells;
+
+static std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> spare_anh_ndt_ptr;
+static MapCells map_cells;
+static float map_cells_res = 0.0;
+static size_t stale_map_points = 0;  // Removed points still held by the source clouds of the voxel grids
+
 static std::ofstream ofs;
 static std::string filename;
 
@@ -266,7 +292,11 @@ static void param_callback(const autoware_config_msgs::ConfigNdt::ConstPtr& inpu
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setResolution(ndt_res);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setResolution(ndt_res);
+    {
+      pthread_mutex_lock(&mutex);
+      anh_ndt_ptr->setResolution(ndt_res);
+      pthread_mutex_unlock(&mutex);
+    }
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setResolution(ndt_res);
@@ -284,7 +314,11 @@ static void param_callback(const autoware_config_msgs::ConfigNdt::ConstPtr& inpu
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setStepSize(step_size);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setStepSize(step_size);
+    {
+      pthread_mutex_lock(&mutex);
+      anh_ndt_ptr->setStepSize(step_size);
+      pthread_mutex_unlock(&mutex);
+    }
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setStepSize(step_size);
@@ -302,7 +336,11 @@ static void param_callback(const autoware_config_msgs::ConfigNdt::ConstPtr& inpu
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setTransformationEpsilon(trans_eps);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setTransformationEpsilon(trans_eps);
+    {
+      pthread_mutex_lock(&mutex);
+      anh_ndt_ptr->setTransformationEpsilon(trans_eps);
+      pthread_mutex_unlock(&mutex);
+    }
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setTransformationEpsilon(trans_eps);
@@ -320,7 +358,11 @@ static void param_callback(const autoware_config_msgs::ConfigNdt::ConstPtr& inpu
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setMaximumIterations(max_iter);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setMaximumIterations(max_iter);
+    {
+      pthread_mutex_lock(&mutex);
+      anh_ndt_ptr->setMaximumIterations(max_iter);
+      pthread_mutex_unlock(&mutex);
+    }
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setMaximumIterations(max_iter);
@@ -403,6 +445,147 @@ static void param_callback(const autoware_config_msgs::ConfigNdt::ConstPtr& inpu
   }
 }
 
+static std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>
+build_anh_ndt(const pcl::PointCloud<pcl::PointXYZ>::Ptr& map_ptr)
+{
+  std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> new_anh_ndt_ptr =
+      std::make_shared<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>();
+  new_anh_ndt_ptr->setResolution(ndt_res);
+  new_anh_ndt_ptr->setInputTarget(map_ptr);
+  new_anh_ndt_ptr->setMaximumIterations(max_iter);
+  new_anh_ndt_ptr->setStepSize(step_size);
+  new_anh_ndt_ptr->setTransformationEpsilon(trans_eps);
+  new_anh_ndt_ptr->setNumThreads(_num_threads);
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr dummy_scan_ptr(new pcl::PointCloud<pcl::PointXYZ>());
+  pcl::PointXYZ dummy_point;
+  dummy_scan_ptr->push_back(dummy_point);
+  new_anh_ndt_ptr->setInputSource(dummy_scan_ptr);
+
+  new_anh_ndt_ptr->align(Eigen::Matrix4f::Identity());
+
+  return new_anh_ndt_ptr;
+}
+
+static int map_cell_index(float coordinate)
+{
+  // Same voxel index as cpu::VoxelGrid, so that cell borders fall on voxel borders
+  int voxel_index = static_cast<int>(floor(coordinate / ndt_res));
+
+  return (voxel_index < 0) ? -((-voxel_index + _map_cell_size - 1) / _map_cell_size) : voxel_index / _map_cell_size;
+}
+
+static void split_map_into_cells(const pcl::PointCloud<pcl::PointXYZ>& cloud, MapCells& cells)
+{
+  for (const pcl::PointXYZ& p : cloud.points)
+  {
+    std::pair<int, int> key(map_cell_index(p.x), map_cell_index(p.y));
+    MapCells::iterator it = cells.find(key);
+
+    if (it == cells.end())
+    {
+      MapCell empty_cell = { 0, 0.0, 0.0, 0.0 };
+      it = cells.insert(std::make_pair(key, empty_cell)).first;
+    }
+
+    it->second.point_num++;
+    it->second.sum_x += p.x;
+    it->second.sum_y += p.y;
+    it->second.sum_z += p.z;
+  }
+}
+
+static bool is_same_cell(const MapCell& a, const MapCell& b)
+{
+  return (a.point_num == b.point_num && a.sum_x == b.sum_x && a.sum_y == b.sum_y && a.sum_z == b.sum_z);
+}
+
+static void apply_map_diff(cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>& target_ndt,
+                           const std::set<std::pair<int, int>>& changed_cells,
+                           const pcl::PointCloud<pcl::PointXYZ>::Ptr& added_points)
+{
+  for (const std::pair<int, int>& key : changed_cells)
+  {
+    target_ndt.clearVoxelGrid(key.first * _map_cell_size, key.second * _map_cell_size,
+                              (key.first + 1) * _map_cell_size - 1, (key.second + 1) * _map_cell_size - 1);
+  }
+
+  if (!added_points->points.empty())
+    target_ndt.updateVoxelGrid(added_points);
+}
+
+static void update_anh_ndt_incrementally(const pcl::PointCloud<pcl::PointXYZ>::Ptr& map_ptr)
+{
+  MapCells new_map_cells;
+  split_map_into_cells(*map_ptr, new_map_cells);
+
+  // Removed points are never erased from the source clouds, so rebuild once they outnumber the map
+  if (!spare_anh_ndt_ptr || map_cells_res != ndt_res || stale_map_points > map_ptr->points.size())
+  {
+    std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> new_anh_ndt_ptr =
+        build_anh_ndt(map_ptr);
+
+    pthread_mutex_lock(&mutex);
+    anh_ndt_ptr.swap(new_anh_ndt_ptr);
+    pthread_mutex_unlock(&mutex);
+
+    new_anh_ndt_ptr.reset();
+
+    // The spare owns its own copy of the map since updateVoxelGrid() appends to it
+    pcl::PointCloud<pcl::PointXYZ>::Ptr spare_map_ptr(new pcl::PointCloud<pcl::PointXYZ>(*map_ptr));
+    spare_anh_ndt_ptr = build_anh_ndt(spare_map_ptr);
+
+    stale_map_points = 0;
+    map_cells_res = ndt_res;
+    map_cells.swap(new_map_cells);
+    return;
+  }
+
+  std::set<std::pair<int, int>> changed_cells;
+
+  for (const MapCells::value_type& cell : map_cells)
+  {
+    MapCells::const_iterator it = new_map_cells.find(cell.first);
+
+    if (it == new_map_cells.end() || !is_same_cell(cell.second, it->second))
+    {
+      changed_cells.insert(cell.first);
+      stale_map_points += cell.second.point_num;
+    }
+  }
+
+  for (const MapCells::value_type& cell : new_map_cells)
+  {
+    if (map_cells.find(cell.first) == map_cells.end())
+      changed_cells.insert(cell.first);
+  }
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr added_points(new pcl::PointCloud<pcl::PointXYZ>());
+
+  for (const pcl::PointXYZ& p : map_ptr->points)
+  {
+    if (changed_cells.count(std::make_pair(map_cell_index(p.x), map_cell_index(p.y))) > 0)
+      added_points->push_back(p);
+  }
+
+  std::cout << "Incremental points_map update: " << changed_cells.size() << " of " << new_map_cells.size()
+            << " cells changed, " << added_points->points.size() << " points added." << std::endl;
+
+  apply_map_diff(*spare_anh_ndt_ptr, changed_cells, added_points);
+  spare_anh_ndt_ptr->setMaximumIterations(max_iter);
+  spare_anh_ndt_ptr->setStepSize(step_size);
+  spare_anh_ndt_ptr->setTransformationEpsilon(trans_eps);
+
+  pthread_mutex_lock(&mutex);
+  anh_ndt_ptr.swap(spare_anh_ndt_ptr);
+  pthread_mutex_unlock(&mutex);
+
+  // Bring the previous NDT up to date so that it can receive the next update
+  apply_map_diff(*spare_anh_ndt_ptr, changed_cells, added_points);
+
+  map_cells.swap(new_map_cells);
+}
+
 static void map_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 {
   // if (map_loaded == 0)
@@ -453,23 +636,20 @@ static void map_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
     }
     else if (_method_type == MethodType::PCL_ANH)
     {
-      cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> new_anh_ndt;
-      new_anh_ndt.setResolution(ndt_res);
-      new_anh_ndt.setInputTarget(map_ptr);
-      new_anh_ndt.setMaximumIterations(max_iter);
-      new_anh_ndt.setStepSize(step_size);
-      new_anh_ndt.setTransformationEpsilon(trans_eps);
-
-      pcl::PointCloud<pcl::PointXYZ>::Ptr dummy_scan_ptr(new pcl::PointCloud<pcl::PointXYZ>());
-      pcl::PointXYZ dummy_point;
-      dummy_scan_ptr->push_back(dummy_point);
-      new_anh_ndt.setInputSource(dummy_scan_ptr);
-
-      new_anh_ndt.align(Eigen::Matrix4f::Identity());
+      if (_incremental_map_update)
+      {
+        update_anh_ndt_incrementally(map_ptr);
+      }
+      else
+      {
+        std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> new_anh_ndt_ptr =
+            build_anh_ndt(map_ptr);
 
-      pthread_mutex_lock(&mutex);
-      anh_ndt = new_anh_ndt;
-      pthread_mutex_unlock(&mutex);
+        // The previous NDT is released outside of the lock
+        pthread_mutex_lock(&mutex);
+        anh_ndt_ptr.swap(new_anh_ndt_ptr);
+        pthread_mutex_unlock(&mutex);
+      }
     }
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
@@ -930,7 +1110,7 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setInputSource(filtered_scan_ptr);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setInputSource(filtered_scan_ptr);
+      anh_ndt_ptr->setInputSource(filtered_scan_ptr);
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setInputSource(filtered_scan_ptr);
@@ -1017,19 +1197,19 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
     else if (_method_type == MethodType::PCL_ANH)
     {
       align_start = std::chrono::system_clock::now();
-      anh_ndt.align(init_guess);
+      anh_ndt_ptr->align(init_guess);
       align_end = std::chrono::system_clock::now();
 
-      has_converged = anh_ndt.hasConverged();
+      has_converged = anh_ndt_ptr->hasConverged();
 
-      t = anh_ndt.getFinalTransformation();
-      iteration = anh_ndt.getFinalNumIteration();
+      t = anh_ndt_ptr->getFinalTransformation();
+      iteration = anh_ndt_ptr->getFinalNumIteration();
 
       getFitnessScore_start = std::chrono::system_clock::now();
-      fitness_score = anh_ndt.getFitnessScore();
+      fitness_score = anh_ndt_ptr->getFitnessScore();
       getFitnessScore_end = std::chrono::system_clock::now();
 
-      trans_probability = anh_ndt.getTransformationProbability();
+      trans_probability = anh_ndt_ptr->getTransformationProbability();
     }
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
@@ -1514,6 +1694,11 @@ int main(int argc, char** argv)
   private_nh.getParam("use_odom", _use_odom);
   private_nh.getParam("imu_upside_down", _imu_upside_down);
   private_nh.getParam("imu_topic", _imu_topic);
+  private_nh.getParam("num_threads", _num_threads);
+  private_nh.getParam("incremental_map_update", _incremental_map_update);
+  private_nh.getParam("map_cell_size", _map_cell_size);
+  if (_map_cell_size < 1)
+    _map_cell_size = 1;
 
   if (nh.getParam("localizer", _localizer) == false)
   {
@@ -1563,6 +1748,9 @@ int main(int argc, char** argv)
   std::cout << "use_imu: " << _use_imu << std::endl;
   std::cout << "imu_upside_down: " << _imu_upside_down << std::endl;
   std::cout << "imu_topic: " << _imu_topic << std::endl;
+  std::cout << "num_threads: " << _num_threads << std::endl;
+  std::cout << "incremental_map_update: " << _incremental_map_update << std::endl;
+  std::cout << "map_cell_size: " << _map_cell_size << std::endl;
   std::cout << "localizer: " << _localizer << std::endl;
   std::cout << "(tf_x,tf_y,tf_z,tf_roll,tf_pitch,tf_yaw): (" << _tf_x << ", " << _tf_y << ", " << _tf_z << ", "
             << _tf_roll << ", " << _tf_pitch << ", " << _tf_yaw << ")" << std::endl;
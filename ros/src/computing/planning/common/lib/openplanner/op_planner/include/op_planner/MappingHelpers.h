@@ -68,6 +68,8 @@ public:
 
 	static void ConstructRoadNetworkFromDataFiles(const std::string vectoMapPath, RoadNetwork& map, const bool& bZeroOrigin = false);
 
+	static void ConstructRoadNetworkFromBinaryFile(const std::string& binaryMapPath, RoadNetwork& map);
+
 	static void UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, const std::vector<int>& data, RoadNetwork& map, std::vector<WayPoint*>& updated_list);
 
 	static bool GetWayPoint(const int& id, const int& laneID,const double& refVel, const int& did,
@@ -760,6 +760,59 @@ public:
 	std::vector<Crossing> crossings;
 	std::vector<Marking> markings;
 	std::vector<TrafficSign> signs;
+
+	RoadNetwork();
+	RoadNetwork(const RoadNetwork& other);
+	RoadNetwork& operator=(const RoadNetwork& other);
+
+	/**
+	 * \brief Builds the lookup index of the map, lanes and waypoints sorted by id and a grid of the lane points.
+	 * The index keeps pointers into roadSegments, so it must be updated after adding, removing or moving lanes or waypoints.
+	 * Until then the lookups fall back to a linear search over the whole map.
+	 * @param cellSize grid cell size in meters
+	 */
+	void UpdateIndex(const double& cellSize = 10.0);
+	void ClearIndex();
+	bool IsIndexed() const { return m_bIndexed; }
+
+	/// first lane with this id in map order, nullptr if not found
+	Lane* GetLaneById(const int& id);
+
+	/// appends every lane with this id to lanes, in map order
+	void GetLanesById(const int& id, std::vector<Lane*>& lanes);
+
+	/// first waypoint with this id in map order, nullptr if not found
+	WayPoint* FindWaypoint(const int& id);
+
+	/// first waypoint with this id in map order that is not in the lane laneId, nullptr if not found
+	WayPoint* FindWaypointNotInLane(const int& id, const int& laneId);
+
+	/**
+	 * \brief Candidate lanes for a closest lane search, in map order.
+	 * Every lane with a point within distance of pos (on the XY plane) is returned, other lanes may be returned too.
+	 * Without an index all the lanes are returned.
+	 */
+	void GetLanesAround(const GPSPoint& pos, const double& distance, std::vector<Lane*>& lanes);
+
+private:
+	class IndexedWaypoint
+	{
+	public:
+		int id;
+		int iLane;
+		int iPoint;
+	};
+
+	bool m_bIndexed;
+	double m_CellSize;
+	int m_MinCellX, m_MaxCellX, m_MinCellY, m_MaxCellY;
+	std::vector<Lane*> m_IndexedLanes; // all the lanes in map order
+	std::vector<std::pair<int, int> > m_LanesById; // (lane id, index in m_IndexedLanes) sorted by id then map order
+	std::vector<IndexedWaypoint> m_WaypointsById; // sorted by id then map order
+	std::vector<std::pair<long long, int> > m_LanesGrid; // (cell key, index in m_IndexedLanes) sorted, one entry per lane and cell
+
+	static long long CellKey(const int& cell_x, const int& cell_y);
+	static bool CompareWaypointId(const IndexedWaypoint& a, const IndexedWaypoint& b);
 };
 
 class VehicleState : public ObjTimeStamp
@@ -54,14 +54,63 @@ public:
 
 
 private:
+	/// Projection on the reference path of one object contour point, the same for all the roll outs
+	struct ContourPointInfo
+	{
+		int obj_index;
+		int contour_index;
+		double perp_distance;
+		double longitudinal_distance; // from the car front, already shifted by the critical front distance
+		WayPoint perp_point;
+		double velocity;
+		bool bInRange; // longitudinal distance within the range that can influence any roll out
+		bool bSkip; // far enough from a slow object to ignore it and the rest of its contour
+		bool bInsideSafetyBorder;
+
+		ContourPointInfo() : obj_index(-1), contour_index(-1), perp_distance(0), longitudinal_distance(0), velocity(0),
+				bInRange(false), bSkip(false), bInsideSafetyBorder(false)
+		{
+		}
+	};
+
+	/// Bounding box of consecutive roll out points [iStart, iEnd), to cull the collision search
+	struct PathSegmentBox
+	{
+		int iStart;
+		int iEnd;
+		double min_x, min_y, max_x, max_y;
+	};
+
+	/// Collision point of one roll out, with its position in the serial object / contour / roll out order
+	struct CollisionPointEntry
+	{
+		int obj_index;
+		int contour_index;
+		int rollout_index;
+		WayPoint p;
+
+		bool operator<(const CollisionPointEntry& other) const
+		{
+			if(obj_index != other.obj_index) return obj_index < other.obj_index;
+			if(contour_index != other.contour_index) return contour_index < other.contour_index;
+			return rollout_index < other.rollout_index;
+		}
+	};
+
+	vector<ContourPointInfo> m_ContourInfo;
+	vector<vector<PathSegmentBox> > m_RollOutSegments;
+	vector<vector<CollisionPointEntry> > m_RollOutCollisionPoints;
+
 	bool ValidateRollOutsInput(const vector<vector<vector<WayPoint> > >& rollOuts);
 	vector<TrajectoryCost> CalculatePriorityAndLaneChangeCosts(const vector<vector<WayPoint> >& laneRollOuts, const int& lane_index, const PlanningParams& params);
 	void NormalizeCosts(vector<TrajectoryCost>& trajectoryCosts);
 	void CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost>& trajectoryCosts, const vector<vector<vector<WayPoint> > >& rollOuts, const vector<vector<WayPoint> >& totalPaths, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState);
 	void CalculateLateralAndLongitudinalCostsStatic(vector<TrajectoryCost>& trajectoryCosts, const vector<vector<WayPoint> >& rollOuts, const vector<WayPoint>& totalPaths, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState);
+	void CalculateRollOutsLateralAndLongitudinalCosts(vector<TrajectoryCost>& trajectoryCosts, const int& iFirstCost, const int& nRollOuts, const vector<WayPoint>& totalPath, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo);
 	void CalculateTransitionCosts(vector<TrajectoryCost>& trajectoryCosts, const int& currTrajectoryIndex, const PlanningParams& params);
 	
-	void CalculateIntersectionVelocities(const std::vector<WayPoint>& path, const DetectedObject& obj, const WayPoint& currPose, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts);
+	void CalculateIntersectionVelocities(const std::vector<WayPoint>& path, const std::vector<PathSegmentBox>& segments, const DetectedObject& obj, const WayPoint& currPose, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts);
+	void InitializeRollOutSegments(const vector<vector<WayPoint> >& rollOuts);
 	int GetCurrentRollOutIndex(const std::vector<WayPoint>& path, const WayPoint& currState, const PlanningParams& params);
 	void InitializeCosts(const vector<vector<WayPoint> >& rollOuts, const PlanningParams& params);
 	void InitializeSafetyPolygon(const WayPoint& currState, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState, const double& c_lateral_d, const double& c_long_front_d, const double& c_long_back_d);
@@ -9,6 +9,7 @@
 #include "op_planner/MappingHelpers.h"
 #include "op_planner/MatrixOperations.h"
 #include "op_planner/PlanningHelpers.h"
+#include <vector_map/binary_map.h>
 #include <float.h>
 
 #include "math.h"
@@ -49,16 +50,7 @@ GPSPoint MappingHelpers::GetTransformationOrigin(const int& bToyotaCityMap)
 
 Lane* MappingHelpers::GetLaneById(const int& id,RoadNetwork& map)
 {
-	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-	{
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-		{
-			if(map.roadSegments.at(rs).Lanes.at(i).id == id)
-				return &map.roadSegments.at(rs).Lanes.at(i);
-		}
-	}
-
-	return nullptr;
+	return map.GetLaneById(id);
 }
 
 int MappingHelpers::GetLaneIdByWaypointId(const int& id,std::vector<Lane>& lanes)
@@ -365,41 +357,11 @@ void MappingHelpers::ConstructRoadNetworkFromRosMessage(const std::vector<Utilit
 	roadSegment1.Lanes = roadLanes;
 	map.roadSegments.push_back(roadSegment1);
 
-	//Link Lanes and lane's waypoints by pointers
-	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-	{
-		//Link Lanes
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-		{
-			Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
-			for(unsigned int j = 0 ; j < pL->fromIds.size(); j++)
-			{
-				for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-				{
-					if(map.roadSegments.at(rs).Lanes.at(l).id == pL->fromIds.at(j))
-					{
-						pL->fromLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-					}
-				}
-			}
+	//Index lanes and waypoints for the id and closest lane lookups, lanes are not added or moved after this
+	map.UpdateIndex();
 
-			for(unsigned int j = 0 ; j < pL->toIds.size(); j++)
-			{
-				for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-				{
-					if(map.roadSegments.at(rs).Lanes.at(l).id == pL->toIds.at(j))
-					{
-						pL->toLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-					}
-				}
-			}
-
-			for(unsigned int j = 0 ; j < pL->points.size(); j++)
-			{
-				pL->points.at(j).pLane  = pL;
-			}
-		}
-	}
+	//Link Lanes and lane's waypoints by pointers
+	LinkLanesPointers(map);
 
 	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
 	{
@@ -481,44 +443,22 @@ void MappingHelpers::AssignActionCostToLane(Lane* pL, ACTION_TYPE action, double
 
 WayPoint* MappingHelpers::FindWaypoint(const int& id, RoadNetwork& map)
 {
-	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-	{
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-		{
-			for(unsigned int p= 0; p < map.roadSegments.at(rs).Lanes.at(i).points.size(); p++)
-			{
-				if(map.roadSegments.at(rs).Lanes.at(i).points.at(p).id == id)
-					return &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
-			}
-		}
-	}
-
-	return nullptr;
+	return map.FindWaypoint(id);
 }
 
 WayPoint* MappingHelpers::FindWaypointV2(const int& id, const int& l_id, RoadNetwork& map)
 {
-	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-	{
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-		{
-			Lane* pLane = &map.roadSegments.at(rs).Lanes.at(i);
-			if(pLane ->id != l_id)
-			{
-				for(unsigned int p= 0; p < pLane->points.size(); p++)
-				{
-					if(pLane->points.at(p).id == id)
-						return &pLane->points.at(p);
-				}
-			}
-		}
-	}
-
-	return nullptr;
+	return map.FindWaypointNotInLane(id, l_id);
 }
 
 void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMapPath, RoadNetwork& map, const bool& bZeroOrigin)
 {
+	if(vector_map::isBinaryMap(vectoMapPath))
+	{
+		ConstructRoadNetworkFromBinaryFile(vectoMapPath, map);
+		return;
+	}
+
 	/**
 	 * Exporting the center lines
 	 */
@@ -616,6 +556,53 @@ void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMa
 	cout << origin.pos.ToString() ;
 }
 
+void MappingHelpers::ConstructRoadNetworkFromBinaryFile(const std::string& binaryMapPath, RoadNetwork& map)
+{
+	cout << " >> Loading compiled vector map file ... " << endl;
+	vector_map::VectorMapData data;
+	if(!vector_map::readBinaryMap(binaryMapPath, data) || data.point.data.size() == 0)
+	{
+		std::cout << std::endl << "## Alert Can't Read Points Data from vector map file: " << binaryMapPath << std::endl;
+		return;
+	}
+
+	AisanCenterLinesFileReader  center_lanes(data.dtlane);
+	AisanLanesFileReader lanes(data.lane);
+	AisanPointsFileReader points(data.point);
+	AisanNodesFileReader nodes(data.node);
+	AisanLinesFileReader lines(data.line);
+	AisanStopLineFileReader stop_line(data.stop_line);
+	AisanSignalFileReader signal(data.signal);
+	AisanVectorFileReader vec(data.vector);
+	AisanCurbFileReader curb(data.curb);
+	AisanRoadEdgeFileReader roadedge(data.road_edge);
+	AisanAreasFileReader areas(data.area);
+	AisanWayareaFileReader way_area(data.way_area);
+	AisanCrossWalkFileReader cross_walk(data.cross_walk);
+
+	//same as the csv files, intersections are not used and the data connections are not part of the compiled map
+	vector<AisanIntersectionFileReader::AisanIntersection> intersection_data;
+	vector<AisanDataConnFileReader::DataConn> conn_data;
+
+	if(nodes.m_data_list.size() > 0)
+	{
+		ConstructRoadNetworkFromRosMessageV2(lanes.m_data_list, points.m_data_list, center_lanes.m_data_list, intersection_data, areas.m_data_list,
+				lines.m_data_list, stop_line.m_data_list, signal.m_data_list, vec.m_data_list, curb.m_data_list, roadedge.m_data_list,
+				way_area.m_data_list, cross_walk.m_data_list, nodes.m_data_list, conn_data, &lanes, &points, &nodes, &lines,
+				GetTransformationOrigin(0), map, false);
+	}
+	else
+	{
+		ConstructRoadNetworkFromRosMessage(lanes.m_data_list, points.m_data_list, center_lanes.m_data_list, intersection_data, areas.m_data_list,
+						lines.m_data_list, stop_line.m_data_list, signal.m_data_list, vec.m_data_list, curb.m_data_list, roadedge.m_data_list,
+						way_area.m_data_list, cross_walk.m_data_list, nodes.m_data_list, conn_data,
+						GetTransformationOrigin(0), map, false);
+	}
+
+	WayPoint origin = GetFirstWaypoint(map);
+	cout << origin.pos.ToString() ;
+}
+
 bool MappingHelpers::GetWayPoint(const int& id, const int& laneID,const double& refVel, const int& did,
 		const std::vector<UtilityHNS::AisanCenterLinesFileReader::AisanCenterLine>& dtpoints,
 		const std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints>& points,
@@ -748,42 +735,12 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
 		}
 	}
 
+	//Index lanes and waypoints for the id and closest lane lookups, lanes are not added or moved after this
+	map.UpdateIndex();
+
 	cout << " >> Link lanes and waypoints with pointers ... " << endl;
 	//Link Lanes and lane's waypoints by pointers
-	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-	{
-		//Link Lanes
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-		{
-			Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
-			for(unsigned int j = 0 ; j < pL->fromIds.size(); j++)
-			{
-				for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-				{
-					if(map.roadSegments.at(rs).Lanes.at(l).id == pL->fromIds.at(j))
-					{
-						pL->fromLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-					}
-				}
-			}
-
-			for(unsigned int j = 0 ; j < pL->toIds.size(); j++)
-			{
-				for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-				{
-					if(map.roadSegments.at(rs).Lanes.at(l).id == pL->toIds.at(j))
-					{
-						pL->toLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-					}
-				}
-			}
-
-			for(unsigned int j = 0 ; j < pL->points.size(); j++)
-			{
-				pL->points.at(j).pLane  = pL;
-			}
-		}
-	}
+	LinkLanesPointers(map);
 
 	//Link waypoints
 	cout << " >> Link missing branches and waypoints... " << endl;
@@ -973,19 +930,18 @@ WayPoint* MappingHelpers::GetClosestBackWaypointFromMap(const WayPoint& pos, Roa
 std::vector<Lane*> MappingHelpers::GetClosestLanesFast(const WayPoint& center, RoadNetwork& map, const double& distance)
 {
 	vector<Lane*> lanesList;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
+	vector<Lane*> lanes_around;
+	map.GetLanesAround(center.pos, distance, lanes_around);
+	for(unsigned int il=0; il< lanes_around.size(); il ++)
 	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
-		{
-			Lane* pL = &map.roadSegments.at(j).Lanes.at(k);
-			int index = PlanningHelpers::GetClosestNextPointIndexFast(pL->points, center);
+		Lane* pL = lanes_around.at(il);
+		int index = PlanningHelpers::GetClosestNextPointIndexFast(pL->points, center);
 
-			if(index < 0 || index >= pL->points.size()) continue;
+		if(index < 0 || index >= pL->points.size()) continue;
 
-			double d = hypot(pL->points.at(index).pos.y - center.pos.y, pL->points.at(index).pos.x - center.pos.x);
-			if(d <= distance)
-				lanesList.push_back(pL);
-		}
+		double d = hypot(pL->points.at(index).pos.y - center.pos.y, pL->points.at(index).pos.x - center.pos.x);
+		if(d <= distance)
+			lanesList.push_back(pL);
 	}
 
 	return lanesList;
@@ -996,24 +952,23 @@ Lane* MappingHelpers::GetClosestLaneFromMap(const WayPoint& pos, RoadNetwork& ma
 	vector<pair<double, Lane*> > laneLinksList;
 	double d = 0;
 	double min_d = DBL_MAX;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
+	vector<Lane*> lanes_around;
+	map.GetLanesAround(pos.pos, distance, lanes_around);
+	for(unsigned int il=0; il< lanes_around.size(); il ++)
 	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
+		Lane* pL = lanes_around.at(il);
+		d = 0;
+		min_d = DBL_MAX;
+		for(unsigned int pindex=0; pindex< pL->points.size(); pindex ++)
 		{
-			//Lane* pLane = &pEdge->lanes.at(k);
-			 d = 0;
-			min_d = DBL_MAX;
-			for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-			{
-
-				d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-				if(d < min_d)
-					min_d = d;
-			}
 
-			if(min_d < distance)
-				laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k)));
+			d = distance2points(pL->points.at(pindex).pos, pos.pos);
+			if(d < min_d)
+				min_d = d;
 		}
+
+		if(min_d < distance)
+			laneLinksList.push_back(make_pair(min_d, pL));
 	}
 
 	if(laneLinksList.size() == 0) return nullptr;
@@ -1048,24 +1003,23 @@ vector<Lane*> MappingHelpers::GetClosestLanesListFromMap(const WayPoint& pos, Ro
 	vector<pair<double, Lane*> > laneLinksList;
 	double d = 0;
 	double min_d = DBL_MAX;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
+	vector<Lane*> lanes_around;
+	map.GetLanesAround(pos.pos, distance, lanes_around);
+	for(unsigned int il=0; il< lanes_around.size(); il ++)
 	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
+		Lane* pL = lanes_around.at(il);
+		d = 0;
+		min_d = DBL_MAX;
+		for(unsigned int pindex=0; pindex< pL->points.size(); pindex ++)
 		{
-			//Lane* pLane = &pEdge->lanes.at(k);
-			 d = 0;
-			min_d = DBL_MAX;
-			for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-			{
-
-				d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-				if(d < min_d)
-					min_d = d;
-			}
 
-			if(min_d < distance)
-				laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k)));
+			d = distance2points(pL->points.at(pindex).pos, pos.pos);
+			if(d < min_d)
+				min_d = d;
 		}
+
+		if(min_d < distance)
+			laneLinksList.push_back(make_pair(min_d, pL));
 	}
 
 	vector<Lane*> closest_lanes;
@@ -1099,27 +1053,26 @@ Lane* MappingHelpers::GetClosestLaneFromMapDirectionBased(const WayPoint& pos, R
 	double d = 0;
 	double min_d = DBL_MAX;
 	int min_i = 0;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
+	vector<Lane*> lanes_around;
+	map.GetLanesAround(pos.pos, distance, lanes_around);
+	for(unsigned int il=0; il< lanes_around.size(); il ++)
 	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
+		Lane* pL = lanes_around.at(il);
+		d = 0;
+		min_d = DBL_MAX;
+		for(unsigned int pindex=0; pindex< pL->points.size(); pindex ++)
 		{
-			//Lane* pLane = &pEdge->lanes.at(k);
-			d = 0;
-			min_d = DBL_MAX;
-			for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-			{
 
-				d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-				if(d < min_d)
-				{
-					min_d = d;
-					min_i = pindex;
-				}
+			d = distance2points(pL->points.at(pindex).pos, pos.pos);
+			if(d < min_d)
+			{
+				min_d = d;
+				min_i = pindex;
 			}
-
-			if(min_d < distance)
-				laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k).points.at(min_i)));
 		}
+
+		if(min_d < distance)
+			laneLinksList.push_back(make_pair(min_d, &pL->points.at(min_i)));
 	}
 
 	if(laneLinksList.size() == 0) return nullptr;
@@ -1152,32 +1105,32 @@ Lane* MappingHelpers::GetClosestLaneFromMapDirectionBased(const WayPoint& pos, R
 	vector<Lane*> lanesList;
 	double d = 0;
 	double a_diff = 0;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
+	vector<Lane*> lanes_around;
+	map.GetLanesAround(pos.pos, distance, lanes_around);
+	for(unsigned int k=0; k< lanes_around.size(); k ++)
 	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
+		Lane* pL = lanes_around.at(k);
+		for(unsigned int pindex=0; pindex< pL->points.size(); pindex ++)
 		{
-			for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-			{
-				d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-				a_diff = UtilityH::AngleBetweenTwoAnglesPositive(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos.a, pos.pos.a);
+			d = distance2points(pL->points.at(pindex).pos, pos.pos);
+			a_diff = UtilityH::AngleBetweenTwoAnglesPositive(pL->points.at(pindex).pos.a, pos.pos.a);
 
-				if(d <= distance && a_diff <= M_PI_4)
+			if(d <= distance && a_diff <= M_PI_4)
+			{
+				bool bLaneExist = false;
+				for(unsigned int il = 0; il < lanesList.size(); il++)
 				{
-					bool bLaneExist = false;
-					for(unsigned int il = 0; il < lanesList.size(); il++)
+					if(lanesList.at(il)->id == pL->id)
 					{
-						if(lanesList.at(il)->id == map.roadSegments.at(j).Lanes.at(k).id)
-						{
-							bLaneExist = true;
-							break;
-						}
+						bLaneExist = true;
+						break;
 					}
+				}
 
-					if(!bLaneExist)
-						lanesList.push_back(&map.roadSegments.at(j).Lanes.at(k));
+				if(!bLaneExist)
+					lanesList.push_back(pL);
 
-					break;
-				}
+				break;
 			}
 		}
 	}
@@ -1865,55 +1818,56 @@ void MappingHelpers::FindAdjacentLanes(RoadNetwork& map)
 		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
 		{
 			Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
-			//Link left and right lanes
-			for(unsigned int rs_2 = 0; rs_2 < map.roadSegments.size(); rs_2++)
-			{
-				for(unsigned int i2 =0; i2 < map.roadSegments.at(rs_2).Lanes.size(); i2++)
+			int iCenter1 = pL->points.size()/2;
+			WayPoint wp_1 = pL->points.at(iCenter1);
+
+			//Link left and right lanes, only lanes with a point closer than the adjacent lane distance can match
+			std::vector<Lane*> near_lanes;
+			map.GetLanesAround(wp_1.pos, 3.5, near_lanes);
+			for(unsigned int i2 =0; i2 < near_lanes.size(); i2++)
+			{
+				Lane* pL2 = near_lanes.at(i2);
+				int iCenter2 = PlanningHelpers::GetClosestNextPointIndexFast(pL2->points, wp_1 );
+				WayPoint closest_p = pL2->points.at(iCenter2);
+				double mid_a1 = wp_1.pos.a;
+				double mid_a2 = closest_p.pos.a;
+				double angle_diff = UtilityH::AngleBetweenTwoAnglesPositive(mid_a1, mid_a2);
+				double distance = distance2points(wp_1.pos, closest_p.pos);
+
+				if(pL->id != pL2->id && angle_diff < 0.05 && distance < 3.5 && distance > 2.5)
 				{
-					int iCenter1 = pL->points.size()/2;
-					WayPoint wp_1 = pL->points.at(iCenter1);
-					int iCenter2 = PlanningHelpers::GetClosestNextPointIndexFast(map.roadSegments.at(rs_2).Lanes.at(i2).points, wp_1 );
-					WayPoint closest_p = map.roadSegments.at(rs_2).Lanes.at(i2).points.at(iCenter2);
-					double mid_a1 = wp_1.pos.a;
-					double mid_a2 = closest_p.pos.a;
-					double angle_diff = UtilityH::AngleBetweenTwoAnglesPositive(mid_a1, mid_a2);
-					double distance = distance2points(wp_1.pos, closest_p.pos);
-
-					if(pL->id != map.roadSegments.at(rs_2).Lanes.at(i2).id && angle_diff < 0.05 && distance < 3.5 && distance > 2.5)
+					double perp_distance = DBL_MAX;
+					if(pL->points.size() > 2 && pL2->points.size()>2)
 					{
-						double perp_distance = DBL_MAX;
-						if(pL->points.size() > 2 && map.roadSegments.at(rs_2).Lanes.at(i2).points.size()>2)
-						{
-							RelativeInfo info;
-							PlanningHelpers::GetRelativeInfo(pL->points, closest_p, info);
-							perp_distance = info.perp_distance;
-							//perp_distance = PlanningHelpers::GetPerpDistanceToVectorSimple(pL->points.at(iCenter1-1), pL->points.at(iCenter1+1), closest_p);
-						}
+						RelativeInfo info;
+						PlanningHelpers::GetRelativeInfo(pL->points, closest_p, info);
+						perp_distance = info.perp_distance;
+						//perp_distance = PlanningHelpers::GetPerpDistanceToVectorSimple(pL->points.at(iCenter1-1), pL->points.at(iCenter1+1), closest_p);
+					}
 
-						if(perp_distance > 1.0 && perp_distance < 10.0)
+					if(perp_distance > 1.0 && perp_distance < 10.0)
+					{
+						pL->pRightLane = pL2;
+						for(unsigned int i_internal = 0; i_internal< pL->points.size(); i_internal++)
 						{
-							pL->pRightLane = &map.roadSegments.at(rs_2).Lanes.at(i2);
-							for(unsigned int i_internal = 0; i_internal< pL->points.size(); i_internal++)
+							if(i_internal<pL2->points.size())
 							{
-								if(i_internal<map.roadSegments.at(rs_2).Lanes.at(i2).points.size())
-								{
-									pL->points.at(i_internal).RightPointId = map.roadSegments.at(rs_2).Lanes.at(i2).id;
-									pL->points.at(i_internal).pRight = &map.roadSegments.at(rs_2).Lanes.at(i2).points.at(i_internal);
-//									map.roadSegments.at(rs_2).Lanes.at(i2).points.at(i_internal).pLeft = &pL->points.at(i_internal);
-								}
+								pL->points.at(i_internal).RightPointId = pL2->id;
+								pL->points.at(i_internal).pRight = &pL2->points.at(i_internal);
+//									pL2->points.at(i_internal).pLeft = &pL->points.at(i_internal);
 							}
 						}
-						else if(perp_distance < -1.0 && perp_distance > -10.0)
+					}
+					else if(perp_distance < -1.0 && perp_distance > -10.0)
+					{
+						pL->pLeftLane = pL2;
+						for(unsigned int i_internal = 0; i_internal< pL->points.size(); i_internal++)
 						{
-							pL->pLeftLane = &map.roadSegments.at(rs_2).Lanes.at(i2);
-							for(unsigned int i_internal = 0; i_internal< pL->points.size(); i_internal++)
+							if(i_internal<pL2->points.size())
 							{
-								if(i_internal<map.roadSegments.at(rs_2).Lanes.at(i2).points.size())
-								{
-									pL->points.at(i_internal).LeftPointId = map.roadSegments.at(rs_2).Lanes.at(i2).id;
-									pL->points.at(i_internal).pLeft = &map.roadSegments.at(rs_2).Lanes.at(i2).points.at(i_internal);
-//									map.roadSegments.at(rs_2).Lanes.at(i2).points.at(i_internal).pRight = &pL->points.at(i_internal);
-								}
+								pL->points.at(i_internal).LeftPointId = pL2->id;
+								pL->points.at(i_internal).pLeft = &pL2->points.at(i_internal);
+//									pL2->points.at(i_internal).pRight = &pL->points.at(i_internal);
 							}
 						}
 					}
@@ -2318,6 +2272,9 @@ void MappingHelpers::ConstructRoadNetworkFromRosMessageV2(const std::vector<Util
 	roadSegment1.Lanes = roadLanes;
 	map.roadSegments.push_back(roadSegment1);
 
+	//Index lanes and waypoints for the id and closest lane lookups, lanes are not added or moved after this
+	map.UpdateIndex();
+
 	//Fix angle for lanes
 	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
 	{
@@ -3142,31 +3099,34 @@ void MappingHelpers::FixUnconnectedLanes(std::vector<Lane>& lanes)
 
 void MappingHelpers::LinkLanesPointers(PlannerHNS::RoadNetwork& map)
 {
+	std::vector<Lane*> id_lanes;
 	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
 	{
-		//Link Lanes
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+		std::vector<Lane>& segment_lanes = map.roadSegments.at(rs).Lanes;
+
+		//Link Lanes, ids are resolved through the map index to every lane of this segment with that id
+		for(unsigned int i =0; i < segment_lanes.size(); i++)
 		{
-			Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
+			Lane* pL = &segment_lanes.at(i);
 			for(unsigned int j = 0 ; j < pL->fromIds.size(); j++)
 			{
-				for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
+				id_lanes.clear();
+				map.GetLanesById(pL->fromIds.at(j), id_lanes);
+				for(unsigned int l= 0; l < id_lanes.size(); l++)
 				{
-					if(map.roadSegments.at(rs).Lanes.at(l).id == pL->fromIds.at(j))
-					{
-						pL->fromLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-					}
+					if(id_lanes.at(l) >= &segment_lanes.front() && id_lanes.at(l) <= &segment_lanes.back())
+						pL->fromLanes.push_back(id_lanes.at(l));
 				}
 			}
 
 			for(unsigned int j = 0 ; j < pL->toIds.size(); j++)
 			{
-				for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
+				id_lanes.clear();
+				map.GetLanesById(pL->toIds.at(j), id_lanes);
+				for(unsigned int l= 0; l < id_lanes.size(); l++)
 				{
-					if(map.roadSegments.at(rs).Lanes.at(l).id == pL->toIds.at(j))
-					{
-						pL->toLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-					}
+					if(id_lanes.at(l) >= &segment_lanes.front() && id_lanes.at(l) <= &segment_lanes.back())
+						pL->toLanes.push_back(id_lanes.at(l));
 				}
 			}
 
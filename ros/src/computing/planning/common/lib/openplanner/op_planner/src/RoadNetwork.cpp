@@ -0,0 +1,281 @@
+/// \file RoadNetwork.cpp
+/// \brief Lookup index of the road network, lanes and waypoints by id and lanes by position
+
+
+#include "op_planner/RoadNetwork.h"
+#include <algorithm>
+#include <cmath>
+#include <limits.h>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+static bool CompareLaneId(const pair<int, int>& a, const pair<int, int>& b)
+{
+	return a.first < b.first;
+}
+
+RoadNetwork::RoadNetwork()
+{
+	m_bIndexed = false;
+	m_CellSize = 10.0;
+	m_MinCellX = m_MaxCellX = m_MinCellY = m_MaxCellY = 0;
+}
+
+RoadNetwork::RoadNetwork(const RoadNetwork& other)
+{
+	m_bIndexed = false;
+	m_CellSize = 10.0;
+	m_MinCellX = m_MaxCellX = m_MinCellY = m_MaxCellY = 0;
+	*this = other;
+}
+
+RoadNetwork& RoadNetwork::operator=(const RoadNetwork& other)
+{
+	if(this == &other)
+		return *this;
+
+	roadSegments = other.roadSegments;
+	trafficLights = other.trafficLights;
+	stopLines = other.stopLines;
+	curbs = other.curbs;
+	boundaries = other.boundaries;
+	crossings = other.crossings;
+	markings = other.markings;
+	signs = other.signs;
+
+	//the index of other points into other's lanes, build a new one for the copies
+	if(other.m_bIndexed)
+		UpdateIndex(other.m_CellSize);
+	else
+		ClearIndex();
+
+	return *this;
+}
+
+bool RoadNetwork::CompareWaypointId(const IndexedWaypoint& a, const IndexedWaypoint& b)
+{
+	return a.id < b.id;
+}
+
+long long RoadNetwork::CellKey(const int& cell_x, const int& cell_y)
+{
+	//cells of the same column are contiguous and sorted by y
+	return (long long)cell_x * 4294967296LL + ((long long)cell_y - INT_MIN);
+}
+
+void RoadNetwork::ClearIndex()
+{
+	m_bIndexed = false;
+	m_IndexedLanes.clear();
+	m_LanesById.clear();
+	m_WaypointsById.clear();
+	m_LanesGrid.clear();
+}
+
+void RoadNetwork::UpdateIndex(const double& cellSize)
+{
+	ClearIndex();
+	m_CellSize = cellSize > 0 ? cellSize : 10.0;
+	m_MinCellX = m_MinCellY = INT_MAX;
+	m_MaxCellX = m_MaxCellY = INT_MIN;
+
+	for(unsigned int rs = 0; rs < roadSegments.size(); rs++)
+	{
+		for(unsigned int i = 0; i < roadSegments.at(rs).Lanes.size(); i++)
+			m_IndexedLanes.push_back(&roadSegments.at(rs).Lanes.at(i));
+	}
+
+	for(unsigned int il = 0; il < m_IndexedLanes.size(); il++)
+	{
+		Lane* pL = m_IndexedLanes.at(il);
+		m_LanesById.push_back(make_pair(pL->id, (int)il));
+
+		for(unsigned int ip = 0; ip < pL->points.size(); ip++)
+		{
+			IndexedWaypoint wp;
+			wp.id = pL->points.at(ip).id;
+			wp.iLane = il;
+			wp.iPoint = ip;
+			m_WaypointsById.push_back(wp);
+
+			const GPSPoint& p = pL->points.at(ip).pos;
+			if(!std::isfinite(p.x) || !std::isfinite(p.y))
+				continue;
+
+			int cell_x = (int)floor(p.x / m_CellSize);
+			int cell_y = (int)floor(p.y / m_CellSize);
+			m_LanesGrid.push_back(make_pair(CellKey(cell_x, cell_y), (int)il));
+
+			m_MinCellX = min(m_MinCellX, cell_x);
+			m_MaxCellX = max(m_MaxCellX, cell_x);
+			m_MinCellY = min(m_MinCellY, cell_y);
+			m_MaxCellY = max(m_MaxCellY, cell_y);
+		}
+	}
+
+	//entries were added in map order, a stable sort keeps it for equal ids
+	std::stable_sort(m_LanesById.begin(), m_LanesById.end(), CompareLaneId);
+	std::stable_sort(m_WaypointsById.begin(), m_WaypointsById.end(), CompareWaypointId);
+
+	std::sort(m_LanesGrid.begin(), m_LanesGrid.end());
+	m_LanesGrid.erase(std::unique(m_LanesGrid.begin(), m_LanesGrid.end()), m_LanesGrid.end());
+
+	m_bIndexed = true;
+}
+
+Lane* RoadNetwork::GetLaneById(const int& id)
+{
+	if(!m_bIndexed)
+	{
+		for(unsigned int rs = 0; rs < roadSegments.size(); rs++)
+		{
+			for(unsigned int i = 0; i < roadSegments.at(rs).Lanes.size(); i++)
+			{
+				if(roadSegments.at(rs).Lanes.at(i).id == id)
+					return &roadSegments.at(rs).Lanes.at(i);
+			}
+		}
+		return nullptr;
+	}
+
+	vector<pair<int, int> >::iterator it = std::lower_bound(m_LanesById.begin(), m_LanesById.end(), make_pair(id, 0), CompareLaneId);
+	if(it == m_LanesById.end() || it->first != id)
+		return nullptr;
+
+	return m_IndexedLanes.at(it->second);
+}
+
+void RoadNetwork::GetLanesById(const int& id, std::vector<Lane*>& lanes)
+{
+	if(!m_bIndexed)
+	{
+		for(unsigned int rs = 0; rs < roadSegments.size(); rs++)
+		{
+			for(unsigned int i = 0; i < roadSegments.at(rs).Lanes.size(); i++)
+			{
+				if(roadSegments.at(rs).Lanes.at(i).id == id)
+					lanes.push_back(&roadSegments.at(rs).Lanes.at(i));
+			}
+		}
+		return;
+	}
+
+	pair<vector<pair<int, int> >::iterator, vector<pair<int, int> >::iterator> range =
+			std::equal_range(m_LanesById.begin(), m_LanesById.end(), make_pair(id, 0), CompareLaneId);
+	for(vector<pair<int, int> >::iterator it = range.first; it != range.second; it++)
+		lanes.push_back(m_IndexedLanes.at(it->second));
+}
+
+WayPoint* RoadNetwork::FindWaypoint(const int& id)
+{
+	if(!m_bIndexed)
+	{
+		for(unsigned int rs = 0; rs < roadSegments.size(); rs++)
+		{
+			for(unsigned int i = 0; i < roadSegments.at(rs).Lanes.size(); i++)
+			{
+				Lane* pLane = &roadSegments.at(rs).Lanes.at(i);
+				for(unsigned int p = 0; p < pLane->points.size(); p++)
+				{
+					if(pLane->points.at(p).id == id)
+						return &pLane->points.at(p);
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	IndexedWaypoint key;
+	key.id = id;
+	key.iLane = key.iPoint = 0;
+	vector<IndexedWaypoint>::iterator it = std::lower_bound(m_WaypointsById.begin(), m_WaypointsById.end(), key, CompareWaypointId);
+	if(it == m_WaypointsById.end() || it->id != id)
+		return nullptr;
+
+	return &m_IndexedLanes.at(it->iLane)->points.at(it->iPoint);
+}
+
+WayPoint* RoadNetwork::FindWaypointNotInLane(const int& id, const int& laneId)
+{
+	if(!m_bIndexed)
+	{
+		for(unsigned int rs = 0; rs < roadSegments.size(); rs++)
+		{
+			for(unsigned int i = 0; i < roadSegments.at(rs).Lanes.size(); i++)
+			{
+				Lane* pLane = &roadSegments.at(rs).Lanes.at(i);
+				if(pLane->id == laneId)
+					continue;
+
+				for(unsigned int p = 0; p < pLane->points.size(); p++)
+				{
+					if(pLane->points.at(p).id == id)
+						return &pLane->points.at(p);
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	IndexedWaypoint key;
+	key.id = id;
+	key.iLane = key.iPoint = 0;
+	vector<IndexedWaypoint>::iterator it = std::lower_bound(m_WaypointsById.begin(), m_WaypointsById.end(), key, CompareWaypointId);
+
+	for(; it != m_WaypointsById.end() && it->id == id; it++)
+	{
+		Lane* pLane = m_IndexedLanes.at(it->iLane);
+		if(pLane->id != laneId)
+			return &pLane->points.at(it->iPoint);
+	}
+
+	return nullptr;
+}
+
+void RoadNetwork::GetLanesAround(const GPSPoint& pos, const double& distance, std::vector<Lane*>& lanes)
+{
+	lanes.clear();
+
+	if(!m_bIndexed || !std::isfinite(pos.x) || !std::isfinite(pos.y) || !std::isfinite(distance))
+	{
+		for(unsigned int rs = 0; rs < roadSegments.size(); rs++)
+		{
+			for(unsigned int i = 0; i < roadSegments.at(rs).Lanes.size(); i++)
+				lanes.push_back(&roadSegments.at(rs).Lanes.at(i));
+		}
+		return;
+	}
+
+	if(m_LanesGrid.size() == 0 || distance < 0)
+		return;
+
+	//small margin so points exactly at distance are not lost to rounding
+	double r = distance + 1e-3;
+	double min_x = max(floor((pos.x - r) / m_CellSize), (double)m_MinCellX);
+	double max_x = min(floor((pos.x + r) / m_CellSize), (double)m_MaxCellX);
+	double min_y = max(floor((pos.y - r) / m_CellSize), (double)m_MinCellY);
+	double max_y = min(floor((pos.y + r) / m_CellSize), (double)m_MaxCellY);
+	if(min_x > max_x || min_y > max_y)
+		return;
+
+	vector<int> lane_indices;
+	for(int cell_x = (int)min_x; cell_x <= (int)max_x; cell_x++)
+	{
+		vector<pair<long long, int> >::iterator it = std::lower_bound(m_LanesGrid.begin(), m_LanesGrid.end(),
+				make_pair(CellKey(cell_x, (int)min_y), INT_MIN));
+		long long last_key = CellKey(cell_x, (int)max_y);
+		for(; it != m_LanesGrid.end() && it->first <= last_key; it++)
+			lane_indices.push_back(it->second);
+	}
+
+	std::sort(lane_indices.begin(), lane_indices.end());
+	lane_indices.erase(std::unique(lane_indices.begin(), lane_indices.end()), lane_indices.end());
+
+	for(unsigned int i = 0; i < lane_indices.size(); i++)
+		lanes.push_back(m_IndexedLanes.at(lane_indices.at(i)));
+}
+
+}
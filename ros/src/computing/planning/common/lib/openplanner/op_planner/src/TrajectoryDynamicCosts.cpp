@@ -7,10 +7,16 @@
 #include "op_planner/TrajectoryDynamicCosts.h"
 #include "op_planner/MatrixOperations.h"
 #include "float.h"
+#include <algorithm>
 
 namespace PlannerHNS
 {
 
+// Consecutive roll out points sharing a bounding box in the collision search
+static const int ROLL_OUT_SEGMENT_SIZE = 16;
+// Added to the collision distance when testing the boxes, so that rounding never culls a colliding point
+static const double SEGMENT_BOX_MARGIN = 0.001;
+
 
 TrajectoryDynamicCosts::TrajectoryDynamicCosts()
 {
@@ -322,121 +328,10 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsStatic(vector<T
 	double critical_long_front_distance =  carInfo.wheel_base/2.0 + carInfo.length/2.0 + params.verticalSafetyDistance;
 	double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
 
-	PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-	PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
-
-	double corner_slide_distance = critical_lateral_distance/2.0;
-	double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
-	double slide_distance = vehicleState.steer * ratio_to_angle;
-
-	GPSPoint bottom_left(-critical_lateral_distance ,-critical_long_back_distance,  currState.pos.z, 0);
-	GPSPoint bottom_right(critical_lateral_distance, -critical_long_back_distance,  currState.pos.z, 0);
-
-	GPSPoint top_right_car(critical_lateral_distance, carInfo.wheel_base/3.0 + carInfo.length/3.0,  currState.pos.z, 0);
-	GPSPoint top_left_car(-critical_lateral_distance, carInfo.wheel_base/3.0 + carInfo.length/3.0, currState.pos.z, 0);
-
-	GPSPoint top_right(critical_lateral_distance - slide_distance, critical_long_front_distance,  currState.pos.z, 0);
-	GPSPoint top_left(-critical_lateral_distance - slide_distance , critical_long_front_distance, currState.pos.z, 0);
-
-	bottom_left = invRotationMat*bottom_left;
-	bottom_left = invTranslationMat*bottom_left;
-
-	top_right = invRotationMat*top_right;
-	top_right = invTranslationMat*top_right;
-
-	bottom_right = invRotationMat*bottom_right;
-	bottom_right = invTranslationMat*bottom_right;
-
-	top_left = invRotationMat*top_left;
-	top_left = invTranslationMat*top_left;
-
-	top_right_car = invRotationMat*top_right_car;
-	top_right_car = invTranslationMat*top_right_car;
-
-	top_left_car = invRotationMat*top_left_car;
-	top_left_car = invTranslationMat*top_left_car;
-
-	m_SafetyBorder.points.clear();
-	m_SafetyBorder.points.push_back(bottom_left) ;
-	m_SafetyBorder.points.push_back(bottom_right) ;
-	m_SafetyBorder.points.push_back(top_right_car) ;
-	m_SafetyBorder.points.push_back(top_right) ;
-	m_SafetyBorder.points.push_back(top_left) ;
-	m_SafetyBorder.points.push_back(top_left_car) ;
+	InitializeSafetyPolygon(currState, carInfo, vehicleState, critical_lateral_distance, critical_long_front_distance, critical_long_back_distance);
 
-	int iCostIndex = 0;
 	if(rollOuts.size() > 0 && rollOuts.at(0).size()>0)
-	{
-		RelativeInfo car_info;
-		PlanningHelpers::GetRelativeInfo(totalPaths, currState, car_info);
-
-
-		for(unsigned int it=0; it< rollOuts.size(); it++)
-		{
-			int skip_id = -1;
-			for(unsigned int icon = 0; icon < contourPoints.size(); icon++)
-			{
-				if(skip_id == contourPoints.at(icon).id)
-					continue;
-
-				RelativeInfo obj_info;
-				PlanningHelpers::GetRelativeInfo(totalPaths, contourPoints.at(icon), obj_info);
-				double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPaths, car_info, obj_info);
-				if(obj_info.iFront == 0 && longitudinalDist > 0)
-					longitudinalDist = -longitudinalDist;
-
-				double direct_distance = hypot(obj_info.perp_point.pos.y-contourPoints.at(icon).pos.y, obj_info.perp_point.pos.x-contourPoints.at(icon).pos.x);
-				if(contourPoints.at(icon).v < params.minSpeed && direct_distance > (m_LateralSkipDistance+contourPoints.at(icon).cost))
-				{
-					skip_id = contourPoints.at(icon).id;
-					continue;
-				}
-
-				double close_in_percentage = 1;
-//					close_in_percentage = ((longitudinalDist- critical_long_front_distance)/params.rollInMargin)*4.0;
-//
-//					if(close_in_percentage <= 0 || close_in_percentage > 1) close_in_percentage = 1;
-
-				double distance_from_center = trajectoryCosts.at(iCostIndex).distance_from_center;
-
-				if(close_in_percentage < 1)
-					distance_from_center = distance_from_center - distance_from_center * (1.0-close_in_percentage);
-
-				double lateralDist = fabs(obj_info.perp_distance - distance_from_center);
-
-				if(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance || lateralDist > m_LateralSkipDistance)
-				{
-					continue;
-				}
-
-				longitudinalDist = longitudinalDist - critical_long_front_distance;
-
-				if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, contourPoints.at(icon).pos) == true)
-					trajectoryCosts.at(iCostIndex).bBlocked = true;
-
-				if(lateralDist <= critical_lateral_distance
-						&& longitudinalDist >= -carInfo.length/1.5
-						&& longitudinalDist < params.minFollowingDistance)
-					trajectoryCosts.at(iCostIndex).bBlocked = true;
-
-
-				if(lateralDist != 0)
-					trajectoryCosts.at(iCostIndex).lateral_cost += 1.0/lateralDist;
-
-				if(longitudinalDist != 0)
-					trajectoryCosts.at(iCostIndex).longitudinal_cost += 1.0/fabs(longitudinalDist);
-
-
-				if(longitudinalDist >= -critical_long_front_distance && longitudinalDist < trajectoryCosts.at(iCostIndex).closest_obj_distance)
-				{
-					trajectoryCosts.at(iCostIndex).closest_obj_distance = longitudinalDist;
-					trajectoryCosts.at(iCostIndex).closest_obj_velocity = contourPoints.at(icon).v;
-				}
-			}
-
-			iCostIndex++;
-		}
-	}
+		CalculateRollOutsLateralAndLongitudinalCosts(trajectoryCosts, 0, rollOuts.size(), totalPaths, currState, contourPoints, params, carInfo);
 }
 
 void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost>& trajectoryCosts,
@@ -449,120 +344,106 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<Traject
 	double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
 	int iCostIndex = 0;
 
-	PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-	PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
-
-	double corner_slide_distance = critical_lateral_distance/2.0;
-	double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
-	double slide_distance = vehicleState.steer * ratio_to_angle;
-
-	GPSPoint bottom_left(-critical_lateral_distance ,-critical_long_back_distance,  currState.pos.z, 0);
-	GPSPoint bottom_right(critical_lateral_distance, -critical_long_back_distance,  currState.pos.z, 0);
-
-	GPSPoint top_right_car(critical_lateral_distance, carInfo.wheel_base/3.0 + carInfo.length/3.0,  currState.pos.z, 0);
-	GPSPoint top_left_car(-critical_lateral_distance, carInfo.wheel_base/3.0 + carInfo.length/3.0, currState.pos.z, 0);
-
-	GPSPoint top_right(critical_lateral_distance - slide_distance, critical_long_front_distance,  currState.pos.z, 0);
-	GPSPoint top_left(-critical_lateral_distance - slide_distance , critical_long_front_distance, currState.pos.z, 0);
-
-	bottom_left = invRotationMat*bottom_left;
-	bottom_left = invTranslationMat*bottom_left;
-
-	top_right = invRotationMat*top_right;
-	top_right = invTranslationMat*top_right;
-
-	bottom_right = invRotationMat*bottom_right;
-	bottom_right = invTranslationMat*bottom_right;
-
-	top_left = invRotationMat*top_left;
-	top_left = invTranslationMat*top_left;
-
-	top_right_car = invRotationMat*top_right_car;
-	top_right_car = invTranslationMat*top_right_car;
-
-	top_left_car = invRotationMat*top_left_car;
-	top_left_car = invTranslationMat*top_left_car;
-
-	m_SafetyBorder.points.clear();
-	m_SafetyBorder.points.push_back(bottom_left) ;
-	m_SafetyBorder.points.push_back(bottom_right) ;
-	m_SafetyBorder.points.push_back(top_right_car) ;
-	m_SafetyBorder.points.push_back(top_right) ;
-	m_SafetyBorder.points.push_back(top_left) ;
-	m_SafetyBorder.points.push_back(top_left_car) ;
+	InitializeSafetyPolygon(currState, carInfo, vehicleState, critical_lateral_distance, critical_long_front_distance, critical_long_back_distance);
 
 	for(unsigned int il=0; il < rollOuts.size(); il++)
 	{
 		if(rollOuts.at(il).size() > 0 && rollOuts.at(il).at(0).size()>0)
 		{
-			RelativeInfo car_info;
-			PlanningHelpers::GetRelativeInfo(totalPaths.at(il), currState, car_info);
-
-
-			for(unsigned int it=0; it< rollOuts.at(il).size(); it++)
-			{
-				int skip_id = -1;
-				for(unsigned int icon = 0; icon < contourPoints.size(); icon++)
-				{
-					if(skip_id == contourPoints.at(icon).id)
-						continue;
-
-					RelativeInfo obj_info;
-					PlanningHelpers::GetRelativeInfo(totalPaths.at(il), contourPoints.at(icon), obj_info);
-					double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPaths.at(il), car_info, obj_info);
-					if(obj_info.iFront == 0 && longitudinalDist > 0)
-						longitudinalDist = -longitudinalDist;
-
-					double direct_distance = hypot(obj_info.perp_point.pos.y-contourPoints.at(icon).pos.y, obj_info.perp_point.pos.x-contourPoints.at(icon).pos.x);
-					if(contourPoints.at(icon).v < params.minSpeed && direct_distance > (m_LateralSkipDistance+contourPoints.at(icon).cost))
-					{
-						skip_id = contourPoints.at(icon).id;
-						continue;
-					}
+			CalculateRollOutsLateralAndLongitudinalCosts(trajectoryCosts, iCostIndex, rollOuts.at(il).size(), totalPaths.at(il), currState, contourPoints, params, carInfo);
+			iCostIndex += rollOuts.at(il).size();
+		}
+	}
+}
 
-					double close_in_percentage = 1;
-//					close_in_percentage = ((longitudinalDist- critical_long_front_distance)/params.rollInMargin)*4.0;
-//
-//					if(close_in_percentage <= 0 || close_in_percentage > 1) close_in_percentage = 1;
+/**
+ * @brief Lateral and longitudinal costs of the nRollOuts roll outs of one lane, starting at trajectoryCosts[iFirstCost].
+ * The contour points are projected on the lane path once, then the roll outs are evaluated in parallel.
+ */
+void TrajectoryDynamicCosts::CalculateRollOutsLateralAndLongitudinalCosts(vector<TrajectoryCost>& trajectoryCosts,
+		const int& iFirstCost, const int& nRollOuts, const vector<WayPoint>& totalPath,
+		const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params,
+		const CAR_BASIC_INFO& carInfo)
+{
+	double critical_lateral_distance =  carInfo.width/2.0 + params.horizontalSafetyDistancel;
+	double critical_long_front_distance =  carInfo.wheel_base/2.0 + carInfo.length/2.0 + params.verticalSafetyDistance;
 
-					double distance_from_center = trajectoryCosts.at(iCostIndex).distance_from_center;
+	RelativeInfo car_info;
+	PlanningHelpers::GetRelativeInfo(totalPath, currState, car_info);
 
-					if(close_in_percentage < 1)
-						distance_from_center = distance_from_center - distance_from_center * (1.0-close_in_percentage);
+	int nContourPoints = contourPoints.size();
+	m_ContourInfo.resize(nContourPoints);
 
-					double lateralDist = fabs(obj_info.perp_distance - distance_from_center);
+	#pragma omp parallel for
+	for(int icon = 0; icon < nContourPoints; icon++)
+	{
+		const WayPoint& contour_p = contourPoints.at(icon);
+		ContourPointInfo& info = m_ContourInfo.at(icon);
+
+		RelativeInfo obj_info;
+		PlanningHelpers::GetRelativeInfo(totalPath, contour_p, obj_info);
+		double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPath, car_info, obj_info);
+		if(obj_info.iFront == 0 && longitudinalDist > 0)
+			longitudinalDist = -longitudinalDist;
+
+		double direct_distance = hypot(obj_info.perp_point.pos.y-contour_p.pos.y, obj_info.perp_point.pos.x-contour_p.pos.x);
+		info.bSkip = contour_p.v < params.minSpeed && direct_distance > (m_LateralSkipDistance+contour_p.cost);
+		info.bInRange = !(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance);
+		info.perp_distance = obj_info.perp_distance;
+		info.longitudinal_distance = longitudinalDist - critical_long_front_distance;
+		info.velocity = contour_p.v;
+		info.bInsideSafetyBorder = m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, contour_p.pos) == true;
+	}
 
-					if(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance || lateralDist > m_LateralSkipDistance)
-					{
-						continue;
-					}
+	// The rest of the contour of a skipped object is ignored, keep the points that can reach a roll out
+	vector<int> candidates;
+	int skip_id = -1;
+	for(int icon = 0; icon < nContourPoints; icon++)
+	{
+		if(skip_id == contourPoints.at(icon).id)
+			continue;
 
-					longitudinalDist = longitudinalDist - critical_long_front_distance;
+		if(m_ContourInfo.at(icon).bSkip)
+		{
+			skip_id = contourPoints.at(icon).id;
+			continue;
+		}
 
-					if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, contourPoints.at(icon).pos) == true)
-						trajectoryCosts.at(iCostIndex).bBlocked = true;
+		if(m_ContourInfo.at(icon).bInRange)
+			candidates.push_back(icon);
+	}
 
-					if(lateralDist <= critical_lateral_distance
-							&& longitudinalDist >= -carInfo.length/1.5
-							&& longitudinalDist < params.minFollowingDistance)
-						trajectoryCosts.at(iCostIndex).bBlocked = true;
+	#pragma omp parallel for
+	for(int it = 0; it < nRollOuts; it++)
+	{
+		TrajectoryCost& tc = trajectoryCosts.at(iFirstCost + it);
+		for(unsigned int ic = 0; ic < candidates.size(); ic++)
+		{
+			const ContourPointInfo& info = m_ContourInfo.at(candidates.at(ic));
+			double lateralDist = fabs(info.perp_distance - tc.distance_from_center);
+			if(lateralDist > m_LateralSkipDistance)
+				continue;
 
+			double longitudinalDist = info.longitudinal_distance;
 
-					if(lateralDist != 0)
-						trajectoryCosts.at(iCostIndex).lateral_cost += 1.0/lateralDist;
+			if(info.bInsideSafetyBorder)
+				tc.bBlocked = true;
 
-					if(longitudinalDist != 0)
-						trajectoryCosts.at(iCostIndex).longitudinal_cost += 1.0/fabs(longitudinalDist);
+			if(lateralDist <= critical_lateral_distance
+					&& longitudinalDist >= -carInfo.length/1.5
+					&& longitudinalDist < params.minFollowingDistance)
+				tc.bBlocked = true;
 
+			if(lateralDist != 0)
+				tc.lateral_cost += 1.0/lateralDist;
 
-					if(longitudinalDist >= -critical_long_front_distance && longitudinalDist < trajectoryCosts.at(iCostIndex).closest_obj_distance)
-					{
-						trajectoryCosts.at(iCostIndex).closest_obj_distance = longitudinalDist;
-						trajectoryCosts.at(iCostIndex).closest_obj_velocity = contourPoints.at(icon).v;
-					}
-				}
+			if(longitudinalDist != 0)
+				tc.longitudinal_cost += 1.0/fabs(longitudinalDist);
 
-				iCostIndex++;
+			if(longitudinalDist >= -critical_long_front_distance && longitudinalDist < tc.closest_obj_distance)
+			{
+				tc.closest_obj_distance = longitudinalDist;
+				tc.closest_obj_velocity = info.velocity;
 			}
 		}
 	}
@@ -690,27 +571,35 @@ bool TrajectoryDynamicCosts::ValidateRollOutsInput(const vector<vector<vector<Wa
 	return true;
 }
 
-void TrajectoryDynamicCosts::CalculateIntersectionVelocities(const std::vector<PlannerHNS::WayPoint>& path, const PlannerHNS::DetectedObject& obj, const WayPoint& currPose, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts)
+void TrajectoryDynamicCosts::CalculateIntersectionVelocities(const std::vector<PlannerHNS::WayPoint>& path, const std::vector<PathSegmentBox>& segments, const PlannerHNS::DetectedObject& obj, const WayPoint& currPose, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts)
 {
 	trajectoryCosts.bBlocked = false;
 	int closest_path_i = path.size();
+	double box_margin = c_lateral_d + SEGMENT_BOX_MARGIN;
 	for(unsigned int k = 0; k < obj.predTrajectories.size(); k++)
 	{
 		for(unsigned int j = 0; j < obj.predTrajectories.at(k).size(); j++)
 		{
-			for(unsigned int i = 0; i < path.size(); i++)
+			const WayPoint& pred_p = obj.predTrajectories.at(k).at(j);
+
+			// only the closest path point within the lateral distance matters, and none of a box farther than it
+			for(unsigned int is = 0; is < segments.size() && segments.at(is).iStart < closest_path_i; is++)
 			{
-				//if(path.at(i).timeCost > -1)
-				{
-					double collision_distance = hypot(path.at(i).pos.x-obj.predTrajectories.at(k).at(j).pos.x, path.at(i).pos.y-obj.predTrajectories.at(k).at(j).pos.y);
-					double collision_t = fabs(path.at(i).timeCost - obj.predTrajectories.at(k).at(j).timeCost);
+				const PathSegmentBox& box = segments.at(is);
+				if(pred_p.pos.x < box.min_x - box_margin || pred_p.pos.x > box.max_x + box_margin
+						|| pred_p.pos.y < box.min_y - box_margin || pred_p.pos.y > box.max_y + box_margin)
+					continue;
 
+				for(int i = box.iStart; i < box.iEnd && i < closest_path_i; i++)
+				{
+					double collision_distance = hypot(path.at(i).pos.x-pred_p.pos.x, path.at(i).pos.y-pred_p.pos.y);
 					//if(collision_distance <= c_lateral_d && i < closest_path_i && collision_t < m_CollisionTimeDiff)
-					if(collision_distance <= c_lateral_d && i < closest_path_i)
+					if(collision_distance <= c_lateral_d)
 					{
+						double collision_t = fabs(path.at(i).timeCost - pred_p.timeCost);
 
 						closest_path_i = i;
-						double a = UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(path.at(i).pos.a, obj.predTrajectories.at(k).at(j).pos.a)/M_PI;
+						double a = UtilityHNS::UtilityH::AngleBetweenTwoAnglesPositive(path.at(i).pos.a, pred_p.pos.a)/M_PI;
 						if(a < 0.25 && (currPose.v - obj.center.v) > 0)
 							trajectoryCosts.closest_obj_velocity = (currPose.v - obj.center.v);
 						else
@@ -807,6 +696,37 @@ void TrajectoryDynamicCosts::InitializeSafetyPolygon(const WayPoint& currState,
 	m_SafetyBorder.points.push_back(top_left_car) ;
 }
 
+void TrajectoryDynamicCosts::InitializeRollOutSegments(const vector<vector<WayPoint> >& rollOuts)
+{
+	m_RollOutSegments.resize(rollOuts.size());
+	for(unsigned int ir=0; ir < rollOuts.size(); ir++)
+	{
+		const vector<WayPoint>& path = rollOuts.at(ir);
+		vector<PathSegmentBox>& segments = m_RollOutSegments.at(ir);
+		segments.clear();
+		for(int iStart = 0; iStart < (int)path.size(); iStart += ROLL_OUT_SEGMENT_SIZE)
+		{
+			PathSegmentBox box;
+			box.iStart = iStart;
+			box.iEnd = std::min(iStart + ROLL_OUT_SEGMENT_SIZE, (int)path.size());
+			box.min_x = box.min_y = DBL_MAX;
+			box.max_x = box.max_y = -DBL_MAX;
+			for(int i = box.iStart; i < box.iEnd; i++)
+			{
+				box.min_x = std::min(box.min_x, path.at(i).pos.x);
+				box.min_y = std::min(box.min_y, path.at(i).pos.y);
+				box.max_x = std::max(box.max_x, path.at(i).pos.x);
+				box.max_y = std::max(box.max_y, path.at(i).pos.y);
+			}
+			segments.push_back(box);
+		}
+	}
+}
+
+/**
+ * @brief Collision costs of the roll outs with the detected objects, following their predicted trajectories when they move.
+ * Objects are processed in the list order, which the costs depend on, but each roll out is evaluated independently in parallel.
+ */
 void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const std::vector<PlannerHNS::DetectedObject>& obj_list, const vector<vector<WayPoint> >& rollOuts, const vector<WayPoint>& totalPaths,
 		const WayPoint& currState, const PlanningParams& params, const CAR_BASIC_INFO& carInfo,
 		const VehicleState& vehicleState, const double& c_lateral_d, const double& c_long_front_d, const double& c_long_back_d )
@@ -816,7 +736,13 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const s
 	PlanningHelpers::GetRelativeInfo(totalPaths, currState, car_info);
 	m_CollisionPoints.clear();
 
-	for(unsigned int i=0; i < obj_list.size(); i++)
+	// Objects to evaluate, in order. A static contour point inside the safety border blocks every roll out
+	// and ends the evaluation, the objects after it are never considered.
+	vector<int> objects;
+	vector<int> contour_ends(obj_list.size(), 0);
+	bool bAllBlocked = false;
+	m_ContourInfo.clear();
+	for(unsigned int i=0; i < obj_list.size() && !bAllBlocked; i++)
 	{
 		if(obj_list.at(i).label.compare("curb") == 0)
 		{
@@ -825,14 +751,105 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const s
 				continue;
 		}
 
+		objects.push_back(i);
 		if(obj_list.at(i).bVelocity && obj_list.at(i).predTrajectories.size() > 0) // dynamic
+			continue;
+
+		ContourPointInfo info;
+		info.obj_index = i;
+		info.velocity = obj_list.at(i).center.v;
+		for(unsigned int icon = 0; icon < obj_list.at(i).contour.size(); icon++)
 		{
+			if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, obj_list.at(i).contour.at(icon)) == true)
+			{
+				bAllBlocked = true;
+				break;
+			}
 
-			for(unsigned int ir=0; ir < rollOuts.size(); ir++)
+			info.contour_index = icon;
+			m_ContourInfo.push_back(info);
+		}
+		contour_ends.at(i) = m_ContourInfo.size();
+	}
+
+	// Projection of the static contour points on the path, the same for all the roll outs
+	int nContourPoints = m_ContourInfo.size();
+	#pragma omp parallel for
+	for(int ic = 0; ic < nContourPoints; ic++)
+	{
+		ContourPointInfo& info = m_ContourInfo.at(ic);
+		WayPoint corner_p;
+		corner_p.pos = obj_list.at(info.obj_index).contour.at(info.contour_index);
+
+		RelativeInfo obj_info;
+		PlanningHelpers::GetRelativeInfo(totalPaths, corner_p, obj_info);
+		double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPaths, car_info, obj_info);
+		if(obj_info.iFront == 0 && longitudinalDist > 0)
+			longitudinalDist = -longitudinalDist;
+
+		info.bInRange = !(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance);
+		info.perp_distance = obj_info.perp_distance;
+		info.longitudinal_distance = longitudinalDist - c_long_front_d;
+		info.perp_point = obj_info.perp_point;
+	}
+
+	// Bounding boxes of the predicted trajectories, an object farther than the lateral distance from a roll out can't collide with it
+	vector<PathSegmentBox> prediction_boxes(obj_list.size());
+	for(unsigned int io = 0; io < objects.size(); io++)
+	{
+		const DetectedObject& obj = obj_list.at(objects.at(io));
+		PathSegmentBox& box = prediction_boxes.at(objects.at(io));
+		box.min_x = box.min_y = DBL_MAX;
+		box.max_x = box.max_y = -DBL_MAX;
+		for(unsigned int k = 0; k < obj.predTrajectories.size(); k++)
+		{
+			for(unsigned int j = 0; j < obj.predTrajectories.at(k).size(); j++)
 			{
+				box.min_x = std::min(box.min_x, obj.predTrajectories.at(k).at(j).pos.x);
+				box.min_y = std::min(box.min_y, obj.predTrajectories.at(k).at(j).pos.y);
+				box.max_x = std::max(box.max_x, obj.predTrajectories.at(k).at(j).pos.x);
+				box.max_y = std::max(box.max_y, obj.predTrajectories.at(k).at(j).pos.y);
+			}
+		}
+	}
+
+	InitializeRollOutSegments(rollOuts);
+	m_RollOutCollisionPoints.resize(rollOuts.size());
+	double box_margin = c_lateral_d + SEGMENT_BOX_MARGIN;
+
+	int nRollOuts = rollOuts.size();
+	#pragma omp parallel for
+	for(int ir=0; ir < nRollOuts; ir++)
+	{
+		TrajectoryCost& tc = m_TrajectoryCosts.at(ir);
+		vector<CollisionPointEntry>& collision_points = m_RollOutCollisionPoints.at(ir);
+		collision_points.clear();
+
+		PathSegmentBox rollout_box;
+		rollout_box.min_x = rollout_box.min_y = DBL_MAX;
+		rollout_box.max_x = rollout_box.max_y = -DBL_MAX;
+		for(unsigned int is = 0; is < m_RollOutSegments.at(ir).size(); is++)
+		{
+			rollout_box.min_x = std::min(rollout_box.min_x, m_RollOutSegments.at(ir).at(is).min_x);
+			rollout_box.min_y = std::min(rollout_box.min_y, m_RollOutSegments.at(ir).at(is).min_y);
+			rollout_box.max_x = std::max(rollout_box.max_x, m_RollOutSegments.at(ir).at(is).max_x);
+			rollout_box.max_y = std::max(rollout_box.max_y, m_RollOutSegments.at(ir).at(is).max_y);
+		}
+
+		int ic = 0;
+		for(unsigned int io = 0; io < objects.size(); io++)
+		{
+			int i = objects.at(io);
+			if(obj_list.at(i).bVelocity && obj_list.at(i).predTrajectories.size() > 0) // dynamic
+			{
+				const PathSegmentBox& box = prediction_boxes.at(i);
+				if(box.min_x > rollout_box.max_x + box_margin || box.max_x < rollout_box.min_x - box_margin
+						|| box.min_y > rollout_box.max_y + box_margin || box.max_y < rollout_box.min_y - box_margin)
+					continue;
+
 				WayPoint collisionPoint;
 				TrajectoryCost trajectoryCosts;
-				CalculateIntersectionVelocities(rollOuts.at(ir), obj_list.at(i), currState, carInfo, c_lateral_d, collisionPoint,trajectoryCosts);
+				CalculateIntersectionVelocities(rollOuts.at(ir), m_RollOutSegments.at(ir), obj_list.at(i), currState, carInfo, c_lateral_d, collisionPoint,trajectoryCosts);
 				if(trajectoryCosts.bBlocked)
 				{
 					RelativeInfo col_info;
@@ -847,71 +864,63 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const s
 
 					//std::cout << "LongDistance: " << longitudinalDist << std::endl;
 
-					if(longitudinalDist >= -c_long_front_d && longitudinalDist < m_TrajectoryCosts.at(ir).closest_obj_distance)
-						m_TrajectoryCosts.at(ir).closest_obj_distance = longitudinalDist;
+					if(longitudinalDist >= -c_long_front_d && longitudinalDist < tc.closest_obj_distance)
+						tc.closest_obj_distance = longitudinalDist;
 
-					m_TrajectoryCosts.at(ir).closest_obj_velocity = trajectoryCosts.closest_obj_velocity;
-					m_TrajectoryCosts.at(ir).bBlocked = true;
+					tc.closest_obj_velocity = trajectoryCosts.closest_obj_velocity;
+					tc.bBlocked = true;
 
-					m_CollisionPoints.push_back(collisionPoint);
+					CollisionPointEntry entry = {i, 0, ir, collisionPoint};
+					collision_points.push_back(entry);
 				}
 			}
-		}
-		else
-		{
-			RelativeInfo obj_info;
-			WayPoint corner_p;
-			for(unsigned int icon = 0; icon < obj_list.at(i).contour.size(); icon++)
+			else
 			{
-				if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, obj_list.at(i).contour.at(icon)) == true)
+				for(; ic < contour_ends.at(i); ic++)
 				{
-					for(unsigned int it=0; it< rollOuts.size(); it++)
-						m_TrajectoryCosts.at(it).bBlocked = true;
-
-					return;
-				}
-
-				corner_p.pos = obj_list.at(i).contour.at(icon);
-				PlanningHelpers::GetRelativeInfo(totalPaths, corner_p, obj_info);
-				double longitudinalDist = PlanningHelpers::GetExactDistanceOnTrajectory(totalPaths, car_info, obj_info);
-				if(obj_info.iFront == 0 && longitudinalDist > 0)
-					longitudinalDist = -longitudinalDist;
-
-
-				if(longitudinalDist < -carInfo.length || longitudinalDist > params.minFollowingDistance)
-					continue;
-
-				longitudinalDist = longitudinalDist - c_long_front_d;
+					const ContourPointInfo& info = m_ContourInfo.at(ic);
+					if(!info.bInRange)
+						continue;
 
-				for(unsigned int it=0; it< rollOuts.size(); it++)
-				{
-					double lateralDist = fabs(obj_info.perp_distance - m_TrajectoryCosts.at(it).distance_from_center);
+					double longitudinalDist = info.longitudinal_distance;
+					double lateralDist = fabs(info.perp_distance - tc.distance_from_center);
 
 					if(lateralDist > m_LateralSkipDistance)
 						continue;
 
 					if(lateralDist <= c_lateral_d && longitudinalDist > -carInfo.length && longitudinalDist < params.minFollowingDistance)
 					{
-						m_TrajectoryCosts.at(it).bBlocked = true;
-						m_CollisionPoints.push_back(obj_info.perp_point);
+						tc.bBlocked = true;
+						CollisionPointEntry entry = {i, info.contour_index, ir, info.perp_point};
+						collision_points.push_back(entry);
 					}
 
 					if(lateralDist != 0)
-						m_TrajectoryCosts.at(it).lateral_cost += 1.0/lateralDist;
+						tc.lateral_cost += 1.0/lateralDist;
 
 					if(longitudinalDist != 0)
-						m_TrajectoryCosts.at(it).longitudinal_cost += 1.0/fabs(longitudinalDist);
+						tc.longitudinal_cost += 1.0/fabs(longitudinalDist);
 
-					if(longitudinalDist >= -c_long_front_d && longitudinalDist < m_TrajectoryCosts.at(it).closest_obj_distance)
+					if(longitudinalDist >= -c_long_front_d && longitudinalDist < tc.closest_obj_distance)
 					{
-						m_TrajectoryCosts.at(it).closest_obj_distance = longitudinalDist;
-						m_TrajectoryCosts.at(it).closest_obj_velocity = obj_list.at(i).center.v;
+						tc.closest_obj_distance = longitudinalDist;
+						tc.closest_obj_velocity = info.velocity;
 					}
 				}
 			}
-
 		}
+
+		if(bAllBlocked)
+			tc.bBlocked = true;
 	}
+
+	// Collision points in the order of the serial evaluation
+	vector<CollisionPointEntry> all_collision_points;
+	for(unsigned int ir=0; ir < m_RollOutCollisionPoints.size(); ir++)
+		all_collision_points.insert(all_collision_points.end(), m_RollOutCollisionPoints.at(ir).begin(), m_RollOutCollisionPoints.at(ir).end());
+	std::sort(all_collision_points.begin(), all_collision_points.end());
+	for(unsigned int i=0; i < all_collision_points.size(); i++)
+		m_CollisionPoints.push_back(all_collision_points.at(i).p);
 }
 
 }
@@ -1,4 +1,4 @@
-#include "astar_search.h"
+#include "astar_planner/astar_search.h"
 #include "search_info_ros.h"
 #include "autoware_msgs/LaneArray.h"
 
@@ -39,7 +39,7 @@ int main(int argc, char **argv)
   private_nh_.param<double>("waypoint_velocity_kmph", waypoint_velocity_kmph, 5.0);
   private_nh_.param<std::string>("map_topic", map_topic, "ring_ogm");
 
-  AstarSearch astar;
+  astar_planner::AstarSearch astar;
   SearchInfo search_info;
 
   // ROS subscribers
@@ -50,7 +50,6 @@ int main(int argc, char **argv)
   // ROS publishers
   ros::Publisher path_pub       = n.advertise<nav_msgs::Path>("astar_path", 1, true);
   ros::Publisher waypoints_pub  = n.advertise<autoware_msgs::LaneArray>("lane_waypoints_array", 1, true);
-  ros::Publisher debug_pose_pub = n.advertise<geometry_msgs::PoseArray>("debug_pose_array", 1, true);
 
   ros::Rate loop_rate(10);
   while (ros::ok()) {
@@ -79,7 +78,6 @@ int main(int argc, char **argv)
       publishPathAsWaypoints(waypoints_pub, astar.getPath(), waypoint_velocity_kmph);
 
 #if DEBUG
-      astar.publishPoseArray(debug_pose_pub, "/map");
       path_pub.publish(astar.getPath());
       astar.broadcastPathTF();
 #endif
@@ -88,7 +86,6 @@ int main(int argc, char **argv)
       ROS_INFO("can't find goal...");
 
 #if DEBUG
-      astar.publishPoseArray(debug_pose_pub, "/map"); // debug
       path_pub.publish(astar.getPath());
 #endif
 
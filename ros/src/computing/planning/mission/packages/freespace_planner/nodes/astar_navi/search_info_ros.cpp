@@ -31,7 +31,7 @@ void SearchInfo::mapCallback(const nav_msgs::OccupancyGridConstPtr &msg)
   }
 
   tf::Transform map2ogm;
-  geometry_msgs::Pose ogm_in_map = astar::transformPose(map_.info.origin, map2ogm_frame);
+  geometry_msgs::Pose ogm_in_map = astar_planner::transformPose(map_.info.origin, map2ogm_frame);
   tf::poseMsgToTF(ogm_in_map, map2ogm);
   ogm2map_ = map2ogm.inverse();
 
@@ -46,7 +46,7 @@ void SearchInfo::startCallback(const geometry_msgs::PoseWithCovarianceStampedCon
 
   start_pose_global_.header = msg->header;
   start_pose_global_.pose   = msg->pose.pose;
-  start_pose_local_.pose    = astar::transformPose(start_pose_global_.pose, ogm2map_);
+  start_pose_local_.pose    = astar_planner::transformPose(start_pose_global_.pose, ogm2map_);
   start_pose_local_.header  = start_pose_global_.header;
 
   start_set_ = true;
@@ -59,7 +59,7 @@ void SearchInfo::currentPoseCallback(const geometry_msgs::PoseStampedConstPtr &m
     return;
 
   start_pose_global_ = *msg;
-  start_pose_local_.pose = astar::transformPose(start_pose_global_.pose, ogm2map_);
+  start_pose_local_.pose = astar_planner::transformPose(start_pose_global_.pose, ogm2map_);
 
   start_set_ = true;
 }
@@ -90,9 +90,9 @@ void SearchInfo::goalCallback(const geometry_msgs::PoseStampedConstPtr &msg)
 
   // Set pose in Global frame
   geometry_msgs::Pose msg_pose = msg->pose;
-  goal_pose_global_.pose   = astar::transformPose(msg_pose, map2world);
+  goal_pose_global_.pose   = astar_planner::transformPose(msg_pose, map2world);
   goal_pose_global_.header = msg->header;
-  goal_pose_local_.pose    = astar::transformPose(goal_pose_global_.pose, ogm2map_);
+  goal_pose_local_.pose    = astar_planner::transformPose(goal_pose_global_.pose, ogm2map_);
   goal_pose_local_.header = goal_pose_global_.header;
 
   goal_set_ = true;
@@ -1,7 +1,7 @@
 #ifndef SEARCH_INFO_ROS_H
 #define SEARCH_INFO_ROS_H
 
-#include "astar_util.h"
+#include "astar_planner/astar_util.h"
 
 #include <nav_msgs/OccupancyGrid.h>
 #include <geometry_msgs/PoseStamped.h>
@@ -31,7 +31,7 @@
 #ifndef ASTAR_NAVI_NODE_H
 #define ASTAR_NAVI_NODE_H
 
-#include "astar_util.h"
+#include "astar_planner/astar_util.h"
 #include <ros/ros.h>
 #include <nav_msgs/OccupancyGrid.h>
 #include <geometry_msgs/PoseArray.h>
@@ -74,8 +74,9 @@ public:
 
 private:
   bool search();
-  // void createStateUpdateTable(int angle_size);
+  void createStateUpdateTable(int angle_size);
   void createStateUpdateTableLocal(int angle_size);  //
+  void createFootprintMasks();
   void poseToIndex(const geometry_msgs::Pose &pose, int *index_x, int *index_y, int *index_theta);
   bool isOutOfRange(int index_x, int index_y);
   void setPath(const SimpleNode &goal);
@@ -85,9 +86,23 @@ private:
   bool isGoal(double x, double y, double theta);
   bool isObs(int index_x, int index_y);
   bool detectCollision(const SimpleNode &sn);
+  bool detectCollision(int index_x, int index_y, const std::vector<CellOffset> &mask, double mask_radius);
   bool calcWaveFrontHeuristic(const SimpleNode &sn);
   bool detectCollisionWaveFront(const WaveFrontNode &sn);
 
+  // Node of the flat arena, status and hc of a node from a previous search are cleared on first access
+  AstarNode &getNode(int index_x, int index_y, int index_theta)
+  {
+    AstarNode &node = nodes_[(static_cast<size_t>(index_y) * node_width_ + index_x) * angle_size_ + index_theta];
+    if (node.generation != generation_)
+    {
+      node.status = STATUS::NONE;
+      node.hc = 0;
+      node.generation = generation_;
+    }
+    return node;
+  }
+
   // for debug
   ros::NodeHandle n_;
   geometry_msgs::PoseArray debug_poses_;
@@ -116,14 +131,37 @@ private:
   double longitudinal_goal_range_;
   double goal_angle_range_;
   bool publish_marker_;
+  double openlist_bucket_width_;  // 0 for an exact binary heap
+  bool use_local_state_update_;   // forward only updates of obstacle avoidance, or forward and back at max steering
+  bool use_footprint_collision_;  // check the whole footprint of each expanded node, not only its cell
+  bool unknown_as_obstacle_;      // cells of unknown cost (< 0) are obstacles
+  double goal_radius_;            // [meter] when positive, the goal is a circle instead of lateral/longitudinal ranges
+  double goal_angle_;             // [degree] angle tolerance of the goal circle
+  bool use_anytime_search_;       // keep improving the first path found until time_limit and return the best one
 
   bool node_initialized_;
   std::vector<std::vector<NodeUpdate>> state_update_table_;
   nav_msgs::MapMetaData map_info_;
-  std::vector<std::vector<std::vector<AstarNode>>> nodes_;
-  std::priority_queue<SimpleNode, std::vector<SimpleNode>, std::greater<SimpleNode>> openlist_;
+  std::vector<AstarNode> nodes_;  // height x width x angle_size, theta is the fastest index
+  size_t node_width_;
+  unsigned int generation_;  // incremented by reset() instead of clearing every node
+  OpenList openlist_;
   std::vector<SimpleNode> goallist_;
 
+  // Obstacle cells of the map, with a border of obstacles one cell wide around it
+  std::vector<uint8_t> obstacle_map_;
+  // Distance in cells from each cell of obstacle_map_ to the nearest obstacle, or to the border of the map
+  std::vector<float> obstacle_distance_;
+  bool obstacle_distance_valid_;
+  size_t obstacle_map_width_;
+
+  // Cells covered by the footprint for each heading bin, relative to the base_link cell
+  std::vector<std::vector<CellOffset>> footprint_masks_;
+  double footprint_mask_radius_;  // [cell] farthest cell of the masks from base_link
+  std::vector<CellOffset> wavefront_mask_;
+  double wavefront_mask_radius_;
+  double footprint_resolution_;  // resolution the masks were made for
+
   // Pose in global(/map) frame
   geometry_msgs::PoseStamped start_pose_;
   geometry_msgs::PoseStamped goal_pose_;
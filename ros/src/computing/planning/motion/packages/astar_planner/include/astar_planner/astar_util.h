@@ -33,6 +33,9 @@
 
 #include <tf/transform_listener.h>
 
+#include <queue>
+#include <vector>
+
 namespace astar_planner
 {
 enum class STATUS : uint8_t
@@ -52,6 +55,7 @@ struct AstarNode
   double move_distance = 0;      // actual move distance
   bool back;                     // true if the current direction of the vehicle is back
   AstarNode *parent = NULL;      // parent node
+  unsigned int generation = 0;   // search generation in which status and hc were last valid
 };
 
 struct WaveFrontNode
@@ -92,6 +96,53 @@ struct SimpleNode
   SimpleNode(int x, int y, int theta, double gc, double hc);
 };
 
+// Open list of the A* search, popping the node of minimum cost.
+// With a positive bucket width, costs are quantized into buckets instead of kept in a binary heap:
+// push and pop are O(1), but the nodes of a bucket are popped in LIFO order, not by exact cost.
+class OpenList
+{
+public:
+  OpenList();
+
+  void setBucketWidth(double bucket_width);
+  void push(const SimpleNode &sn);
+  SimpleNode pop();
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+  void clear();
+
+private:
+  double bucket_width_;
+  size_t size_;
+  std::priority_queue<SimpleNode, std::vector<SimpleNode>, std::greater<SimpleNode>> heap_;
+  std::vector<std::vector<SimpleNode>> buckets_;
+  size_t min_bucket_;  // no bucket below this one holds a node
+  size_t max_bucket_;  // highest bucket used since the last clear
+};
+
+// Cell offset from the base_link cell, covered by the footprint of the vehicle
+struct CellOffset
+{
+  int x;
+  int y;
+
+  bool operator<(const CellOffset &right) const
+  {
+    return y < right.y || (y == right.y && x < right.x);
+  }
+  bool operator==(const CellOffset &right) const
+  {
+    return x == right.x && y == right.y;
+  }
+};
+
+// Exact euclidean distance transform of a width x height grid (Felzenszwalb and Huttenlocher).
+// distance[i] is the distance in cells from the center of cell i to the center of the nearest cell
+// with obstacle[i] != 0, cells of a grid without any obstacle get a very large distance.
+void calcDistanceTransform(const std::vector<uint8_t> &obstacle, int width, int height, std::vector<float> *distance);
+
 inline double calcDistance(double x1, double y1, double x2, double y2)
 {
   return std::hypot(x2 - x1, y2 - y1);
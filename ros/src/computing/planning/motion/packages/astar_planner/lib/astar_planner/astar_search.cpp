@@ -28,11 +28,24 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#include "astar_search.h"
+#include "astar_planner/astar_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace astar_planner
 {
-AstarSearch::AstarSearch() : node_initialized_(false), upper_bound_distance_(-1)
+AstarSearch::AstarSearch()
+  : node_initialized_(false)
+  , node_width_(0)
+  , generation_(1)
+  , obstacle_distance_valid_(false)
+  , obstacle_map_width_(0)
+  , footprint_mask_radius_(0)
+  , wavefront_mask_radius_(0)
+  , footprint_resolution_(0)
+  , upper_bound_distance_(-1)
 {
   ros::NodeHandle private_nh_("~");
   private_nh_.param<bool>("use_2dnav_goal", use_2dnav_goal_, true);
@@ -55,8 +68,20 @@ AstarSearch::AstarSearch() : node_initialized_(false), upper_bound_distance_(-1)
   private_nh_.param<double>("longitudinal_goal_range", longitudinal_goal_range_, 2.0);
   private_nh_.param<double>("goal_angle_range", goal_angle_range_, 24.0);
   private_nh_.param<bool>("publish_marker", publish_marker_, false);
-
-  createStateUpdateTableLocal(angle_size_);
+  private_nh_.param<double>("openlist_bucket_width", openlist_bucket_width_, 0.0);
+  private_nh_.param<bool>("use_local_state_update", use_local_state_update_, true);
+  private_nh_.param<bool>("use_footprint_collision", use_footprint_collision_, false);
+  private_nh_.param<bool>("unknown_as_obstacle", unknown_as_obstacle_, true);
+  private_nh_.param<double>("goal_radius", goal_radius_, 0.0);
+  private_nh_.param<double>("goal_angle", goal_angle_, 6.0);
+  private_nh_.param<bool>("use_anytime_search", use_anytime_search_, false);
+
+  openlist_.setBucketWidth(openlist_bucket_width_);
+
+  if (use_local_state_update_)
+    createStateUpdateTableLocal(angle_size_);
+  else
+    createStateUpdateTable(angle_size_);
 }
 
 AstarSearch::~AstarSearch()
@@ -65,17 +90,13 @@ AstarSearch::~AstarSearch()
 
 void AstarSearch::initializeNode(const nav_msgs::OccupancyGrid &map)
 {
-  int height = map.info.height;
-  int width = map.info.width;
-
-  nodes_.resize(height);
+  size_t height = map.info.height;
+  size_t width = map.info.width;
 
-  for (int i = 0; i < height; i++)
-    nodes_[i].resize(width);
-
-  for (int i = 0; i < height; i++)
-    for (int j = 0; j < width; j++)
-      nodes_[i][j].resize(angle_size_);
+  // a single allocation, the nodes of a cell are contiguous
+  nodes_.assign(height * width * angle_size_, AstarNode());
+  node_width_ = width;
+  generation_ = 1;
 
   node_initialized_ = true;
 }
@@ -97,6 +118,107 @@ void AstarSearch::poseToIndex(const geometry_msgs::Pose &pose, int *index_x, int
   *index_theta %= angle_size_;
 }
 
+// state update table for freespace hybrid astar
+// max-left, no-turn, and max-right of forward and backward
+void AstarSearch::createStateUpdateTable(int angle_size)
+{
+  // Vehicle moving for each angle
+  state_update_table_.resize(angle_size);
+
+  // 6 is the number of steering actions
+  int max_action_num = use_back_ ? 6 : 3;
+  for (int i = 0; i < angle_size; i++)
+    state_update_table_[i].reserve(max_action_num);
+
+  // Minimum moving distance with one state update
+  //     arc  = r                       * theta
+  double step = minimum_turning_radius_ * (2.0 * M_PI / angle_size_);
+
+  for (int i = 0; i < angle_size; i++)
+  {
+    double descretized_angle = 2.0 * M_PI / angle_size;
+    double robot_angle = descretized_angle * i;
+
+    // Calculate right and left circle
+    // Robot moves along these circles
+    double right_circle_center_x = minimum_turning_radius_ * std::sin(robot_angle);
+    double right_circle_center_y = minimum_turning_radius_ * std::cos(robot_angle) * -1.0;
+    double left_circle_center_x = right_circle_center_x * -1.0;
+    double left_circle_center_y = right_circle_center_y * -1.0;
+
+    NodeUpdate nu;
+
+    // Calculate x and y shift to next state
+    // forward
+    nu.shift_x = step * std::cos(robot_angle);
+    nu.shift_y = step * std::sin(robot_angle);
+    nu.rotation = 0;
+    nu.index_theta = 0;
+    nu.step = step;
+    nu.curve = false;
+    nu.back = false;
+    state_update_table_[i].emplace_back(nu);
+
+    // forward right
+    nu.shift_x = right_circle_center_x + minimum_turning_radius_ * std::cos(M_PI_2 + robot_angle - descretized_angle);
+    nu.shift_y = right_circle_center_y + minimum_turning_radius_ * std::sin(M_PI_2 + robot_angle - descretized_angle);
+    nu.rotation = descretized_angle * -1.0;
+    nu.index_theta = -1;
+    nu.step = step;
+    nu.curve = true;
+    nu.back = false;
+    state_update_table_[i].emplace_back(nu);
+
+    // forward left
+    nu.shift_x =
+        left_circle_center_x + minimum_turning_radius_ * std::cos(-1.0 * M_PI_2 + robot_angle + descretized_angle);
+    nu.shift_y =
+        left_circle_center_y + minimum_turning_radius_ * std::sin(-1.0 * M_PI_2 + robot_angle + descretized_angle);
+    nu.rotation = descretized_angle;
+    nu.index_theta = 1;
+    nu.step = step;
+    nu.curve = true;
+    nu.back = false;
+    state_update_table_[i].emplace_back(nu);
+
+    // We don't use back move
+    if (!use_back_)
+      continue;
+
+    // backward
+    nu.shift_x = step * std::cos(robot_angle) * -1.0;
+    nu.shift_y = step * std::sin(robot_angle) * -1.0;
+    nu.rotation = 0;
+    nu.index_theta = 0;
+    nu.step = step;
+    nu.curve = false;
+    nu.back = true;
+    state_update_table_[i].emplace_back(nu);
+
+    // backward right
+    nu.shift_x = right_circle_center_x + minimum_turning_radius_ * std::cos(M_PI_2 + robot_angle + descretized_angle);
+    nu.shift_y = right_circle_center_y + minimum_turning_radius_ * std::sin(M_PI_2 + robot_angle + descretized_angle);
+    nu.rotation = descretized_angle;
+    nu.index_theta = 1;
+    nu.step = step;
+    nu.curve = true;
+    nu.back = true;
+    state_update_table_[i].emplace_back(nu);
+
+    // backward left
+    nu.shift_x =
+        left_circle_center_x + minimum_turning_radius_ * std::cos(-1.0 * M_PI_2 + robot_angle - descretized_angle);
+    nu.shift_y =
+        left_circle_center_y + minimum_turning_radius_ * std::sin(-1.0 * M_PI_2 + robot_angle - descretized_angle);
+    nu.rotation = descretized_angle * -1.0;
+    nu.index_theta = -1;
+    nu.step = step;
+    nu.curve = true;
+    nu.back = true;
+    state_update_table_[i].emplace_back(nu);
+  }
+}
+
 // state update table for local hybrid astar
 // five (for now) expansion to forward for each update
 void AstarSearch::createStateUpdateTableLocal(int angle_size)
@@ -263,8 +385,11 @@ void AstarSearch::setPath(const SimpleNode &goal)
   header.frame_id = map_frame_;
   path_.header = header;
 
+  // an anytime search replaces the path each time it finds a better one
+  path_.poses.clear();
+
   // From the goal node to the start node
-  AstarNode *node = &nodes_[goal.index_y][goal.index_x][goal.index_theta];
+  AstarNode *node = &getNode(goal.index_x, goal.index_y, goal.index_theta);
 
   while (node != NULL)
   {
@@ -296,14 +421,24 @@ void AstarSearch::setPath(const SimpleNode &goal)
 
 // Check if the next state is the goal
 // Check lateral offset, longitudinal offset and angle
+// or, with a goal radius, distance and angle
 bool AstarSearch::isGoal(double x, double y, double theta)
 {
-  // To reduce computation time, we use square value for distance
-  static const double lateral_goal_range =
-      lateral_goal_range_ / 2.0;  // [meter], divide by 2 means we check left and right
-  static const double longitudinal_goal_range =
-      longitudinal_goal_range_ / 2.0;                                         // [meter], check only behind of the goal
-  static const double goal_angle = M_PI * (goal_angle_range_ / 2.0) / 180.0;  // degrees -> radian
+  if (goal_radius_ > 0)
+  {
+    // To reduce computation time, we use square value
+    double dx = goal_pose_local_.pose.position.x - x;
+    double dy = goal_pose_local_.pose.position.y - y;
+    if (dx * dx + dy * dy >= goal_radius_ * goal_radius_)
+      return false;
+
+    // Check the orientation of goal
+    return astar_planner::calcDiffOfRadian(goal_yaw_, theta) < M_PI * goal_angle_ / 180.0;  // degrees -> radian
+  }
+
+  double lateral_goal_range = lateral_goal_range_ / 2.0;  // [meter], divide by 2 means we check left and right
+  double longitudinal_goal_range = longitudinal_goal_range_ / 2.0;    // [meter], check only behind of the goal
+  double goal_angle = M_PI * (goal_angle_range_ / 2.0) / 180.0;  // degrees -> radian
 
   // Calculate the node coordinate seen from the goal point
   tf::Point p(x, y, 0);
@@ -324,46 +459,92 @@ bool AstarSearch::isGoal(double x, double y, double theta)
 
 bool AstarSearch::isObs(int index_x, int index_y)
 {
-  if (nodes_[index_y][index_x][0].status == STATUS::OBS)
-    return true;
-
-  return false;
+  return obstacle_map_[(index_y + 1) * obstacle_map_width_ + index_x + 1] != 0;
 }
 
-bool AstarSearch::detectCollision(const SimpleNode &sn)
+// Cells covered by the footprint for each heading bin, made once for the resolution of the map
+void AstarSearch::createFootprintMasks()
 {
+  double resolution = map_info_.resolution;
+
   // Define the robot as rectangle
-  static double left = -1.0 * base2back_;
-  static double right = robot_length_ - base2back_;
-  static double top = robot_width_ / 2.0;
-  static double bottom = -1.0 * robot_width_ / 2.0;
-  static double resolution = map_info_.resolution;
-
-  // Coordinate of base_link in OccupancyGrid frame
-  static double one_angle_range = 2.0 * M_PI / angle_size_;
-  double base_x = sn.index_x * resolution;
-  double base_y = sn.index_y * resolution;
-  double base_theta = sn.index_theta * one_angle_range;
-
-  // Calculate cos and sin in advance
-  double cos_theta = std::cos(base_theta);
-  double sin_theta = std::sin(base_theta);
-
-  // Convert each point to index and check if the node is Obstacle
-  for (double x = left; x < right; x += resolution)
+  double left = -1.0 * base2back_;
+  double right = robot_length_ - base2back_;
+  double top = robot_width_ / 2.0;
+  double bottom = -1.0 * robot_width_ / 2.0;
+
+  double one_angle_range = 2.0 * M_PI / angle_size_;
+  footprint_masks_.assign(angle_size_, std::vector<CellOffset>());
+  footprint_mask_radius_ = 0;
+  for (int i = 0; i < angle_size_; i++)
   {
-    for (double y = top; y > bottom; y -= resolution)
+    double cos_theta = std::cos(i * one_angle_range);
+    double sin_theta = std::sin(i * one_angle_range);
+
+    // Same sampling of the rectangle as the collision check used to do for each node
+    std::vector<CellOffset> &mask = footprint_masks_[i];
+    for (double x = left; x < right; x += resolution)
     {
-      // 2D point rotation
-      int index_x = (x * cos_theta - y * sin_theta + base_x) / resolution;
-      int index_y = (x * sin_theta + y * cos_theta + base_y) / resolution;
+      for (double y = top; y > bottom; y -= resolution)
+      {
+        CellOffset offset;
+        offset.x = std::floor((x * cos_theta - y * sin_theta) / resolution);
+        offset.y = std::floor((x * sin_theta + y * cos_theta) / resolution);
+        mask.push_back(offset);
+      }
+    }
+    std::sort(mask.begin(), mask.end());
+    mask.erase(std::unique(mask.begin(), mask.end()), mask.end());
 
-      if (isOutOfRange(index_x, index_y))
-        return true;
-      if (nodes_[index_y][index_x][0].status == STATUS::OBS)
-        return true;
+    for (const auto &offset : mask)
+      footprint_mask_radius_ = std::max(footprint_mask_radius_, std::hypot(offset.x, offset.y));
+  }
+
+  // Define the robot as square for wavefront search
+  double half = robot_width_ / 2;
+  wavefront_mask_.clear();
+  wavefront_mask_radius_ = 0;
+  for (double y = half; y > -1.0 * half; y -= resolution)
+  {
+    for (double x = -1.0 * half; x < half; x += resolution)
+    {
+      CellOffset offset;
+      offset.x = std::floor(x / resolution);
+      offset.y = std::floor(y / resolution);
+      wavefront_mask_.push_back(offset);
     }
   }
+  std::sort(wavefront_mask_.begin(), wavefront_mask_.end());
+  wavefront_mask_.erase(std::unique(wavefront_mask_.begin(), wavefront_mask_.end()), wavefront_mask_.end());
+  for (const auto &offset : wavefront_mask_)
+    wavefront_mask_radius_ = std::max(wavefront_mask_radius_, std::hypot(offset.x, offset.y));
+
+  footprint_resolution_ = resolution;
+}
+
+bool AstarSearch::detectCollision(const SimpleNode &sn)
+{
+  return detectCollision(sn.index_x, sn.index_y, footprint_masks_[sn.index_theta], footprint_mask_radius_);
+}
+
+bool AstarSearch::detectCollision(int index_x, int index_y, const std::vector<CellOffset> &mask, double mask_radius)
+{
+  if (isOutOfRange(index_x, index_y))
+    return true;
+
+  // Neither an obstacle nor the border of the map is in reach of the mask
+  size_t index = (index_y + 1) * obstacle_map_width_ + index_x + 1;
+  if (obstacle_distance_valid_ && obstacle_distance_[index] > mask_radius)
+    return false;
+
+  // Check each cell of the mask
+  for (const auto &offset : mask)
+  {
+    int x = index_x + offset.x;
+    int y = index_y + offset.y;
+    if (isOutOfRange(x, y) || isObs(x, y))
+      return true;
+  }
 
   return false;
 }
@@ -372,7 +553,7 @@ bool AstarSearch::calcWaveFrontHeuristic(const SimpleNode &sn)
 {
   // Set start point for wavefront search
   // This is goal for Astar search
-  nodes_[sn.index_y][sn.index_x][0].hc = 0;
+  getNode(sn.index_x, sn.index_y, 0).hc = 0;
   WaveFrontNode wf_node(sn.index_x, sn.index_y, 1e-10);
   std::queue<WaveFrontNode> qu;
   qu.push(wf_node);
@@ -411,8 +592,8 @@ bool AstarSearch::calcWaveFrontHeuristic(const SimpleNode &sn)
       next.index_y = ref.index_y + u.index_y;
 
       // out of range OR already visited OR obstacle node
-      if (isOutOfRange(next.index_x, next.index_y) || nodes_[next.index_y][next.index_x][0].hc > 0 ||
-          nodes_[next.index_y][next.index_x][0].status == STATUS::OBS)
+      if (isOutOfRange(next.index_x, next.index_y) || getNode(next.index_x, next.index_y, 0).hc > 0 ||
+          isObs(next.index_x, next.index_y))
         continue;
 
       // Take the size of robot into account
@@ -425,7 +606,7 @@ bool AstarSearch::calcWaveFrontHeuristic(const SimpleNode &sn)
 
       // Set wavefront heuristic cost
       next.hc = ref.hc + u.hc;
-      nodes_[next.index_y][next.index_x][0].hc = next.hc;
+      getNode(next.index_x, next.index_y, 0).hc = next.hc;
 
       qu.push(next);
     }
@@ -438,27 +619,7 @@ bool AstarSearch::calcWaveFrontHeuristic(const SimpleNode &sn)
 // Simple collidion detection for wavefront search
 bool AstarSearch::detectCollisionWaveFront(const WaveFrontNode &ref)
 {
-  // Define the robot as square
-  static double half = robot_width_ / 2;
-  double robot_x = ref.index_x * map_info_.resolution;
-  double robot_y = ref.index_y * map_info_.resolution;
-
-  for (double y = half; y > -1.0 * half; y -= map_info_.resolution)
-  {
-    for (double x = -1.0 * half; x < half; x += map_info_.resolution)
-    {
-      int index_x = (robot_x + x) / map_info_.resolution;
-      int index_y = (robot_y + y) / map_info_.resolution;
-
-      if (isOutOfRange(index_x, index_y))
-        return true;
-
-      if (nodes_[index_y][index_x][0].status == STATUS::OBS)
-        return true;
-    }
-  }
-
-  return false;
+  return detectCollision(ref.index_x, ref.index_y, wavefront_mask_, wavefront_mask_radius_);
 }
 
 void AstarSearch::reset()
@@ -467,23 +628,17 @@ void AstarSearch::reset()
   debug_poses_.poses.clear();
 
   // Clear queue
-  std::priority_queue<SimpleNode, std::vector<SimpleNode>, std::greater<SimpleNode>> empty;
-  std::swap(openlist_, empty);
+  openlist_.clear();
 
   ros::WallTime begin = ros::WallTime::now();
 
-  // Reset node info here ...?
-  for (size_t i = 0; i < map_info_.height; i++)
+  // Reset node info here, lazily: the status and hc of a node are cleared when it is next accessed
+  if (++generation_ == 0)
   {
-    for (size_t j = 0; j < map_info_.width; j++)
-    {
-      for (int k = 0; k < angle_size_; k++)
-      {
-        // other values will be updated during the search
-        nodes_[i][j][k].status = STATUS::NONE;
-        nodes_[i][j][k].hc = 0;
-      }
-    }
+    // the stamps wrapped around, clear them once
+    for (auto &node : nodes_)
+      node.generation = 0;
+    generation_ = 1;
   }
 
   ros::WallTime end = ros::WallTime::now();
@@ -513,6 +668,17 @@ void AstarSearch::setMap(const nav_msgs::OccupancyGrid &map)
   geometry_msgs::Pose ogm_in_map = astar_planner::transformPose(map_info_.origin, map2ogm_frame);
   tf::poseMsgToTF(ogm_in_map, map2ogm_);
 
+  // Initialize node according to map size
+  if (nodes_.size() != static_cast<size_t>(map.info.width) * map.info.height * angle_size_)
+    initializeNode(map);
+
+  if (map_info_.resolution != footprint_resolution_)
+    createFootprintMasks();
+
+  // the map is surrounded by obstacle cells, so that the distance transform also keeps away from its border
+  obstacle_map_width_ = map.info.width + 2;
+  obstacle_map_.assign(obstacle_map_width_ * (map.info.height + 2), 1);
+
   for (size_t i = 0; i < map.info.height; i++)
   {
     for (size_t j = 0; j < map.info.width; j++)
@@ -521,25 +687,24 @@ void AstarSearch::setMap(const nav_msgs::OccupancyGrid &map)
       size_t og_index = i * map.info.width + j;
       int cost = map.data[og_index];
 
+      // the cost more than threshold is regarded almost same as an obstacle
+      // because of its very high cost
+      bool obstacle = cost > obstacle_threshold_ || cost == 100 || (cost < 0 && unknown_as_obstacle_);
+      obstacle_map_[(i + 1) * obstacle_map_width_ + j + 1] = obstacle;
+
       // hc is set to be 0 when reset()
-      if (cost == 0)
+      if (cost <= 0 || obstacle)
         continue;
 
       if (use_potential_heuristic_)
-      {
-        // the cost more than threshold is regarded almost same as an obstacle
-        // because of its very high cost
-        if (cost > obstacle_threshold_)
-          nodes_[i][j][0].status = STATUS::OBS;
-        else
-          nodes_[i][j][0].hc = cost * potential_weight_;
-      }
-
-      // obstacle or unknown area
-      if (cost == 100 || cost < 0)
-        nodes_[i][j][0].status = STATUS::OBS;
+        getNode(j, i, 0).hc = cost * potential_weight_;
     }
   }
+
+  // Only worth it when many footprints are checked
+  obstacle_distance_valid_ = use_footprint_collision_ || use_wavefront_heuristic_;
+  if (obstacle_distance_valid_)
+    astar_planner::calcDistanceTransform(obstacle_map_, obstacle_map_width_, map.info.height + 2, &obstacle_distance_);
 }
 
 bool AstarSearch::setStartNode()
@@ -556,7 +721,7 @@ bool AstarSearch::setStartNode()
     return false;
 
   // Set start node
-  AstarNode &start_node = nodes_[index_y][index_x][index_theta];
+  AstarNode &start_node = getNode(index_x, index_y, index_theta);
   start_node.x = start_pose_local_.pose.position.x;
   start_node.y = start_pose_local_.pose.position.y;
   start_node.theta = 2.0 * M_PI / angle_size_ * index_theta;
@@ -634,6 +799,10 @@ bool AstarSearch::search()
 {
   ros::WallTime timer_begin = ros::WallTime::now();
 
+  // Cost of the best path found so far by an anytime search
+  double best_gc = std::numeric_limits<double>::max();
+  bool path_found = false;
+
   // Start A* search
   // If the openlist is empty, search failed
   while (!openlist_.empty())
@@ -643,17 +812,26 @@ bool AstarSearch::search()
     double msec = (timer_end - timer_begin).toSec() * 1000.0;
     if (msec > time_limit_)
     {
+      if (path_found)
+      {
+        ROS_INFO("Anytime search stopped at the time limit with the path of cost %lf", best_gc);
+        return true;
+      }
+
       ROS_WARN("Exceed time limit of %lf [ms]", time_limit_);
       return false;
     }
 
     // Pop minimum cost node from openlist
-    SimpleNode sn;
-    sn = openlist_.top();
-    openlist_.pop();
+    SimpleNode sn = openlist_.pop();
 
     // Expand nodes from this node
-    AstarNode *current_node = &nodes_[sn.index_y][sn.index_x][sn.index_theta];
+    AstarNode *current_node = &getNode(sn.index_x, sn.index_y, sn.index_theta);
+
+    // A path at least as cheap was already found, nothing below this node can improve it
+    if (current_node->gc >= best_gc)
+      continue;
+
     current_node->status = STATUS::CLOSED;
 
     // Goal check
@@ -662,7 +840,13 @@ bool AstarSearch::search()
       ROS_INFO("Search time: %lf [msec]", (timer_end - timer_begin).toSec() * 1000.0);
 
       setPath(sn);
-      return true;
+      if (!use_anytime_search_)
+        return true;
+
+      // Keep searching for a cheaper path until the time limit
+      path_found = true;
+      best_gc = current_node->gc;
+      continue;
     }
 
     if (publish_marker_)
@@ -682,6 +866,10 @@ bool AstarSearch::search()
       double move_cost = state.step;
       double move_distance = current_node->move_distance + state.step;
 
+      // Increase curve cost
+      if (state.curve)
+        move_cost *= curve_weight_;
+
       // Increase reverse cost
       if (state.back != current_node->back)
         move_cost *= reverse_weight_;
@@ -696,7 +884,8 @@ bool AstarSearch::search()
       next.index_theta = (next.index_theta + angle_size_) % angle_size_;
 
       // Check if the index is valid
-      if (isOutOfRange(next.index_x, next.index_y) || isObs(next.index_x, next.index_y))
+      if (isOutOfRange(next.index_x, next.index_y) || isObs(next.index_x, next.index_y) ||
+          (use_footprint_collision_ && detectCollision(next)))
         continue;
 
       // prunning with upper bound
@@ -705,14 +894,14 @@ bool AstarSearch::search()
         continue;
       }
 
-      AstarNode *next_node = &nodes_[next.index_y][next.index_x][next.index_theta];
+      AstarNode *next_node = &getNode(next.index_x, next.index_y, next.index_theta);
       double next_gc = current_node->gc + move_cost;
-      double next_hc = nodes_[next.index_y][next.index_x][0].hc;  // wavefront or distance transform heuristic
+      double next_hc = getNode(next.index_x, next.index_y, 0).hc;  // wavefront or distance transform heuristic
 
       // increase the cost with euclidean distance
       if (use_potential_heuristic_)
       {
-        next_gc += nodes_[next.index_y][next.index_x][0].hc;
+        next_gc += getNode(next.index_x, next.index_y, 0).hc;
         next_hc += astar_planner::calcDistance(next_x, next_y, goal_pose_local_.pose.position.x,
                                                goal_pose_local_.pose.position.y) *
                    distance_heuristic_weight_;
@@ -724,6 +913,9 @@ bool AstarSearch::search()
                                               goal_pose_local_.pose.position.y) *
                   distance_heuristic_weight_;
 
+      if (next_gc >= best_gc)
+        continue;
+
       // NONE
       if (next_node->status == STATUS::NONE)
       {
@@ -766,6 +958,9 @@ bool AstarSearch::search()
     }  // state update
   }
 
+  if (path_found)
+    return true;
+
   // Failed to find path
   ROS_INFO("Open list is empty...");
   return false;
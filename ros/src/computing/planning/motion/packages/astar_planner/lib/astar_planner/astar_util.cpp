@@ -0,0 +1,188 @@
+/*
+ *  Copyright (c) 2015, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "astar_planner/astar_util.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace astar_planner
+{
+WaveFrontNode::WaveFrontNode()
+{
+}
+
+WaveFrontNode::WaveFrontNode(int x, int y, double cost) : index_x(x), index_y(y), hc(cost)
+{
+}
+
+SimpleNode::SimpleNode()
+{
+}
+
+SimpleNode::SimpleNode(int x, int y, int theta, double gc, double hc)
+  : index_x(x), index_y(y), index_theta(theta), cost(gc + hc)
+{
+}
+
+namespace
+{
+// costs above this bucket share the last one, the list then degrades to LIFO order for them
+constexpr size_t MAX_BUCKETS = 1 << 20;
+}  // namespace
+
+OpenList::OpenList() : bucket_width_(0), size_(0), min_bucket_(0), max_bucket_(0)
+{
+}
+
+void OpenList::setBucketWidth(double bucket_width)
+{
+  clear();
+  bucket_width_ = bucket_width > 0 ? bucket_width : 0;
+}
+
+void OpenList::push(const SimpleNode &sn)
+{
+  size_++;
+  if (bucket_width_ <= 0)
+  {
+    heap_.push(sn);
+    return;
+  }
+
+  double index = sn.cost > 0 ? sn.cost / bucket_width_ : 0;
+  size_t bucket = index < MAX_BUCKETS - 1 ? static_cast<size_t>(index) : MAX_BUCKETS - 1;
+  if (bucket >= buckets_.size())
+    buckets_.resize(bucket + 1);
+  buckets_[bucket].push_back(sn);
+
+  // the heuristics are not consistent, so a node may go below the last popped one
+  if (size_ == 1 || bucket < min_bucket_)
+    min_bucket_ = bucket;
+  if (bucket > max_bucket_)
+    max_bucket_ = bucket;
+}
+
+SimpleNode OpenList::pop()
+{
+  size_--;
+  if (bucket_width_ <= 0)
+  {
+    SimpleNode sn = heap_.top();
+    heap_.pop();
+    return sn;
+  }
+
+  while (buckets_[min_bucket_].empty())
+    min_bucket_++;
+  SimpleNode sn = buckets_[min_bucket_].back();
+  buckets_[min_bucket_].pop_back();
+  return sn;
+}
+
+void OpenList::clear()
+{
+  std::priority_queue<SimpleNode, std::vector<SimpleNode>, std::greater<SimpleNode>> empty;
+  std::swap(heap_, empty);
+
+  // keep the capacity of the buckets for the next search
+  for (size_t i = 0; i < buckets_.size() && i <= max_bucket_; i++)
+    buckets_[i].clear();
+
+  size_ = 0;
+  min_bucket_ = 0;
+  max_bucket_ = 0;
+}
+
+namespace
+{
+// squared distance of a cell without any obstacle in its row or column, finite so that differences stay valid
+constexpr double NO_OBSTACLE = 1e20;
+
+// 1D squared distance transform of f by the lower envelope of the parabolas rooted at each sample
+void distanceTransform1D(const double *f, int n, double *d, int *v, double *z)
+{
+  int k = 0;
+  v[0] = 0;
+  z[0] = -HUGE_VAL;
+  z[1] = HUGE_VAL;
+  for (int q = 1; q < n; q++)
+  {
+    double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+    while (s <= z[k])
+    {
+      k--;
+      s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+    }
+    k++;
+    v[k] = q;
+    z[k] = s;
+    z[k + 1] = HUGE_VAL;
+  }
+
+  k = 0;
+  for (int q = 0; q < n; q++)
+  {
+    while (z[k + 1] < q)
+      k++;
+    d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+  }
+}
+}  // namespace
+
+void calcDistanceTransform(const std::vector<uint8_t> &obstacle, int width, int height, std::vector<float> *distance)
+{
+  int n = std::max(width, height);
+  std::vector<double> f(n), d(n), z(n + 1);
+  std::vector<int> v(n);
+  std::vector<double> squared(static_cast<size_t>(width) * height);
+
+  // columns
+  for (int x = 0; x < width; x++)
+  {
+    for (int y = 0; y < height; y++)
+      f[y] = obstacle[static_cast<size_t>(y) * width + x] ? 0 : NO_OBSTACLE;
+    distanceTransform1D(f.data(), height, d.data(), v.data(), z.data());
+    for (int y = 0; y < height; y++)
+      squared[static_cast<size_t>(y) * width + x] = d[y];
+  }
+
+  // rows, on the column distances
+  distance->resize(squared.size());
+  for (int y = 0; y < height; y++)
+  {
+    double *row = &squared[static_cast<size_t>(y) * width];
+    distanceTransform1D(row, width, d.data(), v.data(), z.data());
+    for (int x = 0; x < width; x++)
+      (*distance)[static_cast<size_t>(y) * width + x] = static_cast<float>(std::sqrt(d[x]));
+  }
+}
+
+}  // namespace astar_planner
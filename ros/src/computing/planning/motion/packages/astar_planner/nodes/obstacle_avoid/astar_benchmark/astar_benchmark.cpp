@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Replay the occupancy grids of a bag file through AstarSearch and report the planning times.
+// Start and goal poses are given in the frame of the grids, relative to their origin.
+
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "astar_planner/astar_search.h"
+
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "astar_benchmark");
+
+  if (argc < 2)
+  {
+    std::cerr << "Usage: rosrun astar_planner astar_benchmark BAG [_topic:=TOPIC] [_start_x:=X] ..." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ros::NodeHandle private_nh("~");
+  std::string topic;
+  private_nh.param<std::string>("topic", topic, "/grid_map_visualization/distance_transform");
+  int repeat;
+  private_nh.param<int>("repeat", repeat, 1);
+  double upper_bound_distance;
+  private_nh.param<double>("upper_bound_distance", upper_bound_distance, -1);
+
+  rosbag::Bag bag;
+  try
+  {
+    bag.open(argv[1], rosbag::bagmode::Read);
+  }
+  catch (const rosbag::BagException &e)
+  {
+    std::cerr << "cannot open " << argv[1] << ": " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<nav_msgs::OccupancyGrid::ConstPtr> maps;
+  rosbag::View view(bag, rosbag::TopicQuery(topic));
+  for (const auto &m : view)
+  {
+    nav_msgs::OccupancyGrid::ConstPtr map = m.instantiate<nav_msgs::OccupancyGrid>();
+    if (map != NULL)
+      maps.push_back(map);
+  }
+  bag.close();
+
+  if (maps.empty())
+  {
+    std::cerr << "no nav_msgs/OccupancyGrid on " << topic << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Plan in the frame of the grids, so no transform has to be published
+  private_nh.setParam("map_frame", maps.front()->header.frame_id);
+  astar_planner::AstarSearch astar;
+  astar.initializeNode(*maps.front());
+
+  // By default start at the center of the grid and go straight ahead
+  const nav_msgs::MapMetaData &info = maps.front()->info;
+  double start_x, start_y, start_yaw, goal_x, goal_y, goal_yaw;
+  private_nh.param<double>("start_x", start_x, info.width * info.resolution / 2.0);
+  private_nh.param<double>("start_y", start_y, info.height * info.resolution / 2.0);
+  private_nh.param<double>("start_yaw", start_yaw, 0.0);
+  private_nh.param<double>("goal_x", goal_x, start_x + 15.0);
+  private_nh.param<double>("goal_y", goal_y, start_y);
+  private_nh.param<double>("goal_yaw", goal_yaw, start_yaw);
+  geometry_msgs::Pose start_pose = astar_planner::xytToPoseMsg(start_x, start_y, start_yaw);
+  geometry_msgs::Pose goal_pose = astar_planner::xytToPoseMsg(goal_x, goal_y, goal_yaw);
+
+  std::vector<double> times;
+  int found = 0;
+  for (int r = 0; r < repeat; r++)
+  {
+    for (const auto &map : maps)
+    {
+      if (map->info.width != info.width || map->info.height != info.height)
+      {
+        std::cerr << "skip a grid of another size" << std::endl;
+        continue;
+      }
+
+      ros::WallTime begin = ros::WallTime::now();
+      if (astar.makePlan(start_pose, goal_pose, *map, upper_bound_distance))
+        found++;
+      astar.reset();
+      times.push_back((ros::WallTime::now() - begin).toSec() * 1000.0);
+    }
+  }
+
+  if (times.empty())
+    return EXIT_FAILURE;
+
+  std::sort(times.begin(), times.end());
+  double sum = 0;
+  for (const auto &t : times)
+    sum += t;
+  std::cout << "plans: " << times.size() << ", found: " << found << std::endl;
+  std::cout << "time [ms] mean: " << sum / times.size() << ", median: " << times[times.size() / 2]
+            << ", max: " << times.back() << std::endl;
+
+  return EXIT_SUCCESS;
+}
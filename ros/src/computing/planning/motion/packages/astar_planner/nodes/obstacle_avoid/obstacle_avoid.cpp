@@ -28,7 +28,7 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#include "astar_search.h"
+#include "astar_planner/astar_search.h"
 #include "search_info_ros.h"
 
 #include <autoware_msgs/LaneArray.h>
@@ -31,7 +31,7 @@
 #ifndef SEARCH_INFO_ROS_H
 #define SEARCH_INFO_ROS_H
 
-#include "astar_util.h"
+#include "astar_planner/astar_util.h"
 #include "autoware_msgs/Lane.h"
 #include "waypoint_follower/libwaypoint_follower.h"
 
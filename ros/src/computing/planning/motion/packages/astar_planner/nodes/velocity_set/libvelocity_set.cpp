@@ -1,5 +1,31 @@
 #include "libvelocity_set.h"
 
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// upper bound of the cells of a PointsGrid, the cells are enlarged for sparse clouds
+constexpr int MAX_GRID_CELLS = 1 << 18;
+
+double pointX(const pcl::PointXYZ &p)
+{
+  return p.x;
+}
+double pointY(const pcl::PointXYZ &p)
+{
+  return p.y;
+}
+double pointX(const geometry_msgs::Point &p)
+{
+  return p.x;
+}
+double pointY(const geometry_msgs::Point &p)
+{
+  return p.y;
+}
+}  // namespace
+
 // extract edge points from zebra zone
 std::vector<geometry_msgs::Point> removeNeedlessPoints(std::vector<geometry_msgs::Point> &area_points)
 {
@@ -244,6 +270,17 @@ void CrossWalk::setCrossWalkPoints()
   calcDetectionArea(bdid2aid_map);
   calcCenterPoints();
 
+  std::vector<geometry_msgs::Point> points;
+  for (const auto &i : bdID_)
+  {
+    for (unsigned int j = 0; j < detection_points_[i].points.size(); j++)
+    {
+      points.push_back(detection_points_[i].points[j]);
+      grid_points_.push_back(std::make_pair(i, j));
+    }
+  }
+  detection_grid_.setPoints(points, 2.0);
+
   ROS_INFO("Set cross walk detection points");
   set_points = true;
 }
@@ -256,41 +293,45 @@ int CrossWalk::findClosestCrosswalk(const int closest_waypoint, const autoware_m
 
   double find_distance = 2.0 * 2.0;      // meter
   double ignore_distance = 20.0 * 20.0;  // meter
-  static std::vector<int> bdid = getBDID();
 
   int _return_val = 0;
 
   initDetectionCrossWalkIDs();  // for multiple
 
   // Find near cross walk
+  std::vector<int> candidates;
   for (int num = closest_waypoint; num < closest_waypoint + search_distance && num < (int)lane.waypoints.size(); num++)
   {
     geometry_msgs::Point waypoint = lane.waypoints[num].pose.pose.position;
     waypoint.z = 0.0;  // ignore Z axis
-    for (const auto &i : bdid)
+
+    // candidates are in bdID_ order, as if every detection point was checked
+    detection_grid_.findCandidates(waypoint.x, waypoint.y, std::sqrt(find_distance), &candidates);
+    for (const auto &c : candidates)
     {
+      int i = grid_points_[c].first;
+      const CrossWalkPoints &crosswalk = getDetectionPoints(i);
+
       // ignore far crosswalk
-      geometry_msgs::Point crosswalk_center = getDetectionPoints(i).center;
+      geometry_msgs::Point crosswalk_center = crosswalk.center;
       crosswalk_center.z = 0.0;
       if (calcSquareOfLength(crosswalk_center, waypoint) > ignore_distance)
         continue;
 
-      for (auto p : getDetectionPoints(i).points)
+      geometry_msgs::Point p = crosswalk.points[grid_points_[c].second];
+      p.z = waypoint.z;
+      if (calcSquareOfLength(p, waypoint) < find_distance)
       {
-        p.z = waypoint.z;
-        if (calcSquareOfLength(p, waypoint) < find_distance)
+        addDetectionCrossWalkIDs(i);
+        if (!this->isMultipleDetection())
         {
-          addDetectionCrossWalkIDs(i);
-          if (!this->isMultipleDetection())
-          {
-            setDetectionCrossWalkID(i);
-            return num;
-          }
-          else if (!_return_val)
-          {
-            setDetectionCrossWalkID(i);
-            _return_val = num;
-          }
+          setDetectionCrossWalkID(i);
+          return num;
+        }
+        else if (!_return_val)
+        {
+          setDetectionCrossWalkID(i);
+          _return_val = num;
         }
       }
     }
@@ -303,6 +344,108 @@ int CrossWalk::findClosestCrosswalk(const int closest_waypoint, const autoware_m
   return -1;  // no near crosswalk
 }
 
+template <class T>
+void PointsGrid::build(const T &points, double cell_size)
+{
+  cell_size_ = cell_size > 0.1 ? cell_size : 0.1;
+  width_ = height_ = 0;
+  point_indices_.clear();
+  point_cells_.assign(points.size(), -1);
+
+  double min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+  for (const auto &p : points)
+  {
+    double x = pointX(p), y = pointY(p);
+    if (!std::isfinite(x) || !std::isfinite(y))
+      continue;
+    min_x = std::min(min_x, x);
+    min_y = std::min(min_y, y);
+    max_x = std::max(max_x, x);
+    max_y = std::max(max_y, y);
+  }
+  if (min_x > max_x)
+  {
+    cell_begin_.assign(1, 0);
+    return;
+  }
+
+  // far outliers would make the grid huge, grow the cells instead
+  while ((std::floor((max_x - min_x) / cell_size_) + 1) * (std::floor((max_y - min_y) / cell_size_) + 1) >
+         MAX_GRID_CELLS)
+    cell_size_ *= 2.0;
+
+  min_x_ = min_x;
+  min_y_ = min_y;
+  width_ = static_cast<int>(std::floor((max_x - min_x) / cell_size_)) + 1;
+  height_ = static_cast<int>(std::floor((max_y - min_y) / cell_size_)) + 1;
+
+  // counting sort of the points by cell, stable so each cell keeps the points in ascending order
+  cell_begin_.assign(width_ * height_ + 1, 0);
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    double x = pointX(points[i]), y = pointY(points[i]);
+    if (!std::isfinite(x) || !std::isfinite(y))
+      continue;
+    int cell_x = std::min(static_cast<int>((x - min_x_) / cell_size_), width_ - 1);
+    int cell_y = std::min(static_cast<int>((y - min_y_) / cell_size_), height_ - 1);
+    point_cells_[i] = cell_y * width_ + cell_x;
+    cell_begin_[point_cells_[i] + 1]++;
+  }
+  for (int c = 0; c < width_ * height_; c++)
+    cell_begin_[c + 1] += cell_begin_[c];
+
+  point_indices_.resize(cell_begin_.back());
+  std::vector<int> fill(cell_begin_.begin(), cell_begin_.end() - 1);
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    if (point_cells_[i] >= 0)
+      point_indices_[fill[point_cells_[i]]++] = i;
+  }
+}
+
+void PointsGrid::setPoints(const pcl::PointCloud<pcl::PointXYZ> &points, double cell_size)
+{
+  build(points.points, cell_size);
+}
+
+void PointsGrid::setPoints(const std::vector<geometry_msgs::Point> &points, double cell_size)
+{
+  build(points, cell_size);
+}
+
+void PointsGrid::findCandidates(double x, double y, double radius, std::vector<int> *indices) const
+{
+  indices->clear();
+  if (width_ == 0 || !std::isfinite(x) || !std::isfinite(y) || !(radius >= 0))
+    return;
+
+  // small margin so points exactly at radius are not lost to rounding
+  double r = radius + 1e-3;
+  double min_cx = std::max(std::floor((x - r - min_x_) / cell_size_), 0.0);
+  double max_cx = std::min(std::floor((x + r - min_x_) / cell_size_), width_ - 1.0);
+  double min_cy = std::max(std::floor((y - r - min_y_) / cell_size_), 0.0);
+  double max_cy = std::min(std::floor((y + r - min_y_) / cell_size_), height_ - 1.0);
+  if (min_cx > max_cx || min_cy > max_cy)
+    return;
+
+  int cells = 0;
+  for (int cell_y = min_cy; cell_y <= max_cy; cell_y++)
+  {
+    for (int cell_x = min_cx; cell_x <= max_cx; cell_x++)
+    {
+      int c = cell_y * width_ + cell_x;
+      if (cell_begin_[c] == cell_begin_[c + 1])
+        continue;
+      indices->insert(indices->end(), point_indices_.begin() + cell_begin_[c],
+                      point_indices_.begin() + cell_begin_[c + 1]);
+      cells++;
+    }
+  }
+
+  if (cells > 1)
+    std::sort(indices->begin(), indices->end());
+}
+
 geometry_msgs::Point ObstaclePoints::getObstaclePoint(const EControl &kind) const
 {
   geometry_msgs::Point point;
@@ -8,6 +8,8 @@
 #include <vector>
 
 #include <geometry_msgs/Point.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
 #include <ros/ros.h>
 #include <vector_map/vector_map.h>
 
@@ -37,11 +39,44 @@ struct CrossWalkPoints
   double width;
 };
 
+// Points hashed into a dense XY grid over their bounding box, so a radius search only visits the nearby cells.
+// The buffers are kept between calls to avoid reallocating them on each cycle.
+class PointsGrid
+{
+private:
+  double cell_size_;
+  double min_x_;
+  double min_y_;
+  int width_;
+  int height_;
+  std::vector<int> cell_begin_;     // first position of each cell in point_indices_, plus the end
+  std::vector<int> point_indices_;  // point indices grouped by cell, ascending in each cell
+  std::vector<int> point_cells_;    // cell of each point, or -1
+
+  template <class T>
+  void build(const T& points, double cell_size);
+
+public:
+  PointsGrid() : cell_size_(1.0), min_x_(0.0), min_y_(0.0), width_(0), height_(0)
+  {
+  }
+
+  void setPoints(const pcl::PointCloud<pcl::PointXYZ>& points, double cell_size);
+  void setPoints(const std::vector<geometry_msgs::Point>& points, double cell_size);
+
+  // Indices of the points which may be within radius of (x, y) on the XY plane, in ascending order.
+  // The distance still has to be checked by the caller.
+  void findCandidates(double x, double y, double radius, std::vector<int>* indices) const;
+};
+
 class CrossWalk
 {
 private:
   // detection_points_[bdID] has information of each crosswalk
   std::unordered_map<int, CrossWalkPoints> detection_points_;
+  // detection points of all the crosswalks in bdID_ order, as (bdID, index in its points)
+  std::vector<std::pair<int, int>> grid_points_;
+  PointsGrid detection_grid_;
   int detection_waypoint_;
   int detection_crosswalk_id_;
   std::vector<geometry_msgs::Point> obstacle_points_;
@@ -85,7 +120,7 @@ public:
   {
     return bdID_;
   }
-  CrossWalkPoints getDetectionPoints(const int &id) const
+  const CrossWalkPoints &getDetectionPoints(const int &id) const
   {
     return detection_points_.at(id);
   }
@@ -215,15 +215,16 @@ void displayDetectionRange(const autoware_msgs::Lane& lane, const CrossWalk& cro
 }
 
 // obstacle detection for crosswalk
-EControl crossWalkDetection(const pcl::PointCloud<pcl::PointXYZ>& points, const CrossWalk& crosswalk,
-                            const geometry_msgs::PoseStamped& localizer_pose, const int points_threshold,
-                            ObstaclePoints* obstacle_points)
+EControl crossWalkDetection(const pcl::PointCloud<pcl::PointXYZ>& points, const PointsGrid& points_grid,
+                            const CrossWalk& crosswalk, const geometry_msgs::PoseStamped& localizer_pose,
+                            const int points_threshold, ObstaclePoints* obstacle_points)
 {
   int crosswalk_id = crosswalk.getDetectionCrossWalkID();
   double search_radius = crosswalk.getDetectionPoints(crosswalk_id).width / 2;
   // std::vector<int> crosswalk_ids crosswalk.getDetectionCrossWalkIDs();
 
   // Search each calculated points in the crosswalk
+  std::vector<int> candidates;
   for (const auto& c_id : crosswalk.getDetectionCrossWalkIDs())
   {
     for (const auto& p : crosswalk.getDetectionPoints(c_id).points)
@@ -233,8 +234,10 @@ EControl crossWalkDetection(const pcl::PointCloud<pcl::PointXYZ>& points, const
       detection_vector.setZ(0.0);
 
       int stop_count = 0;  // the number of points in the detection area
-      for (const auto& p : points)
+      points_grid.findCandidates(detection_vector.x(), detection_vector.y(), search_radius, &candidates);
+      for (const auto& index : candidates)
       {
+        const pcl::PointXYZ& p = points[index];
         tf::Vector3 point_vector(p.x, p.y, 0.0);
         double distance = tf::tfDistance(point_vector, detection_vector);
         if (distance < search_radius)
@@ -258,14 +261,15 @@ EControl crossWalkDetection(const pcl::PointCloud<pcl::PointXYZ>& points, const
   return EControl::KEEP;  // find no obstacles
 }
 
-int detectStopObstacle(const pcl::PointCloud<pcl::PointXYZ>& points, const int closest_waypoint,
-                       const autoware_msgs::Lane& lane, const CrossWalk& crosswalk, double stop_range,
-                       double points_threshold, const geometry_msgs::PoseStamped& localizer_pose,
+int detectStopObstacle(const pcl::PointCloud<pcl::PointXYZ>& points, const PointsGrid& points_grid,
+                       const int closest_waypoint, const autoware_msgs::Lane& lane, const CrossWalk& crosswalk,
+                       double stop_range, double points_threshold, const geometry_msgs::PoseStamped& localizer_pose,
                        ObstaclePoints* obstacle_points, EObstacleType* obstacle_type,
                        const int wpidx_detection_result_by_other_nodes)
 {
   int stop_obstacle_waypoint = -1;
   *obstacle_type = EObstacleType::NONE;
+  std::vector<int> candidates;
   // start search from the closest waypoint
   for (int i = closest_waypoint; i < closest_waypoint + STOP_SEARCH_DISTANCE; i++)
   {
@@ -287,7 +291,8 @@ int detectStopObstacle(const pcl::PointCloud<pcl::PointXYZ>& points, const int c
     if (i == crosswalk.getDetectionWaypoint())
     {
       // found an obstacle in the cross walk
-      if (crossWalkDetection(points, crosswalk, localizer_pose, points_threshold, obstacle_points) == EControl::STOP)
+      if (crossWalkDetection(points, points_grid, crosswalk, localizer_pose, points_threshold, obstacle_points) ==
+          EControl::STOP)
       {
         stop_obstacle_waypoint = i;
         *obstacle_type = EObstacleType::ON_CROSSWALK;
@@ -301,8 +306,10 @@ int detectStopObstacle(const pcl::PointCloud<pcl::PointXYZ>& points, const int c
     tf_waypoint.setZ(0);
 
     int stop_point_count = 0;
-    for (const auto& p : points)
+    points_grid.findCandidates(tf_waypoint.x(), tf_waypoint.y(), stop_range, &candidates);
+    for (const auto& index : candidates)
     {
+      const pcl::PointXYZ& p = points[index];
       tf::Vector3 point_vector(p.x, p.y, 0);
 
       // 2D distance between waypoint and points (obstacle)
@@ -334,12 +341,13 @@ int detectStopObstacle(const pcl::PointCloud<pcl::PointXYZ>& points, const int c
   return stop_obstacle_waypoint;
 }
 
-int detectDecelerateObstacle(const pcl::PointCloud<pcl::PointXYZ>& points, const int closest_waypoint,
-                             const autoware_msgs::Lane& lane, const double stop_range, const double deceleration_range,
-                             const double points_threshold, const geometry_msgs::PoseStamped& localizer_pose,
-                             ObstaclePoints* obstacle_points)
+int detectDecelerateObstacle(const pcl::PointCloud<pcl::PointXYZ>& points, const PointsGrid& points_grid,
+                             const int closest_waypoint, const autoware_msgs::Lane& lane, const double stop_range,
+                             const double deceleration_range, const double points_threshold,
+                             const geometry_msgs::PoseStamped& localizer_pose, ObstaclePoints* obstacle_points)
 {
   int decelerate_obstacle_waypoint = -1;
+  std::vector<int> candidates;
   // start search from the closest waypoint
   for (int i = closest_waypoint; i < closest_waypoint + DECELERATION_SEARCH_DISTANCE; i++)
   {
@@ -353,8 +361,10 @@ int detectDecelerateObstacle(const pcl::PointCloud<pcl::PointXYZ>& points, const
     tf_waypoint.setZ(0);
 
     int decelerate_point_count = 0;
-    for (const auto& p : points)
+    points_grid.findCandidates(tf_waypoint.x(), tf_waypoint.y(), stop_range + deceleration_range, &candidates);
+    for (const auto& index : candidates)
     {
+      const pcl::PointXYZ& p = points[index];
       tf::Vector3 point_vector(p.x, p.y, 0);
 
       // 2D distance between waypoint and points (obstacle)
@@ -394,9 +404,13 @@ EControl pointsDetection(const pcl::PointCloud<pcl::PointXYZ>& points, const int
   if ((points.empty() == true && vs_info.getDetectionResultByOtherNodes() == -1) || closest_waypoint < 0)
     return EControl::KEEP;
 
+  // index the points once per cycle, each waypoint then only checks the points of the nearby cells
+  static PointsGrid points_grid;
+  points_grid.setPoints(points, vs_info.getStopRange() + vs_info.getDecelerationRange());
+
   EObstacleType obstacle_type = EObstacleType::NONE;
   int stop_obstacle_waypoint =
-      detectStopObstacle(points, closest_waypoint, lane, crosswalk, vs_info.getStopRange(),
+      detectStopObstacle(points, points_grid, closest_waypoint, lane, crosswalk, vs_info.getStopRange(),
                          vs_info.getPointsThreshold(), vs_info.getLocalizerPose(),
                          obstacle_points, &obstacle_type, vs_info.getDetectionResultByOtherNodes());
 
@@ -415,7 +429,8 @@ EControl pointsDetection(const pcl::PointCloud<pcl::PointXYZ>& points, const int
   }
 
   int decelerate_obstacle_waypoint =
-      detectDecelerateObstacle(points, closest_waypoint, lane, vs_info.getStopRange(), vs_info.getDecelerationRange(),
+      detectDecelerateObstacle(points, points_grid, closest_waypoint, lane, vs_info.getStopRange(),
+                               vs_info.getDecelerationRange(),
                                vs_info.getPointsThreshold(), vs_info.getLocalizerPose(), obstacle_points);
 
   // stop obstacle was not found
@@ -451,7 +466,7 @@ EControl pointsDetection(const pcl::PointCloud<pcl::PointXYZ>& points, const int
 }
 
 EControl obstacleDetection(int closest_waypoint, const autoware_msgs::Lane& lane, const CrossWalk& crosswalk,
-                           const VelocitySetInfo vs_info, const ros::Publisher& detection_range_pub,
+                           const VelocitySetInfo& vs_info, const ros::Publisher& detection_range_pub,
                            const ros::Publisher& obstacle_pub, int* obstacle_waypoint)
 {
   ObstaclePoints obstacle_points;
@@ -0,0 +1,216 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Replay the detected objects of a bag file through the roll out cost evaluation of op_trajectory_evaluator
+// and report the time of each planning cycle. The global path, roll outs, pose and velocity used for an
+// object array are the last ones recorded before it. Set OMP_NUM_THREADS to compare thread counts.
+
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <tf/tf.h>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/TwistStamped.h>
+#include <autoware_msgs/LaneArray.h>
+#include <autoware_msgs/DetectedObjectArray.h>
+
+#include "op_planner/PlannerCommonDef.h"
+#include "op_planner/TrajectoryDynamicCosts.h"
+#include "op_ros_helpers/op_RosHelpers.h"
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, "op_trajectory_evaluator_benchmark");
+
+	if(argc < 2)
+	{
+		std::cerr << "Usage: rosrun op_local_planner op_trajectory_evaluator_benchmark BAG [_enablePrediction:=true] [_repeat:=N] ..." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// op_common_params defaults
+	ros::NodeHandle private_nh("~");
+	PlannerHNS::PlanningParams params;
+	PlannerHNS::CAR_BASIC_INFO car_info;
+	bool bEnablePrediction;
+	int repeat;
+	private_nh.param<bool>("enablePrediction", bEnablePrediction, true);
+	private_nh.param<int>("repeat", repeat, 1);
+	private_nh.param<double>("horizontalSafetyDistance", params.horizontalSafetyDistancel, 1.2);
+	private_nh.param<double>("verticalSafetyDistance", params.verticalSafetyDistance, 0.8);
+	private_nh.param<double>("minVelocity", params.minSpeed, 0.1);
+	private_nh.param<double>("pathDensity", params.pathDensity, 0.5);
+	private_nh.param<double>("rollOutDensity", params.rollOutDensity, 0.5);
+	private_nh.param<int>("rollOutsNumber", params.rollOutNumber, 6);
+	private_nh.param<double>("horizonDistance", params.horizonDistance, 200);
+	private_nh.param<double>("minFollowingDistance", params.minFollowingDistance, 35.0);
+	private_nh.param<double>("width", car_info.width, 1.85);
+	private_nh.param<double>("length", car_info.length, 4.2);
+	private_nh.param<double>("wheelBaseLength", car_info.wheel_base, 2.7);
+	private_nh.param<double>("maxSteerAngle", car_info.max_steer_angle, 0.45);
+
+	rosbag::Bag bag;
+	try
+	{
+		bag.open(argv[1], rosbag::bagmode::Read);
+	}
+	catch(const rosbag::BagException& e)
+	{
+		std::cerr << "cannot open " << argv[1] << ": " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// Inputs of each planning cycle, in the way op_trajectory_evaluator converts them
+	struct Cycle
+	{
+		std::vector<PlannerHNS::WayPoint> globalPathSection;
+		std::vector<std::vector<PlannerHNS::WayPoint> > rollOuts;
+		PlannerHNS::WayPoint currentPos;
+		PlannerHNS::VehicleState vehicleStatus;
+		std::vector<PlannerHNS::DetectedObject> objects;
+	};
+	std::vector<Cycle> cycles;
+
+	std::vector<std::string> topics;
+	topics.push_back("/lane_waypoints_array");
+	topics.push_back("/local_trajectories");
+	topics.push_back("/current_pose");
+	topics.push_back("/current_velocity");
+	topics.push_back("/predicted_objects");
+
+	std::vector<PlannerHNS::WayPoint> globalPath;
+	Cycle cycle;
+	bool bCurrentPos = false;
+	rosbag::View view(bag, rosbag::TopicQuery(topics));
+	for(rosbag::View::iterator it = view.begin(); it != view.end(); it++)
+	{
+		if(autoware_msgs::LaneArray::ConstPtr msg = it->instantiate<autoware_msgs::LaneArray>())
+		{
+			if(msg->lanes.size() == 0)
+				continue;
+
+			if(it->getTopic() == "/lane_waypoints_array")
+			{
+				PlannerHNS::RosHelpers::ConvertFromAutowareLaneToLocalLane(msg->lanes.at(0), globalPath);
+				PlannerHNS::PlanningHelpers::CalcAngleAndCost(globalPath);
+			}
+			else
+			{
+				cycle.rollOuts.clear();
+				for(unsigned int i = 0 ; i < msg->lanes.size(); i++)
+				{
+					std::vector<PlannerHNS::WayPoint> path;
+					PlannerHNS::RosHelpers::ConvertFromAutowareLaneToLocalLane(msg->lanes.at(i), path);
+					cycle.rollOuts.push_back(path);
+				}
+			}
+		}
+		else if(geometry_msgs::PoseStamped::ConstPtr msg = it->instantiate<geometry_msgs::PoseStamped>())
+		{
+			double v = cycle.currentPos.v;
+			cycle.currentPos = PlannerHNS::WayPoint(msg->pose.position.x, msg->pose.position.y, msg->pose.position.z, tf::getYaw(msg->pose.orientation));
+			cycle.currentPos.v = v;
+			bCurrentPos = true;
+		}
+		else if(geometry_msgs::TwistStamped::ConstPtr msg = it->instantiate<geometry_msgs::TwistStamped>())
+		{
+			cycle.vehicleStatus.speed = msg->twist.linear.x;
+			cycle.currentPos.v = cycle.vehicleStatus.speed;
+			if(fabs(msg->twist.linear.x) > 0.25)
+				cycle.vehicleStatus.steer = atan(car_info.wheel_base * msg->twist.angular.z/msg->twist.linear.x);
+		}
+		else if(autoware_msgs::DetectedObjectArray::ConstPtr msg = it->instantiate<autoware_msgs::DetectedObjectArray>())
+		{
+			if(!bCurrentPos || globalPath.size() == 0 || cycle.rollOuts.size() == 0)
+				continue;
+
+			cycle.objects.clear();
+			PlannerHNS::DetectedObject obj;
+			for(unsigned int i = 0 ; i < msg->objects.size(); i++)
+			{
+				if(msg->objects.at(i).id > 0)
+				{
+					PlannerHNS::RosHelpers::ConvertFromAutowareDetectedObjectToOpenPlannerDetectedObject(msg->objects.at(i), obj);
+					cycle.objects.push_back(obj);
+				}
+			}
+
+			cycle.globalPathSection.clear();
+			PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(globalPath, cycle.currentPos, params.horizonDistance, params.pathDensity, cycle.globalPathSection);
+			if(cycle.globalPathSection.size() > 0)
+				cycles.push_back(cycle);
+		}
+	}
+	bag.close();
+
+	if(cycles.size() == 0)
+	{
+		std::cerr << "no planning cycle, the bag needs /lane_waypoints_array, /local_trajectories, /current_pose and /predicted_objects" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	PlannerHNS::TrajectoryDynamicCosts costsCalculator;
+	std::vector<double> times;
+	unsigned int nObjects = 0, maxObjects = 0, nBlocked = 0;
+	for(int r = 0; r < repeat; r++)
+	{
+		for(unsigned int i = 0; i < cycles.size(); i++)
+		{
+			const Cycle& c = cycles.at(i);
+			ros::WallTime begin = ros::WallTime::now();
+			PlannerHNS::TrajectoryCost tc;
+			if(bEnablePrediction)
+				tc = costsCalculator.DoOneStepDynamic(c.rollOuts, c.globalPathSection, c.currentPos, params, car_info, c.vehicleStatus, c.objects);
+			else
+				tc = costsCalculator.DoOneStepStatic(c.rollOuts, c.globalPathSection, c.currentPos, params, car_info, c.vehicleStatus, c.objects);
+			times.push_back((ros::WallTime::now() - begin).toSec() * 1000.0);
+
+			nObjects += c.objects.size();
+			maxObjects = std::max(maxObjects, (unsigned int)c.objects.size());
+			if(tc.bBlocked)
+				nBlocked++;
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+	double sum = 0;
+	for(unsigned int i = 0; i < times.size(); i++)
+		sum += times.at(i);
+	std::cout << "cycles: " << times.size() << ", blocked: " << nBlocked
+			<< ", objects mean: " << (double)nObjects / times.size() << ", max: " << maxObjects << std::endl;
+	std::cout << "time [ms] mean: " << sum / times.size() << ", median: " << times.at(times.size() / 2)
+			<< ", max: " << times.back() << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _POINTS_MAP_TILES_H_
+#define _POINTS_MAP_TILES_H_
+
+#include <cstdint>
+#include <fstream>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sensor_msgs/PointCloud2.h>
+
+/*
+ * Tiled points map file (*.pmt), little endian:
+ *
+ *   PointsMapTilesHeader
+ *   PointsMapTileField x field_num
+ *   PointsMapTile      x tile_num
+ *   point data of each tile, starting on a page boundary
+ *
+ * Every tile shares the same point layout, so a tile can be published as a
+ * sensor_msgs::PointCloud2 by copying its data out of the mapped file.
+ */
+
+#define POINTS_MAP_TILES_MAGIC   "PMTL"
+#define POINTS_MAP_TILES_VERSION (1)
+
+struct PointsMapTilesHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t field_num;
+	uint32_t point_step;
+	uint64_t tile_num;
+};
+
+struct PointsMapTileField {
+	char name[32];
+	uint32_t offset;
+	uint32_t datatype;
+	uint32_t count;
+	uint32_t reserved;
+};
+
+struct PointsMapTile {
+	double x_min;
+	double y_min;
+	double z_min;
+	double x_max;
+	double y_max;
+	double z_max;
+	uint64_t offset; // from the beginning of the file
+	uint64_t width;  // number of points
+};
+
+class PointsMapTileWriter {
+private:
+	std::ofstream ofs_;
+	uint64_t tile_num_;
+	std::vector<PointsMapTile> tiles_;
+	std::vector<sensor_msgs::PointField> fields_;
+	uint32_t point_step_;
+
+	void write_header();
+
+public:
+	PointsMapTileWriter();
+
+	// tile_num must be the number of tiles that will be added
+	bool open(const std::string& path, uint64_t tile_num);
+	bool add_tile(const sensor_msgs::PointCloud2& pcd,
+		      double x_min, double y_min, double z_min,
+		      double x_max, double y_max, double z_max);
+	bool close();
+};
+
+class PointsMapTileReader {
+private:
+	int fd_;
+	void *addr_;
+	size_t length_;
+	std::vector<sensor_msgs::PointField> fields_;
+	uint32_t point_step_;
+	std::vector<PointsMapTile> tiles_;
+
+public:
+	PointsMapTileReader();
+	~PointsMapTileReader();
+
+	PointsMapTileReader(const PointsMapTileReader&) = delete;
+	PointsMapTileReader& operator=(const PointsMapTileReader&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+
+	size_t tile_num() const;
+	const PointsMapTile& tile(size_t i) const;
+
+	// Copy the points of tile i out of the mapped file
+	void load_tile(size_t i, sensor_msgs::PointCloud2& pcd) const;
+
+	// Tell the kernel that the pages of tile i may be dropped
+	void release_tile(size_t i) const;
+};
+
+// Least recently used cache of loaded tiles, bounded by the size of the point data
+class PointsMapTileCache {
+private:
+	const PointsMapTileReader& reader_;
+	size_t capacity_;
+	size_t size_;
+	std::list<size_t> lru_; // front is the most recently used
+	std::map<size_t, std::pair<std::list<size_t>::iterator, sensor_msgs::PointCloud2ConstPtr>> tiles_;
+
+public:
+	PointsMapTileCache(const PointsMapTileReader& reader, size_t capacity);
+
+	sensor_msgs::PointCloud2ConstPtr get(size_t i);
+	void clear();
+};
+
+#endif /* _POINTS_MAP_TILES_H_ */
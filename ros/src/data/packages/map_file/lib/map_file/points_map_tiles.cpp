@@ -0,0 +1,323 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <iostream>
+
+#include <map_file/points_map_tiles.h>
+
+namespace {
+
+uint64_t page_align(uint64_t offset)
+{
+	uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+	return (offset + page_size - 1) / page_size * page_size;
+}
+
+bool is_same_fields(const std::vector<sensor_msgs::PointField>& a, const std::vector<sensor_msgs::PointField>& b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); ++i) {
+		if (a[i].name != b[i].name || a[i].offset != b[i].offset || a[i].datatype != b[i].datatype ||
+		    a[i].count != b[i].count)
+			return false;
+	}
+	return true;
+}
+
+} // namespace
+
+PointsMapTileWriter::PointsMapTileWriter()
+	: tile_num_(0), point_step_(0)
+{
+}
+
+bool PointsMapTileWriter::open(const std::string& path, uint64_t tile_num)
+{
+	ofs_.open(path.c_str(), std::ios::binary | std::ios::trunc);
+	tile_num_ = tile_num;
+	tiles_.clear();
+	fields_.clear();
+	point_step_ = 0;
+	return ofs_.is_open();
+}
+
+void PointsMapTileWriter::write_header()
+{
+	PointsMapTilesHeader header;
+	memcpy(header.magic, POINTS_MAP_TILES_MAGIC, sizeof(header.magic));
+	header.version = POINTS_MAP_TILES_VERSION;
+	header.field_num = fields_.size();
+	header.point_step = point_step_;
+	header.tile_num = tile_num_;
+	ofs_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+	for (const sensor_msgs::PointField& f : fields_) {
+		PointsMapTileField field;
+		memset(&field, 0, sizeof(field));
+		strncpy(field.name, f.name.c_str(), sizeof(field.name) - 1);
+		field.offset = f.offset;
+		field.datatype = f.datatype;
+		field.count = f.count;
+		ofs_.write(reinterpret_cast<const char *>(&field), sizeof(field));
+	}
+
+	// Reserve the tile table, it is filled in by close()
+	PointsMapTile tile;
+	memset(&tile, 0, sizeof(tile));
+	for (uint64_t i = 0; i < tile_num_; ++i)
+		ofs_.write(reinterpret_cast<const char *>(&tile), sizeof(tile));
+}
+
+bool PointsMapTileWriter::add_tile(const sensor_msgs::PointCloud2& pcd,
+				   double x_min, double y_min, double z_min,
+				   double x_max, double y_max, double z_max)
+{
+	if (!ofs_.is_open() || tiles_.size() >= tile_num_)
+		return false;
+
+	if (tiles_.empty()) {
+		fields_ = pcd.fields;
+		point_step_ = pcd.point_step;
+		write_header();
+	} else if (pcd.point_step != point_step_ || !is_same_fields(pcd.fields, fields_)) {
+		std::cerr << "point fields differ from the first tile" << std::endl;
+		return false;
+	}
+
+	PointsMapTile tile;
+	tile.x_min = x_min;
+	tile.y_min = y_min;
+	tile.z_min = z_min;
+	tile.x_max = x_max;
+	tile.y_max = y_max;
+	tile.z_max = z_max;
+	tile.offset = page_align(static_cast<uint64_t>(ofs_.tellp()));
+	tile.width = static_cast<uint64_t>(pcd.width) * pcd.height;
+
+	// Rows of an organized cloud may be padded, so copy point by point
+	std::vector<char> padding(tile.offset - static_cast<uint64_t>(ofs_.tellp()), 0);
+	ofs_.write(padding.data(), padding.size());
+	if (pcd.row_step == pcd.width * pcd.point_step) {
+		ofs_.write(reinterpret_cast<const char *>(pcd.data.data()), tile.width * point_step_);
+	} else {
+		for (uint32_t row = 0; row < pcd.height; ++row)
+			ofs_.write(reinterpret_cast<const char *>(&pcd.data[row * pcd.row_step]),
+				   pcd.width * point_step_);
+	}
+
+	tiles_.push_back(tile);
+	return ofs_.good();
+}
+
+bool PointsMapTileWriter::close()
+{
+	if (!ofs_.is_open())
+		return false;
+
+	bool ok = (tiles_.size() == tile_num_);
+	if (ok) {
+		ofs_.seekp(sizeof(PointsMapTilesHeader) + fields_.size() * sizeof(PointsMapTileField));
+		ofs_.write(reinterpret_cast<const char *>(tiles_.data()), tiles_.size() * sizeof(PointsMapTile));
+		ok = ofs_.good();
+	} else {
+		std::cerr << "expected " << tile_num_ << " tiles, got " << tiles_.size() << std::endl;
+	}
+	ofs_.close();
+	return ok;
+}
+
+PointsMapTileReader::PointsMapTileReader()
+	: fd_(-1), addr_(MAP_FAILED), length_(0), point_step_(0)
+{
+}
+
+PointsMapTileReader::~PointsMapTileReader()
+{
+	close();
+}
+
+bool PointsMapTileReader::open(const std::string& path)
+{
+	close();
+
+	fd_ = ::open(path.c_str(), O_RDONLY);
+	if (fd_ < 0) {
+		std::cerr << "cannot open " << path << std::endl;
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PointsMapTilesHeader)) {
+		std::cerr << "invalid tile file " << path << std::endl;
+		close();
+		return false;
+	}
+	length_ = st.st_size;
+
+	addr_ = mmap(NULL, length_, PROT_READ, MAP_SHARED, fd_, 0);
+	if (addr_ == MAP_FAILED) {
+		std::cerr << "cannot map " << path << std::endl;
+		close();
+		return false;
+	}
+
+	const char *base = static_cast<const char *>(addr_);
+	PointsMapTilesHeader header;
+	memcpy(&header, base, sizeof(header));
+	size_t table_end = sizeof(header) + header.field_num * sizeof(PointsMapTileField) +
+		header.tile_num * sizeof(PointsMapTile);
+	if (memcmp(header.magic, POINTS_MAP_TILES_MAGIC, sizeof(header.magic)) != 0 ||
+	    header.version != POINTS_MAP_TILES_VERSION || table_end > length_) {
+		std::cerr << "unsupported tile file " << path << std::endl;
+		close();
+		return false;
+	}
+	point_step_ = header.point_step;
+
+	const PointsMapTileField *fields =
+		reinterpret_cast<const PointsMapTileField *>(base + sizeof(header));
+	for (uint32_t i = 0; i < header.field_num; ++i) {
+		sensor_msgs::PointField f;
+		f.name = std::string(fields[i].name, strnlen(fields[i].name, sizeof(fields[i].name)));
+		f.offset = fields[i].offset;
+		f.datatype = fields[i].datatype;
+		f.count = fields[i].count;
+		fields_.push_back(f);
+	}
+
+	const PointsMapTile *tiles = reinterpret_cast<const PointsMapTile *>(fields + header.field_num);
+	tiles_.assign(tiles, tiles + header.tile_num);
+	for (const PointsMapTile& tile : tiles_) {
+		if (tile.offset + tile.width * point_step_ > length_) {
+			std::cerr << "truncated tile file " << path << std::endl;
+			close();
+			return false;
+		}
+	}
+
+	// Tiles are read on demand, do not let the kernel read ahead the whole map
+	madvise(addr_, length_, MADV_RANDOM);
+
+	return true;
+}
+
+void PointsMapTileReader::close()
+{
+	if (addr_ != MAP_FAILED)
+		munmap(addr_, length_);
+	if (fd_ >= 0)
+		::close(fd_);
+	fd_ = -1;
+	addr_ = MAP_FAILED;
+	length_ = 0;
+	fields_.clear();
+	point_step_ = 0;
+	tiles_.clear();
+}
+
+size_t PointsMapTileReader::tile_num() const
+{
+	return tiles_.size();
+}
+
+const PointsMapTile& PointsMapTileReader::tile(size_t i) const
+{
+	return tiles_.at(i);
+}
+
+void PointsMapTileReader::load_tile(size_t i, sensor_msgs::PointCloud2& pcd) const
+{
+	const PointsMapTile& t = tiles_.at(i);
+	const uint8_t *begin = static_cast<const uint8_t *>(addr_) + t.offset;
+
+	pcd.height = 1;
+	pcd.width = t.width;
+	pcd.fields = fields_;
+	pcd.is_bigendian = false;
+	pcd.point_step = point_step_;
+	pcd.row_step = t.width * point_step_;
+	pcd.is_dense = false;
+	pcd.data.assign(begin, begin + pcd.row_step);
+}
+
+void PointsMapTileReader::release_tile(size_t i) const
+{
+	const PointsMapTile& t = tiles_.at(i);
+	uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+	uint64_t begin = t.offset / page_size * page_size;
+	uint64_t end = page_align(t.offset + t.width * point_step_);
+	madvise(static_cast<char *>(addr_) + begin, end - begin, MADV_DONTNEED);
+}
+
+PointsMapTileCache::PointsMapTileCache(const PointsMapTileReader& reader, size_t capacity)
+	: reader_(reader), capacity_(capacity), size_(0)
+{
+}
+
+sensor_msgs::PointCloud2ConstPtr PointsMapTileCache::get(size_t i)
+{
+	auto it = tiles_.find(i);
+	if (it != tiles_.end()) {
+		lru_.splice(lru_.begin(), lru_, it->second.first);
+		return it->second.second;
+	}
+
+	sensor_msgs::PointCloud2Ptr pcd(new sensor_msgs::PointCloud2);
+	reader_.load_tile(i, *pcd);
+	reader_.release_tile(i);
+
+	lru_.push_front(i);
+	tiles_[i] = std::make_pair(lru_.begin(), pcd);
+	size_ += pcd->data.size();
+
+	// Keep at least the tile just loaded
+	while (size_ > capacity_ && lru_.size() > 1) {
+		auto victim = tiles_.find(lru_.back());
+		size_ -= victim->second.second->data.size();
+		tiles_.erase(victim);
+		lru_.pop_back();
+	}
+
+	return pcd;
+}
+
+void PointsMapTileCache::clear()
+{
+	lru_.clear();
+	tiles_.clear();
+	size_ = 0;
+}
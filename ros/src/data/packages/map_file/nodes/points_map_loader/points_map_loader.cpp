@@ -28,8 +28,12 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
 #include <condition_variable>
+#include <iterator>
+#include <memory>
 #include <queue>
+#include <set>
 #include <thread>
 
 #include <geometry_msgs/PoseWithCovarianceStamped.h>
@@ -40,6 +44,7 @@
 #include "autoware_msgs/LaneArray.h"
 
 #include <map_file/get_file.h>
+#include <map_file/points_map_tiles.h>
 
 namespace {
 
@@ -116,6 +121,7 @@ typedef std::vector<Area> AreaList;
 typedef std::vector<std::vector<std::string>> Tbl;
 
 constexpr int DEFAULT_UPDATE_RATE = 1000; // ms
+constexpr int DEFAULT_CACHE_SIZE = 1024; // MB
 constexpr double MARGIN_UNIT = 100; // meter
 constexpr int ROUNDING_UNIT = 1000; // meter
 const std::string AREALIST_FILENAME = "arealist.txt";
@@ -141,6 +147,14 @@ std::vector<std::string> cached_arealist_paths;
 GetFile gf;
 RequestQueue request_queue;
 
+bool use_tiles;
+bool publish_full_map;
+ros::Publisher added_pub;
+ros::Publisher removed_pub;
+PointsMapTileReader tile_reader;
+std::unique_ptr<PointsMapTileCache> tile_cache;
+std::set<size_t> published_tiles;
+
 Tbl read_csv(const std::string& path)
 {
 	std::ifstream ifs(path.c_str());
@@ -369,6 +383,70 @@ void publish_pcd(sensor_msgs::PointCloud2 pcd, const int* errp = NULL)
 	}
 }
 
+bool is_in_tile(double x, double y, const PointsMapTile& tile, double m)
+{
+	return ((tile.x_min - m) <= x && x <= (tile.x_max + m) && (tile.y_min - m) <= y && y <= (tile.y_max + m));
+}
+
+void append_pcd(sensor_msgs::PointCloud2& pcd, const sensor_msgs::PointCloud2& part)
+{
+	if (pcd.width == 0) {
+		pcd = part;
+	} else {
+		pcd.width += part.width;
+		pcd.row_step += part.row_step;
+		pcd.data.insert(pcd.data.end(), part.data.begin(), part.data.end());
+	}
+}
+
+sensor_msgs::PointCloud2 create_tiles_pcd(const std::set<size_t>& tiles)
+{
+	sensor_msgs::PointCloud2 pcd;
+	for (size_t i : tiles)
+		append_pcd(pcd, *tile_cache->get(i));
+	pcd.header.frame_id = "map";
+	return pcd;
+}
+
+void publish_tiles(const geometry_msgs::Point& p)
+{
+	std::set<size_t> tiles;
+	for (size_t i = 0; i < tile_reader.tile_num(); ++i) {
+		if (is_in_tile(p.x, p.y, tile_reader.tile(i), margin))
+			tiles.insert(i);
+	}
+	if (tiles == published_tiles)
+		return;
+
+	// Only the tiles entering or leaving the window are sent as deltas
+	std::set<size_t> added, removed;
+	std::set_difference(tiles.begin(), tiles.end(), published_tiles.begin(), published_tiles.end(),
+			    std::inserter(added, added.end()));
+	std::set_difference(published_tiles.begin(), published_tiles.end(), tiles.begin(), tiles.end(),
+			    std::inserter(removed, removed.end()));
+
+	if (!removed.empty())
+		removed_pub.publish(create_tiles_pcd(removed));
+	if (!added.empty())
+		added_pub.publish(create_tiles_pcd(added));
+	published_tiles = tiles;
+
+	if (publish_full_map) {
+		publish_pcd(create_tiles_pcd(tiles));
+	} else {
+		stat_msg.data = true;
+		stat_pub.publish(stat_msg);
+	}
+}
+
+void publish_area(const geometry_msgs::Point& p)
+{
+	if (use_tiles)
+		publish_tiles(p);
+	else
+		publish_pcd(create_pcd(p));
+}
+
 void publish_gnss_pcd(const geometry_msgs::PoseStamped& msg)
 {
 	ros::Time now = ros::Time::now();
@@ -381,7 +459,7 @@ void publish_gnss_pcd(const geometry_msgs::PoseStamped& msg)
 	if (can_download)
 		request_queue.enqueue(msg.pose.position);
 
-	publish_pcd(create_pcd(msg.pose.position));
+	publish_area(msg.pose.position);
 }
 
 void publish_current_pcd(const geometry_msgs::PoseStamped& msg)
@@ -394,7 +472,7 @@ void publish_current_pcd(const geometry_msgs::PoseStamped& msg)
 	if (can_download)
 		request_queue.enqueue(msg.pose.position);
 
-	publish_pcd(create_pcd(msg.pose.position));
+	publish_area(msg.pose.position);
 }
 
 void publish_dragged_pcd(const geometry_msgs::PoseWithCovarianceStamped& msg)
@@ -416,7 +494,7 @@ void publish_dragged_pcd(const geometry_msgs::PoseWithCovarianceStamped& msg)
 	if (can_download)
 		request_queue.enqueue(p);
 
-	publish_pcd(create_pcd(p));
+	publish_area(p);
 }
 
 void request_lookahead_download(const autoware_msgs::LaneArray& msg)
@@ -455,6 +533,7 @@ void print_usage()
 	ROS_ERROR_STREAM("rosrun map_file points_map_loader noupdate [PCD]...");
 	ROS_ERROR_STREAM("rosrun map_file points_map_loader {1x1|3x3|5x5|7x7|9x9} AREALIST [PCD]...");
 	ROS_ERROR_STREAM("rosrun map_file points_map_loader {1x1|3x3|5x5|7x7|9x9} download");
+	ROS_ERROR_STREAM("rosrun map_file points_map_loader {1x1|3x3|5x5|7x7|9x9} tiles PMT");
 }
 
 } // namespace
@@ -509,6 +588,21 @@ int main(int argc, char **argv)
 			std::string password;
 			n.param<std::string>("points_map_loader/password", password, HTTP_PASSWORD);
 			gf = GetFile(host_name, port, user, password);
+		} else if (mode == "tiles") {
+			can_download = false;
+			if (argc < 4) {
+				print_usage();
+				return EXIT_FAILURE;
+			}
+			if (!tile_reader.open(argv[3])) {
+				ROS_ERROR_STREAM("failed to open tiles " << argv[3]);
+				return EXIT_FAILURE;
+			}
+			use_tiles = true;
+			int cache_size;
+			n.param<int>("points_map_loader/cache_size", cache_size, DEFAULT_CACHE_SIZE);
+			tile_cache.reset(new PointsMapTileCache(tile_reader, static_cast<size_t>(cache_size) * 1024 * 1024));
+			n.param<bool>("points_map_loader/publish_full_map", publish_full_map, true);
 		} else {
 			can_download = false;
 			arealist_path += argv[2];
@@ -521,6 +615,10 @@ int main(int argc, char **argv)
 
 	pcd_pub = n.advertise<sensor_msgs::PointCloud2>("points_map", 1, true);
 	stat_pub = n.advertise<std_msgs::Bool>("pmap_stat", 1, true);
+	if (use_tiles) {
+		added_pub = n.advertise<sensor_msgs::PointCloud2>("points_map/added", 1);
+		removed_pub = n.advertise<sensor_msgs::PointCloud2>("points_map/removed", 1);
+	}
 
 	stat_msg.data = false;
 	stat_pub.publish(stat_msg);
@@ -548,7 +646,7 @@ int main(int argc, char **argv)
 			} catch (std::exception &ex) {
 				ROS_ERROR_STREAM("failed to create thread from " << ex.what());
 			}
-		} else {
+		} else if (!use_tiles) {
 			AreaList areas = read_arealist(arealist_path);
 			for (const Area& area : areas) {
 				for (const std::string& path : pcd_paths) {
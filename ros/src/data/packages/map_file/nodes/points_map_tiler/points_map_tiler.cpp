@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Convert the PCD files of an area list into a tiled points map file
+ * that can be served by points_map_loader in tiles mode.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pcl/io/pcd_io.h>
+#include <pcl_conversions/pcl_conversions.h>
+
+#include <map_file/points_map_tiles.h>
+
+namespace {
+
+struct Area {
+	std::string path;
+	double x_min;
+	double y_min;
+	double z_min;
+	double x_max;
+	double y_max;
+	double z_max;
+};
+
+std::vector<Area> read_arealist(const std::string& path)
+{
+	std::ifstream ifs(path.c_str());
+	std::string line;
+	std::vector<Area> ret;
+	while (std::getline(ifs, line)) {
+		std::istringstream iss(line);
+		std::string col;
+		std::vector<std::string> cols;
+		while (std::getline(iss, col, ','))
+			cols.push_back(col);
+		if (cols.size() < 7)
+			continue;
+		Area area;
+		area.path = cols[0];
+		area.x_min = std::stod(cols[1]);
+		area.y_min = std::stod(cols[2]);
+		area.z_min = std::stod(cols[3]);
+		area.x_max = std::stod(cols[4]);
+		area.y_max = std::stod(cols[5]);
+		area.z_max = std::stod(cols[6]);
+		ret.push_back(area);
+	}
+	return ret;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		std::cerr << "Usage: rosrun map_file points_map_tiler AREALIST OUTPUT" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<Area> areas = read_arealist(argv[1]);
+	if (areas.empty()) {
+		std::cerr << "no area in " << argv[1] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	PointsMapTileWriter writer;
+	if (!writer.open(argv[2], areas.size())) {
+		std::cerr << "cannot open " << argv[2] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	for (const Area& area : areas) {
+		sensor_msgs::PointCloud2 pcd;
+		if (pcl::io::loadPCDFile(area.path.c_str(), pcd) == -1) {
+			std::cerr << "load failed " << area.path << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (!writer.add_tile(pcd, area.x_min, area.y_min, area.z_min, area.x_max, area.y_max, area.z_max)) {
+			std::cerr << "write failed " << area.path << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cerr << "tile " << area.path << " (" << pcd.width * pcd.height << " points)" << std::endl;
+	}
+
+	if (!writer.close())
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
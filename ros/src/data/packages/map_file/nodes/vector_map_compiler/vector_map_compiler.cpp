@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Compile the csv files of a vector map into a single binary file
+ * that can be loaded by vector_map_loader and the OpenPlanner map readers.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <vector_map/binary_map.h>
+
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    std::cerr << "Usage: rosrun map_file vector_map_compiler OUTPUT [CSV]..." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> file_paths(argv + 2, argv + argc);
+  vector_map::VectorMapData data;
+  vector_map::readCsvFiles(file_paths, data);
+  if (data.category == vector_map::Category::NONE)
+  {
+    std::cerr << "no vector map csv file" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!vector_map::writeBinaryMap(argv[1], data))
+  {
+    std::cerr << "write failed " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cerr << "compiled " << argv[1] << " (" << data.point.data.size() << " points, " << data.lane.data.size()
+            << " lanes)" << std::endl;
+  return EXIT_SUCCESS;
+}
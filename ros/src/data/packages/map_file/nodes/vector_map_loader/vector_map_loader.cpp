@@ -32,6 +32,7 @@
 #include <std_msgs/Bool.h>
 #include <visualization_msgs/MarkerArray.h>
 #include <vector_map/vector_map.h>
+#include <vector_map/binary_map.h>
 #include <map_file/get_file.h>
 #include <sys/stat.h>
 
@@ -117,6 +118,7 @@ void printUsage()
 {
   ROS_ERROR_STREAM("Usage:");
   ROS_ERROR_STREAM("rosrun map_file vector_map_loader [CSV]...");
+  ROS_ERROR_STREAM("rosrun map_file vector_map_loader [VMB]");
   ROS_ERROR_STREAM("rosrun map_file vector_map_loader download [X] [Y]");
 }
 
@@ -126,18 +128,6 @@ bool isDownloaded(const std::string& local_path)
   return stat(local_path.c_str(), &st) == 0;
 }
 
-template <class T, class U>
-U createObjectArray(const std::string& file_path)
-{
-  U obj_array;
-  // NOTE: Autoware want to use map messages with or without /use_sim_time.
-  // Therefore we don't set obj_array.header.stamp.
-  // obj_array.header.stamp = ros::Time::now();
-  obj_array.header.frame_id = "map";
-  obj_array.data = vector_map::parse<T>(file_path);
-  return obj_array;
-}
-
 visualization_msgs::Marker createLinkedLineMarker(const std::string& ns, int id, Color color, const VectorMap& vmap,
                                                   const Line& line)
 {
@@ -1071,177 +1061,80 @@ int main(int argc, char **argv)
     }
   }
 
-  vector_map::category_t category = Category::NONE;
-  for (const auto& file_path : file_paths)
+  vector_map::VectorMapData data;
+  if (file_paths.size() == 1 && vector_map::isBinaryMap(file_paths[0]))
   {
-    std::string file_name(basename(file_path.c_str()));
-    if (file_name == "idx.csv")
-    {
-      ; // XXX: This version of Autoware don't support index csv file now.
-    }
-    else if (file_name == "point.csv")
-    {
-      point_pub.publish(createObjectArray<Point, PointArray>(file_path));
-      category |= Category::POINT;
-    }
-    else if (file_name == "vector.csv")
-    {
-      vector_pub.publish(createObjectArray<Vector, VectorArray>(file_path));
-      category |= Category::VECTOR;
-    }
-    else if (file_name == "line.csv")
-    {
-      line_pub.publish(createObjectArray<Line, LineArray>(file_path));
-      category |= Category::LINE;
-    }
-    else if (file_name == "area.csv")
-    {
-      area_pub.publish(createObjectArray<Area, AreaArray>(file_path));
-      category |= Category::AREA;
-    }
-    else if (file_name == "pole.csv")
-    {
-      pole_pub.publish(createObjectArray<Pole, PoleArray>(file_path));
-      category |= Category::POLE;
-    }
-    else if (file_name == "box.csv")
-    {
-      box_pub.publish(createObjectArray<Box, BoxArray>(file_path));
-      category |= Category::BOX;
-    }
-    else if (file_name == "dtlane.csv")
-    {
-      dtlane_pub.publish(createObjectArray<DTLane, DTLaneArray>(file_path));
-      category |= Category::DTLANE;
-    }
-    else if (file_name == "node.csv")
-    {
-      node_pub.publish(createObjectArray<Node, NodeArray>(file_path));
-      category |= Category::NODE;
-    }
-    else if (file_name == "lane.csv")
-    {
-      lane_pub.publish(createObjectArray<Lane, LaneArray>(file_path));
-      category |= Category::LANE;
-    }
-    else if (file_name == "wayarea.csv")
-    {
-      way_area_pub.publish(createObjectArray<WayArea, WayAreaArray>(file_path));
-      category |= Category::WAY_AREA;
-    }
-    else if (file_name == "roadedge.csv")
-    {
-      road_edge_pub.publish(createObjectArray<RoadEdge, RoadEdgeArray>(file_path));
-      category |= Category::ROAD_EDGE;
-    }
-    else if (file_name == "gutter.csv")
-    {
-      gutter_pub.publish(createObjectArray<Gutter, GutterArray>(file_path));
-      category |= Category::GUTTER;
-    }
-    else if (file_name == "curb.csv")
-    {
-      curb_pub.publish(createObjectArray<Curb, CurbArray>(file_path));
-      category |= Category::CURB;
-    }
-    else if (file_name == "whiteline.csv")
-    {
-      white_line_pub.publish(createObjectArray<WhiteLine, WhiteLineArray>(file_path));
-      category |= Category::WHITE_LINE;
-    }
-    else if (file_name == "stopline.csv")
-    {
-      stop_line_pub.publish(createObjectArray<StopLine, StopLineArray>(file_path));
-      category |= Category::STOP_LINE;
-    }
-    else if (file_name == "zebrazone.csv")
-    {
-      zebra_zone_pub.publish(createObjectArray<ZebraZone, ZebraZoneArray>(file_path));
-      category |= Category::ZEBRA_ZONE;
-    }
-    else if (file_name == "crosswalk.csv")
-    {
-      cross_walk_pub.publish(createObjectArray<CrossWalk, CrossWalkArray>(file_path));
-      category |= Category::CROSS_WALK;
-    }
-    else if (file_name == "road_surface_mark.csv")
-    {
-      road_mark_pub.publish(createObjectArray<RoadMark, RoadMarkArray>(file_path));
-      category |= Category::ROAD_MARK;
-    }
-    else if (file_name == "poledata.csv")
-    {
-      road_pole_pub.publish(createObjectArray<RoadPole, RoadPoleArray>(file_path));
-      category |= Category::ROAD_POLE;
-    }
-    else if (file_name == "roadsign.csv")
-    {
-      road_sign_pub.publish(createObjectArray<RoadSign, RoadSignArray>(file_path));
-      category |= Category::ROAD_SIGN;
-    }
-    else if (file_name == "signaldata.csv")
-    {
-      signal_pub.publish(createObjectArray<Signal, SignalArray>(file_path));
-      category |= Category::SIGNAL;
-    }
-    else if (file_name == "streetlight.csv")
-    {
-      street_light_pub.publish(createObjectArray<StreetLight, StreetLightArray>(file_path));
-      category |= Category::STREET_LIGHT;
-    }
-    else if (file_name == "utilitypole.csv")
-    {
-      utility_pole_pub.publish(createObjectArray<UtilityPole, UtilityPoleArray>(file_path));
-      category |= Category::UTILITY_POLE;
-    }
-    else if (file_name == "guardrail.csv")
-    {
-      guard_rail_pub.publish(createObjectArray<GuardRail, GuardRailArray>(file_path));
-      category |= Category::GUARD_RAIL;
-    }
-    else if (file_name == "sidewalk.csv")
-    {
-      side_walk_pub.publish(createObjectArray<SideWalk, SideWalkArray>(file_path));
-      category |= Category::SIDE_WALK;
-    }
-    else if (file_name == "driveon_portion.csv")
-    {
-      drive_on_portion_pub.publish(createObjectArray<DriveOnPortion, DriveOnPortionArray>(file_path));
-      category |= Category::DRIVE_ON_PORTION;
-    }
-    else if (file_name == "intersection.csv")
-    {
-      cross_road_pub.publish(createObjectArray<CrossRoad, CrossRoadArray>(file_path));
-      category |= Category::CROSS_ROAD;
-    }
-    else if (file_name == "sidestrip.csv")
-    {
-      side_strip_pub.publish(createObjectArray<SideStrip, SideStripArray>(file_path));
-      category |= Category::SIDE_STRIP;
-    }
-    else if (file_name == "curvemirror.csv")
-    {
-      curve_mirror_pub.publish(createObjectArray<CurveMirror, CurveMirrorArray>(file_path));
-      category |= Category::CURVE_MIRROR;
-    }
-    else if (file_name == "wall.csv")
-    {
-      wall_pub.publish(createObjectArray<Wall, WallArray>(file_path));
-      category |= Category::WALL;
-    }
-    else if (file_name == "fence.csv")
-    {
-      fence_pub.publish(createObjectArray<Fence, FenceArray>(file_path));
-      category |= Category::FENCE;
-    }
-    else if (file_name == "railroad_crossing.csv")
-    {
-      rail_crossing_pub.publish(createObjectArray<RailCrossing, RailCrossingArray>(file_path));
-      category |= Category::RAIL_CROSSING;
-    }
-    else
-      ROS_ERROR_STREAM("unknown csv file: " << file_path);
+    if (!vector_map::readBinaryMap(file_paths[0], data))
+      return EXIT_FAILURE;
   }
+  else
+    vector_map::readCsvFiles(file_paths, data);
+
+  if (data.category & Category::POINT)
+    point_pub.publish(data.point);
+  if (data.category & Category::VECTOR)
+    vector_pub.publish(data.vector);
+  if (data.category & Category::LINE)
+    line_pub.publish(data.line);
+  if (data.category & Category::AREA)
+    area_pub.publish(data.area);
+  if (data.category & Category::POLE)
+    pole_pub.publish(data.pole);
+  if (data.category & Category::BOX)
+    box_pub.publish(data.box);
+  if (data.category & Category::DTLANE)
+    dtlane_pub.publish(data.dtlane);
+  if (data.category & Category::NODE)
+    node_pub.publish(data.node);
+  if (data.category & Category::LANE)
+    lane_pub.publish(data.lane);
+  if (data.category & Category::WAY_AREA)
+    way_area_pub.publish(data.way_area);
+  if (data.category & Category::ROAD_EDGE)
+    road_edge_pub.publish(data.road_edge);
+  if (data.category & Category::GUTTER)
+    gutter_pub.publish(data.gutter);
+  if (data.category & Category::CURB)
+    curb_pub.publish(data.curb);
+  if (data.category & Category::WHITE_LINE)
+    white_line_pub.publish(data.white_line);
+  if (data.category & Category::STOP_LINE)
+    stop_line_pub.publish(data.stop_line);
+  if (data.category & Category::ZEBRA_ZONE)
+    zebra_zone_pub.publish(data.zebra_zone);
+  if (data.category & Category::CROSS_WALK)
+    cross_walk_pub.publish(data.cross_walk);
+  if (data.category & Category::ROAD_MARK)
+    road_mark_pub.publish(data.road_mark);
+  if (data.category & Category::ROAD_POLE)
+    road_pole_pub.publish(data.road_pole);
+  if (data.category & Category::ROAD_SIGN)
+    road_sign_pub.publish(data.road_sign);
+  if (data.category & Category::SIGNAL)
+    signal_pub.publish(data.signal);
+  if (data.category & Category::STREET_LIGHT)
+    street_light_pub.publish(data.street_light);
+  if (data.category & Category::UTILITY_POLE)
+    utility_pole_pub.publish(data.utility_pole);
+  if (data.category & Category::GUARD_RAIL)
+    guard_rail_pub.publish(data.guard_rail);
+  if (data.category & Category::SIDE_WALK)
+    side_walk_pub.publish(data.side_walk);
+  if (data.category & Category::DRIVE_ON_PORTION)
+    drive_on_portion_pub.publish(data.drive_on_portion);
+  if (data.category & Category::CROSS_ROAD)
+    cross_road_pub.publish(data.cross_road);
+  if (data.category & Category::SIDE_STRIP)
+    side_strip_pub.publish(data.side_strip);
+  if (data.category & Category::CURVE_MIRROR)
+    curve_mirror_pub.publish(data.curve_mirror);
+  if (data.category & Category::WALL)
+    wall_pub.publish(data.wall);
+  if (data.category & Category::FENCE)
+    fence_pub.publish(data.fence);
+  if (data.category & Category::RAIL_CROSSING)
+    rail_crossing_pub.publish(data.rail_crossing);
+  vector_map::category_t category = data.category;
 
   VectorMap vmap;
   vmap.subscribe(nh, category);
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef VECTOR_MAP_BINARY_MAP_H
+#define VECTOR_MAP_BINARY_MAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vector_map/vector_map.h>
+
+/*
+ * Compiled vector map file (*.vmb), native (little endian) byte order:
+ *
+ *   BinaryMapHeader
+ *   BinaryMapTable x table_num
+ *   ROS serialized array message of each table, starting on an 8 byte boundary
+ *
+ * Each table holds one category of the map. The MD5 sum of the message definition is stored with it, so a file
+ * compiled against other vector_map_msgs is rejected instead of being deserialized into garbage.
+ */
+
+#define VECTOR_MAP_BINARY_MAGIC   "VMAPBIN"
+#define VECTOR_MAP_BINARY_VERSION (1)
+
+namespace vector_map
+{
+struct BinaryMapHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t table_num;
+};
+
+struct BinaryMapTable
+{
+  uint64_t category;
+  uint64_t offset;  // from the beginning of the file
+  uint64_t size;
+  char md5sum[32];
+};
+
+// All the categories of a vector map, as published on /vector_map_info/*
+struct VectorMapData
+{
+  category_t category;  // categories that have been read
+
+  PointArray point;
+  VectorArray vector;
+  LineArray line;
+  AreaArray area;
+  PoleArray pole;
+  BoxArray box;
+  DTLaneArray dtlane;
+  NodeArray node;
+  LaneArray lane;
+  WayAreaArray way_area;
+  RoadEdgeArray road_edge;
+  GutterArray gutter;
+  CurbArray curb;
+  WhiteLineArray white_line;
+  StopLineArray stop_line;
+  ZebraZoneArray zebra_zone;
+  CrossWalkArray cross_walk;
+  RoadMarkArray road_mark;
+  RoadPoleArray road_pole;
+  RoadSignArray road_sign;
+  SignalArray signal;
+  StreetLightArray street_light;
+  UtilityPoleArray utility_pole;
+  GuardRailArray guard_rail;
+  SideWalkArray side_walk;
+  DriveOnPortionArray drive_on_portion;
+  CrossRoadArray cross_road;
+  SideStripArray side_strip;
+  CurveMirrorArray curve_mirror;
+  WallArray wall;
+  FenceArray fence;
+  RailCrossingArray rail_crossing;
+
+  VectorMapData() : category(Category::NONE)
+  {
+  }
+};
+
+// Parse the csv files of a vector map, the category of each file is given by its name (point.csv, lane.csv, ...)
+void readCsvFiles(const std::vector<std::string>& file_paths, VectorMapData& data);
+
+bool isBinaryMap(const std::string& file_path);
+bool readBinaryMap(const std::string& file_path, VectorMapData& data);
+
+// Write the categories of data.category, the file is replaced only once it has been completely written
+bool writeBinaryMap(const std::string& file_path, const VectorMapData& data);
+} // namespace vector_map
+
+#endif // VECTOR_MAP_BINARY_MAP_H
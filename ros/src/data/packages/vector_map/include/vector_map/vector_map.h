@@ -31,6 +31,8 @@
 #ifndef VECTOR_MAP_VECTOR_MAP_H
 #define VECTOR_MAP_VECTOR_MAP_H
 
+#include <algorithm>
+#include <climits>
 #include <fstream>
 #include <ros/ros.h>
 #include <geometry_msgs/Point.h>
@@ -245,6 +247,9 @@ using Callback = std::function<void(const T&)>;
 template <class T>
 using Filter = std::function<bool(const T&)>;
 
+template <class T>
+using Indexer = std::function<int(const T&)>;
+
 template <class T, class U>
 class Handle
 {
@@ -253,14 +258,29 @@ private:
   Updater<T, U> update_;
   std::vector<Callback<U>> cbs_;
   std::map<Key<T>, T> map_;
+  std::map<std::string, Indexer<T>> indexers_;
+  std::map<std::string, std::vector<std::pair<int, Key<T>>>> indices_; // (value, key) sorted
 
   void subscribe(const U& msg)
   {
     update_(map_, msg);
+    for (const auto& indexer : indexers_)
+      updateIndex(indexer.first);
     for (const auto& cb : cbs_)
       cb(msg);
   }
 
+  void updateIndex(const std::string& name)
+  {
+    const Indexer<T>& indexer = indexers_.at(name);
+    std::vector<std::pair<int, Key<T>>>& index = indices_[name];
+    index.clear();
+    index.reserve(map_.size());
+    for (const auto& pair : map_)
+      index.push_back(std::make_pair(indexer(pair.second), pair.first));
+    std::sort(index.begin(), index.end());
+  }
+
 public:
   Handle()
   {
@@ -300,6 +320,33 @@ public:
     return vector;
   }
 
+  // The index named name is kept up to date with the map and finds the objects with indexer(object) == value
+  void registerIndex(const std::string& name, const Indexer<T>& indexer)
+  {
+    indexers_[name] = indexer;
+    updateIndex(name);
+  }
+
+  // Same result as findByFilter with indexer(object) == value, objects are in key order
+  std::vector<T> findByIndex(const std::string& name, int value) const
+  {
+    std::vector<T> vector;
+    auto it = indices_.find(name);
+    if (it == indices_.end())
+      return vector;
+    const std::vector<std::pair<int, Key<T>>>& index = it->second;
+    auto first = std::lower_bound(index.begin(), index.end(), std::make_pair(value, Key<T>(INT_MIN)));
+    for (auto pos = first; pos != index.end() && pos->first == value; ++pos)
+      vector.push_back(map_.find(pos->second)->second);
+    return vector;
+  }
+
+  void forEach(const Callback<T>& cb) const
+  {
+    for (const auto& pair : map_)
+      cb(pair.second);
+  }
+
   bool empty() const
   {
     return map_.empty();
@@ -395,8 +442,19 @@ private:
   Handle<Fence, FenceArray> fence_;
   Handle<RailCrossing, RailCrossingArray> rail_crossing_;
 
+  // XY grid over points, lines and areas, each entry is (cell key, id) sorted
+  double cell_size_;
+  std::vector<std::pair<long long, int>> point_cells_;
+  std::vector<std::pair<long long, int>> line_cells_;
+  std::vector<std::pair<long long, int>> area_cells_;
+
   bool hasSubscribed(category_t category) const;
   void registerSubscriber(ros::NodeHandle& nh, category_t category);
+  void updateSpatialIndex();
+  std::vector<int> findCellIds(const std::vector<std::pair<long long, int>>& cells, const Point& center,
+                               double radius) const;
+  bool isLineInRadius(const Line& line, const Point& center, double radius) const;
+  void forEachAreaLine(const Area& area, const Callback<Line>& cb) const;
 
 public:
   VectorMap();
@@ -471,6 +529,23 @@ public:
   std::vector<Fence> findByFilter(const Filter<Fence>& filter) const;
   std::vector<RailCrossing> findByFilter(const Filter<RailCrossing>& filter) const;
 
+  // Indexed queries, same results as the equivalent findByFilter (in key order) without scanning the whole map
+  std::vector<Node> findNodesByPoint(const Key<Point>& key) const; // node.pid
+  std::vector<Line> findLinesByStartPoint(const Key<Point>& key) const; // line.bpid
+  std::vector<Line> findLinesByEndPoint(const Key<Point>& key) const; // line.fpid
+  std::vector<Lane> findLanesByStartNode(const Key<Node>& key) const; // lane.bnid
+  std::vector<Lane> findLanesByEndNode(const Key<Node>& key) const; // lane.fnid
+
+  // Objects linked to a lane (T::linkid), defined for all the object data types that have a linkid
+  template <class T>
+  std::vector<T> findByLink(const Key<Lane>& key) const;
+
+  // Spatial queries on the XY plane (bx, ly), results are in key order.
+  // Lines are within radius if their segment is, areas if one of their boundary lines is.
+  std::vector<Point> findPointsInRadius(const Point& center, double radius) const;
+  std::vector<Line> findLinesInRadius(const Point& center, double radius) const;
+  std::vector<Area> findAreasInRadius(const Point& center, double radius) const;
+
   void registerCallback(const Callback<PointArray>& cb);
   void registerCallback(const Callback<VectorArray>& cb);
   void registerCallback(const Callback<LineArray>& cb);
@@ -505,6 +580,51 @@ public:
   void registerCallback(const Callback<RailCrossingArray>& cb);
 };
 
+template <>
+std::vector<RoadEdge> VectorMap::findByLink<RoadEdge>(const Key<Lane>& key) const;
+template <>
+std::vector<Gutter> VectorMap::findByLink<Gutter>(const Key<Lane>& key) const;
+template <>
+std::vector<Curb> VectorMap::findByLink<Curb>(const Key<Lane>& key) const;
+template <>
+std::vector<WhiteLine> VectorMap::findByLink<WhiteLine>(const Key<Lane>& key) const;
+template <>
+std::vector<StopLine> VectorMap::findByLink<StopLine>(const Key<Lane>& key) const;
+template <>
+std::vector<ZebraZone> VectorMap::findByLink<ZebraZone>(const Key<Lane>& key) const;
+template <>
+std::vector<CrossWalk> VectorMap::findByLink<CrossWalk>(const Key<Lane>& key) const;
+template <>
+std::vector<RoadMark> VectorMap::findByLink<RoadMark>(const Key<Lane>& key) const;
+template <>
+std::vector<RoadPole> VectorMap::findByLink<RoadPole>(const Key<Lane>& key) const;
+template <>
+std::vector<RoadSign> VectorMap::findByLink<RoadSign>(const Key<Lane>& key) const;
+template <>
+std::vector<Signal> VectorMap::findByLink<Signal>(const Key<Lane>& key) const;
+template <>
+std::vector<StreetLight> VectorMap::findByLink<StreetLight>(const Key<Lane>& key) const;
+template <>
+std::vector<UtilityPole> VectorMap::findByLink<UtilityPole>(const Key<Lane>& key) const;
+template <>
+std::vector<GuardRail> VectorMap::findByLink<GuardRail>(const Key<Lane>& key) const;
+template <>
+std::vector<SideWalk> VectorMap::findByLink<SideWalk>(const Key<Lane>& key) const;
+template <>
+std::vector<DriveOnPortion> VectorMap::findByLink<DriveOnPortion>(const Key<Lane>& key) const;
+template <>
+std::vector<CrossRoad> VectorMap::findByLink<CrossRoad>(const Key<Lane>& key) const;
+template <>
+std::vector<SideStrip> VectorMap::findByLink<SideStrip>(const Key<Lane>& key) const;
+template <>
+std::vector<CurveMirror> VectorMap::findByLink<CurveMirror>(const Key<Lane>& key) const;
+template <>
+std::vector<Wall> VectorMap::findByLink<Wall>(const Key<Lane>& key) const;
+template <>
+std::vector<Fence> VectorMap::findByLink<Fence>(const Key<Lane>& key) const;
+template <>
+std::vector<RailCrossing> VectorMap::findByLink<RailCrossing>(const Key<Lane>& key) const;
+
 extern const double COLOR_VALUE_MIN;
 extern const double COLOR_VALUE_MAX;
 extern const double COLOR_VALUE_MEDIAN;
@@ -0,0 +1,338 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <vector_map/binary_map.h>
+
+namespace vector_map
+{
+namespace
+{
+const uint64_t TABLE_ALIGNMENT = 8;
+
+// Call visitor(category, csv file name, array) for every category of data
+template <class T, class U>
+void visitArrays(T& data, U& visitor)
+{
+  visitor(Category::POINT, "point.csv", data.point);
+  visitor(Category::VECTOR, "vector.csv", data.vector);
+  visitor(Category::LINE, "line.csv", data.line);
+  visitor(Category::AREA, "area.csv", data.area);
+  visitor(Category::POLE, "pole.csv", data.pole);
+  visitor(Category::BOX, "box.csv", data.box);
+  visitor(Category::DTLANE, "dtlane.csv", data.dtlane);
+  visitor(Category::NODE, "node.csv", data.node);
+  visitor(Category::LANE, "lane.csv", data.lane);
+  visitor(Category::WAY_AREA, "wayarea.csv", data.way_area);
+  visitor(Category::ROAD_EDGE, "roadedge.csv", data.road_edge);
+  visitor(Category::GUTTER, "gutter.csv", data.gutter);
+  visitor(Category::CURB, "curb.csv", data.curb);
+  visitor(Category::WHITE_LINE, "whiteline.csv", data.white_line);
+  visitor(Category::STOP_LINE, "stopline.csv", data.stop_line);
+  visitor(Category::ZEBRA_ZONE, "zebrazone.csv", data.zebra_zone);
+  visitor(Category::CROSS_WALK, "crosswalk.csv", data.cross_walk);
+  visitor(Category::ROAD_MARK, "road_surface_mark.csv", data.road_mark);
+  visitor(Category::ROAD_POLE, "poledata.csv", data.road_pole);
+  visitor(Category::ROAD_SIGN, "roadsign.csv", data.road_sign);
+  visitor(Category::SIGNAL, "signaldata.csv", data.signal);
+  visitor(Category::STREET_LIGHT, "streetlight.csv", data.street_light);
+  visitor(Category::UTILITY_POLE, "utilitypole.csv", data.utility_pole);
+  visitor(Category::GUARD_RAIL, "guardrail.csv", data.guard_rail);
+  visitor(Category::SIDE_WALK, "sidewalk.csv", data.side_walk);
+  visitor(Category::DRIVE_ON_PORTION, "driveon_portion.csv", data.drive_on_portion);
+  visitor(Category::CROSS_ROAD, "intersection.csv", data.cross_road);
+  visitor(Category::SIDE_STRIP, "sidestrip.csv", data.side_strip);
+  visitor(Category::CURVE_MIRROR, "curvemirror.csv", data.curve_mirror);
+  visitor(Category::WALL, "wall.csv", data.wall);
+  visitor(Category::FENCE, "fence.csv", data.fence);
+  visitor(Category::RAIL_CROSSING, "railroad_crossing.csv", data.rail_crossing);
+}
+
+struct CsvReader
+{
+  std::string file_path;
+  std::string file_name;
+  category_t category;
+
+  explicit CsvReader(const std::string& path)
+    : file_path(path), file_name(path.substr(path.find_last_of('/') + 1)), category(Category::NONE)
+  {
+  }
+
+  template <class U>
+  void operator()(category_t c, const char* name, U& array)
+  {
+    if (file_name != name)
+      return;
+    // NOTE: Autoware want to use map messages with or without /use_sim_time.
+    // Therefore we don't set array.header.stamp.
+    array.header.frame_id = "map";
+    array.data = parse<typename U::_data_type::value_type>(file_path);
+    category = c;
+  }
+};
+
+struct TableWriter
+{
+  category_t category;
+  std::vector<BinaryMapTable> tables;
+  std::vector<std::vector<uint8_t>> payloads;
+
+  explicit TableWriter(category_t c) : category(c)
+  {
+  }
+
+  template <class U>
+  void operator()(category_t c, const char* name, const U& array)
+  {
+    if (!(category & c))
+      return;
+
+    uint32_t size = ros::serialization::serializationLength(array);
+    std::vector<uint8_t> payload(size);
+    ros::serialization::OStream os(payload.data(), size);
+    ros::serialization::serialize(os, array);
+
+    BinaryMapTable table;
+    memset(&table, 0, sizeof(table));
+    table.category = c;
+    table.size = size;
+    strncpy(table.md5sum, ros::message_traits::md5sum(array), sizeof(table.md5sum));
+    tables.push_back(table);
+    payloads.push_back(std::move(payload));
+  }
+};
+
+struct TableReader
+{
+  uint8_t* addr;
+  BinaryMapTable table;
+  bool found;
+  bool read;
+
+  TableReader(uint8_t* a, const BinaryMapTable& t) : addr(a), table(t), found(false), read(false)
+  {
+  }
+
+  template <class U>
+  void operator()(category_t c, const char* name, U& array)
+  {
+    if (table.category != c)
+      return;
+    found = true;
+
+    if (strncmp(table.md5sum, ros::message_traits::md5sum(array), sizeof(table.md5sum)) != 0)
+    {
+      ROS_ERROR_STREAM("vector map binary: " << name << " was compiled from another message definition");
+      return;
+    }
+
+    try
+    {
+      ros::serialization::IStream is(addr + table.offset, table.size);
+      ros::serialization::deserialize(is, array);
+      read = true;
+    }
+    catch (const ros::Exception& e)
+    {
+      ROS_ERROR_STREAM("vector map binary: " << name << " is broken: " << e.what());
+    }
+  }
+};
+
+struct MappedFile
+{
+  int fd;
+  void* addr;
+  size_t length;
+
+  MappedFile() : fd(-1), addr(MAP_FAILED), length(0)
+  {
+  }
+
+  ~MappedFile()
+  {
+    if (addr != MAP_FAILED)
+      munmap(addr, length);
+    if (fd >= 0)
+      close(fd);
+  }
+
+  bool open(const std::string& file_path)
+  {
+    fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+      return false;
+    length = static_cast<size_t>(st.st_size);
+    addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    return addr != MAP_FAILED;
+  }
+};
+} // namespace
+
+void readCsvFiles(const std::vector<std::string>& file_paths, VectorMapData& data)
+{
+  for (const auto& file_path : file_paths)
+  {
+    CsvReader reader(file_path);
+    visitArrays(data, reader);
+    if (reader.category != Category::NONE)
+      data.category |= reader.category;
+    else if (reader.file_name != "idx.csv") // XXX: This version of Autoware don't support index csv file now.
+      ROS_ERROR_STREAM("unknown csv file: " << file_path);
+  }
+}
+
+bool isBinaryMap(const std::string& file_path)
+{
+  std::ifstream ifs(file_path.c_str(), std::ios::binary);
+  char magic[sizeof(BinaryMapHeader::magic)];
+  if (!ifs.read(magic, sizeof(magic)))
+    return false;
+  return memcmp(magic, VECTOR_MAP_BINARY_MAGIC, sizeof(magic)) == 0;
+}
+
+bool readBinaryMap(const std::string& file_path, VectorMapData& data)
+{
+  MappedFile file;
+  if (!file.open(file_path))
+  {
+    ROS_ERROR_STREAM("cannot map vector map binary: " << file_path);
+    return false;
+  }
+
+  uint8_t* addr = static_cast<uint8_t*>(file.addr);
+  BinaryMapHeader header;
+  if (file.length < sizeof(header))
+  {
+    ROS_ERROR_STREAM("vector map binary is too short: " << file_path);
+    return false;
+  }
+  memcpy(&header, addr, sizeof(header));
+  if (memcmp(header.magic, VECTOR_MAP_BINARY_MAGIC, sizeof(header.magic)) != 0)
+  {
+    ROS_ERROR_STREAM("not a vector map binary: " << file_path);
+    return false;
+  }
+  if (header.version != VECTOR_MAP_BINARY_VERSION)
+  {
+    ROS_ERROR_STREAM("unsupported vector map binary version " << header.version << ": " << file_path);
+    return false;
+  }
+  if (header.table_num > (file.length - sizeof(header)) / sizeof(BinaryMapTable))
+  {
+    ROS_ERROR_STREAM("vector map binary is too short: " << file_path);
+    return false;
+  }
+
+  for (uint32_t i = 0; i < header.table_num; ++i)
+  {
+    BinaryMapTable table;
+    memcpy(&table, addr + sizeof(header) + i * sizeof(table), sizeof(table));
+    if (table.offset > file.length || table.size > file.length - table.offset)
+    {
+      ROS_ERROR_STREAM("vector map binary is too short: " << file_path);
+      return false;
+    }
+
+    TableReader reader(addr, table);
+    visitArrays(data, reader);
+    if (!reader.found)
+    {
+      ROS_ERROR_STREAM("unknown category " << table.category << " in vector map binary: " << file_path);
+      return false;
+    }
+    if (!reader.read)
+      return false;
+    data.category |= table.category;
+  }
+
+  return true;
+}
+
+bool writeBinaryMap(const std::string& file_path, const VectorMapData& data)
+{
+  TableWriter writer(data.category);
+  visitArrays(data, writer);
+
+  BinaryMapHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, VECTOR_MAP_BINARY_MAGIC, sizeof(header.magic));
+  header.version = VECTOR_MAP_BINARY_VERSION;
+  header.table_num = writer.tables.size();
+
+  uint64_t offset = sizeof(header) + writer.tables.size() * sizeof(BinaryMapTable);
+  for (auto& table : writer.tables)
+  {
+    offset = (offset + TABLE_ALIGNMENT - 1) / TABLE_ALIGNMENT * TABLE_ALIGNMENT;
+    table.offset = offset;
+    offset += table.size;
+  }
+
+  std::string tmp_path = file_path + ".tmp";
+  std::ofstream ofs(tmp_path.c_str(), std::ios::binary | std::ios::trunc);
+  if (!ofs)
+  {
+    ROS_ERROR_STREAM("cannot open " << tmp_path);
+    return false;
+  }
+
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  for (const auto& table : writer.tables)
+    ofs.write(reinterpret_cast<const char*>(&table), sizeof(table));
+  for (size_t i = 0; i < writer.tables.size(); ++i)
+  {
+    while (static_cast<uint64_t>(ofs.tellp()) < writer.tables[i].offset)
+      ofs.put('\0');
+    ofs.write(reinterpret_cast<const char*>(writer.payloads[i].data()), writer.payloads[i].size());
+  }
+
+  ofs.close();
+  if (!ofs || std::rename(tmp_path.c_str(), file_path.c_str()) != 0)
+  {
+    ROS_ERROR_STREAM("cannot write " << file_path);
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+
+  return true;
+}
+} // namespace vector_map
@@ -28,6 +28,10 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <set>
 #include <tf/transform_datatypes.h>
 #include <vector_map/vector_map.h>
 
@@ -386,6 +390,61 @@ void updateRailCrossing(std::map<Key<RailCrossing>, RailCrossing>& map, const Ra
     map.insert(std::make_pair(Key<RailCrossing>(item.id), item));
   }
 }
+
+// objects covering more cells than this are stored once under LARGE_OBJECT_KEY and checked by every query
+const long long MAX_OBJECT_CELLS = 65536;
+const long long LARGE_OBJECT_KEY = LLONG_MIN;
+
+long long computeCellIndex(double value, double cell_size)
+{
+  return static_cast<long long>(std::floor(value / cell_size));
+}
+
+long long createCellKey(long long cell_x, long long cell_y)
+{
+  // cells of the same column are contiguous and sorted by y
+  return cell_x * 4294967296LL + (cell_y - INT_MIN);
+}
+
+bool isValidCellIndex(long long cell_index)
+{
+  return cell_index > INT_MIN && cell_index < INT_MAX;
+}
+
+void addCells(std::vector<std::pair<long long, int>>& cells, double min_x, double min_y, double max_x, double max_y,
+              double cell_size, int id)
+{
+  if (!std::isfinite(min_x) || !std::isfinite(min_y) || !std::isfinite(max_x) || !std::isfinite(max_y))
+    return;
+
+  long long min_cell_x = computeCellIndex(min_x, cell_size);
+  long long min_cell_y = computeCellIndex(min_y, cell_size);
+  long long max_cell_x = computeCellIndex(max_x, cell_size);
+  long long max_cell_y = computeCellIndex(max_y, cell_size);
+  if (!isValidCellIndex(min_cell_x) || !isValidCellIndex(min_cell_y) || !isValidCellIndex(max_cell_x) ||
+      !isValidCellIndex(max_cell_y) || (max_cell_x - min_cell_x + 1) * (max_cell_y - min_cell_y + 1) > MAX_OBJECT_CELLS)
+  {
+    cells.push_back(std::make_pair(LARGE_OBJECT_KEY, id));
+    return;
+  }
+
+  for (long long cell_x = min_cell_x; cell_x <= max_cell_x; ++cell_x)
+  {
+    for (long long cell_y = min_cell_y; cell_y <= max_cell_y; ++cell_y)
+      cells.push_back(std::make_pair(createCellKey(cell_x, cell_y), id));
+  }
+}
+
+double computeSegmentDistance(const Point& bp, const Point& fp, const Point& point)
+{
+  double dx = fp.bx - bp.bx;
+  double dy = fp.ly - bp.ly;
+  double length2 = dx * dx + dy * dy;
+  double t = 0;
+  if (length2 > 0)
+    t = std::min(std::max(((point.bx - bp.bx) * dx + (point.ly - bp.ly) * dy) / length2, 0.0), 1.0);
+  return std::hypot(bp.bx + t * dx - point.bx, bp.ly + t * dy - point.ly); // XXX: don't consider z axis
+}
 } // namespace
 
 bool VectorMap::hasSubscribed(category_t category) const
@@ -558,7 +617,11 @@ void VectorMap::registerSubscriber(ros::NodeHandle& nh, category_t category)
   if (category & POINT)
   {
     point_.registerSubscriber(nh, "/vector_map_info/point");
-    point_.registerUpdater(updatePoint);
+    point_.registerUpdater([this](std::map<Key<Point>, Point>& map, const PointArray& msg)
+                         {
+                           updatePoint(map, msg);
+                           updateSpatialIndex();
+                         });
   }
   if (category & VECTOR)
   {
@@ -568,12 +631,20 @@ void VectorMap::registerSubscriber(ros::NodeHandle& nh, category_t category)
   if (category & LINE)
   {
     line_.registerSubscriber(nh, "/vector_map_info/line");
-    line_.registerUpdater(updateLine);
+    line_.registerUpdater([this](std::map<Key<Line>, Line>& map, const LineArray& msg)
+                         {
+                           updateLine(map, msg);
+                           updateSpatialIndex();
+                         });
   }
   if (category & AREA)
   {
     area_.registerSubscriber(nh, "/vector_map_info/area");
-    area_.registerUpdater(updateArea);
+    area_.registerUpdater([this](std::map<Key<Area>, Area>& map, const AreaArray& msg)
+                         {
+                           updateArea(map, msg);
+                           updateSpatialIndex();
+                         });
   }
   if (category & POLE)
   {
@@ -718,7 +789,35 @@ void VectorMap::registerSubscriber(ros::NodeHandle& nh, category_t category)
 }
 
 VectorMap::VectorMap()
-{
+  : cell_size_(10.0)
+{
+  node_.registerIndex("pid", [](const Node& node){ return node.pid; });
+  line_.registerIndex("bpid", [](const Line& line){ return line.bpid; });
+  line_.registerIndex("fpid", [](const Line& line){ return line.fpid; });
+  lane_.registerIndex("bnid", [](const Lane& lane){ return lane.bnid; });
+  lane_.registerIndex("fnid", [](const Lane& lane){ return lane.fnid; });
+  road_edge_.registerIndex("linkid", [](const RoadEdge& road_edge){ return road_edge.linkid; });
+  gutter_.registerIndex("linkid", [](const Gutter& gutter){ return gutter.linkid; });
+  curb_.registerIndex("linkid", [](const Curb& curb){ return curb.linkid; });
+  white_line_.registerIndex("linkid", [](const WhiteLine& white_line){ return white_line.linkid; });
+  stop_line_.registerIndex("linkid", [](const StopLine& stop_line){ return stop_line.linkid; });
+  zebra_zone_.registerIndex("linkid", [](const ZebraZone& zebra_zone){ return zebra_zone.linkid; });
+  cross_walk_.registerIndex("linkid", [](const CrossWalk& cross_walk){ return cross_walk.linkid; });
+  road_mark_.registerIndex("linkid", [](const RoadMark& road_mark){ return road_mark.linkid; });
+  road_pole_.registerIndex("linkid", [](const RoadPole& road_pole){ return road_pole.linkid; });
+  road_sign_.registerIndex("linkid", [](const RoadSign& road_sign){ return road_sign.linkid; });
+  signal_.registerIndex("linkid", [](const Signal& signal){ return signal.linkid; });
+  street_light_.registerIndex("linkid", [](const StreetLight& street_light){ return street_light.linkid; });
+  utility_pole_.registerIndex("linkid", [](const UtilityPole& utility_pole){ return utility_pole.linkid; });
+  guard_rail_.registerIndex("linkid", [](const GuardRail& guard_rail){ return guard_rail.linkid; });
+  side_walk_.registerIndex("linkid", [](const SideWalk& side_walk){ return side_walk.linkid; });
+  drive_on_portion_.registerIndex("linkid", [](const DriveOnPortion& drive_on_portion){ return drive_on_portion.linkid; });
+  cross_road_.registerIndex("linkid", [](const CrossRoad& cross_road){ return cross_road.linkid; });
+  side_strip_.registerIndex("linkid", [](const SideStrip& side_strip){ return side_strip.linkid; });
+  curve_mirror_.registerIndex("linkid", [](const CurveMirror& curve_mirror){ return curve_mirror.linkid; });
+  wall_.registerIndex("linkid", [](const Wall& wall){ return wall.linkid; });
+  fence_.registerIndex("linkid", [](const Fence& fence){ return fence.linkid; });
+  rail_crossing_.registerIndex("linkid", [](const RailCrossing& rail_crossing){ return rail_crossing.linkid; });
 }
 
 void VectorMap::subscribe(ros::NodeHandle& nh, category_t category)
@@ -1076,6 +1175,315 @@ std::vector<RailCrossing> VectorMap::findByFilter(const Filter<RailCrossing>& fi
   return rail_crossing_.findByFilter(filter);
 }
 
+std::vector<Node> VectorMap::findNodesByPoint(const Key<Point>& key) const
+{
+  return node_.findByIndex("pid", key.getId());
+}
+
+std::vector<Line> VectorMap::findLinesByStartPoint(const Key<Point>& key) const
+{
+  return line_.findByIndex("bpid", key.getId());
+}
+
+std::vector<Line> VectorMap::findLinesByEndPoint(const Key<Point>& key) const
+{
+  return line_.findByIndex("fpid", key.getId());
+}
+
+std::vector<Lane> VectorMap::findLanesByStartNode(const Key<Node>& key) const
+{
+  return lane_.findByIndex("bnid", key.getId());
+}
+
+std::vector<Lane> VectorMap::findLanesByEndNode(const Key<Node>& key) const
+{
+  return lane_.findByIndex("fnid", key.getId());
+}
+
+template <>
+std::vector<RoadEdge> VectorMap::findByLink<RoadEdge>(const Key<Lane>& key) const
+{
+  return road_edge_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<Gutter> VectorMap::findByLink<Gutter>(const Key<Lane>& key) const
+{
+  return gutter_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<Curb> VectorMap::findByLink<Curb>(const Key<Lane>& key) const
+{
+  return curb_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<WhiteLine> VectorMap::findByLink<WhiteLine>(const Key<Lane>& key) const
+{
+  return white_line_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<StopLine> VectorMap::findByLink<StopLine>(const Key<Lane>& key) const
+{
+  return stop_line_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<ZebraZone> VectorMap::findByLink<ZebraZone>(const Key<Lane>& key) const
+{
+  return zebra_zone_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<CrossWalk> VectorMap::findByLink<CrossWalk>(const Key<Lane>& key) const
+{
+  return cross_walk_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<RoadMark> VectorMap::findByLink<RoadMark>(const Key<Lane>& key) const
+{
+  return road_mark_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<RoadPole> VectorMap::findByLink<RoadPole>(const Key<Lane>& key) const
+{
+  return road_pole_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<RoadSign> VectorMap::findByLink<RoadSign>(const Key<Lane>& key) const
+{
+  return road_sign_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<Signal> VectorMap::findByLink<Signal>(const Key<Lane>& key) const
+{
+  return signal_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<StreetLight> VectorMap::findByLink<StreetLight>(const Key<Lane>& key) const
+{
+  return street_light_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<UtilityPole> VectorMap::findByLink<UtilityPole>(const Key<Lane>& key) const
+{
+  return utility_pole_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<GuardRail> VectorMap::findByLink<GuardRail>(const Key<Lane>& key) const
+{
+  return guard_rail_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<SideWalk> VectorMap::findByLink<SideWalk>(const Key<Lane>& key) const
+{
+  return side_walk_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<DriveOnPortion> VectorMap::findByLink<DriveOnPortion>(const Key<Lane>& key) const
+{
+  return drive_on_portion_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<CrossRoad> VectorMap::findByLink<CrossRoad>(const Key<Lane>& key) const
+{
+  return cross_road_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<SideStrip> VectorMap::findByLink<SideStrip>(const Key<Lane>& key) const
+{
+  return side_strip_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<CurveMirror> VectorMap::findByLink<CurveMirror>(const Key<Lane>& key) const
+{
+  return curve_mirror_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<Wall> VectorMap::findByLink<Wall>(const Key<Lane>& key) const
+{
+  return wall_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<Fence> VectorMap::findByLink<Fence>(const Key<Lane>& key) const
+{
+  return fence_.findByIndex("linkid", key.getId());
+}
+
+template <>
+std::vector<RailCrossing> VectorMap::findByLink<RailCrossing>(const Key<Lane>& key) const
+{
+  return rail_crossing_.findByIndex("linkid", key.getId());
+}
+
+void VectorMap::forEachAreaLine(const Area& area, const Callback<Line>& cb) const
+{
+  // boundary lines are chained by flid from slid until flid is 0, as createAreaMarker follows them.
+  // line ids need not be consecutive, visited ids only guard against a chain looping back on itself
+  std::set<int> visited_lids;
+  Line line = line_.findByKey(Key<Line>(area.slid));
+  while (line.lid != 0 && visited_lids.insert(line.lid).second)
+  {
+    cb(line);
+    if (line.flid == 0)
+      break;
+    line = line_.findByKey(Key<Line>(line.flid));
+  }
+}
+
+void VectorMap::updateSpatialIndex()
+{
+  point_cells_.clear();
+  line_cells_.clear();
+  area_cells_.clear();
+
+  point_.forEach([this](const Point& point)
+                 {
+                   addCells(point_cells_, point.bx, point.ly, point.bx, point.ly, cell_size_, point.pid);
+                 });
+
+  line_.forEach([this](const Line& line)
+                {
+                  Point bp = point_.findByKey(Key<Point>(line.bpid));
+                  Point fp = point_.findByKey(Key<Point>(line.fpid));
+                  if (bp.pid == 0 || fp.pid == 0)
+                    return;
+                  addCells(line_cells_, std::min(bp.bx, fp.bx), std::min(bp.ly, fp.ly), std::max(bp.bx, fp.bx),
+                           std::max(bp.ly, fp.ly), cell_size_, line.lid);
+                });
+
+  area_.forEach([this](const Area& area)
+                {
+                  double min_x = DBL_MAX;
+                  double min_y = DBL_MAX;
+                  double max_x = -DBL_MAX;
+                  double max_y = -DBL_MAX;
+                  forEachAreaLine(area, [&](const Line& line)
+                                  {
+                                    for (int pid : { line.bpid, line.fpid })
+                                    {
+                                      Point point = point_.findByKey(Key<Point>(pid));
+                                      if (point.pid == 0)
+                                        continue;
+                                      min_x = std::min(min_x, point.bx);
+                                      min_y = std::min(min_y, point.ly);
+                                      max_x = std::max(max_x, point.bx);
+                                      max_y = std::max(max_y, point.ly);
+                                    }
+                                  });
+                  if (min_x <= max_x)
+                    addCells(area_cells_, min_x, min_y, max_x, max_y, cell_size_, area.aid);
+                });
+
+  std::sort(point_cells_.begin(), point_cells_.end());
+  std::sort(line_cells_.begin(), line_cells_.end());
+  std::sort(area_cells_.begin(), area_cells_.end());
+}
+
+std::vector<int> VectorMap::findCellIds(const std::vector<std::pair<long long, int>>& cells, const Point& center,
+                                        double radius) const
+{
+  std::vector<int> ids;
+  if (cells.empty() || !(radius >= 0) || !std::isfinite(radius) || !std::isfinite(center.bx) ||
+      !std::isfinite(center.ly))
+    return ids;
+
+  long long min_cell_x = computeCellIndex(center.bx - radius, cell_size_);
+  long long min_cell_y = computeCellIndex(center.ly - radius, cell_size_);
+  long long max_cell_x = computeCellIndex(center.bx + radius, cell_size_);
+  long long max_cell_y = computeCellIndex(center.ly + radius, cell_size_);
+  if (!isValidCellIndex(min_cell_x) || !isValidCellIndex(min_cell_y) || !isValidCellIndex(max_cell_x) ||
+      !isValidCellIndex(max_cell_y) || static_cast<size_t>(max_cell_x - min_cell_x + 1) > cells.size())
+  {
+    // the query covers more columns than there are entries, every object is a candidate
+    for (const auto& cell : cells)
+      ids.push_back(cell.second);
+  }
+  else
+  {
+    for (auto it = cells.begin(); it != cells.end() && it->first == LARGE_OBJECT_KEY; ++it)
+      ids.push_back(it->second);
+    for (long long cell_x = min_cell_x; cell_x <= max_cell_x; ++cell_x)
+    {
+      long long last_key = createCellKey(cell_x, max_cell_y);
+      auto it = std::lower_bound(cells.begin(), cells.end(), std::make_pair(createCellKey(cell_x, min_cell_y), INT_MIN));
+      for (; it != cells.end() && it->first <= last_key; ++it)
+        ids.push_back(it->second);
+    }
+  }
+
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  return ids;
+}
+
+bool VectorMap::isLineInRadius(const Line& line, const Point& center, double radius) const
+{
+  Point bp = point_.findByKey(Key<Point>(line.bpid));
+  Point fp = point_.findByKey(Key<Point>(line.fpid));
+  if (bp.pid == 0 || fp.pid == 0)
+    return false;
+  return computeSegmentDistance(bp, fp, center) <= radius;
+}
+
+std::vector<Point> VectorMap::findPointsInRadius(const Point& center, double radius) const
+{
+  std::vector<Point> points;
+  for (int pid : findCellIds(point_cells_, center, radius))
+  {
+    Point point = point_.findByKey(Key<Point>(pid));
+    if (std::hypot(point.bx - center.bx, point.ly - center.ly) <= radius) // XXX: don't consider z axis
+      points.push_back(point);
+  }
+  return points;
+}
+
+std::vector<Line> VectorMap::findLinesInRadius(const Point& center, double radius) const
+{
+  std::vector<Line> lines;
+  for (int lid : findCellIds(line_cells_, center, radius))
+  {
+    Line line = line_.findByKey(Key<Line>(lid));
+    if (isLineInRadius(line, center, radius))
+      lines.push_back(line);
+  }
+  return lines;
+}
+
+std::vector<Area> VectorMap::findAreasInRadius(const Point& center, double radius) const
+{
+  std::vector<Area> areas;
+  for (int aid : findCellIds(area_cells_, center, radius))
+  {
+    Area area = area_.findByKey(Key<Area>(aid));
+    bool in_radius = false;
+    forEachAreaLine(area, [&](const Line& line)
+                    {
+                      if (!in_radius && isLineInRadius(line, center, radius))
+                        in_radius = true;
+                    });
+    if (in_radius)
+      areas.push_back(area);
+  }
+  return areas;
+}
+
 void VectorMap::registerCallback(const Callback<PointArray>& cb)
 {
   point_.registerCallback(cb);
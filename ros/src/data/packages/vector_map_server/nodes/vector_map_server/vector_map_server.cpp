@@ -28,6 +28,8 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+#include <set>
 #include <geometry_msgs/PoseStamped.h>
 #include "autoware_msgs/Lane.h"
 #include <visualization_msgs/MarkerArray.h>
@@ -164,38 +166,6 @@ Point createMedianPoint(const Point& p1, const Point& p2)
   return point;
 }
 
-std::vector<Point> findStartPoints(const VectorMap& vmap)
-{
-  std::vector<Point> start_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
-  {
-    Node node = vmap.findByKey(Key<Node>(lane.bnid));
-    if (node.nid == 0)
-      continue;
-    Point point = vmap.findByKey(Key<Point>(node.pid));
-    if (point.pid == 0)
-      continue;
-    start_points.push_back(point);
-  }
-  return start_points;
-}
-
-std::vector<Point> findEndPoints(const VectorMap& vmap)
-{
-  std::vector<Point> end_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
-  {
-    Node node = vmap.findByKey(Key<Node>(lane.fnid));
-    if (node.nid == 0)
-      continue;
-    Point point = vmap.findByKey(Key<Point>(node.pid));
-    if (point.pid == 0)
-      continue;
-    end_points.push_back(point);
-  }
-  return end_points;
-}
-
 Point findNearestPoint(const std::vector<Point>& points, const Point& base_point)
 {
   Point nearest_point;
@@ -212,23 +182,12 @@ Point findNearestPoint(const std::vector<Point>& points, const Point& base_point
   return nearest_point;
 }
 
-std::vector<Point> findNearPoints(const std::vector<Point>& points, const Point& base_point, double radius)
-{
-  std::vector<Point> near_points;
-  for (const auto& point : points)
-  {
-    if (computeDistance(base_point, point) <= radius)
-      near_points.push_back(point);
-  }
-  return near_points;
-}
-
 std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& start_point)
 {
   std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&start_point](const Node& node){return node.pid == start_point.pid;}))
+  for (const auto& node : vmap.findNodesByPoint(Key<Point>(start_point.pid)))
   {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.bnid == node.nid;}))
+    for (const auto& lane : vmap.findLanesByStartNode(Key<Node>(node.nid)))
       lanes.push_back(lane);
   }
   return lanes;
@@ -237,14 +196,61 @@ std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& star
 std::vector<Lane> findLanesByEndPoint(const VectorMap& vmap, const Point& end_point)
 {
   std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&end_point](const Node& node){return node.pid == end_point.pid;}))
+  for (const auto& node : vmap.findNodesByPoint(Key<Point>(end_point.pid)))
   {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.fnid == node.nid;}))
+    for (const auto& lane : vmap.findLanesByEndNode(Key<Node>(node.nid)))
       lanes.push_back(lane);
   }
   return lanes;
 }
 
+using LaneGroup = std::pair<Point, std::vector<Lane>>;
+
+// Points within radius of base_point with the lanes that start (or end) at each of them.
+// Scanning every lane in key order visited a group once per lane, last at its highest lnid,
+// so the groups are sorted by it to resolve score ties to the same lane as that scan.
+std::vector<LaneGroup> findLaneGroupsInRadius(const VectorMap& vmap, const Point& base_point, double radius,
+                                              bool start)
+{
+  std::vector<std::pair<int, LaneGroup>> sorted_groups;
+  for (const auto& point : vmap.findPointsInRadius(base_point, radius))
+  {
+    std::vector<Lane> lanes = start ? findLanesByStartPoint(vmap, point) : findLanesByEndPoint(vmap, point);
+    if (lanes.empty())
+      continue;
+    int last_lnid = 0;
+    for (const auto& lane : lanes)
+      last_lnid = std::max(last_lnid, lane.lnid);
+    sorted_groups.push_back(std::make_pair(last_lnid, LaneGroup(point, lanes)));
+  }
+  std::sort(sorted_groups.begin(), sorted_groups.end(),
+            [](const std::pair<int, LaneGroup>& a, const std::pair<int, LaneGroup>& b)
+            {
+              return a.first < b.first;
+            });
+
+  std::vector<LaneGroup> groups;
+  for (const auto& group : sorted_groups)
+    groups.push_back(group.second);
+  return groups;
+}
+
+std::vector<Lane> findNextLanes(const VectorMap& vmap, const Lane& lane)
+{
+  // same lanes and order as filtering the whole map by lnid
+  std::set<int> lnids = { lane.flid, lane.flid2, lane.flid3, lane.flid4 };
+  std::vector<Lane> next_lanes;
+  for (int lnid : lnids)
+  {
+    if (lnid == 0)
+      continue;
+    Lane next_lane = vmap.findByKey(Key<Lane>(lnid));
+    if (next_lane.lnid != 0)
+      next_lanes.push_back(next_lane);
+  }
+  return next_lanes;
+}
+
 Lane findStartLane(const VectorMap& vmap, const std::vector<Point>& points, double radius)
 {
   Lane start_lane;
@@ -254,9 +260,10 @@ Lane findStartLane(const VectorMap& vmap, const std::vector<Point>& points, doub
   Point bp1 = points[0];
   Point bp2 = points[1];
   double max_score = -DBL_MAX;
-  for (const auto& p1 : findNearPoints(findStartPoints(vmap), bp1, radius))
+  for (const auto& group : findLaneGroupsInRadius(vmap, bp1, radius, true))
   {
-    for (const auto& lane : findLanesByStartPoint(vmap, p1))
+    const Point& p1 = group.first;
+    for (const auto& lane : group.second)
     {
       if (lane.lnid == 0)
         continue;
@@ -283,9 +290,10 @@ Lane findEndLane(const VectorMap& vmap, const std::vector<Point>& points, double
   Point bp1 = points[points.size() - 2];
   Point bp2 = points[points.size() - 1];
   double max_score = -DBL_MAX;
-  for (const auto& p2 : findNearPoints(findEndPoints(vmap), bp2, radius))
+  for (const auto& group : findLaneGroupsInRadius(vmap, bp2, radius, false))
   {
-    for (const auto& lane : findLanesByEndPoint(vmap, p2))
+    const Point& p2 = group.first;
+    for (const auto& lane : group.second)
     {
       if (lane.lnid == 0)
         continue;
@@ -400,12 +408,7 @@ std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::La
         return null_lanes;
 
       double max_score = -DBL_MAX;
-      Filter<Lane> is_next_lane = [&current_lane](const Lane& lane)
-        {
-          return lane.lnid == current_lane.flid || lane.lnid == current_lane.flid2 ||
-                 lane.lnid == current_lane.flid3 || lane.lnid == current_lane.flid4;
-        };
-      for (const auto& lane : vmap.findByFilter(is_next_lane))
+      for (const auto& lane : findNextLanes(vmap, current_lane))
       {
         Lane next_lane = lane;
         Point next_point = findEndPoint(vmap, next_lane);
@@ -685,8 +688,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_edge : vmap_.findByFilter(
-           [&lane](const RoadEdge& road_edge){return road_edge.linkid == lane.lnid;}))
+      for (const auto& road_edge : vmap_.findByLink<RoadEdge>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(road_edge);
     }
     return true;
@@ -701,8 +703,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& gutter : vmap_.findByFilter(
-           [&lane](const Gutter& gutter){return gutter.linkid == lane.lnid;}))
+      for (const auto& gutter : vmap_.findByLink<Gutter>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(gutter);
     }
     return true;
@@ -717,8 +718,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& curb : vmap_.findByFilter(
-           [&lane](const Curb& curb){return curb.linkid == lane.lnid;}))
+      for (const auto& curb : vmap_.findByLink<Curb>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(curb);
     }
     return true;
@@ -733,8 +733,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& white_line : vmap_.findByFilter(
-           [&lane](const WhiteLine& white_line){return white_line.linkid == lane.lnid;}))
+      for (const auto& white_line : vmap_.findByLink<WhiteLine>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(white_line);
     }
     return true;
@@ -749,8 +748,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& stop_line : vmap_.findByFilter(
-           [&lane](const StopLine& stop_line){return stop_line.linkid == lane.lnid;}))
+      for (const auto& stop_line : vmap_.findByLink<StopLine>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(stop_line);
     }
     return true;
@@ -765,8 +763,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& zebra_zone : vmap_.findByFilter(
-           [&lane](const ZebraZone& zebra_zone){return zebra_zone.linkid == lane.lnid;}))
+      for (const auto& zebra_zone : vmap_.findByLink<ZebraZone>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(zebra_zone);
     }
     return true;
@@ -781,8 +778,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& cross_walk : vmap_.findByFilter(
-           [&lane](const CrossWalk& cross_walk){return cross_walk.linkid == lane.lnid;}))
+      for (const auto& cross_walk : vmap_.findByLink<CrossWalk>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(cross_walk);
     }
     return true;
@@ -797,8 +793,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_mark : vmap_.findByFilter(
-           [&lane](const RoadMark& road_mark){return road_mark.linkid == lane.lnid;}))
+      for (const auto& road_mark : vmap_.findByLink<RoadMark>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(road_mark);
     }
     return true;
@@ -813,8 +808,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_pole : vmap_.findByFilter(
-           [&lane](const RoadPole& road_pole){return road_pole.linkid == lane.lnid;}))
+      for (const auto& road_pole : vmap_.findByLink<RoadPole>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(road_pole);
     }
     return true;
@@ -829,8 +823,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_sign : vmap_.findByFilter(
-           [&lane](const RoadSign& road_sign){return road_sign.linkid == lane.lnid;}))
+      for (const auto& road_sign : vmap_.findByLink<RoadSign>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(road_sign);
     }
     return true;
@@ -845,8 +838,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& signal : vmap_.findByFilter(
-           [&lane](const Signal& signal){return signal.linkid == lane.lnid;}))
+      for (const auto& signal : vmap_.findByLink<Signal>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(signal);
     }
     return true;
@@ -861,8 +853,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& street_light : vmap_.findByFilter(
-           [&lane](const StreetLight& street_light){return street_light.linkid == lane.lnid;}))
+      for (const auto& street_light : vmap_.findByLink<StreetLight>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(street_light);
     }
     return true;
@@ -877,8 +868,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& utility_pole : vmap_.findByFilter(
-           [&lane](const UtilityPole& utility_pole){return utility_pole.linkid == lane.lnid;}))
+      for (const auto& utility_pole : vmap_.findByLink<UtilityPole>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(utility_pole);
     }
     return true;
@@ -893,8 +883,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& guard_rail : vmap_.findByFilter(
-           [&lane](const GuardRail& guard_rail){return guard_rail.linkid == lane.lnid;}))
+      for (const auto& guard_rail : vmap_.findByLink<GuardRail>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(guard_rail);
     }
     return true;
@@ -909,8 +898,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& side_walk : vmap_.findByFilter(
-           [&lane](const SideWalk& side_walk){return side_walk.linkid == lane.lnid;}))
+      for (const auto& side_walk : vmap_.findByLink<SideWalk>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(side_walk);
     }
     return true;
@@ -925,8 +913,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& drive_on_portion : vmap_.findByFilter(
-           [&lane](const DriveOnPortion& drive_on_portion){return drive_on_portion.linkid == lane.lnid;}))
+      for (const auto& drive_on_portion : vmap_.findByLink<DriveOnPortion>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(drive_on_portion);
     }
     return true;
@@ -941,8 +928,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& cross_road : vmap_.findByFilter(
-           [&lane](const CrossRoad& cross_road){return cross_road.linkid == lane.lnid;}))
+      for (const auto& cross_road : vmap_.findByLink<CrossRoad>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(cross_road);
     }
     return true;
@@ -957,8 +943,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& side_strip : vmap_.findByFilter(
-           [&lane](const SideStrip& side_strip){return side_strip.linkid == lane.lnid;}))
+      for (const auto& side_strip : vmap_.findByLink<SideStrip>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(side_strip);
     }
     return true;
@@ -973,8 +958,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& curve_mirror : vmap_.findByFilter(
-           [&lane](const CurveMirror& curve_mirror){return curve_mirror.linkid == lane.lnid;}))
+      for (const auto& curve_mirror : vmap_.findByLink<CurveMirror>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(curve_mirror);
     }
     return true;
@@ -989,8 +973,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& wall : vmap_.findByFilter(
-           [&lane](const Wall& wall){return wall.linkid == lane.lnid;}))
+      for (const auto& wall : vmap_.findByLink<Wall>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(wall);
     }
     return true;
@@ -1005,8 +988,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& fence : vmap_.findByFilter(
-           [&lane](const Fence& fence){return fence.linkid == lane.lnid;}))
+      for (const auto& fence : vmap_.findByLink<Fence>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(fence);
     }
     return true;
@@ -1021,8 +1003,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& rail_crossing : vmap_.findByFilter(
-           [&lane](const RailCrossing& rail_crossing){return rail_crossing.linkid == lane.lnid;}))
+      for (const auto& rail_crossing : vmap_.findByLink<RailCrossing>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(rail_crossing);
     }
     return true;
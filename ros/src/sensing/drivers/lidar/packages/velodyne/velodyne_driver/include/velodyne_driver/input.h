@@ -36,9 +36,13 @@
 #include <stdio.h>
 #include <pcap.h>
 #include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <vector>
 
 #include <ros/ros.h>
 #include <velodyne_msgs/VelodynePacket.h>
+#include <velodyne_msgs/VelodyneInputStats.h>
 
 namespace velodyne_driver
 {
@@ -63,13 +67,28 @@ namespace velodyne_driver
     virtual int getPacket(velodyne_msgs::VelodynePacket *pkt,
                           const double time_offset) = 0;
 
+    /** @brief Get the packet statistics.
+     *
+     * The counters add up since the input was opened, max_latency is
+     * reset by each call.
+     */
+    void getStats(velodyne_msgs::VelodyneInputStats *stats);
+
   protected:
     ros::NodeHandle private_nh_;
     uint16_t port_;
     std::string devip_str_;
+    velodyne_msgs::VelodyneInputStats stats_;
   };
 
-  /** @brief Live Velodyne input from socket. */
+  /** @brief Live Velodyne input from socket.
+   *
+   * With a batch_size parameter above 1, packets are read by batches
+   * with a blocking recvmmsg(), which returns when batch_size packets
+   * arrived or after about batch_timeout seconds, and stamped with their
+   * kernel arrival time. This saves most of the system calls of reading
+   * them one at a time.
+   */
   class InputSocket: public Input
   {
   public:
@@ -81,10 +100,26 @@ namespace velodyne_driver
                           const double time_offset);
     void setDeviceIP( const std::string& ip );
   private:
+    int waitForData();
+    int receiveBatch();
+    bool acceptSender(const sockaddr_in &sender_address);
 
   private:
     int sockfd_;
     in_addr devip_;
+    double late_threshold_;          ///< [s] arrival to read delay
+    int batch_size_;                 ///< packets per recvmmsg() call
+    double batch_timeout_;           ///< [s] longest wait to fill a batch
+
+    // buffers of a batch of packets, kept to avoid reallocation
+    std::vector<uint8_t> batch_data_;
+    std::vector<sockaddr_in> batch_addresses_;
+    std::vector<iovec> batch_iovecs_;
+    std::vector<char> batch_controls_;
+    std::vector<mmsghdr> batch_msgs_;
+    int batch_received_;             ///< packets in the last batch
+    int batch_next_;                 ///< next packet of the batch to return
+    ros::Time batch_time_;           ///< time the batch was read
   };
 
 
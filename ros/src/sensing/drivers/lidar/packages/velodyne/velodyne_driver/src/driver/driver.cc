@@ -151,6 +151,10 @@ VelodyneDriver::VelodyneDriver(ros::NodeHandle node,
   // raw packet output topic
   output_ =
     node.advertise<velodyne_msgs::VelodyneScan>("velodyne_packets", 10);
+
+  // statistics of the packets read, once per scan
+  stats_output_ =
+    node.advertise<velodyne_msgs::VelodyneInputStats>("velodyne_input_stats", 10);
 }
 
 /** poll the device
@@ -218,6 +222,14 @@ bool VelodyneDriver::poll(void)
   scan->header.frame_id = config_.frame_id;
   output_.publish(scan);
 
+  if (stats_output_.getNumSubscribers() > 0)
+    {
+      velodyne_msgs::VelodyneInputStatsPtr stats(new velodyne_msgs::VelodyneInputStats);
+      input_->getStats(stats.get());
+      stats->header = scan->header;
+      stats_output_.publish(stats);
+    }
+
   // notify diagnostics that a message has been published, updating
   // its status
   diag_topic_->tick(scan->header.stamp);
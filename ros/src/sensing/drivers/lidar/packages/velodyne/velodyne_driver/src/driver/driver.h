@@ -60,6 +60,7 @@ private:
 
   boost::shared_ptr<Input> input_;
   ros::Publisher output_;
+  ros::Publisher stats_output_;
 
   /** diagnostics updater */
   diagnostic_updater::Updater diagnostics_;
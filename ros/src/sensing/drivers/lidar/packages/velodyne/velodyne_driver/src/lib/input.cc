@@ -57,6 +57,13 @@ namespace velodyne_driver
                       << devip_str_);
   }
 
+  /** @brief Get the packet statistics. */
+  void Input::getStats(velodyne_msgs::VelodyneInputStats *stats)
+  {
+    *stats = stats_;
+    stats_.max_latency = 0.0;
+  }
+
   ////////////////////////////////////////////////////////////////////////
   // InputSocket class implementation
   ////////////////////////////////////////////////////////////////////////
@@ -67,7 +74,9 @@ namespace velodyne_driver
    *  @param port UDP port number
    */
   InputSocket::InputSocket(ros::NodeHandle private_nh, uint16_t port):
-    Input(private_nh, port)
+    Input(private_nh, port),
+    batch_received_(0),
+    batch_next_(0)
   {
     sockfd_ = -1;
     
@@ -75,6 +84,14 @@ namespace velodyne_driver
       inet_aton(devip_str_.c_str(),&devip_);
     }    
 
+    int rcvbuf_size;
+    private_nh.param("batch_size", batch_size_, 1);
+    private_nh.param("rcvbuf_size", rcvbuf_size, 0);
+    private_nh.param("batch_timeout", batch_timeout_, 0.05);
+    private_nh.param("late_threshold", late_threshold_, 0.01);
+    if (batch_size_ < 1)
+      batch_size_ = 1;
+
     // connect to Velodyne UDP port
     ROS_INFO_STREAM("Opening UDP socket: port " << port);
     sockfd_ = socket(PF_INET, SOCK_DGRAM, 0);
@@ -96,12 +113,69 @@ namespace velodyne_driver
         return;
       }
   
-    if (fcntl(sockfd_,F_SETFL, O_NONBLOCK|FASYNC) < 0)
+    // in batch mode recvmmsg() blocks until the batch is full, bounded by
+    // SO_RCVTIMEO below, so that a whole scan is read in a few calls
+    int flags = batch_size_ > 1 ? FASYNC : O_NONBLOCK|FASYNC;
+    if (fcntl(sockfd_,F_SETFL, flags) < 0)
       {
         perror("non-block");
         return;
       }
 
+    // a larger buffer absorbs the bursts of packets arriving while the
+    // driver is not scheduled, e.g. with several devices on one host
+    if (rcvbuf_size > 0)
+      {
+        if (setsockopt(sockfd_, SOL_SOCKET, SO_RCVBUF,
+                       &rcvbuf_size, sizeof(rcvbuf_size)) < 0)
+          perror("SO_RCVBUF");
+        socklen_t len = sizeof(rcvbuf_size);
+        getsockopt(sockfd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf_size, &len);
+        ROS_INFO_STREAM("Socket receive buffer size: " << rcvbuf_size);
+      }
+
+    if (batch_size_ > 1)
+      {
+        // kernel arrival time stamps and count of dropped packets
+        int on = 1;
+        if (setsockopt(sockfd_, SOL_SOCKET, SO_TIMESTAMPNS,
+                       &on, sizeof(on)) < 0)
+          perror("SO_TIMESTAMPNS");
+        if (setsockopt(sockfd_, SOL_SOCKET, SO_RXQ_OVFL,
+                       &on, sizeof(on)) < 0)
+          perror("SO_RXQ_OVFL");
+
+        // longest wait for the next packet of a batch, so a read ends
+        // when the device stops sending
+        timeval rcvtimeo;
+        rcvtimeo.tv_sec = (time_t) batch_timeout_;
+        rcvtimeo.tv_usec = (suseconds_t) ((batch_timeout_ - rcvtimeo.tv_sec) * 1e6);
+        if (setsockopt(sockfd_, SOL_SOCKET, SO_RCVTIMEO,
+                       &rcvtimeo, sizeof(rcvtimeo)) < 0)
+          perror("SO_RCVTIMEO");
+
+        size_t control_size = CMSG_SPACE(sizeof(timespec))
+                              + CMSG_SPACE(sizeof(uint32_t));
+        batch_data_.resize(batch_size_ * packet_size);
+        batch_addresses_.resize(batch_size_);
+        batch_iovecs_.resize(batch_size_);
+        batch_controls_.resize(batch_size_ * control_size);
+        batch_msgs_.resize(batch_size_);
+        for (int i = 0; i < batch_size_; ++i)
+          {
+            batch_iovecs_[i].iov_base = &batch_data_[i * packet_size];
+            batch_iovecs_[i].iov_len = packet_size;
+            msghdr &hdr = batch_msgs_[i].msg_hdr;
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.msg_name = &batch_addresses_[i];
+            hdr.msg_iov = &batch_iovecs_[i];
+            hdr.msg_iovlen = 1;
+            hdr.msg_control = &batch_controls_[i * control_size];
+          }
+        ROS_INFO_STREAM("Reading packets by batches of " << batch_size_
+                        << ", waiting at most " << batch_timeout_ << " s");
+      }
+
     ROS_DEBUG("Velodyne socket fd is %d\n", sockfd_);
   }
 
@@ -111,61 +185,186 @@ namespace velodyne_driver
     (void) close(sockfd_);
   }
 
-  /** @brief Get one velodyne packet. */
-  int InputSocket::getPacket(velodyne_msgs::VelodynePacket *pkt, const double time_offset)
+  /** @brief Wait until the socket has data to read.
+   *
+   *  @returns 0 if data is available, 1 on timeout or error
+   */
+  int InputSocket::waitForData()
   {
-    double time1 = ros::Time::now().toSec();
-
     struct pollfd fds[1];
     fds[0].fd = sockfd_;
     fds[0].events = POLLIN;
     static const int POLL_TIMEOUT = 1000; // one second (in msec)
 
-    sockaddr_in sender_address;
-    socklen_t sender_address_len = sizeof(sender_address);
+    // Unfortunately, the Linux kernel recvfrom() implementation
+    // uses a non-interruptible sleep() when waiting for data,
+    // which would cause this method to hang if the device is not
+    // providing data.  We poll() the device first to make sure
+    // the recvfrom() will not block.
+    //
+    // Note, however, that there is a known Linux kernel bug:
+    //
+    //   Under Linux, select() may report a socket file descriptor
+    //   as "ready for reading", while nevertheless a subsequent
+    //   read blocks.  This could for example happen when data has
+    //   arrived but upon examination has wrong checksum and is
+    //   discarded.  There may be other circumstances in which a
+    //   file descriptor is spuriously reported as ready.  Thus it
+    //   may be safer to use O_NONBLOCK on sockets that should not
+    //   block.
+
+    // poll() until input available
+    do
+      {
+        int retval = poll(fds, 1, POLL_TIMEOUT);
+        if (retval < 0)             // poll() error?
+          {
+            if (errno != EINTR)
+              ROS_ERROR("poll() error: %s", strerror(errno));
+            return 1;
+          }
+        if (retval == 0)            // poll() timeout?
+          {
+            ROS_WARN("Velodyne poll() timeout");
+            return 1;
+          }
+        if ((fds[0].revents & POLLERR)
+            || (fds[0].revents & POLLHUP)
+            || (fds[0].revents & POLLNVAL)) // device error?
+          {
+            ROS_ERROR("poll() reports Velodyne error");
+            return 1;
+          }
+      } while ((fds[0].revents & POLLIN) == 0);
 
-    while (true)
+    return 0;
+  }
+
+  /** @brief Check the packet is from the lidar scanner we selected by IP. */
+  bool InputSocket::acceptSender(const sockaddr_in &sender_address)
+  {
+    return devip_str_ == ""
+           || sender_address.sin_addr.s_addr == devip_.s_addr;
+  }
+
+  /** @brief Read packets until batch_size arrived or batch_timeout passed.
+   *
+   *  The socket is blocking in batch mode, so after poll() reports the
+   *  first packet recvmmsg() keeps waiting for the next ones instead of
+   *  returning the few already queued. The timeout argument bounds the
+   *  whole read (the kernel checks it after each packet) and SO_RCVTIMEO
+   *  bounds the wait for each packet, so a read takes at most about
+   *  twice batch_timeout.
+   *
+   *  @returns 0 if some packets were read, 1 on timeout or error
+   */
+  int InputSocket::receiveBatch()
+  {
+    batch_received_ = 0;
+    batch_next_ = 0;
+    while (batch_received_ == 0)
       {
-        // Unfortunately, the Linux kernel recvfrom() implementation
-        // uses a non-interruptible sleep() when waiting for data,
-        // which would cause this method to hang if the device is not
-        // providing data.  We poll() the device first to make sure
-        // the recvfrom() will not block.
-        //
-        // Note, however, that there is a known Linux kernel bug:
-        //
-        //   Under Linux, select() may report a socket file descriptor
-        //   as "ready for reading", while nevertheless a subsequent
-        //   read blocks.  This could for example happen when data has
-        //   arrived but upon examination has wrong checksum and is
-        //   discarded.  There may be other circumstances in which a
-        //   file descriptor is spuriously reported as ready.  Thus it
-        //   may be safer to use O_NONBLOCK on sockets that should not
-        //   block.
-
-        // poll() until input available
-        do
+        if (waitForData() != 0)
+          return 1;
+
+        // the kernel overwrites the lengths of each message
+        for (int i = 0; i < batch_size_; ++i)
+          {
+            msghdr &hdr = batch_msgs_[i].msg_hdr;
+            hdr.msg_namelen = sizeof(sockaddr_in);
+            hdr.msg_controllen = batch_controls_.size() / batch_size_;
+            hdr.msg_flags = 0;
+          }
+
+        // the kernel writes the time left back into the timeout
+        timespec timeout;
+        timeout.tv_sec = (time_t) batch_timeout_;
+        timeout.tv_nsec = (long) ((batch_timeout_ - timeout.tv_sec) * 1e9);
+        int n = recvmmsg(sockfd_, &batch_msgs_[0], batch_size_, 0, &timeout);
+        ++stats_.receive_calls;
+        if (n < 0)
           {
-            int retval = poll(fds, 1, POLL_TIMEOUT);
-            if (retval < 0)             // poll() error?
+            if (errno != EWOULDBLOCK && errno != EAGAIN && errno != EINTR)
               {
-                if (errno != EINTR)
-                  ROS_ERROR("poll() error: %s", strerror(errno));
+                perror("recvfail");
+                ROS_INFO("recvfail");
                 return 1;
               }
-            if (retval == 0)            // poll() timeout?
+            continue;
+          }
+        batch_received_ = n;
+      }
+    batch_time_ = ros::Time::now();
+    return 0;
+  }
+
+  /** @brief Get one velodyne packet. */
+  int InputSocket::getPacket(velodyne_msgs::VelodynePacket *pkt, const double time_offset)
+  {
+    if (batch_size_ > 1)
+      {
+        while (true)
+          {
+            if (batch_next_ >= batch_received_ && receiveBatch() != 0)
+              return 1;
+
+            mmsghdr &msg = batch_msgs_[batch_next_];
+            const uint8_t *data = &batch_data_[batch_next_ * packet_size];
+            const sockaddr_in &sender_address = batch_addresses_[batch_next_];
+            ++batch_next_;
+
+            if (msg.msg_len != packet_size || !acceptSender(sender_address))
               {
-                ROS_WARN("Velodyne poll() timeout");
-                return 1;
+                ROS_DEBUG_STREAM("ignoring Velodyne packet read: "
+                                 << msg.msg_len << " bytes");
+                ++stats_.filtered;
+                continue;
               }
-            if ((fds[0].revents & POLLERR)
-                || (fds[0].revents & POLLHUP)
-                || (fds[0].revents & POLLNVAL)) // device error?
+
+            // use the arrival time of the packet, if the kernel gave one
+            ros::Time arrival = batch_time_;
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg.msg_hdr); cmsg != NULL;
+                 cmsg = CMSG_NXTHDR(&msg.msg_hdr, cmsg))
               {
-                ROS_ERROR("poll() reports Velodyne error");
-                return 1;
+                if (cmsg->cmsg_level != SOL_SOCKET)
+                  continue;
+                if (cmsg->cmsg_type == SCM_TIMESTAMPNS)
+                  {
+                    timespec ts;
+                    memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    arrival = ros::Time(ts.tv_sec, ts.tv_nsec);
+                  }
+                else if (cmsg->cmsg_type == SO_RXQ_OVFL)
+                  {
+                    uint32_t dropped;
+                    memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+                    stats_.dropped = dropped;
+                  }
               }
-          } while ((fds[0].revents & POLLIN) == 0);
+
+            // waiting for the rest of the batch is not a late read
+            double latency = (batch_time_ - arrival).toSec();
+            if (latency > late_threshold_ + batch_timeout_)
+              ++stats_.late;
+            if (latency > stats_.max_latency)
+              stats_.max_latency = latency;
+
+            memcpy(&pkt->data[0], data, packet_size);
+            pkt->stamp = arrival + ros::Duration(time_offset);
+            ++stats_.packets;
+            return 0;
+          }
+      }
+
+    double time1 = ros::Time::now().toSec();
+
+    sockaddr_in sender_address;
+    socklen_t sender_address_len = sizeof(sender_address);
+
+    while (true)
+      {
+        if (waitForData() != 0)
+          return 1;
 
         // Receive packets that should now be available from the
         // socket using a blocking read.
@@ -173,6 +372,7 @@ namespace velodyne_driver
                                   packet_size,  0,
                                   (sockaddr*) &sender_address,
                                   &sender_address_len);
+        ++stats_.receive_calls;
 
         if (nbytes < 0)
           {
@@ -188,12 +388,16 @@ namespace velodyne_driver
             // read successful,
             // if packet is not from the lidar scanner we selected by IP,
             // continue otherwise we are done
-            if(devip_str_ != ""
-               && sender_address.sin_addr.s_addr != devip_.s_addr)
-              continue;
+            if(!acceptSender(sender_address))
+              {
+                ++stats_.filtered;
+                continue;
+              }
             else
               break; //done
           }
+        else
+          ++stats_.filtered;
 
         ROS_DEBUG_STREAM("incomplete Velodyne packet read: "
                          << nbytes << " bytes");
@@ -203,6 +407,7 @@ namespace velodyne_driver
     // estimate when the scan occurred. Add the time offset.
     double time2 = ros::Time::now().toSec();
     pkt->stamp = ros::Time((time2 + time1) / 2.0 + time_offset);
+    ++stats_.packets;
 
     return 0;
   }
@@ -290,6 +495,7 @@ namespace velodyne_driver
             memcpy(&pkt->data[0], pkt_data+42, packet_size);
             pkt->stamp = ros::Time::now(); // time_offset not considered here, as no synchronization required
             empty_ = false;
+            ++stats_.packets;
             return 0;                   // success
           }
 
@@ -28,6 +28,7 @@
 
 #include <ros/ros.h>
 #include <pcl_ros/point_cloud.h>
+#include <sensor_msgs/PointCloud2.h>
 #include <velodyne_msgs/VelodyneScan.h>
 #include <velodyne_pointcloud/point_types.h>
 #include <velodyne_pointcloud/calibration.h>
@@ -93,6 +94,9 @@ namespace velodyne_rawdata
   static const int PACKET_STATUS_SIZE = 4;
   static const int SCANS_PER_PACKET = (SCANS_PER_BLOCK * BLOCKS_PER_PACKET);
 
+  /** highest hardware laser number + 1 of the upper and lower banks */
+  static const int MAX_LASERS = 64;
+
   /** \brief Raw Velodyne packet.
    *
    *  revolution is described in the device manual as incrementing
@@ -147,6 +151,23 @@ namespace velodyne_rawdata
     int setupOffline(std::string calibration_file, double max_range_, double min_range_);
 
     void unpack(const velodyne_msgs::VelodynePacket &pkt, VPointCloud &pc, int packets_num);
+
+    /** \brief Convert all the packets of a scan, reserving their points up front.
+     *
+     *  @param scan raw scan to unpack
+     *  @param pc point cloud (points are appended)
+     */
+    void unpack(const velodyne_msgs::VelodyneScan &scan, VPointCloud &pc);
+
+    /** \brief Convert all the packets of a scan straight into a PointCloud2.
+     *
+     *  The cloud gets the fields of VPoint, as a VPointCloud published
+     *  through pcl_ros. Its header is left to the caller.
+     *
+     *  @param scan raw scan to unpack
+     *  @param cloud output cloud (previous points are replaced)
+     */
+    void unpack(const velodyne_msgs::VelodyneScan &scan, sensor_msgs::PointCloud2 &cloud);
     
     void setParameters(double min_range, double max_range, double view_direction,
                        double view_width);
@@ -172,9 +193,69 @@ namespace velodyne_rawdata
     velodyne_pointcloud::Calibration calibration_;
     float sin_rot_table_[ROTATION_MAX_UNITS];
     float cos_rot_table_[ROTATION_MAX_UNITS];
-    
+
+    /** \brief Corrections of each hardware laser, one array per value.
+     *
+     *  Copied from calibration_ in setup(), so that the lasers of a block
+     *  are converted by one loop the compiler can vectorize. Lasers
+     *  missing from the calibration keep zero corrections.
+     */
+    typedef struct {
+      float dist_correction[MAX_LASERS];
+      float dist_correction_x[MAX_LASERS];
+      float dist_correction_y[MAX_LASERS];
+      float two_pt_correction[MAX_LASERS];   ///< 1 if available, else 0
+      float cos_vert_correction[MAX_LASERS];
+      float sin_vert_correction[MAX_LASERS];
+      float cos_rot_correction[MAX_LASERS];
+      float sin_rot_correction[MAX_LASERS];
+      float horiz_offset_correction[MAX_LASERS];
+      float vert_offset_correction[MAX_LASERS];
+      float focal_offset[MAX_LASERS];
+      float focal_slope[MAX_LASERS];
+      float min_intensity[MAX_LASERS];
+      float max_intensity[MAX_LASERS];
+      uint16_t laser_ring[MAX_LASERS];
+    } LaserTable;
+    LaserTable lasers_;
+
+    /** \brief Returns of up to one block, converted together. */
+    typedef struct {
+      float raw_distance[SCANS_PER_BLOCK];
+      float distance_ratio[SCANS_PER_BLOCK];  ///< raw distance / 65535, for the intensity
+      float raw_intensity[SCANS_PER_BLOCK];
+      float cos_rot[SCANS_PER_BLOCK];       ///< cached cosine of the azimuth
+      float sin_rot[SCANS_PER_BLOCK];       ///< cached sine of the azimuth
+      bool in_view[SCANS_PER_BLOCK];        ///< azimuth between min and max angles
+      float x[SCANS_PER_BLOCK];
+      float y[SCANS_PER_BLOCK];
+      float z[SCANS_PER_BLOCK];
+      float intensity[SCANS_PER_BLOCK];
+      float distance[SCANS_PER_BLOCK];
+    } ReturnBatch;
+    ReturnBatch batch_;
+
+    /** points of one packet, for unpacking into a PointCloud2 */
+    VPointCloud::VectorType packet_points_;
+
+    void setupTables();
+    int unpackPacket(const velodyne_msgs::VelodynePacket &pkt, int packets_num, VPoint *points);
+    void convertBatch(int first_laser, int n, float distance_scale);
+    int appendBatch(int first_laser, int n, VPoint *points);
+
     /** add private function to handle the VLP16 **/ 
-    void unpack_vlp16(const velodyne_msgs::VelodynePacket &pkt, VPointCloud &pc);
+    int unpack_vlp16(const velodyne_msgs::VelodynePacket &pkt, VPoint *points);
+
+    /** in-line test whether an azimuth is in the published view */
+    bool angleInView(int rotation)
+    {
+      return (rotation >= config_.min_angle
+              && rotation <= config_.max_angle
+              && config_.min_angle < config_.max_angle)
+             || (config_.min_angle > config_.max_angle
+              && (rotation <= config_.max_angle
+              || rotation >= config_.min_angle));
+    }
 
     /** in-line test whether a point is in range */
     bool pointInRange(float range)
@@ -15,8 +15,6 @@
 
 #include "convert.h"
 
-#include <pcl_conversions/pcl_conversions.h>
-
 namespace velodyne_pointcloud
 {
   /** @brief Constructor. */
@@ -59,18 +57,13 @@ namespace velodyne_pointcloud
       return;                                     // avoid much work
 
     // allocate a point cloud with same time and frame ID as raw data
-    velodyne_rawdata::VPointCloud::Ptr
-      outMsg(new velodyne_rawdata::VPointCloud());
-    // outMsg's header is a pcl::PCLHeader, convert it before stamp assignment
-    outMsg->header.stamp = pcl_conversions::toPCL(scanMsg->header).stamp;
+    sensor_msgs::PointCloud2Ptr outMsg(new sensor_msgs::PointCloud2());
+    outMsg->header.stamp = scanMsg->header.stamp;
     outMsg->header.frame_id = scanMsg->header.frame_id;
-    outMsg->height = 1;
 
-    // process each packet provided by the driver
-    for (size_t i = 0; i < scanMsg->packets.size(); ++i)
-      {
-        data_->unpack(scanMsg->packets[i], *outMsg, scanMsg->packets.size());
-      }
+    // unpack all the packets provided by the driver straight into the
+    // message buffer
+    data_->unpack(*scanMsg, *outMsg);
 
     // publish the accumulated cloud message
     ROS_DEBUG_STREAM("Publishing " << outMsg->height * outMsg->width
@@ -23,14 +23,32 @@
 
 namespace velodyne_pointcloud
 {
+  /** @brief Pose at ratio between two poses, extrapolated beyond [0, 1]. */
+  static tf::Transform interpolatePose(const tf::Transform &start,
+                                       const tf::Transform &end,
+                                       double ratio)
+  {
+    tf::Transform pose;
+    pose.setOrigin(start.getOrigin().lerp(end.getOrigin(), ratio));
+    pose.setRotation(start.getRotation().slerp(end.getRotation(), ratio));
+    return pose;
+  }
+
+  const double Transform::ODOMETRY_BUFFER_DURATION = 2.0; // [s]
+  const double Transform::MAX_EXTRAPOLATION = 0.1;        // [s]
+
   /** @brief Constructor. */
   Transform::Transform(ros::NodeHandle node, ros::NodeHandle private_nh):
     tf_prefix_(tf::getPrefixParam(private_nh)),
-    data_(new velodyne_rawdata::RawData())
+    data_(new velodyne_rawdata::RawData()),
+    tf_filter_(NULL)
   {
     // Read calibration.
     data_->setup(private_nh);
 
+    // odometry for deskewing, TF of the fixed frame is used if none
+    private_nh.param("odom_topic", odom_topic_, std::string(""));
+
     // advertise output point cloud (before subscribing to input data)
     output_ =
       node.advertise<sensor_msgs::PointCloud2>("velodyne_points", 10);
@@ -49,6 +67,15 @@ namespace velodyne_pointcloud
                                                          listener_,
                                                          config_.frame_id, 10);
     tf_filter_->registerCallback(boost::bind(&Transform::processScan, this, _1));
+    updateTargetFrames();
+
+    if (!odom_topic_.empty())
+      {
+        ROS_INFO_STREAM("Deskewing with odometry from " << odom_topic_);
+        odom_sub_ = node.subscribe(odom_topic_, 100,
+                                   &Transform::processOdometry, this,
+                                   ros::TransportHints().tcpNoDelay(true));
+      }
   }
   
   void Transform::reconfigure_callback(
@@ -59,6 +86,25 @@ namespace velodyne_pointcloud
                          config.view_direction, config.view_width);
     config_.frame_id = tf::resolve(tf_prefix_, config.frame_id);
     ROS_INFO_STREAM("Target frame ID: " << config_.frame_id);
+    config_.deskew = config.deskew;
+    config_.fixed_frame_id = tf::resolve(tf_prefix_, config.fixed_frame_id);
+    if (config_.deskew && odom_topic_.empty())
+      ROS_INFO_STREAM("Deskewing in frame ID: " << config_.fixed_frame_id);
+    updateTargetFrames();
+  }
+
+  /** @brief Make the TF filter wait for all the frames processScan needs. */
+  void Transform::updateTargetFrames()
+  {
+    if (tf_filter_ == NULL)             // not created yet
+      return;
+
+    std::vector<std::string> frames;
+    frames.push_back(config_.frame_id);
+    if (config_.deskew && odom_topic_.empty()
+        && config_.fixed_frame_id != config_.frame_id)
+      frames.push_back(config_.fixed_frame_id);
+    tf_filter_->setTargetFrames(frames);
   }
 
   /** @brief Callback for raw scan messages.
@@ -78,6 +124,18 @@ namespace velodyne_pointcloud
     outMsg->header.frame_id = config_.frame_id;
     outMsg->height = 1;
 
+    if (config_.deskew)
+      {
+        if (deskewScan(scanMsg, *outMsg))
+          {
+            ROS_DEBUG_STREAM("Publishing " << outMsg->height * outMsg->width
+                             << " deskewed Velodyne points, time: "
+                             << outMsg->header.stamp);
+            output_.publish(outMsg);
+          }
+        return;
+      }
+
     // process each packet provided by the driver
     for (size_t next = 0; next < scanMsg->packets.size(); ++next)
       {
@@ -135,4 +193,191 @@ namespace velodyne_pointcloud
     output_.publish(outMsg);
   }
 
+  /** @brief Unpack a scan, compensating the motion of the sensor.
+   *
+   *  The pose of the sensor is interpolated once per scan at the time
+   *  of each packet.  The points of a packet are then moved to where
+   *  they would have been measured at the time of the scan, and
+   *  transformed into the target frame, in a single pass.
+   *
+   *  @returns false if the sensor trajectory is not available
+   */
+  bool Transform::deskewScan(const velodyne_msgs::VelodyneScan::ConstPtr &scanMsg,
+                             VPointCloud &outPc)
+  {
+    std::vector<tf::Transform> packetPoses;
+    tf::Transform scanPose;
+    tf::StampedTransform targetPose;
+    try
+      {
+        if (!sensorTrajectory(scanMsg, packetPoses, scanPose))
+          return false;
+        listener_.lookupTransform(config_.frame_id, scanMsg->header.frame_id,
+                                  scanMsg->header.stamp, targetPose);
+      }
+    catch (tf::TransformException &ex)
+      {
+        // only log tf error once every 100 times
+        ROS_WARN_THROTTLE(100, "%s", ex.what());
+        return false;                   // skip this scan
+      }
+    tf::Transform toScan = targetPose * scanPose.inverse();
+
+    outPc.points.reserve(scanMsg->packets.size()
+                         * velodyne_rawdata::SCANS_PER_PACKET);
+    for (size_t next = 0; next < scanMsg->packets.size(); ++next)
+      {
+        size_t first = outPc.points.size();
+        data_->unpack(scanMsg->packets[next], outPc, scanMsg->packets.size());
+
+        tf::Transform transform = toScan * packetPoses[next];
+        const tf::Matrix3x3 &basis = transform.getBasis();
+        const tf::Vector3 &origin = transform.getOrigin();
+        float m[3][4];
+        for (int r = 0; r < 3; ++r)
+          {
+            for (int c = 0; c < 3; ++c)
+              m[r][c] = basis[r][c];
+            m[r][3] = origin[r];
+          }
+
+        for (size_t i = first; i < outPc.points.size(); ++i)
+          {
+            VPoint &p = outPc.points[i];
+            float x = p.x, y = p.y, z = p.z;
+            p.x = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+            p.y = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+            p.z = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+          }
+      }
+    return true;
+  }
+
+  /** @brief Interpolate the pose of the sensor during a scan.
+   *
+   *  Poses are in the fixed frame, looked up in TF at the first and last
+   *  packets only, or in the odometry frame when an odometry topic is
+   *  given.
+   *
+   *  @param packetPoses pose of the sensor at the time of each packet
+   *  @param scanPose pose of the sensor at the time of the scan
+   *  @returns false if the odometry does not cover the scan
+   *  @throws tf::TransformException if TF does not cover the scan
+   */
+  bool Transform::sensorTrajectory(const velodyne_msgs::VelodyneScan::ConstPtr &scanMsg,
+                                   std::vector<tf::Transform> &packetPoses,
+                                   tf::Transform &scanPose)
+  {
+    const std::string &sensorFrame = scanMsg->header.frame_id;
+    packetPoses.resize(scanMsg->packets.size());
+
+    if (!odom_topic_.empty())
+      {
+        // static pose of the sensor on the odometry child frame
+        tf::StampedTransform mount;
+        std::string childFrame;
+        {
+          boost::mutex::scoped_lock lock(odom_mutex_);
+          if (odom_buffer_.empty())
+            {
+              ROS_WARN_THROTTLE(10, "No odometry received on %s",
+                                odom_topic_.c_str());
+              return false;
+            }
+          childFrame = odom_buffer_.back()->child_frame_id;
+        }
+        listener_.lookupTransform(childFrame, sensorFrame, ros::Time(0), mount);
+
+        tf::Transform pose;
+        if (!odometryPose(scanMsg->header.stamp, pose))
+          return false;
+        scanPose = pose * mount;
+        for (size_t i = 0; i < scanMsg->packets.size(); ++i)
+          {
+            if (!odometryPose(scanMsg->packets[i].stamp, pose))
+              return false;
+            packetPoses[i] = pose * mount;
+          }
+        return true;
+      }
+
+    ros::Time start = scanMsg->packets.front().stamp;
+    ros::Time end = scanMsg->packets.back().stamp;
+    tf::StampedTransform startPose, endPose;
+    listener_.lookupTransform(config_.fixed_frame_id, sensorFrame, start,
+                              startPose);
+    listener_.lookupTransform(config_.fixed_frame_id, sensorFrame, end,
+                              endPose);
+
+    double duration = (end - start).toSec();
+    for (size_t i = 0; i < scanMsg->packets.size(); ++i)
+      {
+        double ratio = 0.0;
+        if (duration > 0.0)
+          ratio = (scanMsg->packets[i].stamp - start).toSec() / duration;
+        packetPoses[i] = interpolatePose(startPose, endPose, ratio);
+      }
+    double ratio = 1.0;
+    if (duration > 0.0)
+      ratio = (scanMsg->header.stamp - start).toSec() / duration;
+    scanPose = interpolatePose(startPose, endPose, ratio);
+    return true;
+  }
+
+  /** @brief Callback for odometry messages, kept to deskew scans. */
+  void Transform::processOdometry(const nav_msgs::Odometry::ConstPtr &odomMsg)
+  {
+    boost::mutex::scoped_lock lock(odom_mutex_);
+    if (!odom_buffer_.empty()
+        && odomMsg->header.stamp < odom_buffer_.back()->header.stamp)
+      {
+        ROS_WARN_STREAM("Odometry went back in time, clearing its buffer");
+        odom_buffer_.clear();
+      }
+    odom_buffer_.push_back(odomMsg);
+    while (odomMsg->header.stamp - odom_buffer_.front()->header.stamp
+           > ros::Duration(ODOMETRY_BUFFER_DURATION))
+      odom_buffer_.pop_front();
+  }
+
+  /** @brief Interpolate the odometry at some time.
+   *
+   *  The pose is extrapolated from the last two messages for at most
+   *  MAX_EXTRAPOLATION seconds, odometry usually lagging the scans.
+   *
+   *  @param pose pose of the odometry child frame at stamp
+   *  @returns false if the odometry does not cover stamp
+   */
+  bool Transform::odometryPose(const ros::Time &stamp, tf::Transform &pose)
+  {
+    boost::mutex::scoped_lock lock(odom_mutex_);
+    if (odom_buffer_.size() < 2
+        || stamp < odom_buffer_.front()->header.stamp
+        || stamp > odom_buffer_.back()->header.stamp
+                   + ros::Duration(MAX_EXTRAPOLATION))
+      {
+        ROS_WARN_THROTTLE(10, "No odometry on %s around time %f",
+                          odom_topic_.c_str(), stamp.toSec());
+        return false;
+      }
+
+    // first message after stamp, or the last one to extrapolate
+    size_t next = 1;
+    while (next < odom_buffer_.size() - 1
+           && odom_buffer_[next]->header.stamp < stamp)
+      ++next;
+    const nav_msgs::Odometry &before = *odom_buffer_[next - 1];
+    const nav_msgs::Odometry &after = *odom_buffer_[next];
+
+    tf::Transform beforePose, afterPose;
+    tf::poseMsgToTF(before.pose.pose, beforePose);
+    tf::poseMsgToTF(after.pose.pose, afterPose);
+    double duration = (after.header.stamp - before.header.stamp).toSec();
+    double ratio = 0.0;
+    if (duration > 0.0)
+      ratio = (stamp - before.header.stamp).toSec() / duration;
+    pose = interpolatePose(beforePose, afterPose, ratio);
+    return true;
+  }
+
 } // namespace velodyne_pointcloud
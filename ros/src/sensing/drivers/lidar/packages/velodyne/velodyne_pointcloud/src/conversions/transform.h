@@ -18,9 +18,13 @@
 #ifndef _VELODYNE_POINTCLOUD_TRANSFORM_H_
 #define _VELODYNE_POINTCLOUD_TRANSFORM_H_ 1
 
+#include <deque>
+
+#include <boost/thread/mutex.hpp>
 #include <ros/ros.h>
 #include "tf/message_filter.h"
 #include "message_filters/subscriber.h"
+#include <nav_msgs/Odometry.h>
 #include <sensor_msgs/PointCloud2.h>
 
 #include <velodyne_pointcloud/rawdata.h>
@@ -55,6 +59,14 @@ namespace velodyne_pointcloud
   private:
 
     void processScan(const velodyne_msgs::VelodyneScan::ConstPtr &scanMsg);
+    bool deskewScan(const velodyne_msgs::VelodyneScan::ConstPtr &scanMsg,
+                    VPointCloud &outPc);
+    bool sensorTrajectory(const velodyne_msgs::VelodyneScan::ConstPtr &scanMsg,
+                          std::vector<tf::Transform> &packetPoses,
+                          tf::Transform &scanPose);
+    void processOdometry(const nav_msgs::Odometry::ConstPtr &odomMsg);
+    bool odometryPose(const ros::Time &stamp, tf::Transform &pose);
+    void updateTargetFrames();
 
     ///Pointer to dynamic reconfigure service srv_
     boost::shared_ptr<dynamic_reconfigure::Server<velodyne_pointcloud::
@@ -72,9 +84,21 @@ namespace velodyne_pointcloud
     /// configuration parameters
     typedef struct {
       std::string frame_id;          ///< target frame ID
+      bool deskew;                   ///< compensate the motion during a scan
+      std::string fixed_frame_id;    ///< frame of the sensor motion from TF
     } Config;
     Config config_;
 
+    // Odometry of the vehicle, used for deskewing instead of TF when an
+    // odometry topic is given.  Messages are kept for the last
+    // ODOMETRY_BUFFER_DURATION seconds.
+    static const double ODOMETRY_BUFFER_DURATION;
+    static const double MAX_EXTRAPOLATION;
+    std::string odom_topic_;
+    ros::Subscriber odom_sub_;
+    std::deque<nav_msgs::Odometry::ConstPtr> odom_buffer_;
+    boost::mutex odom_mutex_;
+
     // Point cloud buffers for collecting points within a packet.  The
     // inPc_ and tfPc_ are class members only to avoid reallocation on
     // every message.
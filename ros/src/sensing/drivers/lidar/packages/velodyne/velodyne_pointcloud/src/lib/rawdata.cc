@@ -27,10 +27,12 @@
 
 #include <fstream>
 #include <math.h>
+#include <string.h>
 
 #include <ros/ros.h>
 #include <ros/package.h>
 #include <angles/angles.h>
+#include <pcl_conversions/pcl_conversions.h>
 
 #include <velodyne_pointcloud/rawdata.h>
 
@@ -97,12 +99,7 @@ namespace velodyne_rawdata
     
     ROS_INFO_STREAM("Number of lasers: " << calibration_.num_lasers << ".");
     
-    // Set up cached values for sin and cos of all the possible headings
-    for (uint16_t rot_index = 0; rot_index < ROTATION_MAX_UNITS; ++rot_index) {
-      float rotation = angles::from_degrees(ROTATION_RESOLUTION * rot_index);
-      cos_rot_table_[rot_index] = cosf(rotation);
-      sin_rot_table_[rot_index] = sinf(rotation);
-    }
+    setupTables();
    return 0;
   }
 
@@ -128,16 +125,54 @@ namespace velodyne_rawdata
 	  return -1;
       }
 
-      // Set up cached values for sin and cos of all the possible headings
-      for (uint16_t rot_index = 0; rot_index < ROTATION_MAX_UNITS; ++rot_index) {
-	  float rotation = angles::from_degrees(ROTATION_RESOLUTION * rot_index);
-	  cos_rot_table_[rot_index] = cosf(rotation);
-	  sin_rot_table_[rot_index] = sinf(rotation);
-      }
+      setupTables();
       return 0;
   }
 
 
+  /** Fill the cached values used while unpacking: the sin and cos of
+   *  all the possible headings and the corrections of each laser.
+   */
+  void RawData::setupTables()
+  {
+    for (uint16_t rot_index = 0; rot_index < ROTATION_MAX_UNITS; ++rot_index) {
+      float rotation = angles::from_degrees(ROTATION_RESOLUTION * rot_index);
+      cos_rot_table_[rot_index] = cosf(rotation);
+      sin_rot_table_[rot_index] = sinf(rotation);
+    }
+
+    memset(&lasers_, 0, sizeof(lasers_));
+    std::map<int, velodyne_pointcloud::LaserCorrection>::const_iterator it;
+    for (it = calibration_.laser_corrections.begin();
+         it != calibration_.laser_corrections.end(); ++it) {
+      int laser = it->first;
+      if (laser < 0 || laser >= MAX_LASERS) {
+        ROS_WARN_STREAM("ignoring calibration of laser " << laser);
+        continue;
+      }
+      const velodyne_pointcloud::LaserCorrection &corrections = it->second;
+      lasers_.dist_correction[laser] = corrections.dist_correction;
+      lasers_.dist_correction_x[laser] = corrections.dist_correction_x;
+      lasers_.dist_correction_y[laser] = corrections.dist_correction_y;
+      lasers_.two_pt_correction[laser] =
+        corrections.two_pt_correction_available ? 1.0f : 0.0f;
+      lasers_.cos_vert_correction[laser] = corrections.cos_vert_correction;
+      lasers_.sin_vert_correction[laser] = corrections.sin_vert_correction;
+      lasers_.cos_rot_correction[laser] = corrections.cos_rot_correction;
+      lasers_.sin_rot_correction[laser] = corrections.sin_rot_correction;
+      lasers_.horiz_offset_correction[laser] = corrections.horiz_offset_correction;
+      lasers_.vert_offset_correction[laser] = corrections.vert_offset_correction;
+      lasers_.focal_offset[laser] = 256
+                                  * (1 - corrections.focal_distance / 13100)
+                                  * (1 - corrections.focal_distance / 13100);
+      lasers_.focal_slope[laser] = corrections.focal_slope;
+      lasers_.min_intensity[laser] = corrections.min_intensity;
+      lasers_.max_intensity[laser] = corrections.max_intensity;
+      lasers_.laser_ring[laser] = corrections.laser_ring;
+    }
+  }
+
+
   /** @brief convert raw packet to point cloud
    *
    *  @param pkt raw packet to unpack
@@ -147,18 +182,95 @@ namespace velodyne_rawdata
                        VPointCloud &pc, int packets_num)
   {
     ROS_DEBUG_STREAM("Received packet, time: " << pkt.stamp);
-    
+
+    size_t size = pc.points.size();
+    pc.points.resize(size + SCANS_PER_PACKET);
+    int count = unpackPacket(pkt, packets_num, &pc.points[size]);
+    pc.points.resize(size + count);
+    pc.width += count;
+  }
+
+  /** @brief convert all the packets of a raw scan to point cloud
+   *
+   *  @param scan raw scan to unpack
+   *  @param pc point cloud (points are appended)
+   */
+  void RawData::unpack(const velodyne_msgs::VelodyneScan &scan,
+                       VPointCloud &pc)
+  {
+    size_t first = pc.points.size();
+    size_t size = first;
+    pc.points.resize(first + scan.packets.size() * SCANS_PER_PACKET);
+    for (size_t i = 0; i < scan.packets.size(); ++i) {
+      size += unpackPacket(scan.packets[i], scan.packets.size(),
+                           &pc.points[size]);
+    }
+    pc.points.resize(size);
+    pc.width += size - first;
+  }
+
+  /** @brief convert all the packets of a raw scan to PointCloud2
+   *
+   *  @param scan raw scan to unpack
+   *  @param cloud output cloud (previous points are replaced)
+   */
+  void RawData::unpack(const velodyne_msgs::VelodyneScan &scan,
+                       sensor_msgs::PointCloud2 &cloud)
+  {
+    // take the fields and point step from an empty VPointCloud, so that
+    // subscribers get the same layout as before
+    std_msgs::Header header = cloud.header;
+    pcl::toROSMsg(VPointCloud(), cloud);
+    cloud.header = header;
+
+    size_t point_step = cloud.point_step;
+    cloud.data.resize(scan.packets.size() * SCANS_PER_PACKET * point_step);
+    packet_points_.resize(SCANS_PER_PACKET);
+
+    size_t size = 0;
+    for (size_t i = 0; i < scan.packets.size(); ++i) {
+      int count = unpackPacket(scan.packets[i], scan.packets.size(),
+                               &packet_points_[0]);
+      memcpy(&cloud.data[size * point_step], &packet_points_[0],
+             count * point_step);
+      size += count;
+    }
+    cloud.data.resize(size * point_step);
+
+    cloud.height = 1;
+    cloud.width = size;
+    cloud.row_step = size * point_step;
+  }
+
+  /** @brief convert raw packet to points
+   *
+   *  @param pkt raw packet to unpack
+   *  @param packets_num number of packets of the scan
+   *  @param points room for SCANS_PER_PACKET points
+   *  @returns number of points written
+   */
+  int RawData::unpackPacket(const velodyne_msgs::VelodynePacket &pkt,
+                            int packets_num, VPoint *points)
+  {
     /** special parsing for the VLP16 **/
     if (calibration_.num_lasers == 16)
-    {
-      unpack_vlp16(pkt, pc);
-      return;
-    }
-    
+      return unpack_vlp16(pkt, points);
+
     const raw_packet_t *raw = (const raw_packet_t *) &pkt.data[0];
 
+    float distance_scale = 1.0f;
+    if (packets_num==(int) ceil(1507.0 / 10))
+      distance_scale = 2.0f;
+
+    int count = 0;
     for (int i = 0; i < BLOCKS_PER_PACKET; i++) {
 
+      /*condition added to avoid calculating points which are not
+        in the interesting defined area (min_angle < area < max_angle)*/
+      uint16_t rotation = raw->blocks[i].rotation;
+      if (!angleInView(rotation))
+        continue;
+
       // upper bank lasers are numbered [0..31]
       // NOTE: this is a change from the old velodyne_common implementation
       int bank_origin = 0;
@@ -167,167 +279,167 @@ namespace velodyne_rawdata
         bank_origin = 32;
       }
 
+      float cos_rot = cos_rot_table_[rotation];
+      float sin_rot = sin_rot_table_[rotation];
       for (int j = 0, k = 0; j < SCANS_PER_BLOCK; j++, k += RAW_SCAN_SIZE) {
-        
-        float x, y, z;
-        float intensity;
-        uint8_t laser_number;       ///< hardware laser number
-
-        laser_number = j + bank_origin;
-        velodyne_pointcloud::LaserCorrection &corrections = 
-          calibration_.laser_corrections[laser_number];
-
-        /** Position Calculation */
-
         union two_bytes tmp;
         tmp.bytes[0] = raw->blocks[i].data[k];
         tmp.bytes[1] = raw->blocks[i].data[k+1];
-        /*condition added to avoid calculating points which are not
-          in the interesting defined area (min_angle < area < max_angle)*/
-        if ((raw->blocks[i].rotation >= config_.min_angle 
-             && raw->blocks[i].rotation <= config_.max_angle 
-             && config_.min_angle < config_.max_angle)
-             ||(config_.min_angle > config_.max_angle 
-             && (raw->blocks[i].rotation <= config_.max_angle 
-             || raw->blocks[i].rotation >= config_.min_angle))){
-
-          float distance;
-          if (packets_num==(int) ceil(1507.0 / 10))
-            distance = tmp.uint * DISTANCE_RESOLUTION * 2;
-          else
-            distance = tmp.uint * DISTANCE_RESOLUTION;
-
-          distance += corrections.dist_correction;
-  
-          float cos_vert_angle = corrections.cos_vert_correction;
-          float sin_vert_angle = corrections.sin_vert_correction;
-          float cos_rot_correction = corrections.cos_rot_correction;
-          float sin_rot_correction = corrections.sin_rot_correction;
-  
-          // cos(a-b) = cos(a)*cos(b) + sin(a)*sin(b)
-          // sin(a-b) = sin(a)*cos(b) - cos(a)*sin(b)
-          float cos_rot_angle = 
-            cos_rot_table_[raw->blocks[i].rotation] * cos_rot_correction + 
-            sin_rot_table_[raw->blocks[i].rotation] * sin_rot_correction;
-          float sin_rot_angle = 
-            sin_rot_table_[raw->blocks[i].rotation] * cos_rot_correction - 
-            cos_rot_table_[raw->blocks[i].rotation] * sin_rot_correction;
-  
-          float horiz_offset = corrections.horiz_offset_correction;
-          float vert_offset = corrections.vert_offset_correction;
-  
-          // Compute the distance in the xy plane (w/o accounting for rotation)
-          /**the new term of 'vert_offset * sin_vert_angle'
-           * was added to the expression due to the mathemathical
-           * model we used.
-           */
-          float xy_distance = distance * cos_vert_angle - vert_offset * sin_vert_angle;
-  
-          // Calculate temporal X, use absolute value.
-          float xx = xy_distance * sin_rot_angle - horiz_offset * cos_rot_angle;
-          // Calculate temporal Y, use absolute value
-          float yy = xy_distance * cos_rot_angle + horiz_offset * sin_rot_angle;
-          if (xx < 0) xx=-xx;
-          if (yy < 0) yy=-yy;
-    
-          // Get 2points calibration values,Linear interpolation to get distance
-          // correction for X and Y, that means distance correction use
-          // different value at different distance
-          float distance_corr_x = 0;
-          float distance_corr_y = 0;
-          if (corrections.two_pt_correction_available) {
-            distance_corr_x = 
-              (corrections.dist_correction - corrections.dist_correction_x)
-                * (xx - 2.4) / (25.04 - 2.4) 
-              + corrections.dist_correction_x;
-            distance_corr_x -= corrections.dist_correction;
-            distance_corr_y = 
-              (corrections.dist_correction - corrections.dist_correction_y)
-                * (yy - 1.93) / (25.04 - 1.93)
-              + corrections.dist_correction_y;
-            distance_corr_y -= corrections.dist_correction;
-          }
-  
-          float distance_x = distance + distance_corr_x;
-          /**the new term of 'vert_offset * sin_vert_angle'
-           * was added to the expression due to the mathemathical
-           * model we used.
-           */
-          xy_distance = distance_x * cos_vert_angle - vert_offset * sin_vert_angle ;
-          ///the expression wiht '-' is proved to be better than the one with '+'
-          x = xy_distance * sin_rot_angle - horiz_offset * cos_rot_angle;
-  
-          float distance_y = distance + distance_corr_y;
-          xy_distance = distance_y * cos_vert_angle - vert_offset * sin_vert_angle ;
-          /**the new term of 'vert_offset * sin_vert_angle'
-           * was added to the expression due to the mathemathical
-           * model we used.
-           */
-          y = xy_distance * cos_rot_angle + horiz_offset * sin_rot_angle;
-  
-          // Using distance_y is not symmetric, but the velodyne manual
-          // does this.
-          /**the new term of 'vert_offset * cos_vert_angle'
-           * was added to the expression due to the mathemathical
-           * model we used.
-           */
-          z = distance_y * sin_vert_angle + vert_offset*cos_vert_angle;
-  
-          /** Use standard ROS coordinate system (right-hand rule) */
-          float x_coord = y;
-          float y_coord = -x;
-          float z_coord = z;
-  
-          /** Intensity Calculation */
-  
-          float min_intensity = corrections.min_intensity;
-          float max_intensity = corrections.max_intensity;
-  
-          intensity = raw->blocks[i].data[k+2];
-  
-          float focal_offset = 256 
-                             * (1 - corrections.focal_distance / 13100) 
-                             * (1 - corrections.focal_distance / 13100);
-          float focal_slope = corrections.focal_slope;
-          intensity += focal_slope * (std::abs(focal_offset - 256 * 
-            (1 - static_cast<float>(tmp.uint)/65535)*(1 - static_cast<float>(tmp.uint)/65535)));
-          intensity = (intensity < min_intensity) ? min_intensity : intensity;
-          intensity = (intensity > max_intensity) ? max_intensity : intensity;
-  
-          if (pointInRange(distance)) {
-  
-            // convert polar coordinates to Euclidean XYZ
-            VPoint point;
-            point.ring = corrections.laser_ring;
-            point.x = x_coord;
-            point.y = y_coord;
-            point.z = z_coord;
-            point.intensity = intensity;
-  
-            // append this point to the cloud
-            pc.points.push_back(point);
-            ++pc.width;
-          }
-        }
+        batch_.raw_distance[j] = tmp.uint;
+        batch_.distance_ratio[j] = static_cast<float>(tmp.uint)/65535;
+        batch_.raw_intensity[j] = raw->blocks[i].data[k+2];
+        batch_.cos_rot[j] = cos_rot;
+        batch_.sin_rot[j] = sin_rot;
+        batch_.in_view[j] = true;
+      }
+
+      convertBatch(bank_origin, SCANS_PER_BLOCK, distance_scale);
+      count += appendBatch(bank_origin, SCANS_PER_BLOCK, points + count);
+    }
+    return count;
+  }
+
+  /** @brief convert the returns of consecutive lasers held in batch_
+   *
+   *  Every return is converted, whether in view and range or not, so
+   *  that the loop has no branches and is vectorized by the compiler
+   *  (rawdata.cc is built with -ftree-vectorize -fno-trapping-math).
+   *
+   *  @param first_laser hardware laser number of the first return
+   *  @param n number of returns
+   *  @param distance_scale factor of the raw distances
+   */
+  void RawData::convertBatch(int first_laser, int n, float distance_scale)
+  {
+    const LaserTable &l = lasers_;
+    ReturnBatch &b = batch_;
+
+    for (int j = 0; j < n; j++) {
+      int laser = first_laser + j;
+
+      /** Position Calculation */
+
+      float distance = b.raw_distance[j] * DISTANCE_RESOLUTION * distance_scale;
+      distance += l.dist_correction[laser];
+
+      float cos_vert_angle = l.cos_vert_correction[laser];
+      float sin_vert_angle = l.sin_vert_correction[laser];
+      float cos_rot_correction = l.cos_rot_correction[laser];
+      float sin_rot_correction = l.sin_rot_correction[laser];
+
+      // cos(a-b) = cos(a)*cos(b) + sin(a)*sin(b)
+      // sin(a-b) = sin(a)*cos(b) - cos(a)*sin(b)
+      float cos_rot_angle = 
+        b.cos_rot[j] * cos_rot_correction + 
+        b.sin_rot[j] * sin_rot_correction;
+      float sin_rot_angle = 
+        b.sin_rot[j] * cos_rot_correction - 
+        b.cos_rot[j] * sin_rot_correction;
+
+      float horiz_offset = l.horiz_offset_correction[laser];
+      float vert_offset = l.vert_offset_correction[laser];
+
+      // Compute the distance in the xy plane (w/o accounting for rotation)
+      /**the new term of 'vert_offset * sin_vert_angle'
+       * was added to the expression due to the mathemathical
+       * model we used.
+       */
+      float xy_distance = distance * cos_vert_angle - vert_offset * sin_vert_angle;
+
+      // Calculate temporal X, use absolute value.
+      float xx = fabsf(xy_distance * sin_rot_angle - horiz_offset * cos_rot_angle);
+      // Calculate temporal Y, use absolute value
+      float yy = fabsf(xy_distance * cos_rot_angle + horiz_offset * sin_rot_angle);
+
+      // Get 2points calibration values,Linear interpolation to get distance
+      // correction for X and Y, that means distance correction use
+      // different value at different distance
+      float distance_corr_x = 
+        (l.dist_correction[laser] - l.dist_correction_x[laser])
+          * (xx - 2.4) / (25.04 - 2.4) 
+        + l.dist_correction_x[laser];
+      distance_corr_x -= l.dist_correction[laser];
+      float distance_corr_y = 
+        (l.dist_correction[laser] - l.dist_correction_y[laser])
+          * (yy - 1.93) / (25.04 - 1.93)
+        + l.dist_correction_y[laser];
+      distance_corr_y -= l.dist_correction[laser];
+      distance_corr_x = (l.two_pt_correction[laser] != 0) ? distance_corr_x : 0;
+      distance_corr_y = (l.two_pt_correction[laser] != 0) ? distance_corr_y : 0;
+
+      float distance_x = distance + distance_corr_x;
+      /**the new term of 'vert_offset * sin_vert_angle'
+       * was added to the expression due to the mathemathical
+       * model we used.
+       */
+      xy_distance = distance_x * cos_vert_angle - vert_offset * sin_vert_angle ;
+      ///the expression wiht '-' is proved to be better than the one with '+'
+      float x = xy_distance * sin_rot_angle - horiz_offset * cos_rot_angle;
+
+      float distance_y = distance + distance_corr_y;
+      xy_distance = distance_y * cos_vert_angle - vert_offset * sin_vert_angle ;
+      float y = xy_distance * cos_rot_angle + horiz_offset * sin_rot_angle;
+
+      // Using distance_y is not symmetric, but the velodyne manual
+      // does this.
+      /**the new term of 'vert_offset * cos_vert_angle'
+       * was added to the expression due to the mathemathical
+       * model we used.
+       */
+      float z = distance_y * sin_vert_angle + vert_offset*cos_vert_angle;
+
+      /** Use standard ROS coordinate system (right-hand rule) */
+      b.x[j] = y;
+      b.y[j] = -x;
+      b.z[j] = z;
+      b.distance[j] = distance;
+
+      /** Intensity Calculation */
+
+      float intensity = b.raw_intensity[j];
+      intensity += l.focal_slope[laser] * (fabsf(l.focal_offset[laser] - 256 * 
+        (1 - b.distance_ratio[j])*(1 - b.distance_ratio[j])));
+      intensity = (intensity < l.min_intensity[laser]) ? l.min_intensity[laser] : intensity;
+      intensity = (intensity > l.max_intensity[laser]) ? l.max_intensity[laser] : intensity;
+      b.intensity[j] = intensity;
+    }
+  }
+
+  /** @brief write the returns of batch_ in view and range as points
+   *
+   *  @returns number of points written
+   */
+  int RawData::appendBatch(int first_laser, int n, VPoint *points)
+  {
+    int count = 0;
+    for (int j = 0; j < n; j++) {
+      if (batch_.in_view[j] && pointInRange(batch_.distance[j])) {
+        VPoint &point = points[count++];
+        point.ring = lasers_.laser_ring[first_laser + j];
+        point.x = batch_.x[j];
+        point.y = batch_.y[j];
+        point.z = batch_.z[j];
+        point.intensity = batch_.intensity[j];
       }
     }
+    return count;
   }
   
-  /** @brief convert raw VLP16 packet to point cloud
+  /** @brief convert raw VLP16 packet to points
    *
    *  @param pkt raw packet to unpack
-   *  @param pc shared pointer to point cloud (points are appended)
+   *  @param points room for SCANS_PER_PACKET points
+   *  @returns number of points written
    */
-  void RawData::unpack_vlp16(const velodyne_msgs::VelodynePacket &pkt,
-                             VPointCloud &pc)
+  int RawData::unpack_vlp16(const velodyne_msgs::VelodynePacket &pkt,
+                            VPoint *points)
   {
     float azimuth;
     float azimuth_diff;
     float last_azimuth_diff=0;
     float azimuth_corrected_f;
     int azimuth_corrected;
-    float x, y, z;
-    float intensity;
+    int count = 0;
 
     const raw_packet_t *raw = (const raw_packet_t *) &pkt.data[0];
 
@@ -340,7 +452,7 @@ namespace velodyne_rawdata
         ROS_WARN_STREAM_THROTTLE(60, "skipping invalid VLP-16 packet: block "
                                  << block << " header value is "
                                  << raw->blocks[block].header);
-        return;                         // bad packet: skip the rest
+        return count;                   // bad packet: skip the rest
       }
 
       // Calculate difference between current and next block's azimuth angle.
@@ -354,10 +466,6 @@ namespace velodyne_rawdata
 
       for (int firing=0, k=0; firing < VLP16_FIRINGS_PER_BLOCK; firing++){
         for (int dsr=0; dsr < VLP16_SCANS_PER_FIRING; dsr++, k+=RAW_SCAN_SIZE){
-          velodyne_pointcloud::LaserCorrection &corrections = 
-            calibration_.laser_corrections[dsr];
-
-          /** Position Calculation */
           union two_bytes tmp;
           tmp.bytes[0] = raw->blocks[block].data[k];
           tmp.bytes[1] = raw->blocks[block].data[k+1];
@@ -365,131 +473,22 @@ namespace velodyne_rawdata
           /** correct for the laser rotation as a function of timing during the firings **/
           azimuth_corrected_f = azimuth + (azimuth_diff * ((dsr*VLP16_DSR_TOFFSET) + (firing*VLP16_FIRING_TOFFSET)) / VLP16_BLOCK_TDURATION);
           azimuth_corrected = ((int)round(azimuth_corrected_f)) % 36000;
-          
+
+          batch_.raw_distance[dsr] = tmp.uint;
+          batch_.distance_ratio[dsr] = tmp.uint/65535;
+          batch_.raw_intensity[dsr] = raw->blocks[block].data[k+2];
+          batch_.cos_rot[dsr] = cos_rot_table_[azimuth_corrected];
+          batch_.sin_rot[dsr] = sin_rot_table_[azimuth_corrected];
           /*condition added to avoid calculating points which are not
             in the interesting defined area (min_angle < area < max_angle)*/
-          if ((azimuth_corrected >= config_.min_angle 
-               && azimuth_corrected <= config_.max_angle 
-               && config_.min_angle < config_.max_angle)
-               ||(config_.min_angle > config_.max_angle 
-               && (azimuth_corrected <= config_.max_angle 
-               || azimuth_corrected >= config_.min_angle))){
-
-            // convert polar coordinates to Euclidean XYZ
-            float distance = tmp.uint * DISTANCE_RESOLUTION;
-            distance += corrections.dist_correction;
-            
-            float cos_vert_angle = corrections.cos_vert_correction;
-            float sin_vert_angle = corrections.sin_vert_correction;
-            float cos_rot_correction = corrections.cos_rot_correction;
-            float sin_rot_correction = corrections.sin_rot_correction;
-    
-            // cos(a-b) = cos(a)*cos(b) + sin(a)*sin(b)
-            // sin(a-b) = sin(a)*cos(b) - cos(a)*sin(b)
-            float cos_rot_angle = 
-              cos_rot_table_[azimuth_corrected] * cos_rot_correction + 
-              sin_rot_table_[azimuth_corrected] * sin_rot_correction;
-            float sin_rot_angle = 
-              sin_rot_table_[azimuth_corrected] * cos_rot_correction - 
-              cos_rot_table_[azimuth_corrected] * sin_rot_correction;
-    
-            float horiz_offset = corrections.horiz_offset_correction;
-            float vert_offset = corrections.vert_offset_correction;
-    
-            // Compute the distance in the xy plane (w/o accounting for rotation)
-            /**the new term of 'vert_offset * sin_vert_angle'
-             * was added to the expression due to the mathemathical
-             * model we used.
-             */
-            float xy_distance = distance * cos_vert_angle - vert_offset * sin_vert_angle;
-    
-            // Calculate temporal X, use absolute value.
-            float xx = xy_distance * sin_rot_angle - horiz_offset * cos_rot_angle;
-            // Calculate temporal Y, use absolute value
-            float yy = xy_distance * cos_rot_angle + horiz_offset * sin_rot_angle;
-            if (xx < 0) xx=-xx;
-            if (yy < 0) yy=-yy;
-      
-            // Get 2points calibration values,Linear interpolation to get distance
-            // correction for X and Y, that means distance correction use
-            // different value at different distance
-            float distance_corr_x = 0;
-            float distance_corr_y = 0;
-            if (corrections.two_pt_correction_available) {
-              distance_corr_x = 
-                (corrections.dist_correction - corrections.dist_correction_x)
-                  * (xx - 2.4) / (25.04 - 2.4) 
-                + corrections.dist_correction_x;
-              distance_corr_x -= corrections.dist_correction;
-              distance_corr_y = 
-                (corrections.dist_correction - corrections.dist_correction_y)
-                  * (yy - 1.93) / (25.04 - 1.93)
-                + corrections.dist_correction_y;
-              distance_corr_y -= corrections.dist_correction;
-            }
-    
-            float distance_x = distance + distance_corr_x;
-            /**the new term of 'vert_offset * sin_vert_angle'
-             * was added to the expression due to the mathemathical
-             * model we used.
-             */
-            xy_distance = distance_x * cos_vert_angle - vert_offset * sin_vert_angle ;
-            x = xy_distance * sin_rot_angle - horiz_offset * cos_rot_angle;
-    
-            float distance_y = distance + distance_corr_y;
-            /**the new term of 'vert_offset * sin_vert_angle'
-             * was added to the expression due to the mathemathical
-             * model we used.
-             */
-            xy_distance = distance_y * cos_vert_angle - vert_offset * sin_vert_angle ;
-            y = xy_distance * cos_rot_angle + horiz_offset * sin_rot_angle;
-    
-            // Using distance_y is not symmetric, but the velodyne manual
-            // does this.
-            /**the new term of 'vert_offset * cos_vert_angle'
-             * was added to the expression due to the mathemathical
-             * model we used.
-             */
-            z = distance_y * sin_vert_angle + vert_offset*cos_vert_angle;
-  
-    
-            /** Use standard ROS coordinate system (right-hand rule) */
-            float x_coord = y;
-            float y_coord = -x;
-            float z_coord = z;
-    
-            /** Intensity Calculation */
-            float min_intensity = corrections.min_intensity;
-            float max_intensity = corrections.max_intensity;
-    
-            intensity = raw->blocks[block].data[k+2];
-    
-            float focal_offset = 256 
-                               * (1 - corrections.focal_distance / 13100) 
-                               * (1 - corrections.focal_distance / 13100);
-            float focal_slope = corrections.focal_slope;
-            intensity += focal_slope * (std::abs(focal_offset - 256 * 
-              (1 - tmp.uint/65535)*(1 - tmp.uint/65535)));
-            intensity = (intensity < min_intensity) ? min_intensity : intensity;
-            intensity = (intensity > max_intensity) ? max_intensity : intensity;
-    
-            if (pointInRange(distance)) {
-    
-              // append this point to the cloud
-              VPoint point;
-              point.ring = corrections.laser_ring;
-              point.x = x_coord;
-              point.y = y_coord;
-              point.z = z_coord;
-              point.intensity = intensity;
-
-              pc.points.push_back(point);
-              ++pc.width;
-            }
-          }
+          batch_.in_view[dsr] = angleInView(azimuth_corrected);
         }
+
+        convertBatch(0, VLP16_SCANS_PER_FIRING, 1.0f);
+        count += appendBatch(0, VLP16_SCANS_PER_FIRING, points + count);
       }
     }
+    return count;
   }  
 
 } // namespace velodyne_rawdata
@@ -0,0 +1,132 @@
+//
+// Microbenchmark of the RawData unpack paths over recorded packets.
+//
+// usage: benchmark_unpack CALIBRATION PCAP PACKETS_PER_SCAN [REPEAT]
+//
+// PACKETS_PER_SCAN is the npackets of the driver, e.g. for the
+// downloaded test data (64E S2.1 at 300 rpm, VLP16 at 600 rpm), from
+// the tests directory of the devel space:
+//
+//   PARAMS=`rospack find velodyne_pointcloud`/params
+//   benchmark_unpack $PARAMS/64e_s2.1-sztaki.yaml 64e_s2.1-300-sztaki.pcap 695
+//   benchmark_unpack $PARAMS/VLP16db.yaml vlp16.pcap 76
+//
+
+#include <pcap.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ros/ros.h>
+#include <velodyne_pointcloud/rawdata.h>
+
+using namespace velodyne_rawdata;
+
+// UDP payload offset of the packets captured from the device
+static const int PCAP_HEADER_SIZE = 42;
+
+static bool read_scans(const char *filename, size_t packets_per_scan,
+                       std::vector<velodyne_msgs::VelodyneScan> &scans)
+{
+  char errbuf[PCAP_ERRBUF_SIZE];
+  pcap_t *pcap = pcap_open_offline(filename, errbuf);
+  if (pcap == NULL)
+    {
+      fprintf(stderr, "Error opening %s: %s\n", filename, errbuf);
+      return false;
+    }
+
+  velodyne_msgs::VelodyneScan scan;
+  struct pcap_pkthdr *header;
+  const u_char *pkt_data;
+  while (pcap_next_ex(pcap, &header, &pkt_data) >= 0)
+    {
+      if (header->caplen != PCAP_HEADER_SIZE + PACKET_SIZE)
+        continue;                       // not a data packet
+
+      velodyne_msgs::VelodynePacket packet;
+      memcpy(&packet.data[0], pkt_data + PCAP_HEADER_SIZE, PACKET_SIZE);
+      scan.packets.push_back(packet);
+      if (scan.packets.size() == packets_per_scan)
+        {
+          scans.push_back(scan);
+          scan.packets.clear();
+        }
+    }
+  pcap_close(pcap);
+  return true;
+}
+
+static void report(const char *name, ros::WallDuration elapsed,
+                   size_t scans, size_t points)
+{
+  printf("%-28s %10.3f ms/scan %10lu points/scan\n", name,
+         elapsed.toSec() * 1e3 / scans, (unsigned long) (points / scans));
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 4)
+    {
+      fprintf(stderr, "usage: %s CALIBRATION PCAP PACKETS_PER_SCAN [REPEAT]\n",
+              argv[0]);
+      return 1;
+    }
+  size_t packets_per_scan = atoi(argv[3]);
+  int repeat = (argc > 4) ? atoi(argv[4]) : 10;
+
+  RawData data;
+  if (data.setupOffline(argv[1], 130.0, 0.9) != 0)
+    return 1;
+  data.setParameters(0.9, 130.0, 0.0, 2 * M_PI);
+
+  std::vector<velodyne_msgs::VelodyneScan> scans;
+  if (packets_per_scan == 0 || !read_scans(argv[2], packets_per_scan, scans))
+    return 1;
+  if (scans.empty())
+    {
+      fprintf(stderr, "No complete scan in %s\n", argv[2]);
+      return 1;
+    }
+  size_t n = scans.size() * repeat;
+  printf("%lu scans of %lu packets, %d times\n",
+         (unsigned long) scans.size(), (unsigned long) packets_per_scan, repeat);
+
+  // packet by packet, as the transform node does
+  size_t points = 0;
+  ros::WallTime start = ros::WallTime::now();
+  for (int r = 0; r < repeat; ++r)
+    for (size_t i = 0; i < scans.size(); ++i)
+      {
+        VPointCloud pc;
+        for (size_t j = 0; j < scans[i].packets.size(); ++j)
+          data.unpack(scans[i].packets[j], pc, scans[i].packets.size());
+        points += pc.points.size();
+      }
+  report("unpack packets, VPointCloud", ros::WallTime::now() - start, n, points);
+
+  points = 0;
+  start = ros::WallTime::now();
+  for (int r = 0; r < repeat; ++r)
+    for (size_t i = 0; i < scans.size(); ++i)
+      {
+        VPointCloud pc;
+        data.unpack(scans[i], pc);
+        points += pc.points.size();
+      }
+  report("unpack scan, VPointCloud", ros::WallTime::now() - start, n, points);
+
+  // as the cloud node does
+  points = 0;
+  start = ros::WallTime::now();
+  for (int r = 0; r < repeat; ++r)
+    for (size_t i = 0; i < scans.size(); ++i)
+      {
+        sensor_msgs::PointCloud2 cloud;
+        data.unpack(scans[i], cloud);
+        points += cloud.width;
+      }
+  report("unpack scan, PointCloud2", ros::WallTime::now() - start, n, points);
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * undistortion_maps.h
+ */
+
+#ifndef IMAGE_PROCESSOR_UNDISTORTION_MAPS_H
+#define IMAGE_PROCESSOR_UNDISTORTION_MAPS_H
+
+#include <sensor_msgs/CameraInfo.h>
+
+#include <opencv2/core/core.hpp>
+
+namespace image_processor
+{
+/*!
+ * Undistortion of the images of one camera, as cv::undistort with the
+ * intrinsics of a CameraInfo, but from remap tables computed only once
+ * per calibration and image size instead of on every frame.
+ */
+class UndistortionMaps
+{
+public:
+	UndistortionMaps();
+
+	/*!
+	 * Sets the calibration from K and D of a CameraInfo
+	 * @param in_camera_info
+	 * @return true if the calibration changed, the maps are then recomputed on the next Undistort
+	 */
+	bool SetCameraInfo(const sensor_msgs::CameraInfo &in_camera_info);
+
+	/*!
+	 * @return true before the first CameraInfo
+	 */
+	bool Empty() const;
+
+	/*!
+	 * Undistorts an image of the camera, in_image and out_image must not be the same
+	 * @param in_image
+	 * @param out_image
+	 */
+	void Undistort(const cv::Mat &in_image, cv::Mat &out_image);
+
+	const cv::Mat &CameraMatrix() const
+	{
+		return camera_matrix_;
+	}
+
+	const cv::Mat &DistortionCoefficients() const
+	{
+		return distortion_coefficients_;
+	}
+
+private:
+	cv::Mat camera_matrix_;
+	cv::Mat distortion_coefficients_;
+
+	cv::Size maps_size_;  // image size of the maps, empty until they are computed
+	cv::Mat map1_;
+	cv::Mat map2_;
+};
+}  // namespace image_processor
+
+#endif  // IMAGE_PROCESSOR_UNDISTORTION_MAPS_H
@@ -0,0 +1,105 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * undistortion_maps.cpp
+ */
+
+#include "image_processor/undistortion_maps.h"
+
+#include <algorithm>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace image_processor
+{
+UndistortionMaps::UndistortionMaps()
+{
+}
+
+bool UndistortionMaps::SetCameraInfo(const sensor_msgs::CameraInfo &in_camera_info)
+{
+	cv::Mat camera_matrix(3, 3, CV_64F);
+	for (int row = 0; row < 3; row++)
+	{
+		for (int col = 0; col < 3; col++)
+		{
+			camera_matrix.at<double>(row, col) = in_camera_info.K[row * 3 + col];
+		}
+	}
+
+	// OpenCV takes 4, 5, 8, 12 or 14 coefficients, other counts are read as the first ones of plumb_bob
+	size_t count = in_camera_info.D.size();
+	if (count != 4 && count != 5 && count != 8 && count != 12 && count != 14)
+	{
+		count = 5;
+	}
+	cv::Mat distortion_coefficients = cv::Mat::zeros(1, count, CV_64F);
+	for (size_t col = 0; col < std::min(count, in_camera_info.D.size()); col++)
+	{
+		distortion_coefficients.at<double>(col) = in_camera_info.D[col];
+	}
+
+	if (!Empty()
+	    && cv::countNonZero(camera_matrix != camera_matrix_) == 0
+	    && distortion_coefficients.size() == distortion_coefficients_.size()
+	    && cv::countNonZero(distortion_coefficients != distortion_coefficients_) == 0)
+	{
+		return false;
+	}
+
+	camera_matrix_ = camera_matrix;
+	distortion_coefficients_ = distortion_coefficients;
+	maps_size_ = cv::Size();
+	return true;
+}
+
+bool UndistortionMaps::Empty() const
+{
+	return camera_matrix_.empty();
+}
+
+void UndistortionMaps::Undistort(const cv::Mat &in_image, cv::Mat &out_image)
+{
+	if (Empty())
+	{
+		in_image.copyTo(out_image);
+		return;
+	}
+
+	if (in_image.size() != maps_size_)
+	{
+		// same maps and interpolation as cv::undistort, which builds them again on every call
+		cv::initUndistortRectifyMap(camera_matrix_, distortion_coefficients_, cv::Mat(), camera_matrix_,
+		                            in_image.size(), CV_16SC2, map1_, map2_);
+		maps_size_ = in_image.size();
+	}
+	cv::remap(in_image, out_image, map1_, map2_, cv::INTER_LINEAR, cv::BORDER_CONSTANT);
+}
+}  // namespace image_processor
@@ -42,6 +42,8 @@
 #include "opencv2/imgproc/imgproc.hpp"
 #include "opencv2/calib3d/calib3d.hpp"
 
+#include "image_processor/undistortion_maps.h"
+
 #define _NODE_NAME_ "image_rectifier"
 
 class RosImageRectifierApp
@@ -52,9 +54,7 @@ class RosImageRectifierApp
 
 	ros::Publisher      publisher_image_rectified_;
 
-	cv::Size            image_size_;
-	cv::Mat             camera_instrinsics_;
-	cv::Mat             distortion_coefficients_;
+	image_processor::UndistortionMaps undistortion_maps_;
 
 
 	void ImageCallback(const sensor_msgs::Image& in_image_sensor)
@@ -63,14 +63,14 @@ class RosImageRectifierApp
 		cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(in_image_sensor, "bgr8");
 		cv::Mat tmp_image = cv_image->image;
 		cv::Mat image;
-		if (camera_instrinsics_.empty())
+		if (undistortion_maps_.Empty())
 		{
 			ROS_INFO("[%s] Make sure camera_info is being published in the specified topic", _NODE_NAME_);
 			image = tmp_image;
 		}
 		else
 		{
-			cv::undistort(tmp_image, image, camera_instrinsics_, distortion_coefficients_);
+			undistortion_maps_.Undistort(tmp_image, image);
 		}
 
 		cv_bridge::CvImage out_msg;
@@ -84,20 +84,7 @@ class RosImageRectifierApp
 
 	void IntrinsicsCallback(const sensor_msgs::CameraInfo& in_message)
 	{
-		image_size_.height = in_message.height;
-		image_size_.width = in_message.width;
-
-		camera_instrinsics_ = cv::Mat(3,3, CV_64F);
-		for (int row=0; row<3; row++) {
-			for (int col=0; col<3; col++) {
-				camera_instrinsics_.at<double>(row, col) = in_message.K[row * 3 + col];
-			}
-		}
-
-		distortion_coefficients_ = cv::Mat(1,5,CV_64F);
-		for (int col=0; col<5; col++) {
-			distortion_coefficients_.at<double>(col) = in_message.D[col];
-		}
+		undistortion_maps_.SetCameraInfo(in_message);
 	}
 
 public:
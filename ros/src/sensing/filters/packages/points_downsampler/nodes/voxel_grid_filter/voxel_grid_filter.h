@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2015, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef VOXEL_GRID_FILTER_H
+#define VOXEL_GRID_FILTER_H
+
+#include <fstream>
+#include <string>
+
+#include <ros/ros.h>
+#include <pcl/point_types.h>
+#include <pcl_ros/point_cloud.h>
+
+#include "autoware_config_msgs/ConfigVoxelGridFilter.h"
+
+#include <points_downsampler/PointsDownsamplerInfo.h>
+
+class VoxelGridFilter
+{
+public:
+  VoxelGridFilter(ros::NodeHandle nh, ros::NodeHandle private_nh);
+
+private:
+  typedef pcl::PointCloud<pcl::PointXYZI> PointCloudT;
+
+  ros::NodeHandle nh_;
+  ros::NodeHandle private_nh_;
+
+  ros::Publisher filtered_points_pub_;
+  ros::Publisher points_downsampler_info_pub_;
+  ros::Subscriber config_sub_;
+  ros::Subscriber scan_sub_;
+
+  points_downsampler::PointsDownsamplerInfo points_downsampler_info_msg_;
+
+  // Leaf size of VoxelGrid filter.
+  double voxel_leaf_size_;
+  double measurement_range_;
+
+  std::string points_topic_;
+  bool output_log_;
+  std::ofstream ofs_;
+  std::string filename_;
+
+  void config_callback(const autoware_config_msgs::ConfigVoxelGridFilter::ConstPtr& input);
+  // pcl clouds are received and published as is, so that no serialization happens inside a nodelet manager
+  void scan_callback(const PointCloudT::ConstPtr& input);
+};
+
+#endif // VOXEL_GRID_FILTER_H
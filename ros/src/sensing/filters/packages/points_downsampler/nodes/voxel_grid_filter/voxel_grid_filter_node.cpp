@@ -28,25 +28,20 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#include "astar_util.h"
+#include <ros/ros.h>
 
-namespace astar_planner
-{
-WaveFrontNode::WaveFrontNode()
-{
-}
+#include "voxel_grid_filter.h"
 
-WaveFrontNode::WaveFrontNode(int x, int y, double cost) : index_x(x), index_y(y), hc(cost)
+int main(int argc, char** argv)
 {
-}
+  ros::init(argc, argv, "voxel_grid_filter");
 
-SimpleNode::SimpleNode()
-{
-}
+  ros::NodeHandle nh;
+  ros::NodeHandle private_nh("~");
 
-SimpleNode::SimpleNode(int x, int y, int theta, double gc, double hc)
-  : index_x(x), index_y(y), index_theta(theta), cost(gc + hc)
-{
-}
+  VoxelGridFilter filter(nh, private_nh);
 
-}  // namespace astar_planner
+  ros::spin();
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2018, Nagoya University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <ros/ros.h>
+#include <pluginlib/class_list_macros.h>
+#include <nodelet/nodelet.h>
+#include <tf/transform_listener.h>
+
+#include "cloud_transformer.h"
+
+namespace points_preprocessor
+{
+  class CloudTransformerNodelet: public nodelet::Nodelet
+  {
+  public:
+
+    CloudTransformerNodelet() {}
+    ~CloudTransformerNodelet() {}
+
+  private:
+
+    virtual void onInit();
+    boost::shared_ptr<tf::TransformListener> tf_listener_;
+    boost::shared_ptr<CloudTransformerNode> transformer_;
+  };
+
+  /** @brief Nodelet initialization. */
+  void CloudTransformerNodelet::onInit()
+  {
+    tf_listener_.reset(new tf::TransformListener(getNodeHandle()));
+    transformer_.reset(new CloudTransformerNode(getPrivateNodeHandle(), tf_listener_.get()));
+    transformer_->Init();
+  }
+
+} // namespace points_preprocessor
+
+
+// Register this plugin with pluginlib.  Names must match nodelets.xml.
+//
+// parameters: class type, base class type
+PLUGINLIB_EXPORT_CLASS(points_preprocessor::CloudTransformerNodelet, nodelet::Nodelet)
@@ -28,52 +28,20 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
-#include <message_filters/subscriber.h>
-#include <message_filters/sync_policies/approximate_time.h>
-#include <message_filters/synchronizer.h>
-#include <pcl/point_types.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl_ros/point_cloud.h>
-#include <pcl_ros/transforms.h>
-#include <ros/ros.h>
-#include <sensor_msgs/PointCloud2.h>
-#include <tf/tf.h>
-#include <tf/transform_listener.h>
-#include <velodyne_pointcloud/point_types.h>
-#include <yaml-cpp/yaml.h>
+#include "points_concat_filter.h"
 
-class PointsConcatFilter
+PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_("~"), tf_listener_()
 {
-public:
-  PointsConcatFilter();
-
-private:
-  typedef pcl::PointXYZI PointT;
-  typedef pcl::PointCloud<PointT> PointCloudT;
-  typedef sensor_msgs::PointCloud2 PointCloudMsgT;
-  typedef message_filters::sync_policies::ApproximateTime<PointCloudMsgT, PointCloudMsgT, PointCloudMsgT,
-                                                          PointCloudMsgT, PointCloudMsgT, PointCloudMsgT,
-                                                          PointCloudMsgT, PointCloudMsgT>
-      SyncPolicyT;
-
-  ros::NodeHandle node_handle_, private_node_handle_;
-  message_filters::Subscriber<PointCloudMsgT> *cloud_subscribers_[8];
-  message_filters::Synchronizer<SyncPolicyT> *cloud_synchronizer_;
-  ros::Subscriber config_subscriber_;
-  ros::Publisher cloud_publisher_;
-  tf::TransformListener tf_listener_;
-
-  size_t input_topics_size_;
-  std::string input_topics_;
-  std::string output_frame_id_;
+  init();
+}
 
-  void pointcloud_callback(const PointCloudMsgT::ConstPtr &msg1, const PointCloudMsgT::ConstPtr &msg2,
-                           const PointCloudMsgT::ConstPtr &msg3, const PointCloudMsgT::ConstPtr &msg4,
-                           const PointCloudMsgT::ConstPtr &msg5, const PointCloudMsgT::ConstPtr &msg6,
-                           const PointCloudMsgT::ConstPtr &msg7, const PointCloudMsgT::ConstPtr &msg8);
-};
+PointsConcatFilter::PointsConcatFilter(ros::NodeHandle node_handle, ros::NodeHandle private_node_handle)
+  : node_handle_(node_handle), private_node_handle_(private_node_handle), tf_listener_(node_handle)
+{
+  init();
+}
 
-PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_("~"), tf_listener_()
+void PointsConcatFilter::init()
 {
   private_node_handle_.param("input_topics", input_topics_, std::string("[/points_alpha, /points_beta]"));
   private_node_handle_.param("output_frame_id", output_frame_id_, std::string("velodyne"));
@@ -84,6 +52,7 @@ PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_(
   {
     ROS_ERROR("The size of input_topics must be between 2 and 8");
     ros::shutdown();
+    return;
   }
   for (size_t i = 0; i < 8; ++i)
   {
@@ -103,7 +72,7 @@ PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_(
       *cloud_subscribers_[4], *cloud_subscribers_[5], *cloud_subscribers_[6], *cloud_subscribers_[7]);
   cloud_synchronizer_->registerCallback(
       boost::bind(&PointsConcatFilter::pointcloud_callback, this, _1, _2, _3, _4, _5, _6, _7, _8));
-  cloud_publisher_ = node_handle_.advertise<PointCloudMsgT>("/points_concat", 1);
+  cloud_publisher_ = node_handle_.advertise<PointCloudT>("/points_concat", 1);
 }
 
 void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg1, const PointCloudMsgT::ConstPtr &msg2,
@@ -122,12 +91,9 @@ void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg
   {
     for (size_t i = 0; i < input_topics_size_; ++i)
     {
-      // Note: If you use kinetic, you can directly receive messages as
-      // PointCloutT.
       cloud_sources[i] = PointCloudT().makeShared();
-      pcl::fromROSMsg(*msgs[i], *cloud_sources[i]);
       tf_listener_.waitForTransform(output_frame_id_, msgs[i]->header.frame_id, ros::Time(0), ros::Duration(1.0));
-      pcl_ros::transformPointCloud(output_frame_id_, *cloud_sources[i], *cloud_sources[i], tf_listener_);
+      pcl_ros::transformPointCloud(output_frame_id_, *msgs[i], *cloud_sources[i], tf_listener_);
     }
   }
   catch (tf::TransformException &ex)
@@ -143,15 +109,7 @@ void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg
   }
 
   // publsh points
-  cloud_concatenated->header = pcl_conversions::toPCL(msgs[0]->header);
+  cloud_concatenated->header = msgs[0]->header;
   cloud_concatenated->header.frame_id = output_frame_id_;
   cloud_publisher_.publish(cloud_concatenated);
 }
-
-int main(int argc, char **argv)
-{
-  ros::init(argc, argv, "points_concat_filter");
-  PointsConcatFilter node;
-  ros::spin();
-  return 0;
-}
@@ -78,6 +78,15 @@ private:
 	size_t              radial_dividers_num_;
 	size_t              concentric_dividers_num_;
 
+	bool                single_pass_;//classify using the preallocated radial buckets instead of the per point structures
+
+	//buffers of the single pass classification, kept across scans so they are not reallocated on each callback
+	std::vector<float>    point_radius_;  //distance on the XY plane of each input point
+	std::vector<uint32_t> point_bucket_;  //radial division of each input point, radial_dividers_num_ if discarded
+	std::vector<uint8_t>  point_ground_;  //1 if the input point was classified as ground
+	std::vector<uint32_t> bucket_offsets_;//position in bucket_points_ where each radial division starts
+	std::vector<uint32_t> bucket_points_; //input indices grouped by radial division, ordered by radius
+
 	std::vector<cv::Scalar> colors_;
 	const size_t        color_num_ = 60;//different number of color to generate
 
@@ -135,7 +144,7 @@ private:
 	 * @param in_clip_height Maximum allowed height in the cloud
 	 * @param out_clipped_cloud_ptr Resultung PointCloud with the points removed
 	 */
-	void ClipCloud(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr,
+	void ClipCloud(const pcl::PointCloud<pcl::PointXYZI>::ConstPtr in_cloud_ptr,
 	               double in_clip_height,
 	               pcl::PointCloud<pcl::PointXYZI>::Ptr out_clipped_cloud_ptr);
 	
@@ -163,12 +172,52 @@ private:
 	                      double in_min_distance,
 	                      pcl::PointCloud<pcl::PointXYZI>::Ptr out_filtered_cloud_ptr);
 	
-	void CloudCallback(const sensor_msgs::PointCloud2ConstPtr &in_sensor_cloud);
+	/*!
+	 * Clips, removes close points and classifies the cloud in a single pass, using radial buckets that are reused
+	 * across scans. Radial divisions are independent, so they are sorted and classified in parallel.
+	 * Equivalent to ClipCloud, RemovePointsUpTo, ConvertXYZIToRTZColor and ClassifyPointCloud without the colors.
+	 * @param in_cloud_ptr Input PointCloud
+	 * @param out_ground_cloud_ptr Resulting PointCloud with the points classified as ground
+	 * @param out_no_ground_cloud_ptr Resulting PointCloud with the points classified as not ground
+	 */
+	void SegmentCloudSinglePass(const pcl::PointCloud<pcl::PointXYZI>::ConstPtr in_cloud_ptr,
+	                            pcl::PointCloud<pcl::PointXYZI>::Ptr out_ground_cloud_ptr,
+	                            pcl::PointCloud<pcl::PointXYZI>::Ptr out_no_ground_cloud_ptr);
+
+	/*!
+	 * Clips, removes close points and classifies the cloud with the per point structures, colors included
+	 * @param in_cloud_ptr Input PointCloud
+	 * @param out_ground_cloud_ptr Resulting PointCloud with the points classified as ground
+	 * @param out_no_ground_cloud_ptr Resulting PointCloud with the points classified as not ground
+	 */
+	void SegmentCloud(const pcl::PointCloud<pcl::PointXYZI>::ConstPtr in_cloud_ptr,
+	                  pcl::PointCloud<pcl::PointXYZI>::Ptr out_ground_cloud_ptr,
+	                  pcl::PointCloud<pcl::PointXYZI>::Ptr out_no_ground_cloud_ptr);
+
+	void CloudCallback(const pcl::PointCloud<pcl::PointXYZI>::ConstPtr &in_sensor_cloud);
 	
 friend class RayGroundFilter_clipCloud_Test;
+friend class RayGroundFilterSinglePass;
+friend class RayGroundFilterSinglePass_matchesSegmentCloud_Test;
+friend class RayGroundFilterSinglePass_benchmark_Test;
 public:
 	RayGroundFilter();
-  void Run();
+
+	/*!
+	 * Constructs the filter on the given private node handle, used by the nodelet
+	 * @param in_private_handle Handle from which parameters are read and topics are resolved
+	 */
+	explicit RayGroundFilter(ros::NodeHandle in_private_handle);
+
+	/*!
+	 * Reads the parameters, subscribes and advertises. Does not block.
+	 */
+	void Init();
+
+	/*!
+	 * Init() followed by ros::spin(), used by the standalone node
+	 */
+	void Run();
 };
 
 #endif  // RAY_GROUND_FILTER_H_
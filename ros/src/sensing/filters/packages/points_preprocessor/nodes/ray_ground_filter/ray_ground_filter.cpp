@@ -69,10 +69,9 @@ void RayGroundFilter::publish_cloud(const ros::Publisher& in_publisher,
     const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_to_publish_ptr,
     const std_msgs::Header& in_header)
 {
-  sensor_msgs::PointCloud2 cloud_msg;
-  pcl::toROSMsg(*in_cloud_to_publish_ptr, cloud_msg);
-  cloud_msg.header = in_header;
-  in_publisher.publish(cloud_msg);
+  // publish the pcl cloud itself, so subscribers in the same nodelet manager receive it without serialization
+  in_cloud_to_publish_ptr->header = pcl_conversions::toPCL(in_header);
+  in_publisher.publish(in_cloud_to_publish_ptr);
 }
 
 /*!
@@ -221,7 +220,7 @@ void RayGroundFilter::ClassifyPointCloud(std::vector<PointCloudXYZIRTColor>& in_
  * @param in_clip_height Maximum allowed height in the cloud
  * @param out_clipped_cloud_ptr Resultung PointCloud with the points removed
  */
-void RayGroundFilter::ClipCloud(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr,
+void RayGroundFilter::ClipCloud(const pcl::PointCloud<pcl::PointXYZI>::ConstPtr in_cloud_ptr,
     double in_clip_height,
     pcl::PointCloud<pcl::PointXYZI>::Ptr out_clipped_cloud_ptr)
 {
@@ -295,15 +294,143 @@ void RayGroundFilter::RemovePointsUpTo(const pcl::PointCloud<pcl::PointXYZI>::Pt
   extractor.filter(*out_filtered_cloud_ptr);
 }
 
-void RayGroundFilter::CloudCallback(const sensor_msgs::PointCloud2ConstPtr &in_sensor_cloud)
+void RayGroundFilter::SegmentCloudSinglePass(const pcl::PointCloud<pcl::PointXYZI>::ConstPtr in_cloud_ptr,
+    pcl::PointCloud<pcl::PointXYZI>::Ptr out_ground_cloud_ptr,
+    pcl::PointCloud<pcl::PointXYZI>::Ptr out_no_ground_cloud_ptr)
 {
-  pcl::PointCloud<pcl::PointXYZI>::Ptr current_sensor_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
-  pcl::fromROSMsg(*in_sensor_cloud, *current_sensor_cloud_ptr);
+  const std::vector<pcl::PointXYZI, Eigen::aligned_allocator<pcl::PointXYZI> >& points = in_cloud_ptr->points;
+  const size_t points_num = points.size();
+  const size_t buckets_num = radial_dividers_num_;
+  const uint32_t discarded = (uint32_t) buckets_num;
+
+  //resize keeps the capacity, after the first scans no allocation happens here
+  point_radius_.resize(points_num);
+  point_bucket_.resize(points_num);
+  point_ground_.resize(points_num);
+  bucket_offsets_.assign(buckets_num + 1, 0);
+
+  //polar coordinates, clipping and removal of close points in a single sweep
+#pragma omp parallel for
+  for (size_t i = 0; i < points_num; i++)
+  {
+    const pcl::PointXYZI& point = points[i];
+    auto radius = (float) sqrt(point.x*point.x + point.y*point.y);
+    point_radius_[i] = radius;
+    if (!pcl_isfinite(point.x) || !pcl_isfinite(point.y) || !pcl_isfinite(point.z)
+        || point.z > clipping_height_ || radius < min_point_distance_)
+    {
+      point_bucket_[i] = discarded;
+      continue;
+    }
+    auto theta = (float) atan2(point.y, point.x) * 180 / M_PI;
+    if (theta < 0){ theta+=360; }
+    point_bucket_[i] = std::min((uint32_t) floor(theta/radial_divider_angle_), discarded - 1);
+  }
+
+  //counting sort of the valid points into their radial divisions, keeps the input order inside each division
+  for (size_t i = 0; i < points_num; i++)
+  {
+    if (point_bucket_[i] != discarded)
+    { bucket_offsets_[point_bucket_[i] + 1]++; }
+  }
+  for (size_t b = 0; b < buckets_num; b++)
+  {
+    bucket_offsets_[b + 1] += bucket_offsets_[b];
+  }
+  bucket_points_.resize(bucket_offsets_[buckets_num]);
+  for (size_t i = 0; i < points_num; i++)
+  {
+    if (point_bucket_[i] != discarded)
+    { bucket_points_[bucket_offsets_[point_bucket_[i]]++] = i; }
+  }
+  //the scatter moved every offset to the start of the next division, shift them back
+  for (size_t b = buckets_num; b > 0; b--)
+  {
+    bucket_offsets_[b] = bucket_offsets_[b - 1];
+  }
+  bucket_offsets_[0] = 0;
+
+  const double local_slope = tan(DEG2RAD(local_max_slope_));
+  const double general_slope = tan(DEG2RAD(general_max_slope_));
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for (size_t b = 0; b < buckets_num; b++)//sweep through each radial division
+  {
+    std::vector<uint32_t>::iterator begin = bucket_points_.begin() + bucket_offsets_[b];
+    std::vector<uint32_t>::iterator end = bucket_points_.begin() + bucket_offsets_[b + 1];
+    std::sort(begin, end, [this](uint32_t a, uint32_t c)
+      { return point_radius_[a] < point_radius_[c] || (point_radius_[a] == point_radius_[c] && a < c); });
 
+    float prev_radius = 0.f;
+    float prev_height = - sensor_height_;
+    bool prev_ground = false;
+    bool current_ground = false;
+    for (std::vector<uint32_t>::iterator it = begin; it != end; ++it)//loop through each point in the radial div
+    {
+      const uint32_t index = *it;
+      float radius = point_radius_[index];
+      float current_height = points[index].z;
+      float points_distance = radius - prev_radius;
+      float height_threshold = local_slope * points_distance;
+      float general_height_threshold = general_slope * radius;
+
+      //for points which are very close causing the height threshold to be tiny, set a minimum value
+      if (points_distance > concentric_divider_distance_ && height_threshold < min_height_threshold_)
+      { height_threshold = min_height_threshold_; }
+
+      //check current point height against the LOCAL threshold (previous point)
+      if (current_height <= (prev_height + height_threshold)
+          && current_height >= (prev_height - height_threshold))
+      {
+        //Check again using general geometry (radius from origin) if previous points wasn't ground
+        current_ground = prev_ground
+            || (current_height <= (-sensor_height_ + general_height_threshold)
+                && current_height >= (-sensor_height_ - general_height_threshold));
+      }
+      else
+      {
+        //check if previous point is too far from previous one, if so classify again
+        current_ground = points_distance > reclass_distance_threshold_
+            && current_height <= (-sensor_height_ + height_threshold)
+            && current_height >= (-sensor_height_ - height_threshold);
+      }
+
+      point_ground_[index] = current_ground;
+      prev_ground = current_ground;
+      prev_radius = radius;
+      prev_height = current_height;
+    }
+  }
+
+  size_t ground_num = 0;
+  for (size_t i = 0; i < points_num; i++)
+  {
+    if (point_bucket_[i] != discarded && point_ground_[i])
+    { ground_num++; }
+  }
+  out_ground_cloud_ptr->points.reserve(ground_num);
+  out_no_ground_cloud_ptr->points.reserve(bucket_points_.size() - ground_num);
+  for (size_t i = 0; i < points_num; i++)
+  {
+    if (point_bucket_[i] == discarded)
+    { continue; }
+    if (point_ground_[i])
+    { out_ground_cloud_ptr->push_back(points[i]); }
+    else
+    { out_no_ground_cloud_ptr->push_back(points[i]); }
+  }
+  out_ground_cloud_ptr->header = in_cloud_ptr->header;
+  out_no_ground_cloud_ptr->header = in_cloud_ptr->header;
+}
+
+void RayGroundFilter::SegmentCloud(const pcl::PointCloud<pcl::PointXYZI>::ConstPtr in_cloud_ptr,
+    pcl::PointCloud<pcl::PointXYZI>::Ptr out_ground_cloud_ptr,
+    pcl::PointCloud<pcl::PointXYZI>::Ptr out_no_ground_cloud_ptr)
+{
   pcl::PointCloud<pcl::PointXYZI>::Ptr clipped_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
 
   //remove points above certain point
-  ClipCloud(current_sensor_cloud_ptr, clipping_height_, clipped_cloud_ptr);
+  ClipCloud(in_cloud_ptr, clipping_height_, clipped_cloud_ptr);
 
   //remove closer points than a threshold
   pcl::PointCloud<pcl::PointXYZI>::Ptr filtered_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
@@ -318,8 +445,6 @@ void RayGroundFilter::CloudCallback(const sensor_msgs::PointCloud2ConstPtr &in_s
   std::vector<pcl::PointIndices> closest_indices;
   std::vector<PointCloudXYZIRTColor> radial_ordered_clouds;
 
-  radial_dividers_num_ = ceil(360 / radial_divider_angle_);
-
   ConvertXYZIToRTZColor(filtered_cloud_ptr,
       organized_points,
       radial_division_indices,
@@ -329,21 +454,43 @@ void RayGroundFilter::CloudCallback(const sensor_msgs::PointCloud2ConstPtr &in_s
 
   ClassifyPointCloud(radial_ordered_clouds, ground_indices, no_ground_indices);
 
+  ExtractPointsIndices(filtered_cloud_ptr, ground_indices, out_ground_cloud_ptr, out_no_ground_cloud_ptr);
+}
+
+void RayGroundFilter::CloudCallback(const pcl::PointCloud<pcl::PointXYZI>::ConstPtr &in_sensor_cloud)
+{
   pcl::PointCloud<pcl::PointXYZI>::Ptr ground_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
   pcl::PointCloud<pcl::PointXYZI>::Ptr no_ground_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
 
-  ExtractPointsIndices(filtered_cloud_ptr, ground_indices, ground_cloud_ptr, no_ground_cloud_ptr);
+  radial_dividers_num_ = ceil(360 / radial_divider_angle_);
+
+  if (single_pass_)
+    SegmentCloudSinglePass(in_sensor_cloud, ground_cloud_ptr, no_ground_cloud_ptr);
+  else
+    SegmentCloud(in_sensor_cloud, ground_cloud_ptr, no_ground_cloud_ptr);
+
+  std_msgs::Header header = pcl_conversions::fromPCL(in_sensor_cloud->header);
+  publish_cloud(ground_points_pub_, ground_cloud_ptr, header);
+  publish_cloud(groundless_points_pub_, no_ground_cloud_ptr, header);
 
-  publish_cloud(ground_points_pub_, ground_cloud_ptr, in_sensor_cloud->header);
-  publish_cloud(groundless_points_pub_, no_ground_cloud_ptr, in_sensor_cloud->header);
+}
 
+RayGroundFilter::RayGroundFilter():node_handle_("~"), single_pass_(true)
+{
 }
 
-RayGroundFilter::RayGroundFilter():node_handle_("~")
+RayGroundFilter::RayGroundFilter(ros::NodeHandle in_private_handle):node_handle_(in_private_handle), single_pass_(true)
 {
 }
 
 void RayGroundFilter::Run()
+{
+  Init();
+
+  ros::spin();
+}
+
+void RayGroundFilter::Init()
 {
   //Model   |   Horizontal   |   Vertical   | FOV(Vertical)    degrees / rads
   //----------------------------------------------------------
@@ -376,6 +523,8 @@ void RayGroundFilter::Run()
   ROS_INFO("min_point_distance[meters]: %f", min_point_distance_);
   node_handle_.param("reclass_distance_threshold", reclass_distance_threshold_, 0.2);//0.5 meters default
   ROS_INFO("reclass_distance_threshold[meters]: %f", reclass_distance_threshold_);
+  node_handle_.param("single_pass", single_pass_, true);//false uses the per point structures with colors
+  ROS_INFO("single_pass: %d", single_pass_);
 
 
 #if (CV_MAJOR_VERSION == 3)
@@ -398,12 +547,9 @@ void RayGroundFilter::Run()
 
   config_node_sub_ = node_handle_.subscribe("/config/ray_ground_filter", 1, &RayGroundFilter::update_config_params, this);
 
-  groundless_points_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>(no_ground_topic, 2);
-  ground_points_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>(ground_topic, 2);
+  groundless_points_pub_ = node_handle_.advertise<pcl::PointCloud<pcl::PointXYZI> >(no_ground_topic, 2);
+  ground_points_pub_ = node_handle_.advertise<pcl::PointCloud<pcl::PointXYZI> >(ground_topic, 2);
 
   ROS_INFO("Ready");
-
-  ros::spin();
-
 }
 
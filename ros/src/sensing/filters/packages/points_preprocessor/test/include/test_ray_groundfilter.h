@@ -1,5 +1,10 @@
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
 
 #include <ros/ros.h>
 
@@ -53,3 +58,159 @@ TEST(RayGroundFilter, clipCloud)
   ASSERT_LT(fabsf(out_cloud_ptr->points[3].y - 6.0F), TOL);
   ASSERT_LT(fabsf(out_cloud_ptr->points[3].z - 1.5F), TOL);
 }
+
+// Simulates a rotating lidar with in_beams lasers spread over a -25..2 degrees vertical field of view,
+// 1800 firings per revolution, looking at a flat ground, a few boxes and a surrounding wall
+static pcl::PointCloud<pcl::PointXYZI>::Ptr MakeLidarScan(int in_beams, float in_sensor_height)
+{
+  pcl::PointCloud<pcl::PointXYZI>::Ptr cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+  const int firings = 1800;
+  const float wall_distance = 60.0F;
+  cloud_ptr->points.reserve(in_beams * firings);
+  for (int f = 0; f < firings; f++)
+  {
+    float azimuth = 2.0F * M_PI * f / firings;
+    // a box every 45 degrees, 10 degrees wide, at increasing distances
+    float sector = fmodf(azimuth * 180.0F / M_PI, 45.0F);
+    float box_distance = (sector < 10.0F) ? 8.0F + 4.0F * floorf(azimuth * 4.0F / M_PI) : -1.0F;
+    for (int b = 0; b < in_beams; b++)
+    {
+      float elevation = (-25.0F + 27.0F * b / (in_beams - 1)) * M_PI / 180.0F;
+      float range = (elevation < 0.0F) ? in_sensor_height / tanf(-elevation) : wall_distance;
+      if (range > wall_distance)
+        range = wall_distance;
+      if (box_distance > 0.0F && range > box_distance)
+        range = box_distance;
+      // beams hitting a vertical surface would share the same radius, whose order inside a radial
+      // division is unspecified, so spread them a little
+      range += 0.001F * b;
+      pcl::PointXYZI pt;
+      pt.x = range * cosf(azimuth);
+      pt.y = range * sinf(azimuth);
+      pt.z = range * tanf(elevation);
+      pt.intensity = b;
+      cloud_ptr->push_back(pt);
+    }
+  }
+  return cloud_ptr;
+}
+
+static bool LessXYZ(const pcl::PointXYZI& a, const pcl::PointXYZI& b)
+{
+  if (a.x != b.x) return a.x < b.x;
+  if (a.y != b.y) return a.y < b.y;
+  return a.z < b.z;
+}
+
+static bool EqualXYZ(const pcl::PointXYZI& a, const pcl::PointXYZI& b)
+{
+  return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+// the fixture is a friend of RayGroundFilter, so it can set the parameters without a parameter server
+class RayGroundFilterSinglePass : public ::testing::Test
+{
+protected:
+  static const float SENSOR_HEIGHT;
+
+  virtual void SetUp()
+  {
+    if (!ros::isInitialized())
+    {
+      char* argv = "test_points_preprocessor";
+      int argc = 1;
+      ros::init(argc, &argv, "test_raygroundfilter_singlepass");
+    }
+    rgfilter_.reset(new RayGroundFilter);
+    rgfilter_->sensor_height_ = SENSOR_HEIGHT;
+    rgfilter_->general_max_slope_ = 5.0;
+    rgfilter_->local_max_slope_ = 8.0;
+    rgfilter_->radial_divider_angle_ = 0.08;
+    rgfilter_->concentric_divider_distance_ = 0.01;
+    rgfilter_->min_height_threshold_ = 0.05;
+    rgfilter_->clipping_height_ = 0.2;
+    rgfilter_->min_point_distance_ = 1.85;
+    rgfilter_->reclass_distance_threshold_ = 0.2;
+    rgfilter_->radial_dividers_num_ = ceil(360 / rgfilter_->radial_divider_angle_);
+    rgfilter_->colors_.assign(rgfilter_->color_num_, cv::Scalar(0, 0, 0));
+  }
+
+  boost::shared_ptr<RayGroundFilter> rgfilter_;
+};
+
+const float RayGroundFilterSinglePass::SENSOR_HEIGHT = 1.8F;
+
+TEST_F(RayGroundFilterSinglePass, matchesSegmentCloud)
+{
+  RayGroundFilter& rgfilter = *rgfilter_;
+
+  pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr = MakeLidarScan(32, SENSOR_HEIGHT);
+  pcl::PointXYZI nan_pt;
+  nan_pt.x = nan_pt.y = nan_pt.z = std::numeric_limits<float>::quiet_NaN();
+  in_cloud_ptr->push_back(nan_pt);
+
+  pcl::PointCloud<pcl::PointXYZI>::Ptr ground_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::PointCloud<pcl::PointXYZI>::Ptr no_ground_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::PointCloud<pcl::PointXYZI>::Ptr ref_ground_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+  pcl::PointCloud<pcl::PointXYZI>::Ptr ref_no_ground_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+
+  // the reference path does not handle NaN points, feed it the finite ones only
+  pcl::PointCloud<pcl::PointXYZI>::Ptr finite_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>(*in_cloud_ptr));
+  finite_cloud_ptr->points.pop_back();
+  finite_cloud_ptr->width = finite_cloud_ptr->points.size();
+  rgfilter.SegmentCloud(finite_cloud_ptr, ref_ground_ptr, ref_no_ground_ptr);
+
+  // run twice, the second run reuses the buffers of the first one
+  rgfilter.SegmentCloudSinglePass(in_cloud_ptr, ground_ptr, no_ground_ptr);
+  ground_ptr->clear();
+  no_ground_ptr->clear();
+  rgfilter.SegmentCloudSinglePass(in_cloud_ptr, ground_ptr, no_ground_ptr);
+
+  ASSERT_GT(ref_ground_ptr->points.size(), 0U);
+  ASSERT_GT(ref_no_ground_ptr->points.size(), 0U);
+  ASSERT_EQ(ground_ptr->points.size(), ref_ground_ptr->points.size());
+  ASSERT_EQ(no_ground_ptr->points.size(), ref_no_ground_ptr->points.size());
+
+  std::sort(ground_ptr->points.begin(), ground_ptr->points.end(), LessXYZ);
+  std::sort(ref_ground_ptr->points.begin(), ref_ground_ptr->points.end(), LessXYZ);
+  std::sort(no_ground_ptr->points.begin(), no_ground_ptr->points.end(), LessXYZ);
+  std::sort(ref_no_ground_ptr->points.begin(), ref_no_ground_ptr->points.end(), LessXYZ);
+  ASSERT_TRUE(std::equal(ground_ptr->points.begin(), ground_ptr->points.end(), ref_ground_ptr->points.begin(),
+                         EqualXYZ));
+  ASSERT_TRUE(std::equal(no_ground_ptr->points.begin(), no_ground_ptr->points.end(),
+                         ref_no_ground_ptr->points.begin(), EqualXYZ));
+}
+
+// Prints the per scan time of both paths for 32, 64 and 128 beam sensors
+TEST_F(RayGroundFilterSinglePass, benchmark)
+{
+  const int SCANS = 10;
+  const int BEAMS[] = { 32, 64, 128 };
+  RayGroundFilter& rgfilter = *rgfilter_;
+
+  for (int beams : BEAMS)
+  {
+    pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr = MakeLidarScan(beams, SENSOR_HEIGHT);
+    double elapsed_ms[2] = { 0.0, 0.0 };
+    size_t ground_num[2] = { 0, 0 };
+    for (int scan = 0; scan < SCANS; scan++)
+    {
+      for (int path = 0; path < 2; path++)
+      {
+        pcl::PointCloud<pcl::PointXYZI>::Ptr ground_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+        pcl::PointCloud<pcl::PointXYZI>::Ptr no_ground_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (path == 0)
+          rgfilter.SegmentCloud(in_cloud_ptr, ground_ptr, no_ground_ptr);
+        else
+          rgfilter.SegmentCloudSinglePass(in_cloud_ptr, ground_ptr, no_ground_ptr);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        elapsed_ms[path] += std::chrono::duration<double, std::milli>(end - start).count();
+        ground_num[path] = ground_ptr->points.size();
+      }
+    }
+    printf("RayGroundFilter %3d beams, %6zu points: SegmentCloud %8.3f ms/scan, SegmentCloudSinglePass %8.3f ms/scan\n",
+           beams, in_cloud_ptr->points.size(), elapsed_ms[0] / SCANS, elapsed_ms[1] / SCANS);
+    ASSERT_EQ(ground_num[0], ground_num[1]);
+  }
+}